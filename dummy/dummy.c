@@ -63,6 +63,15 @@ struct dummy_priv_data {
 
 		char *magic_conf;
 		int static_data;
+
+		/* simulated link, see dummy_link() */
+		int sim_baud;
+		int sim_latency;	/* ms */
+		int sim_jitter;		/* ms */
+		float sim_timeouts;	/* % of the commands */
+		int sim_protocol;
+		unsigned long sim_seed;	/* as configured */
+		unsigned long sim_rand;	/* state of dummy_link_rand() */
 };
 
 /* levels pertain to each VFO */
@@ -95,6 +104,24 @@ static const struct confparams dummy_cfg_params[] = {
 	{ TOK_CFG_STATIC_DATA, "static_data", "Static data", "Output only static data, no randomization of S-meter values",
 		"0", RIG_CONF_CHECKBUTTON, { }
 	},
+	{ TOK_CFG_SIM_BAUD, "sim_baud", "Simulated baud rate", "Simulated serial speed, 0 for an instant link",
+		"0", RIG_CONF_NUMERIC, { .n = { 0, 115200, 1 } }
+	},
+	{ TOK_CFG_SIM_LATENCY, "sim_latency", "Simulated latency", "Simulated processing time of each command, in ms",
+		"0", RIG_CONF_NUMERIC, { .n = { 0, 10000, 1 } }
+	},
+	{ TOK_CFG_SIM_JITTER, "sim_jitter", "Simulated jitter", "Random extra processing time of each command, up to this many ms",
+		"0", RIG_CONF_NUMERIC, { .n = { 0, 10000, 1 } }
+	},
+	{ TOK_CFG_SIM_TIMEOUTS, "sim_timeouts", "Simulated timeouts", "Percentage of the commands that time out",
+		"0", RIG_CONF_NUMERIC, { .n = { 0, 100, .1 } }
+	},
+	{ TOK_CFG_SIM_PROTOCOL, "sim_protocol", "Simulated protocol", "Protocol the command and reply sizes are taken from",
+		"Kenwood", RIG_CONF_COMBO, { .c = {{ "Kenwood", "Yaesu", "Icom", NULL }} }
+	},
+	{ TOK_CFG_SIM_SEED, "sim_seed", "Simulation seed", "Seed of the jitter and timeouts, for repeatable runs",
+		"1", RIG_CONF_NUMERIC, { .n = { 0, 0x7fffffff, 1 } }
+	},
 	{ RIG_CONF_END, NULL, }
 };
 
@@ -136,7 +163,8 @@ static void copy_chan(channel_t *dest, const channel_t *src)
 
     /* TODO: ext_levels[] of different sizes */
 
-    for (i=0; !RIG_IS_EXT_END(src->ext_levels[i]) &&
+    for (i=0; src->ext_levels && dest->ext_levels &&
+            !RIG_IS_EXT_END(src->ext_levels[i]) &&
             !RIG_IS_EXT_END(dest->ext_levels[i]); i++) {
         dest->ext_levels[i] = src->ext_levels[i];
     }
@@ -181,6 +209,167 @@ static struct ext_list * find_ext(struct ext_list *elp, token_t token)
   return NULL;
 }
 
+/*
+ * Simulated link
+ *
+ * Each command costs the time to send it and its reply at sim_baud,
+ * plus the processing time of the rig, sim_latency and up to sim_jitter
+ * more.  sim_timeouts percent of the commands are lost, and fail after
+ * the port timeout without changing anything.  The sizes of the commands
+ * and replies are those of the protocol in sim_protocol, including the
+ * "ID;" read back of the Kenwood sets and the echo of the Icom CI-V bus.
+ */
+enum dummy_op {
+  DUMMY_OP_SET_FREQ,
+  DUMMY_OP_GET_FREQ,
+  DUMMY_OP_SET_MODE,
+  DUMMY_OP_GET_MODE,
+  DUMMY_OP_SET_VFO,
+  DUMMY_OP_GET_VFO,
+  DUMMY_OP_SET_PTT,
+  DUMMY_OP_GET_PTT,
+  DUMMY_OP_GET_DCD,
+  DUMMY_OP_SET_LEVEL,
+  DUMMY_OP_GET_LEVEL,
+  DUMMY_OP_SET_FUNC,
+  DUMMY_OP_GET_FUNC,
+  DUMMY_OP_SET_MEM,
+  DUMMY_OP_GET_MEM,
+  DUMMY_OP_SET_CHANNEL,
+  DUMMY_OP_GET_CHANNEL,
+  DUMMY_OP_SET,		/* any other setting */
+  DUMMY_OP_GET,
+  DUMMY_OP_NB
+};
+
+enum dummy_protocol {
+  DUMMY_PROTO_KENWOOD,
+  DUMMY_PROTO_YAESU,
+  DUMMY_PROTO_ICOM,
+  DUMMY_PROTO_NB
+};
+
+static const char *const dummy_proto_names[DUMMY_PROTO_NB] = {
+  "Kenwood", "Yaesu", "Icom"
+};
+
+/* bytes sent and received, per operation */
+static const unsigned char dummy_link_bytes[DUMMY_PROTO_NB][DUMMY_OP_NB][2] = {
+  [DUMMY_PROTO_KENWOOD] = {
+    [DUMMY_OP_SET_FREQ] = { 17, 6 },	/* FA00014074000; ID; */
+    [DUMMY_OP_GET_FREQ] = { 3, 14 },
+    [DUMMY_OP_SET_MODE] = { 7, 6 },
+    [DUMMY_OP_GET_MODE] = { 3, 4 },
+    [DUMMY_OP_SET_VFO] = { 11, 6 },	/* FR0;FT0; ID; */
+    [DUMMY_OP_GET_VFO] = { 3, 4 },
+    [DUMMY_OP_SET_PTT] = { 6, 6 },
+    [DUMMY_OP_GET_PTT] = { 3, 38 },	/* IF; */
+    [DUMMY_OP_GET_DCD] = { 3, 5 },
+    [DUMMY_OP_SET_LEVEL] = { 10, 6 },
+    [DUMMY_OP_GET_LEVEL] = { 4, 8 },
+    [DUMMY_OP_SET_FUNC] = { 7, 6 },
+    [DUMMY_OP_GET_FUNC] = { 4, 5 },
+    [DUMMY_OP_SET_MEM] = { 9, 6 },
+    [DUMMY_OP_GET_MEM] = { 3, 6 },
+    [DUMMY_OP_SET_CHANNEL] = { 53, 6 },
+    [DUMMY_OP_GET_CHANNEL] = { 7, 50 },
+    [DUMMY_OP_SET] = { 10, 6 },
+    [DUMMY_OP_GET] = { 3, 10 },
+  },
+  [DUMMY_PROTO_YAESU] = {
+    [DUMMY_OP_SET_FREQ] = { 12, 0 },	/* FA014074000; */
+    [DUMMY_OP_GET_FREQ] = { 3, 12 },
+    [DUMMY_OP_SET_MODE] = { 5, 0 },
+    [DUMMY_OP_GET_MODE] = { 4, 5 },
+    [DUMMY_OP_SET_VFO] = { 4, 0 },
+    [DUMMY_OP_GET_VFO] = { 3, 4 },
+    [DUMMY_OP_SET_PTT] = { 4, 0 },
+    [DUMMY_OP_GET_PTT] = { 3, 4 },
+    [DUMMY_OP_GET_DCD] = { 3, 5 },
+    [DUMMY_OP_SET_LEVEL] = { 7, 0 },
+    [DUMMY_OP_GET_LEVEL] = { 4, 8 },
+    [DUMMY_OP_SET_FUNC] = { 5, 0 },
+    [DUMMY_OP_GET_FUNC] = { 4, 5 },
+    [DUMMY_OP_SET_MEM] = { 6, 0 },
+    [DUMMY_OP_GET_MEM] = { 3, 6 },
+    [DUMMY_OP_SET_CHANNEL] = { 29, 0 },
+    [DUMMY_OP_GET_CHANNEL] = { 6, 29 },
+    [DUMMY_OP_SET] = { 6, 0 },
+    [DUMMY_OP_GET] = { 4, 8 },
+  },
+  [DUMMY_PROTO_ICOM] = {
+    [DUMMY_OP_SET_FREQ] = { 11, 17 },	/* echo, then FB */
+    [DUMMY_OP_GET_FREQ] = { 6, 17 },
+    [DUMMY_OP_SET_MODE] = { 8, 14 },
+    [DUMMY_OP_GET_MODE] = { 6, 14 },
+    [DUMMY_OP_SET_VFO] = { 7, 13 },
+    [DUMMY_OP_GET_VFO] = { 7, 15 },
+    [DUMMY_OP_SET_PTT] = { 8, 14 },
+    [DUMMY_OP_GET_PTT] = { 7, 15 },
+    [DUMMY_OP_GET_DCD] = { 7, 15 },
+    [DUMMY_OP_SET_LEVEL] = { 9, 15 },
+    [DUMMY_OP_GET_LEVEL] = { 7, 16 },
+    [DUMMY_OP_SET_FUNC] = { 8, 14 },
+    [DUMMY_OP_GET_FUNC] = { 7, 15 },
+    [DUMMY_OP_SET_MEM] = { 8, 14 },
+    [DUMMY_OP_GET_MEM] = { 7, 15 },
+    [DUMMY_OP_SET_CHANNEL] = { 40, 46 },
+    [DUMMY_OP_GET_CHANNEL] = { 9, 49 },
+    [DUMMY_OP_SET] = { 8, 14 },
+    [DUMMY_OP_GET] = { 7, 15 },
+  },
+};
+
+/* repeatable from the seed, and independent of rand() users */
+static unsigned dummy_link_rand(struct dummy_priv_data *priv)
+{
+  priv->sim_rand = priv->sim_rand * 1103515245 + 12345;
+
+  return (priv->sim_rand >> 16) & 0x7fff;
+}
+
+static int dummy_link(RIG *rig, enum dummy_op op)
+{
+  struct dummy_priv_data *priv = (struct dummy_priv_data *)rig->state.priv;
+  const unsigned char *bytes;
+  unsigned long us;
+
+  if (!priv->sim_baud && !priv->sim_latency && !priv->sim_jitter
+      && priv->sim_timeouts <= 0)
+    return RIG_OK;
+
+  if (priv->sim_timeouts > 0
+      && dummy_link_rand(priv) * 100. / 0x8000 < priv->sim_timeouts)
+    {
+      rig_debug(RIG_DEBUG_WARN, "%s: simulated timeout\n", __func__);
+      usleep(1000UL * rig->state.rigport.timeout);
+      return -RIG_ETIMEOUT;
+    }
+
+  bytes = dummy_link_bytes[priv->sim_protocol][op];
+
+  us = 1000UL * priv->sim_latency;
+
+  if (priv->sim_jitter)
+    us += 1000UL * priv->sim_jitter * dummy_link_rand(priv) / 0x8000;
+
+  /* 8N1, 10 bits per byte */
+  if (priv->sim_baud)
+    us += 10000000UL * (bytes[0] + bytes[1]) / priv->sim_baud;
+
+  if (us)
+    usleep(us);
+
+  return RIG_OK;
+}
+
+#define DUMMY_LINK(rig, op) \
+  do { \
+    int _retval = dummy_link((rig), (op)); \
+    if (_retval != RIG_OK) \
+      return _retval; \
+  } while (0)
+
 static int dummy_init(RIG *rig)
 {
   struct dummy_priv_data *priv;
@@ -227,6 +416,14 @@ static int dummy_init(RIG *rig)
 
   priv->magic_conf = strdup("DX");
 
+  priv->sim_baud = 0;
+  priv->sim_latency = 0;
+  priv->sim_jitter = 0;
+  priv->sim_timeouts = 0;
+  priv->sim_protocol = DUMMY_PROTO_KENWOOD;
+  priv->sim_seed = 1;
+  priv->sim_rand = priv->sim_seed;
+
   return RIG_OK;
 }
 
@@ -283,6 +480,32 @@ static int dummy_set_conf(RIG *rig, token_t token, const char *val)
 		case TOK_CFG_STATIC_DATA:
 			priv->static_data = atoi(val) ? 1 : 0;
 			break;
+		case TOK_CFG_SIM_BAUD:
+			priv->sim_baud = atoi(val);
+			break;
+		case TOK_CFG_SIM_LATENCY:
+			priv->sim_latency = atoi(val);
+			break;
+		case TOK_CFG_SIM_JITTER:
+			priv->sim_jitter = atoi(val);
+			break;
+		case TOK_CFG_SIM_TIMEOUTS:
+			priv->sim_timeouts = atof(val);
+			break;
+		case TOK_CFG_SIM_PROTOCOL:
+			if (!strcasecmp(val, "Kenwood"))
+				priv->sim_protocol = DUMMY_PROTO_KENWOOD;
+			else if (!strcasecmp(val, "Yaesu"))
+				priv->sim_protocol = DUMMY_PROTO_YAESU;
+			else if (!strcasecmp(val, "Icom"))
+				priv->sim_protocol = DUMMY_PROTO_ICOM;
+			else
+				return -RIG_EINVAL;
+			break;
+		case TOK_CFG_SIM_SEED:
+			priv->sim_seed = strtoul(val, NULL, 0);
+			priv->sim_rand = priv->sim_seed;
+			break;
 		default:
 			return -RIG_EINVAL;
 	}
@@ -299,6 +522,27 @@ static int dummy_get_conf(RIG *rig, token_t token, char *val)
 		case TOK_CFG_MAGICCONF:
 			strcpy(val, priv->magic_conf);
 			break;
+		case TOK_CFG_STATIC_DATA:
+			sprintf(val, "%d", priv->static_data);
+			break;
+		case TOK_CFG_SIM_BAUD:
+			sprintf(val, "%d", priv->sim_baud);
+			break;
+		case TOK_CFG_SIM_LATENCY:
+			sprintf(val, "%d", priv->sim_latency);
+			break;
+		case TOK_CFG_SIM_JITTER:
+			sprintf(val, "%d", priv->sim_jitter);
+			break;
+		case TOK_CFG_SIM_TIMEOUTS:
+			sprintf(val, "%g", priv->sim_timeouts);
+			break;
+		case TOK_CFG_SIM_PROTOCOL:
+			strcpy(val, dummy_proto_names[priv->sim_protocol]);
+			break;
+		case TOK_CFG_SIM_SEED:
+			sprintf(val, "%lu", priv->sim_seed);
+			break;
 		default:
 			return -RIG_EINVAL;
 	}
@@ -314,6 +558,9 @@ static int dummy_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
   sprintf_freq(fstr, freq);
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s %s\n", __FUNCTION__,
  			rig_strvfo(vfo), fstr);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET_FREQ);
+
   curr->freq = freq;
 
   return RIG_OK;
@@ -327,6 +574,8 @@ static int dummy_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n", __FUNCTION__, rig_strvfo(vfo));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_FREQ);
+
   *freq = curr->freq;
 
   return RIG_OK;
@@ -343,6 +592,8 @@ static int dummy_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s %s %s\n", __FUNCTION__,
   		rig_strvfo(vfo), rig_strrmode(mode), buf);
 
+  DUMMY_LINK(rig, DUMMY_OP_SET_MODE);
+
   curr->mode = mode;
 
   if (RIG_PASSBAND_NOCHANGE == width) return RIG_OK;
@@ -363,6 +614,8 @@ static int dummy_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n", __FUNCTION__, rig_strvfo(vfo));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_MODE);
+
   *mode = curr->mode;
   *width = curr->width;
 
@@ -377,6 +630,8 @@ static int dummy_set_vfo(RIG *rig, vfo_t vfo)
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n", __FUNCTION__, rig_strvfo(vfo));
 
+  DUMMY_LINK(rig, DUMMY_OP_SET_VFO);
+
   priv->last_vfo = priv->curr_vfo;
   priv->curr_vfo = vfo;
   switch (vfo) {
@@ -404,6 +659,8 @@ static int dummy_get_vfo(RIG *rig, vfo_t *vfo)
   *vfo = priv->curr_vfo;
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n", __FUNCTION__, rig_strvfo(*vfo));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_VFO);
+
   return RIG_OK;
 }
 
@@ -413,6 +670,9 @@ static int dummy_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
   struct dummy_priv_data *priv = (struct dummy_priv_data *)rig->state.priv;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET_PTT);
+
   priv->ptt = ptt;
 
   return RIG_OK;
@@ -426,6 +686,9 @@ static int dummy_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
   ptt_t par_status = RIG_PTT_OFF;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_GET_PTT);
+
   *ptt = priv->ptt;
 
   // sneak a look at the hardware PTT and OR that in with our result
@@ -447,6 +710,9 @@ static int dummy_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
   static int twiddle = 0;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_GET_DCD);
+
   *dcd = twiddle++ & 1 ? RIG_DCD_ON : RIG_DCD_OFF;
 
   return RIG_OK;
@@ -459,6 +725,9 @@ static int dummy_set_rptr_shift(RIG *rig, vfo_t vfo, rptr_shift_t rptr_shift)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->rptr_shift = rptr_shift;
 
   return RIG_OK;
@@ -473,6 +742,8 @@ static int dummy_get_rptr_shift(RIG *rig, vfo_t vfo, rptr_shift_t *rptr_shift)
   *rptr_shift = curr->rptr_shift;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -483,6 +754,9 @@ static int dummy_set_rptr_offs(RIG *rig, vfo_t vfo, shortfreq_t rptr_offs)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->rptr_offs = rptr_offs;
 
   return RIG_OK;
@@ -497,6 +771,8 @@ static int dummy_get_rptr_offs(RIG *rig, vfo_t vfo, shortfreq_t *rptr_offs)
   *rptr_offs = curr->rptr_offs;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -507,6 +783,9 @@ static int dummy_set_ctcss_tone(RIG *rig, vfo_t vfo, tone_t tone)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->ctcss_tone = tone;
 
   return RIG_OK;
@@ -521,6 +800,8 @@ static int dummy_get_ctcss_tone(RIG *rig, vfo_t vfo, tone_t *tone)
   *tone = curr->ctcss_tone;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -531,6 +812,9 @@ static int dummy_set_dcs_code(RIG *rig, vfo_t vfo, tone_t code)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->dcs_code = code;
 
   return RIG_OK;
@@ -545,6 +829,8 @@ static int dummy_get_dcs_code(RIG *rig, vfo_t vfo, tone_t *code)
   *code = curr->dcs_code;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -555,6 +841,9 @@ static int dummy_set_ctcss_sql(RIG *rig, vfo_t vfo, tone_t tone)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->ctcss_sql = tone;
 
   return RIG_OK;
@@ -569,6 +858,8 @@ static int dummy_get_ctcss_sql(RIG *rig, vfo_t vfo, tone_t *tone)
   *tone = curr->ctcss_sql;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -579,6 +870,9 @@ static int dummy_set_dcs_sql(RIG *rig, vfo_t vfo, unsigned int code)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->dcs_sql = code;
 
   return RIG_OK;
@@ -593,6 +887,8 @@ static int dummy_get_dcs_sql(RIG *rig, vfo_t vfo, unsigned int *code)
   *code = curr->dcs_sql;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -606,6 +902,9 @@ static int dummy_set_split_freq(RIG *rig, vfo_t vfo, freq_t tx_freq)
   sprintf_freq(fstr, tx_freq);
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s %s\n", __FUNCTION__,
  			rig_strvfo(vfo), fstr);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->tx_freq = tx_freq;
 
   return RIG_OK;
@@ -619,6 +918,8 @@ static int dummy_get_split_freq(RIG *rig, vfo_t vfo, freq_t *tx_freq)
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n", __FUNCTION__,rig_strvfo(vfo));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   *tx_freq = curr->tx_freq;
 
   return RIG_OK;
@@ -634,6 +935,8 @@ static int dummy_set_split_mode(RIG *rig, vfo_t vfo, rmode_t tx_mode, pbwidth_t
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s %s %s\n", __FUNCTION__,
   		rig_strvfo(vfo), rig_strrmode(tx_mode), buf);
 
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->tx_mode = tx_mode;
   if (RIG_PASSBAND_NOCHANGE == tx_width) return RIG_OK;
 
@@ -649,6 +952,8 @@ static int dummy_get_split_mode(RIG *rig, vfo_t vfo, rmode_t *tx_mode, pbwidth_t
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n", __FUNCTION__, rig_strvfo(vfo));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   *tx_mode = curr->tx_mode;
   *tx_width = curr->tx_width;
 
@@ -661,6 +966,9 @@ static int dummy_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->split = split;
 
   return RIG_OK;
@@ -675,6 +983,8 @@ static int dummy_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split, vfo_t *tx_vf
   *split = curr->split;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -684,6 +994,9 @@ static int dummy_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->rit = rit;
 
   return RIG_OK;
@@ -698,6 +1011,8 @@ static int dummy_get_rit(RIG *rig, vfo_t vfo, shortfreq_t *rit)
   *rit = curr->rit;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -708,6 +1023,9 @@ static int dummy_set_xit(RIG *rig, vfo_t vfo, shortfreq_t xit)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->xit = xit;
 
   return RIG_OK;
@@ -722,6 +1040,8 @@ static int dummy_get_xit(RIG *rig, vfo_t vfo, shortfreq_t *xit)
   *xit = curr->xit;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -732,6 +1052,9 @@ static int dummy_set_ts(RIG *rig, vfo_t vfo, shortfreq_t ts)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   curr->tuning_step = ts;
 
   return RIG_OK;
@@ -746,6 +1069,8 @@ static int dummy_get_ts(RIG *rig, vfo_t vfo, shortfreq_t *ts)
   *ts = curr->tuning_step;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -757,6 +1082,9 @@ static int dummy_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s %d\n",__FUNCTION__,
 				  rig_strfunc(func), status);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET_FUNC);
+
   if (status)
 	curr->funcs |=  func;
   else
@@ -776,6 +1104,8 @@ static int dummy_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n",__FUNCTION__,
 				  rig_strfunc(func));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_FUNC);
+
   return RIG_OK;
 }
 
@@ -791,6 +1121,8 @@ static int dummy_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
   if (idx >= RIG_SETTING_MAX)
       return -RIG_EINVAL;
 
+  DUMMY_LINK(rig, DUMMY_OP_SET_LEVEL);
+
   curr->levels[idx] = val;
 
   if (RIG_LEVEL_IS_FLOAT(level))
@@ -838,6 +1170,8 @@ static int dummy_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n",__FUNCTION__,
 				  rig_strlevel(level));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_LEVEL);
+
   return RIG_OK;
 }
 
@@ -934,6 +1268,9 @@ static int dummy_set_powerstat(RIG *rig, powerstat_t status)
   struct dummy_priv_data *priv = (struct dummy_priv_data *)rig->state.priv;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   priv->powerstat = status;
 
   return RIG_OK;
@@ -947,6 +1284,8 @@ static int dummy_get_powerstat(RIG *rig, powerstat_t *status)
   *status = priv->powerstat;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -967,6 +1306,9 @@ static int dummy_set_parm(RIG *rig, setting_t parm, value_t val)
 		  sprintf(pstr, "%d", val.i);
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s %s\n", __FUNCTION__,
 				  rig_strparm(parm), pstr);
+
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   priv->parms[idx] = val;
 
   return RIG_OK;
@@ -986,6 +1328,8 @@ static int dummy_get_parm(RIG *rig, setting_t parm, value_t *val)
   rig_debug(RIG_DEBUG_VERBOSE,"%s called %s\n",__FUNCTION__,
 				  rig_strparm(parm));
 
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   return RIG_OK;
 }
 
@@ -1080,9 +1424,12 @@ static int dummy_set_ant(RIG *rig, vfo_t vfo, ant_t ant)
   struct dummy_priv_data *priv = (struct dummy_priv_data *)rig->state.priv;
   channel_t *curr = priv->curr;
 
-  curr->ant = ant;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
+  curr->ant = ant;
+
   return RIG_OK;
 }
 
@@ -1093,6 +1440,9 @@ static int dummy_get_ant(RIG *rig, vfo_t vfo, ant_t *ant)
   channel_t *curr = priv->curr;
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  DUMMY_LINK(rig, DUMMY_OP_GET);
+
   *ant = curr->ant;
 
   return RIG_OK;
@@ -1106,6 +1456,8 @@ static int dummy_set_bank(RIG *rig, vfo_t vfo, int bank)
   priv->bank = bank;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   return RIG_OK;
 }
 
@@ -1116,6 +1468,8 @@ static int dummy_set_mem(RIG *rig, vfo_t vfo, int ch)
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_SET_MEM);
+
   if (ch < 0 || ch >= NB_CHAN)
 	return -RIG_EINVAL;
 
@@ -1136,6 +1490,8 @@ static int dummy_get_mem(RIG *rig, vfo_t vfo, int *ch)
   *ch = curr->channel_num;
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_MEM);
+
   return RIG_OK;
 }
 
@@ -1164,6 +1520,8 @@ static int dummy_vfo_op(RIG *rig, vfo_t vfo, vfo_op_t op)
   rig_debug(RIG_DEBUG_VERBOSE,"%s called: %s\n",__FUNCTION__,
 				  rig_strvfop(op));
 
+  DUMMY_LINK(rig, DUMMY_OP_SET);
+
   switch (op) {
 	  case RIG_OP_FROM_VFO:	/* VFO->MEM */
 			  if (priv->curr_vfo == RIG_VFO_MEM) {
@@ -1290,8 +1648,7 @@ static int dummy_set_channel(RIG *rig, const channel_t *chan)
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
-  if (!chan->ext_levels)
-      return -RIG_EINVAL;
+  DUMMY_LINK(rig, DUMMY_OP_SET_CHANNEL);
 
   if (chan->channel_num < 0 || chan->channel_num >= NB_CHAN)
       return -RIG_EINVAL;
@@ -1326,6 +1683,8 @@ static int dummy_get_channel(RIG *rig, channel_t *chan)
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  DUMMY_LINK(rig, DUMMY_OP_GET_CHANNEL);
+
   if (chan->channel_num < 0 || chan->channel_num >= NB_CHAN)
       return -RIG_EINVAL;
 
@@ -1498,6 +1857,7 @@ const struct rig_caps dummy_caps = {
   .ptt_type =       RIG_PTT_RIG,
   .dcd_type =       RIG_DCD_RIG,
   .port_type =      RIG_PORT_NONE,
+  .timeout =        1000,	/* of the simulated timeouts */
   .has_get_func =   DUMMY_FUNC,
   .has_set_func =   DUMMY_FUNC,
   .has_get_level =  DUMMY_LEVEL,
@@ -28,6 +28,12 @@
 /* backend conf */
 #define TOK_CFG_MAGICCONF    TOKEN_BACKEND(1)
 #define TOK_CFG_STATIC_DATA  TOKEN_BACKEND(2)
+#define TOK_CFG_SIM_BAUD     TOKEN_BACKEND(3)
+#define TOK_CFG_SIM_LATENCY  TOKEN_BACKEND(4)
+#define TOK_CFG_SIM_JITTER   TOKEN_BACKEND(5)
+#define TOK_CFG_SIM_TIMEOUTS TOKEN_BACKEND(6)
+#define TOK_CFG_SIM_PROTOCOL TOKEN_BACKEND(7)
+#define TOK_CFG_SIM_SEED     TOKEN_BACKEND(8)
 
 
 /* ext_level's and ext_parm's tokens */
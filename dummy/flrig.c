@@ -27,7 +27,17 @@
 #include <stdlib.h>
 #include <string.h>             /* String function definitions */
 #include <unistd.h>             /* UNIX standard function definitions */
+#include <ctype.h>
 #include <math.h>
+#include <sys/types.h>
+#ifdef HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
+#if defined (HAVE_SYS_SOCKET_H)
+#include <sys/socket.h>
+#elif HAVE_WS2TCPIP_H
+#include <ws2tcpip.h>
+#endif
 
 #include <hamlib/rig.h>
 #include <serial.h>
@@ -47,9 +57,18 @@
 #define MAXBANDWIDTHLEN 4096
 
 #define DEFAULTPATH "127.0.0.1:12345"
+#define FLRIG_PORT 12345
+
+/* how long a system.multicall status snapshot answers the getters */
+#define FLRIG_STATUS_MS 100
 
 #define FLRIG_VFOS (RIG_VFO_A|RIG_VFO_B)
 
+/* the calls of the system.multicall status snapshot */
+enum { ST_AB, ST_VFOA, ST_VFOB, ST_PTT, ST_SPLIT,
+       ST_MODEA, ST_MODEB, ST_BWA, ST_BWB, ST_N };
+#define ST_BIT(i) (1U << (i))
+
 #define FLRIG_MODES (RIG_MODE_AM | RIG_MODE_PKTAM | RIG_MODE_CW | RIG_MODE_CWR |\
                      RIG_MODE_RTTY | RIG_MODE_RTTYR |\
                      RIG_MODE_PKTLSB | RIG_MODE_PKTUSB |\
@@ -82,6 +101,7 @@ static int flrig_set_split_freq_mode(RIG *rig, vfo_t vfo, freq_t freq, rmode_t m
 static int flrig_get_split_freq_mode(RIG *rig, vfo_t vfo, freq_t *freq, rmode_t *mode, pbwidth_t *width);
 
 static const char *flrig_get_info(RIG *rig);
+static unsigned int modeMapGetHamlib(const char *modeFLRig);
 
 struct flrig_priv_data {
     vfo_t curr_vfo;
@@ -98,6 +118,15 @@ struct flrig_priv_data {
     pbwidth_t curr_widthB;
     int has_get_modeA; /* True if this function is available */
     int has_get_bwA; /* True if this function is available */
+    int has_multicall; /* True if system.multicall is available */
+    char *buf; /* reusable HTTP request/response buffer */
+    int buflen;
+    int reconnect; /* True if the connection must be reopened */
+    struct timeval status_time; /* when the status snapshot was taken */
+    vfo_t status_modes; /* VFOs whose mode is in the snapshot */
+    vfo_t status_widths; /* VFOs whose width is in the snapshot */
+    unsigned status_have; /* ST_BIT of the calls answered in the snapshot */
+    unsigned status_skip; /* ST_BIT of the calls FLRig faulted on, left out */
 };
 
 const struct rig_caps flrig_caps = {
@@ -219,183 +248,501 @@ static int check_vfo(vfo_t vfo)
     return TRUE;
 }
 
+/*
+ * xml_head, xml_mid, xml_tail
+ * The fixed parts of an XML-RPC methodCall body
+ */
+static const char xml_head[] = "<?xml version=\"1.0\"?>\r\n<methodCall><methodName>";
+static const char xml_mid[] = "</methodName>\r\n";
+static const char xml_tail[] = "</methodCall>\r\n";
+
 /* Rather than use some huge XML library we only need a few things
  * So we'll hand craft them
- * xml_build takes a value and return an xml string for FLRig
+ * The scanner below walks the scalar <value> elements of a response in
+ * place and hands back a pointer and length into the response buffer,
+ * so nothing is copied or allocated while parsing.
+ * <array> nesting is tracked so system.multicall results can be told apart:
+ * a result is an array of one value, or a fault struct of its own
  */
-static char *xml_build(char *cmd, char *value, char *xmlbuf,int xmllen)
-{
-    char xml[MAXXMLLEN];
-    // We want at least a 4K buf to play with
-    if (xmllen < 4096) {
-        rig_debug(RIG_DEBUG_ERR, "%s: xmllen < 4096\n");
-        return NULL;
-    }
-    sprintf(xmlbuf,
-            "POST /RPC2 HTTP/1.1\r\n" "User-Agent: XMLRPC++ 0.8\r\n"
-            "Host: 127.0.0.1:12345\r\n" "Content-type: text/xml\r\n");
-    sprintf(xml, "<?xml version=\"1.0\"?>\r\n");
-    strcat(xml, "<methodCall><methodName>");
-    strcat(xml, cmd);
-    strcat(xml, "</methodName>\r\n");
-
-    if (value && strlen(value) > 0) {
-        strcat(xml, value);
-    }
-
-    strcat(xml, "</methodCall>\r\n");
-    strcat(xmlbuf, "Content-length: ");
-    char tmp[32];
-    sprintf(tmp, "%d\r\n\r\n", (int)strlen(xml));
-    strcat(xmlbuf, tmp);
-    strcat(xmlbuf, xml);
-    return xmlbuf;
-}
+struct xml_scan {
+    const char *p;  /* where scanning resumes */
+    int depth;      /* current <array> nesting depth */
+    int results;    /* multicall results seen so far */
+    int fault;      /* True while in a multicall result that is a fault */
+};
 
-/* This is a very crude xml parse specific to what we need from FLRig
- * This works for strings, doubles, I4-type values, and arrays
- * Arrays are returned pipe delimited
+/*
+ * xml_next_value
+ * Assumes s!=NULL, s->p NUL terminated, val!=NULL, len!=NULL
+ * Returns 1 with the next scalar value in val/len, 0 at the end
  */
-static char *xml_parse2(char *xml, char *value, int valueLen)
+static int xml_next_value(struct xml_scan *s, const char **val, int *len)
 {
-    char* delims = "<>\r\n ";
-    char *xmltmp = strdup(xml);
-    //rig_debug(RIG_DEBUG_TRACE, "%s: xml='%s'\n", __FUNCTION__,xml);
-    char *p = strtok(xmltmp,delims);
-    value[0]=0;
-    while(p) {
-        if (streq(p,"value")) {
-            p=strtok(NULL,delims);
-            if (streq(p,"array")) continue;
-            if (streq(p,"/value")) continue; // empty value
-            if (streq(p,"i4") || streq(p,"double")) {
-                p = strtok(NULL,delims);
-            }
-            else if (streq(p,"array")) {
-                p = strtok(NULL,delims);
-                p = strtok(NULL,delims);
+    const char *p = s->p;
+
+    while ((p = strchr(p, '<')) != NULL) {
+        if (strncmp(p, "<array>", 7) == 0) {
+            if (++s->depth == 2) {
+                s->results++;
+                s->fault = 0;
             }
-            if (strlen(value)+strlen(p)+1 < valueLen) {
-                if (value[0]!=0) strcat(value,"|");
-                strcat(value,p);
+            p += 7;
+        }
+        else if (strncmp(p, "<struct>", 8) == 0) {
+            if (s->depth == 1) {
+                s->results++;
+                s->fault = 1;
             }
-            else { // we'll just stop adding stuff
-                rig_debug(RIG_DEBUG_ERR, "%s: max value length exceeded\n", __FUNCTION__);
+            p += 8;
+        }
+        else if (strncmp(p, "</array>", 8) == 0) {
+            s->depth--;
+            p += 8;
+        }
+        else if (strncmp(p, "<value>", 7) == 0) {
+            const char *q = p + 7;
+            const char *t = q;
+            while (isspace((unsigned char)*t)) t++;
+            if (*t == '<' && strncmp(t, "</value>", 8) != 0) {
+                if (strncmp(t, "<array>", 7) == 0 || strncmp(t, "<struct>", 8) == 0) {
+                    p = t; // a container, its members are scanned next
+                    continue;
+                }
+                // typed scalar such as <i4> or <double>
+                t = strchr(t, '>');
+                if (t == NULL) break;
+                q = t + 1;
             }
+            t = strchr(q, '<');
+            if (t == NULL) break;
+            *val = q;
+            *len = t - q;
+            s->p = t;
+            return 1;
         }
         else {
-            p=strtok(NULL,delims);
+            p++;
         }
     }
+    s->p += strlen(s->p);
+    return 0;
+}
+
+/*
+ * xml_parse
+ * Assumes xml!=NULL, value!=NULL, value_len big enough
+ * This works for strings, doubles, I4-type values, and arrays
+ * Arrays are returned pipe delimited, empty values are skipped
+ */
+static char *xml_parse(const char *xml, char *value, int value_len)
+{
+    struct xml_scan s = { xml, 0, 0, 0 };
+    const char *v;
+    int len;
+    int n = 0;
+
+    value[0]=0;
+    while (xml_next_value(&s, &v, &len)) {
+        if (len == 0) continue; // empty value
+        if (n + len + 2 > value_len) { // we'll just stop adding stuff
+            rig_debug(RIG_DEBUG_ERR, "%s: max value length exceeded\n", __FUNCTION__);
+            break;
+        }
+        if (n > 0) value[n++] = '|';
+        memcpy(value + n, v, len);
+        n += len;
+        value[n] = 0;
+    }
     rig_debug(RIG_DEBUG_TRACE, "%s: value returned='%s'\n", __FUNCTION__,value);
-    if (rig_need_debug(RIG_DEBUG_WARN) && value != NULL && strlen(value)==0) {
+    if (rig_need_debug(RIG_DEBUG_WARN) && strlen(value)==0) {
         rig_debug(RIG_DEBUG_ERR, "%s: xml='%s'\n", __FUNCTION__,xml);
     }
-    free(xmltmp);
     return value;
 }
 
 /*
- * xml_parse
- * Assumes xml!=NULL, value!=NULL, value_len big enough
- * returns the string value contained in the xml string
+ * flrig_reserve
+ * Assumes priv!=NULL
+ * Grows the reusable transaction buffer to at least len bytes
  */
-static char *xml_parse(char *xml, char *value, int value_len)
+static int flrig_reserve(struct flrig_priv_data *priv, int len)
 {
-    /* first off we should have an OK on the 1st line */
-    if (strstr(xml, " 200 OK") == NULL) {
-        return NULL;
+    if (len <= priv->buflen) {
+        return RIG_OK;
+    }
+    char *p = realloc(priv->buf, len);
+    if (p == NULL) {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot grow buffer to %d bytes\n", __FUNCTION__, len);
+        return -RIG_ENOMEM;
     }
-    rig_debug(RIG_DEBUG_TRACE, "%s XML:\n%s\n", __FUNCTION__, xml);
+    priv->buf = p;
+    priv->buflen = len;
+    return RIG_OK;
+}
 
-    // find the xml skipping the other stuff above it
-    char *pxml = strstr(xml, "<?xml");
+/*
+ * flrig_reconnect
+ * Assumes rig!=NULL, rig->state.priv!=NULL
+ * Opens a fresh connection after FLRig closed the old one
+ */
+static int flrig_reconnect(RIG *rig)
+{
+    struct rig_state *rs = &rig->state;
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) rs->priv;
 
-    if (pxml == NULL) {
-        return NULL;
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: reconnecting to %s\n", __FUNCTION__, rs->rigport.pathname);
+    network_close(&rs->rigport);
+    int retval = network_open(&rs->rigport, FLRIG_PORT);
+    priv->reconnect = retval != RIG_OK;
+    return retval;
+}
+
+/*
+ * flrig_connected
+ * Assumes rig!=NULL
+ * Checks that the kept-alive connection is still usable before reusing it:
+ * a readable idle socket either was closed by FLRig or holds a stale reply
+ */
+static int flrig_connected(RIG *rig)
+{
+    struct rig_state *rs = &rig->state;
+    fd_set rfds;
+    struct timeval tv = { 0, 0 };
+    char c;
+
+    FD_ZERO(&rfds);
+    FD_SET(rs->rigport.fd, &rfds);
+    if (select(rs->rigport.fd + 1, &rfds, NULL, NULL, &tv) <= 0) {
+        return TRUE; // nothing pending
     }
+    if (recv(rs->rigport.fd, &c, 1, MSG_PEEK) <= 0) {
+        return FALSE;
+    }
+    rig_debug(RIG_DEBUG_WARN, "%s: flushing stale data\n", __FUNCTION__);
+    network_flush(&rs->rigport);
+    return TRUE;
+}
 
-    char *next = strchr(pxml + 1, '<');
-    if (value != NULL) {
-        xml_parse2(next, value, value_len);
+/*
+ * write_transaction
+ * Assumes rig!=NULL, cmd!=NULL
+ * Builds the HTTP request into the reusable buffer and sends it in one write
+ */
+static int write_transaction(RIG *rig, const char *cmd, const char *params)
+{
+    int retval;
+    struct rig_state *rs = &rig->state;
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) rs->priv;
+
+    if (params == NULL) {
+        params = "";
+    }
+    int body = sizeof(xml_head) - 1 + strlen(cmd) + sizeof(xml_mid) - 1
+               + strlen(params) + sizeof(xml_tail) - 1;
+    retval = flrig_reserve(priv, body + strlen(rs->rigport.pathname) + 256);
+    if (retval != RIG_OK) {
+        return retval;
     }
-    if (strstr(value,"faultString")) {
-        rig_debug(RIG_DEBUG_ERR, "%s error:\n%s\n", __FUNCTION__, value);
-        value[0]=0; /* truncate to give empty response */
+    int len = snprintf(priv->buf, priv->buflen,
+                       "POST /RPC2 HTTP/1.1\r\n" "User-Agent: XMLRPC++ 0.8\r\n"
+                       "Host: %s\r\n" "Content-type: text/xml\r\n"
+                       "Connection: keep-alive\r\n" "Content-length: %d\r\n\r\n"
+                       "%s%s%s%s%s", rs->rigport.pathname, body,
+                       xml_head, cmd, xml_mid, params, xml_tail);
+    if (len < 0 || len >= priv->buflen) {
+        rig_debug(RIG_DEBUG_ERR, "%s: request for %s too long\n", __FUNCTION__, cmd);
+        return -RIG_EINTERNAL;
     }
-    return value;
+    rig_debug(RIG_DEBUG_TRACE, "%s: %s\n", __FUNCTION__, cmd);
+
+    retval = write_block(&rs->rigport, priv->buf, len);
+    if (retval < 0) {
+        return -RIG_EIO;
+    }
+    return RIG_OK;
 }
 
 /*
  * read_transaction
- * Assumes rig!=NULL, xml!=NULL, xml_len>=MAXXMLLEN
+ * Assumes rig!=NULL, rig->state.priv!=NULL
+ * Reads one HTTP response, leaving the NUL terminated body in priv->buf.
+ * The body is framed by Content-length so the connection can stay open.
  */
-static int read_transaction(RIG *rig, char *xml, int xml_len)
+static int read_transaction(RIG *rig)
 {
-    int retval;
+    int len;
+    int content = -1;
+    int ok = 0;
     char *terminator = "</methodResponse>";
 
-    rig_debug(RIG_DEBUG_TRACE, "%s\n", __FUNCTION__);
-
     struct rig_state *rs = &rig->state;
-    rs->rigport.timeout = 1000; // 2 second read string timeout
-
-    int retry=5;
-    char *delims="\n";
-    xml[0]=0;
-    do {
-        char tmp_buf[MAXXMLLEN];        // plenty big for expected flrig responses
-        int len = read_string(&rs->rigport, tmp_buf, sizeof(tmp_buf), delims, strlen(delims));
-        rig_debug(RIG_DEBUG_VERBOSE,"%s: string='%s'",__FUNCTION__,tmp_buf);
-        if (len > 0) retry = 3;
-        if (len <= 0) {
-            rig_debug(RIG_DEBUG_ERR,"%s: read_string error=%d\n",__FUNCTION__,len);
-            return -(100+RIG_EPROTO);
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) rs->priv;
+
+    // status line and headers, one line at a time
+    for (len = 0; ; ++len) {
+        int n = read_string(&rs->rigport, priv->buf, priv->buflen, "\n", 1);
+        if (n <= 0) {
+            rig_debug(RIG_DEBUG_ERR, "%s: read_string error=%d\n", __FUNCTION__, n);
+            priv->reconnect = 1;
+            return len == 0 && n == 0 ? -RIG_EIO : (n < 0 ? n : -RIG_EPROTO);
+        }
+        if (len == 0) {
+            ok = strstr(priv->buf, " 200 ") != NULL;
+            if (!ok) rig_debug(RIG_DEBUG_ERR, "%s: %s", __FUNCTION__, priv->buf);
+        }
+        else if (priv->buf[0] == '\r' || priv->buf[0] == '\n') {
+            break;
+        }
+        else if (strncasecmp(priv->buf, "Content-length:", 15) == 0) {
+            content = atoi(priv->buf + 15);
+        }
+        else if (strncasecmp(priv->buf, "Connection:", 11) == 0 && strstr(priv->buf, "close")) {
+            priv->reconnect = 1; // reopen before the next request
         }
-        strcat(xml,tmp_buf);
-    } while (retry-- > 0 && strstr(xml,terminator)==NULL);
-    if (retry == 0) {
-        rig_debug(RIG_DEBUG_WARN,"%s: retry timeout\n",__FUNCTION__);
     }
-    if (strstr(xml,terminator)) {
-        rig_debug(RIG_DEBUG_VERBOSE,"%s: got %s\n",__FUNCTION__,terminator);
-        // Slow down just a bit -- not sure this is needed anymore but not a big deal here
-        usleep(2*1000);
-        retval = RIG_OK;
+
+    if (content >= 0) {
+        int retval = flrig_reserve(priv, content + 1);
+        if (retval != RIG_OK) {
+            return retval;
+        }
+        len = content > 0 ? read_block(&rs->rigport, priv->buf, content) : 0;
+        if (len < content) {
+            rig_debug(RIG_DEBUG_ERR, "%s: short body %d of %d\n", __FUNCTION__, len, content);
+            priv->reconnect = 1;
+            return len < 0 ? len : -RIG_EPROTO;
+        }
+        priv->buf[content] = 0;
     }
     else {
-        rig_debug(RIG_DEBUG_VERBOSE,"%s: did not get %s\n",__FUNCTION__,terminator);
-        retval = -(101+RIG_EPROTO);
+        // no Content-length, so read up to the end of the response
+        len = 0;
+        priv->buf[0] = 0;
+        while (strstr(priv->buf, terminator) == NULL) {
+            int retval = flrig_reserve(priv, len + 1024);
+            if (retval != RIG_OK) {
+                return retval;
+            }
+            int n = read_string(&rs->rigport, priv->buf + len, priv->buflen - len, "\n", 1);
+            if (n <= 0) {
+                rig_debug(RIG_DEBUG_ERR, "%s: did not get %s\n", __FUNCTION__, terminator);
+                priv->reconnect = 1;
+                return n < 0 ? n : -RIG_EPROTO;
+            }
+            len += n;
+        }
     }
-    return retval;
+    rig_debug(RIG_DEBUG_TRACE, "%s XML:\n%s\n", __FUNCTION__, priv->buf);
+
+    return ok ? RIG_OK : -RIG_EPROTO;
 }
 
 /*
- * write_transaction
- * Assumes rig!=NULL, xml!=NULL, xml_len=total size of xml for response
+ * flrig_transaction
+ * Assumes rig!=NULL, cmd!=NULL, value_len big enough when value!=NULL
+ * Calls cmd with the given <params> over the kept-alive connection and
+ * returns the pipe delimited result in value if it's wanted
+ * The response body stays in priv->buf until the next call
  */
-static int write_transaction(RIG *rig, char *xml, int xml_len)
+static int flrig_transaction(RIG *rig, const char *cmd, const char *params,
+                             char *value, int value_len)
 {
-    int try=rig->caps->retry;
-    int retval=-RIG_EPROTO;
-    char xmltmp[MAXXMLLEN];
+    int retval = -RIG_EIO;
+    int try;
 
-    struct rig_state *rs = &rig->state;
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
 
-    // This shouldn't ever happen...but just in case
-    // We need to avoid and empty write as rigctld replies with blank line
-    if (xml_len == 0) {
-        rig_debug(RIG_DEBUG_ERR,"%s: len==0??\n",__FUNCTION__);
+    if (value) {
+        value[0] = 0;
+    }
+    // anything but a get can change what the status snapshot holds
+    if (strncmp(cmd, "rig.get_", 8) != 0) {
+        timerclear(&priv->status_time);
     }
 
-    while(try-- >= 0 && retval != RIG_OK) {
-            retval = write_block(&rs->rigport, xml, strlen(xml));
-            if (retval  < 0) {
-                return -RIG_EIO;
+    // one retry on a fresh connection if FLRig dropped the kept-alive one
+    for (try = 0; try < 2; ++try) {
+        if (!priv->reconnect && !flrig_connected(rig)) {
+            priv->reconnect = 1;
+        }
+        if (priv->reconnect) {
+            retval = flrig_reconnect(rig);
+            if (retval != RIG_OK) {
+                return retval;
             }
         }
-    strcpy(xml,xmltmp);
-    return retval;
+        retval = write_transaction(rig, cmd, params);
+        if (retval == RIG_OK) {
+            retval = read_transaction(rig);
+        }
+        if (retval != -RIG_EIO) {
+            break;
+        }
+        priv->reconnect = 1;
+    }
+    if (retval != RIG_OK) {
+        return retval;
+    }
+
+    if (strstr(priv->buf, "<fault>")) {
+        rig_debug(RIG_DEBUG_ERR, "%s: %s fault:\n%s\n", __FUNCTION__, cmd, priv->buf);
+        return -RIG_ERJCTED;
+    }
+    if (value) {
+        xml_parse(priv->buf, value, value_len);
+    }
+    return RIG_OK;
+}
+
+/*
+ * flrig_get_status
+ * Assumes rig!=NULL, rig->state.priv!=NULL
+ * Fetches VFO, frequencies, modes, bandwidths, PTT and split in a single
+ * system.multicall request and keeps them for FLRIG_STATUS_MS so a client
+ * polling them one after the other costs one round trip instead of several
+ * A call FLRig faults on is left out of the next ones, the getters then
+ * ask for what it gave on their own
+ * Returns -RIG_ENAVAIL when FLRig can't do system.multicall
+ */
+static int flrig_get_status(RIG *rig)
+{
+    const char *cmds[ST_N] = {
+        "rig.get_AB", "rig.get_vfoA", "rig.get_vfoB", "rig.get_ptt", "rig.get_split",
+        "rig.get_modeA", "rig.get_modeB", "rig.get_bwA", "rig.get_bwB"
+    };
+    int slot[ST_N];
+    int fault[ST_N];
+    char res[ST_N][64];
+    char params[2048];
+    struct timeval now, age;
+    struct xml_scan s;
+    const char *v;
+    int i, len, n, nslots;
+    int retval;
+
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
+
+    if (!priv->has_multicall) {
+        return -RIG_ENAVAIL;
+    }
+    if (timerisset(&priv->status_time)) {
+        gettimeofday(&now, NULL);
+        timersub(&now, &priv->status_time, &age);
+        if (age.tv_sec == 0 && age.tv_usec < FLRIG_STATUS_MS * 1000) {
+            return RIG_OK;
+        }
+    }
+
+    // without the per VFO calls only the current VFO can be asked
+    if (!priv->has_get_modeA) {
+        cmds[ST_MODEA] = "rig.get_mode";
+        cmds[ST_MODEB] = NULL;
+    }
+    if (!priv->has_get_bwA) {
+        cmds[ST_BWA] = "rig.get_bw";
+        cmds[ST_BWB] = NULL;
+    }
+
+    n = snprintf(params, sizeof(params), "<params><param><value><array><data>");
+    for (i = 0, nslots = 0; i < ST_N; ++i) {
+        if (cmds[i] == NULL || (priv->status_skip & ST_BIT(i))) continue;
+        slot[nslots++] = i;
+        n += snprintf(params + n, sizeof(params) - n,
+                      "<value><struct>"
+                      "<member><name>methodName</name><value>%s</value></member>"
+                      "<member><name>params</name><value><array><data></data></array></value></member>"
+                      "</struct></value>", cmds[i]);
+    }
+    snprintf(params + n, sizeof(params) - n, "</data></array></value></param></params>");
+
+    if (nslots == 0) {
+        priv->has_multicall = 0;
+        return -RIG_ENAVAIL;
+    }
+
+    retval = flrig_transaction(rig, "system.multicall", params, NULL, 0);
+    // a fault of the call as a whole, not of one of its results
+    if (retval == RIG_OK && strstr(priv->buf, "<fault>")) {
+        retval = -RIG_ERJCTED;
+    }
+    if (retval != RIG_OK) {
+        if (retval == -RIG_ERJCTED) {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: system.multicall not available\n", __FUNCTION__);
+            priv->has_multicall = 0;
+            retval = -RIG_ENAVAIL;
+        }
+        return retval;
+    }
+
+    // each result is an array of its own; keep the last non-empty value
+    // of each so the bandwidth calls give the 2nd of their two values
+    memset(res, 0, sizeof(res));
+    memset(fault, 0, sizeof(fault));
+    s.p = priv->buf;
+    s.depth = 0;
+    s.results = 0;
+    s.fault = 0;
+    while (xml_next_value(&s, &v, &len)) {
+        i = s.results - 1;
+        if (i < 0 || i >= nslots) continue;
+        if (s.fault) {
+            fault[slot[i]] = 1;
+            continue;
+        }
+        if (len == 0) continue;
+        if (len >= sizeof(res[0])) len = sizeof(res[0]) - 1;
+        memcpy(res[slot[i]], v, len);
+        res[slot[i]][len] = 0;
+    }
+
+    priv->status_have = 0;
+    for (i = 0; i < nslots; ++i) {
+        if (fault[slot[i]]) {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: %s faulted, left out of system.multicall\n",
+                      __FUNCTION__, cmds[slot[i]]);
+            priv->status_skip |= ST_BIT(slot[i]);
+        }
+        else if (i < s.results) {
+            priv->status_have |= ST_BIT(slot[i]);
+        }
+    }
+
+    if (priv->status_have & ST_BIT(ST_AB))
+        priv->curr_vfo = res[ST_AB][0] == 'B' ? RIG_VFO_B : RIG_VFO_A;
+    if (priv->status_have & ST_BIT(ST_VFOA))
+        priv->curr_freqA = atof(res[ST_VFOA]);
+    if (priv->status_have & ST_BIT(ST_VFOB))
+        priv->curr_freqB = atof(res[ST_VFOB]);
+    if (priv->status_have & ST_BIT(ST_PTT))
+        priv->ptt = atoi(res[ST_PTT]);
+    if (priv->status_have & ST_BIT(ST_SPLIT))
+        priv->split = atoi(res[ST_SPLIT]);
+
+    priv->status_modes = 0;
+    for (i = ST_MODEA; i <= ST_MODEB; ++i) {
+        vfo_t vfo = i == ST_MODEB ? RIG_VFO_B : RIG_VFO_A;
+        if (!priv->has_get_modeA) vfo = priv->curr_vfo;
+        if (res[i][0] == 0 || (retval = modeMapGetHamlib(res[i])) < 0) continue;
+        if (vfo == RIG_VFO_A) priv->curr_modeA = retval;
+        else priv->curr_modeB = retval;
+        priv->status_modes |= vfo;
+    }
+    priv->status_widths = 0;
+    for (i = ST_BWA; i <= ST_BWB; ++i) {
+        vfo_t vfo = i == ST_BWB ? RIG_VFO_B : RIG_VFO_A;
+        if (!priv->has_get_bwA) vfo = priv->curr_vfo;
+        if (res[i][0] == 0) continue;
+        if (vfo == RIG_VFO_A) priv->curr_widthA = atoi(res[i]);
+        else priv->curr_widthB = atoi(res[i]);
+        priv->status_widths |= vfo;
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: vfo=%s freqA=%.0f freqB=%.0f ptt=%d split=%d\n",
+              __FUNCTION__, rig_strvfo(priv->curr_vfo), priv->curr_freqA,
+              priv->curr_freqB, priv->ptt, priv->split);
+
+    gettimeofday(&priv->status_time, NULL);
+    return RIG_OK;
 }
 
 /*
@@ -513,28 +860,25 @@ static void modeMapAdd(unsigned int *modes,int mode_hamlib,char *mode_flrig)
  */
 static int flrig_open(RIG *rig) {
     int retval;
-    char xml[MAXXMLLEN];
     char value[MAXXMLLEN];
 
     rig_debug(RIG_DEBUG_TRACE, "%s version %s\n", __FUNCTION__, BACKEND_VER);
 
     struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
 
-    char *pxml = xml_build("rig.get_xcvr", NULL,xml,sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    rig->state.rigport.timeout = 1000; // 1 second read timeout
+    priv->reconnect = 0;
+    timerclear(&priv->status_time);
+
+    retval = flrig_transaction(rig, "rig.get_xcvr", NULL, value, sizeof(value));
     if (retval < 0) {
         return retval;
     }
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
     strncpy(priv->info,value,sizeof(priv->info));
     rig_debug(RIG_DEBUG_VERBOSE,"Transceiver=%s\n", value);
 
     /* see if get_modeA is available */
-    pxml = xml_build("rig.get_modeA", NULL, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
+    flrig_transaction(rig, "rig.get_modeA", NULL, value, sizeof(value));
     if (strlen(value)>0) { /* must have it since we got an answer */
         priv->has_get_modeA = 1;
         rig_debug(RIG_DEBUG_VERBOSE,"%s: getmodeA is available=%s\n", __FUNCTION__, value);
@@ -543,10 +887,7 @@ static int flrig_open(RIG *rig) {
         rig_debug(RIG_DEBUG_VERBOSE,"%s: getmodeA is not available\n",__FUNCTION__);
     }
     /* see if get_bwA is available */
-    pxml = xml_build("rig.get_bwA", NULL, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
+    flrig_transaction(rig, "rig.get_bwA", NULL, value, sizeof(value));
     if (strlen(value)>0) { /* must have it since we got an answer */
         priv->has_get_bwA = 1;
         rig_debug(RIG_DEBUG_VERBOSE,"%s: get_bwA is available=%s\n", __FUNCTION__, value);
@@ -555,10 +896,7 @@ static int flrig_open(RIG *rig) {
         rig_debug(RIG_DEBUG_VERBOSE,"%s: get_bwA is not available\n",__FUNCTION__);
     }
 
-    pxml = xml_build("rig.get_AB", value, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
+    flrig_transaction(rig, "rig.get_AB", NULL, value, sizeof(value));
     if (streq(value,"A")) {
         priv->curr_vfo = RIG_VFO_A;
     }
@@ -571,13 +909,10 @@ static int flrig_open(RIG *rig) {
     //flrig_get_split_vfo(rig, vfo, &priv->split, &vfo_tx);
 
     /* find out available widths and modes */
-    pxml = xml_build("rig.get_modes", NULL,xml,sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, "rig.get_modes", NULL, value, sizeof(value));
     if (retval < 0) {
         return retval;
     }
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
     rig_debug(RIG_DEBUG_VERBOSE, "%s: modes=%s\n",__FUNCTION__, value);
     unsigned int modes = 0;
     char *p;
@@ -639,6 +974,13 @@ static int flrig_open(RIG *rig) {
     rig->state.mode_list = modes;
     rig_debug(RIG_DEBUG_VERBOSE, "%s: hamlib modes=0x%08x\n",__FUNCTION__, modes);
 
+    /* see if the status can be fetched in one system.multicall */
+    priv->has_multicall = 1;
+    priv->status_skip = 0;
+    flrig_get_status(rig);
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: system.multicall is%s available\n", __FUNCTION__,
+              priv->has_multicall ? "" : " not");
+
     return RIG_OK;
 }
 
@@ -660,6 +1002,10 @@ static int flrig_cleanup(RIG *rig) {
     if (!rig)
         return -RIG_EINVAL;
 
+    struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
+    if (priv) {
+        free(priv->buf);
+    }
     free(rig->state.priv);
     rig->state.priv = NULL;
 
@@ -685,39 +1031,39 @@ static int flrig_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
         return -RIG_EINVAL;
     }
 
+    int status = flrig_get_status(rig);
+
     if (vfo == RIG_VFO_CURR) {
         vfo = priv->curr_vfo;
         rig_debug(RIG_DEBUG_VERBOSE, "%s: get_freq2 vfo=%s\n",
                   __FUNCTION__, rig_strvfo(vfo));
     }
 
+    if (status == RIG_OK
+            && (priv->status_have & ST_BIT(vfo == RIG_VFO_A ? ST_VFOA : ST_VFOB))) {
+        *freq = vfo == RIG_VFO_A ? priv->curr_freqA : priv->curr_freqB;
+        if (*freq != 0) {
+            rig_debug(RIG_DEBUG_VERBOSE, "%s: freq=%.0f\n", __FUNCTION__,*freq);
+            return RIG_OK;
+        }
+    }
+
     int retries=10;
-    char xml[MAXXMLLEN];
     char value[MAXCMDLEN];
     do {
-        char *pxml;
-        if (vfo == RIG_VFO_A) {
-            pxml = xml_build("rig.get_vfoA", NULL,xml,sizeof(xml));
-        }
-        else {
-            pxml = xml_build("rig.get_vfoB", NULL,xml,sizeof(xml));
-        }
-        retval = write_transaction(rig, pxml, strlen(pxml));
-        if (retval < 0) {
+        retval = flrig_transaction(rig, vfo == RIG_VFO_A ? "rig.get_vfoA" : "rig.get_vfoB",
+                                   NULL, value, sizeof(value));
+        if (retval == -RIG_EIO) {
             return retval;
         }
-
-        read_transaction(rig, xml, sizeof(xml));
-        xml_parse(xml, value, sizeof(value));
         if (strlen(value)==0) {
             rig_debug(RIG_DEBUG_ERR, "%s: retries=%d\n",__FUNCTION__, retries);
-            //usleep(10*1000);
         }
     } while (--retries && strlen(value)==0);
 
     *freq = atof(value);
     if (*freq == 0) {
-        rig_debug(RIG_DEBUG_ERR, "%s: freq==0??\nvalue=%s\nxml=%s\n", __FUNCTION__,value,xml);
+        rig_debug(RIG_DEBUG_ERR, "%s: freq==0??\nvalue=%s\n", __FUNCTION__,value);
         return -(102+RIG_EPROTO);
     }
     else {
@@ -758,21 +1104,11 @@ static int flrig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         vfo = RIG_VFO_B; // if split always TX on VFOB
     }
 
-    char value[MAXXMLLEN];
+    char value[MAXCMDLEN];
     sprintf(value, "<params><param><value><double>%.0f</double></value></param></params>", freq);
-    char xml[MAXXMLLEN];
-    char *pxml;
-    if (vfo == RIG_VFO_B) {
-        pxml = xml_build("rig.set_vfoB", value, xml, sizeof(xml));
-        rig_debug(RIG_DEBUG_VERBOSE,"rig.set_vfoB %s",value);
-        priv->curr_freqB = freq;
-    }
-    else {
-        pxml = xml_build("rig.set_vfoA", value, xml, sizeof(xml));
-        rig_debug(RIG_DEBUG_VERBOSE,"rig.set_vfoA %s",value);
-        priv->curr_freqA = freq;
-    }
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    char *cmd = vfo == RIG_VFO_B ? "rig.set_vfoB" : "rig.set_vfoA";
+    rig_debug(RIG_DEBUG_VERBOSE,"%s %s",cmd,value);
+    retval = flrig_transaction(rig, cmd, value, NULL, 0);
     if (retval < 0) {
         return retval;
     }
@@ -783,8 +1119,6 @@ static int flrig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
         priv->curr_freqA = freq;
     }
 
-    read_transaction(rig, xml, sizeof(xml)); // get response but don't care
-
     return RIG_OK;
 }
 
@@ -810,16 +1144,12 @@ static int flrig_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
     sprintf(cmd_buf,
             "<params><param><value><i4>%d</i4></value></param></params>",
             ptt);
-    char xml[MAXXMLLEN];
-    char *pxml = xml_build("rig.set_ptt", cmd_buf, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, "rig.set_ptt", cmd_buf, NULL, 0);
 
     if (retval < 0) {
         return retval;
     }
 
-    read_transaction(rig, xml, sizeof(xml)); // get response but don't care
-
     priv->ptt = ptt;
 
     return RIG_OK;
@@ -838,18 +1168,18 @@ static int flrig_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 
     struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
 
-    char xml[MAXXMLLEN];
-    char *pxml = xml_build("rig.get_ptt", NULL, xml, sizeof(xml));
+    if (flrig_get_status(rig) == RIG_OK && (priv->status_have & ST_BIT(ST_PTT))) {
+        *ptt = priv->ptt;
+        return RIG_OK;
+    }
 
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    char value[MAXCMDLEN];
+    retval = flrig_transaction(rig, "rig.get_ptt", NULL, value, sizeof(value));
 
     if (retval < 0) {
         return retval;
     }
 
-    read_transaction(rig, xml, sizeof(xml));
-    char value[MAXCMDLEN];
-    xml_parse(xml, value, sizeof(value));
     *ptt = atoi(value);
     rig_debug(RIG_DEBUG_VERBOSE, "%s: '%s'\n", __FUNCTION__, value);
 
@@ -942,36 +1272,25 @@ static int flrig_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
     }
 
     // Set the mode
-    char *ttmode = strdup(modeMapGetFLRig(mode));
-    if (ttmode[0]=='|') ttmode = &ttmode[1]; // remove first pipe symbol
-    char *p=strchr(ttmode,'|');
-    if (p) *p=0; // remove any other pipe
+    const char *ttmode = modeMapGetFLRig(mode);
+    if (ttmode[0]=='|') ttmode++; // remove first pipe symbol
+    int ttlen = strcspn(ttmode,"|"); // and any other pipe
 
     char cmd_buf[MAXCMDLEN];
-    sprintf(cmd_buf, "<params><param><value>%s</value></param></params>", ttmode);
-    free(ttmode);
-    char xml[MAXXMLLEN];
-    char *pxml=NULL;
-    if (!priv->has_get_modeA) {
-        pxml = xml_build("rig.set_mode", cmd_buf, xml, sizeof(xml));
-    }
-    else {
-        char *cmd="rig.set_modeA";
+    sprintf(cmd_buf, "<params><param><value>%.*s</value></param></params>", ttlen, ttmode);
+    char *cmd="rig.set_mode";
+    if (priv->has_get_modeA) {
+        cmd="rig.set_modeA";
         if (vfo==RIG_VFO_B) {
             cmd="rig.set_modeB";
         }
-        pxml = xml_build(cmd, cmd_buf, xml, sizeof(xml));
     }
 
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, cmd, cmd_buf, NULL, 0);
     if (retval < 0) {
         return retval;
     }
 
-    // Get the response
-    read_transaction(rig, xml, sizeof(xml));
-    rig_debug(RIG_DEBUG_VERBOSE, "%s: response=%s\n", __FUNCTION__,xml);
-
     // Determine if we need to update the bandwidth
     int needBW=0;
     if (vfo == RIG_VFO_A) {
@@ -991,12 +1310,10 @@ static int flrig_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
         // if we're not on VFOB but asking for VFOB still have to switch VFOS
         if (!vfoSwitched && vfo==RIG_VFO_B) flrig_set_vfo(rig,RIG_VFO_B);
         if (!vfoSwitched && vfo==RIG_VFO_A) flrig_set_vfo(rig,RIG_VFO_A);
-        pxml = xml_build("rig.set_bandwidth", cmd_buf, xml, sizeof(xml));
-        retval = write_transaction(rig, pxml, strlen(pxml));
+        retval = flrig_transaction(rig, "rig.set_bandwidth", cmd_buf, NULL, 0);
         if (retval < 0) {
             return retval;
         }
-        read_transaction(rig, xml, sizeof(xml));
         flrig_set_vfo(rig,vfo); // ensure reset to our initial vfo
     }
 
@@ -1041,12 +1358,21 @@ static int flrig_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         return -RIG_EINVAL;
     }
 
+    int status = flrig_get_status(rig);
+
     vfo_t curr_vfo = priv->curr_vfo;
     if (vfo == RIG_VFO_CURR) {
         vfo = priv->curr_vfo;
     }
     rig_debug(RIG_DEBUG_TRACE, "%s: using vfo=%s\n", __FUNCTION__,
               rig_strvfo(vfo));
+    if (status == RIG_OK && (priv->status_modes & vfo) && (priv->status_widths & vfo)) {
+        *mode = vfo == RIG_VFO_A ? priv->curr_modeA : priv->curr_modeB;
+        *width = vfo == RIG_VFO_A ? priv->curr_widthA : priv->curr_widthB;
+        rig_debug(RIG_DEBUG_VERBOSE, "%s: mode=%s width=%d\n", __FUNCTION__,
+                  rig_strrmode(*mode), (int)*width);
+        return RIG_OK;
+    }
     if (priv->ptt) {
         if (vfo == RIG_VFO_A) *mode = priv->curr_modeA;
         else *mode = priv->curr_modeB;
@@ -1068,7 +1394,6 @@ static int flrig_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         }
     }
 
-    char xml[MAXXMLLEN];
     char *cmdp="rig.get_mode"; /* default to old way */
     if (priv->has_get_modeA) { /* change to new way if we can */
         /* calling this way reduces VFO swapping */
@@ -1078,15 +1403,12 @@ static int flrig_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         cmdp = "rig.get_modeA";
         if (vfo==RIG_VFO_B) cmdp = "rig.get_modeB";
     }
-    char *pxml = xml_build(cmdp, NULL, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    char value[MAXCMDLEN];
+    retval = flrig_transaction(rig, cmdp, NULL, value, sizeof(value));
     if (retval < 0) {
         return retval;
     }
 
-    read_transaction(rig, xml, sizeof(xml));
-    char value[MAXCMDLEN];
-    xml_parse(xml, value, sizeof(value));
     retval = modeMapGetHamlib(value);
     if (retval < 0 ) {
         return retval;
@@ -1111,14 +1433,11 @@ static int flrig_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
         cmdp = "rig.get_bwA";
         if (vfo==RIG_VFO_B) cmdp = "rig.get_bwB";
     }
-    pxml = xml_build(cmdp, NULL, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, cmdp, NULL, value, sizeof(value));
     if (retval < 0) {
         return retval;
     }
 
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
     rig_debug(RIG_DEBUG_VERBOSE, "%s: mode=%s width='%s'\n", __FUNCTION__, rig_strrmode(*mode), value);
     // we get 2 entries pipe separated for bandwidth, lower and upper
     if(strlen(value)>0) {
@@ -1174,31 +1493,24 @@ static int flrig_set_vfo(RIG *rig, vfo_t vfo)
     }
 
     char value[MAXCMDLEN];
-    char xml[MAXXMLLEN];
     sprintf(value, "<params><param><value>%s</value></param></params>",
             vfo == RIG_VFO_A ? "A" : "B");
-    char *pxml = xml_build("rig.set_AB", value, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, "rig.set_AB", value, NULL, 0);
 
     if (retval < 0) {
         return retval;
     }
     priv->curr_vfo = vfo;
     rs->tx_vfo = RIG_VFO_B; // always VFOB
-    read_transaction(rig, xml, sizeof(xml));
 
     /* for some rigs FLRig turns off split when VFOA is selected */
     /* so if we are in split and asked for A we have to turn split back on */
     if (priv->split && vfo==RIG_VFO_A) {
-        char xml[MAXXMLLEN];
-        char value[MAXCMDLEN];
         sprintf(value, "<params><param><value><i4>%d</i4></value></param></params>", priv->split);
-        char *pxml = xml_build("rig.set_split", value, xml, sizeof(xml));
-        retval = write_transaction(rig, pxml, strlen(pxml));
+        retval = flrig_transaction(rig, "rig.set_split", value, NULL, 0);
         if (retval < 0) {
             return retval;
         }
-        read_transaction(rig, xml, sizeof(xml)); // get response but don't care
     }
     return RIG_OK;
 }
@@ -1215,17 +1527,18 @@ static int flrig_get_vfo(RIG *rig, vfo_t *vfo)
 
     struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
 
-    char xml[MAXXMLLEN];
-    char *pxml = xml_build("rig.get_AB", NULL, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    if (flrig_get_status(rig) == RIG_OK && (priv->status_have & ST_BIT(ST_AB))) {
+        *vfo = priv->curr_vfo;
+        return RIG_OK;
+    }
+
+    char value[MAXCMDLEN];
+    retval = flrig_transaction(rig, "rig.get_AB", NULL, value, sizeof(value));
 
     if (retval < 0) {
         return retval;
     }
 
-    read_transaction(rig, xml, sizeof(xml));
-    char value[MAXCMDLEN];
-    xml_parse(xml, value, sizeof(value));
     rig_debug(RIG_DEBUG_VERBOSE, "%s: vfo value=%s\n", __FUNCTION__,value);
 
     switch (value[0]) {
@@ -1280,19 +1593,15 @@ static int flrig_set_split_freq(RIG *rig, vfo_t vfo, freq_t tx_freq)
     if (retval != RIG_OK) return retval;
     if (tx_freq == qtx_freq) return RIG_OK;
 
-    char xml[MAXXMLLEN];
     char value[MAXCMDLEN];
     sprintf(value,
             "<params><param><value><double>%.6f</double></value></param></params>", tx_freq);
-    char *pxml = xml_build("rig.set_vfoB", value, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, "rig.set_vfoB", value, NULL, 0);
     if (retval < 0) {
         return retval;
     }
     priv->curr_freqB = tx_freq;
 
-    read_transaction(rig, xml, sizeof(xml)); // get response but don't care
-
     return RIG_OK;
 }
 
@@ -1338,18 +1647,14 @@ static int flrig_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
         return RIG_OK;  // just return OK and ignore this
     }
 
-    char xml[MAXXMLLEN];
     char value[MAXCMDLEN];
     sprintf(value, "<params><param><value><i4>%d</i4></value></param></params>", split);
-    char *pxml = xml_build("rig.set_split", value, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    retval = flrig_transaction(rig, "rig.set_split", value, NULL, 0);
     if (retval < 0) {
         return retval;
     }
     priv->split = split;
 
-    read_transaction(rig, xml, sizeof(xml)); // get response but don't care
-
     return RIG_OK;
 }
 
@@ -1365,19 +1670,19 @@ static int flrig_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split,
     rig_debug(RIG_DEBUG_TRACE, "%s\n", __FUNCTION__);
     struct flrig_priv_data *priv = (struct flrig_priv_data *) rig->state.priv;
 
-    char xml[MAXXMLLEN];
-    char *pxml = xml_build("rig.get_split", NULL, xml, sizeof(xml));
-    retval = write_transaction(rig, pxml, strlen(pxml));
+    *tx_vfo = RIG_VFO_B;
+    if (flrig_get_status(rig) == RIG_OK && (priv->status_have & ST_BIT(ST_SPLIT))) {
+        *split = priv->split;
+        return RIG_OK;
+    }
+
+    char value[MAXCMDLEN];
+    retval = flrig_transaction(rig, "rig.get_split", NULL, value, sizeof(value));
 
     if (retval < 0) {
         return retval;
     }
 
-    char value[MAXCMDLEN];
-    read_transaction(rig, xml, sizeof(xml));
-    xml_parse(xml, value, sizeof(value));
-
-    *tx_vfo = RIG_VFO_B;
     *split = atoi(value);
     priv->split = *split;
     rig_debug(RIG_DEBUG_VERBOSE,"%s tx_vfo=%s, split=%d\n",__FUNCTION__,rig_strvfo(*tx_vfo),*split);
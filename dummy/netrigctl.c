@@ -37,37 +37,396 @@
 #include "iofunc.h"
 #include "misc.h"
 #include "num_stdio.h"
+#include "binproto.h"
 
 #include "dummy.h"
 
 #define CMD_MAX 32
 #define BUF_MAX 96
 
+/* room for the replies of a whole batch, e.g. the dump_state answer */
+#define NETRIGCTL_RBUF 4096
+#define NETRIGCTL_WBUF 256
+
 #define CHKSCN1ARG(a) if ((a) != 1) return -RIG_EPROTO; else do {} while(0)
 
+#define TOK_BINARY TOKEN_BACKEND(1)
+
+struct netrigctl_priv_data {
+  char rbuf[NETRIGCTL_RBUF];	/* received, not yet consumed */
+  int rpos, rlen;
+  char wbuf[NETRIGCTL_WBUF];	/* queued, not yet sent */
+  int wlen;
+  int wlast;		/* offset in wbuf of the last frame queued, or -1 */
+  int pending;		/* replies still to be read, in request order */
+  int desync;		/* a reply was abandoned, flush before next request */
+  int vfo_ret;		/* reply to the get_vfo batched with dump_state */
+  vfo_t vfo;
+  int has_vfo;
+  int binary_conf;	/* ask rigctld for binary frames at open */
+  int binary;		/* binary frames in use, see binproto.h */
+  unsigned seq;		/* id of the next request frame */
+  char tbuf[NETRIGCTL_RBUF];	/* text reply of a BINPROTO_TEXT frame */
+  int tpos, tlen;
+};
+
+static const struct confparams netrigctl_cfg_params[] = {
+	{ TOK_BINARY, "binary", "Binary protocol", "Switch to the binary frames of rigctld, when it has them",
+		"0", RIG_CONF_CHECKBUTTON, { }
+	},
+	{ RIG_CONF_END, NULL, }
+};
+
+static int netrigctl_init(RIG *rig)
+{
+  struct netrigctl_priv_data *priv;
+
+  priv = calloc(1, sizeof(struct netrigctl_priv_data));
+  if (!priv)
+	return -RIG_ENOMEM;
+
+  rig->state.priv = (rig_ptr_t) priv;
+
+  return RIG_OK;
+}
+
+static int netrigctl_cleanup(RIG *rig)
+{
+  free(rig->state.priv);
+  rig->state.priv = NULL;
+
+  return RIG_OK;
+}
+
+static int netrigctl_set_conf(RIG *rig, token_t token, const char *val)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+
+  switch(token) {
+	case TOK_BINARY:
+		priv->binary_conf = atoi(val) ? 1 : 0;
+		break;
+	default:
+		return -RIG_EINVAL;
+  }
+  return RIG_OK;
+}
+
+static int netrigctl_get_conf(RIG *rig, token_t token, char *val)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+
+  switch(token) {
+	case TOK_BINARY:
+		sprintf(val, "%d", priv->binary_conf);
+		break;
+	default:
+		return -RIG_EINVAL;
+  }
+  return RIG_OK;
+}
+
 /*
- * Helper function with protocol return code parsing
+ * Drop whatever is left of abandoned replies, on the wire and buffered
  */
-static int netrigctl_transaction(RIG *rig, char *cmd, int len, char *buf)
+static void netrigctl_flush(RIG *rig)
 {
-  int ret;
-
-  rig_debug(RIG_DEBUG_VERBOSE,"%s: called len=%d\n",__FUNCTION__,len);
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
 
-  /* flush anything in the read buffer before command is sent */
   if (rig->state.rigport.type.rig == RIG_PORT_NETWORK || rig->state.rigport.type.rig == RIG_PORT_UDP_NETWORK) {
       network_flush(&rig->state.rigport);
   } else {
       serial_flush(&rig->state.rigport);
   }
+  priv->rpos = priv->rlen = 0;
+  priv->tpos = priv->tlen = 0;
+  priv->pending = 0;
+  priv->desync = 0;
+}
 
-  ret = write_block(&rig->state.rigport, cmd, len);
+/*
+ * Append to the requests of the next netrigctl_send, for that many
+ * more replies.  Batching them lets several queries go out in one
+ * TCP segment.
+ */
+static int netrigctl_append(RIG *rig, const char *data, int len, int replies)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  int ret;
+
+  if (priv->desync)
+	netrigctl_flush(rig);
+
+  /* whatever comes next may change the VFO */
+  priv->has_vfo = 0;
+
+  if (priv->wlen + len > NETRIGCTL_WBUF) {
+	ret = write_block(&rig->state.rigport, priv->wbuf, priv->wlen);
+	priv->wlen = 0;
+	priv->wlast = -1;
+	if (ret != RIG_OK)
+		return ret;
+	if (len > NETRIGCTL_WBUF) {
+		priv->pending += replies;
+		return write_block(&rig->state.rigport, data, len);
+	}
+  }
+
+  priv->wlast = priv->wlen;
+  memcpy(priv->wbuf + priv->wlen, data, len);
+  priv->wlen += len;
+  priv->pending += replies;
+
+  return RIG_OK;
+}
+
+/*
+ * Start a request frame, with the next id.  Like a text request, it
+ * acts on the current VFO of rigctld, rig.c having selected the one
+ * asked for.
+ */
+static void netrigctl_frame(RIG *rig, struct binproto_frame *f, int cmd)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+
+  binproto_init(f, priv->seq++ & 0xffff, 0, cmd);
+}
+
+/*
+ * Queue a request frame, rigctld holds the replies of a batch till
+ * its last request
+ */
+static int netrigctl_queue_frame(RIG *rig, struct binproto_frame *f)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+
+  if (priv->wlast >= 0 && priv->wlen > 0)
+	priv->wbuf[priv->wlast + 4] |= BINPROTO_MORE;
+
+  return netrigctl_append(rig, (const char *)f->buf, f->len, 1);
+}
+
+/*
+ * Queue text protocol requests, one reply expected per line.  With
+ * binary frames, each line goes as a BINPROTO_TEXT frame.
+ */
+static int netrigctl_queue(RIG *rig, const char *cmd, int len)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  const char *nl;
+  int i, n, ret;
+
+  if (!priv->binary) {
+	for (i=0, n=0; i<len; i++)
+		if (cmd[i] == '\n')
+			n++;
+	return netrigctl_append(rig, cmd, len, n);
+  }
+
+  while (len > 0) {
+	nl = memchr(cmd, '\n', len);
+	n = nl ? nl + 1 - cmd : len;
+
+	netrigctl_frame(rig, &f, BINPROTO_TEXT);
+	for (i=0; i<n; i+=255) {
+		ret = binproto_put_str(&f, cmd + i, n - i > 255 ? 255 : n - i);
+		if (ret != RIG_OK)
+			return ret;
+	}
+	ret = netrigctl_queue_frame(rig, &f);
+	if (ret != RIG_OK)
+		return ret;
+
+	cmd += n;
+	len -= n;
+  }
+
+  return RIG_OK;
+}
+
+/*
+ * Send the queued requests in one write, replies are not waited for
+ */
+static int netrigctl_send(RIG *rig)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  int ret;
+
+  if (priv->wlen == 0)
+	return RIG_OK;
+
+  ret = write_block(&rig->state.rigport, priv->wbuf, priv->wlen);
+  priv->wlen = 0;
+  priv->wlast = -1;
+  if (ret != RIG_OK)
+	priv->desync = 1;
+
+  return ret;
+}
+
+/*
+ * Read one line of a reply out of the receive buffer, refilling it with
+ * as much as the socket has ready.  Same return as read_string.
+ */
+static int netrigctl_read_line(RIG *rig, char *buf, int buflen)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  char *nl;
+  int len, ret;
+
+  if (priv->binary) {
+	/* the reply is all there, in the frame */
+	nl = memchr(priv->tbuf + priv->tpos, '\n', priv->tlen - priv->tpos);
+	len = nl ? nl + 1 - (priv->tbuf + priv->tpos) : priv->tlen - priv->tpos;
+	if (len == 0)
+		return -RIG_EPROTO;
+	if (len > buflen - 1)
+		len = buflen - 1;
+	memcpy(buf, priv->tbuf + priv->tpos, len);
+	buf[len] = '\0';
+	priv->tpos += len;
+	return len;
+  }
+
+  for (;;) {
+	nl = memchr(priv->rbuf + priv->rpos, '\n', priv->rlen - priv->rpos);
+	len = nl ? nl + 1 - (priv->rbuf + priv->rpos) : priv->rlen - priv->rpos;
+	if (nl || len >= buflen - 1 || len == NETRIGCTL_RBUF)
+		break;
+
+	/* partial line, make room and wait for more */
+	if (priv->rpos > 0) {
+		memmove(priv->rbuf, priv->rbuf + priv->rpos, len);
+		priv->rlen = len;
+		priv->rpos = 0;
+	}
+	ret = read_avail(&rig->state.rigport, priv->rbuf + priv->rlen,
+			NETRIGCTL_RBUF - priv->rlen);
+	if (ret < 0) {
+		priv->desync = 1;
+		return ret;
+	}
+	priv->rlen += ret;
+  }
+
+  if (len > buflen - 1)
+	len = buflen - 1;
+  memcpy(buf, priv->rbuf + priv->rpos, len);
+  buf[len] = '\0';
+  priv->rpos += len;
+  if (priv->rpos == priv->rlen)
+	priv->rpos = priv->rlen = 0;
+
+  return len;
+}
+
+/*
+ * Read the next reply frame, in request order, and check its id
+ */
+static int netrigctl_read_frame(RIG *rig, struct binproto_frame *f)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  unsigned char *p;
+  int len = 0, ret;
+
+  for (;;) {
+	p = (unsigned char *)priv->rbuf + priv->rpos;
+	if (priv->rlen - priv->rpos >= 2) {
+		len = BINPROTO_FRAMELEN(p);
+		if (len < BINPROTO_HDRLEN || len > NETRIGCTL_RBUF) {
+			priv->desync = 1;
+			return -RIG_EPROTO;
+		}
+		if (priv->rlen - priv->rpos >= len)
+			break;
+	}
+
+	/* partial frame, make room and wait for more */
+	if (priv->rpos > 0) {
+		memmove(priv->rbuf, p, priv->rlen - priv->rpos);
+		priv->rlen -= priv->rpos;
+		priv->rpos = 0;
+	}
+	ret = read_avail(&rig->state.rigport, priv->rbuf + priv->rlen,
+			NETRIGCTL_RBUF - priv->rlen);
+	if (ret < 0) {
+		priv->desync = 1;
+		return ret;
+	}
+	priv->rlen += ret;
+  }
+
+  ret = binproto_parse(f, p, len);
+  priv->rpos += len;
+  if (priv->rpos == priv->rlen)
+	priv->rpos = priv->rlen = 0;
+
+  if (ret != RIG_OK || BINPROTO_ID(f) != ((priv->seq - priv->pending) & 0xffff)) {
+	rig_debug(RIG_DEBUG_ERR, "%s: unexpected reply\n", __FUNCTION__);
+	priv->desync = 1;
+	return -RIG_EPROTO;
+  }
+  priv->pending--;
+
+  return RIG_OK;
+}
+
+/*
+ * Read the next reply frame, its values are left in f for the caller
+ * when there is no error
+ */
+static int netrigctl_bin_reply(RIG *rig, struct binproto_frame *f)
+{
+  int64_t status;
+  int ret;
+
+  ret = netrigctl_read_frame(rig, f);
   if (ret != RIG_OK)
 	return ret;
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  if (!(BINPROTO_FLAGS(f) & BINPROTO_ERROR))
+	return RIG_OK;
+
+  ret = binproto_get_int(f, &status);
+  if (ret != RIG_OK || status >= 0)
+	return -RIG_EPROTO;
+
+  return (int)status;
+}
+
+/*
+ * Read the first line of the next reply, in request order, with
+ * protocol return code parsing
+ */
+static int netrigctl_reply(RIG *rig, char *buf)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int ret;
+
+  if (priv->binary) {
+	/* lines the previous reply had over are of no use now */
+	priv->tpos = priv->tlen = 0;
+
+	ret = netrigctl_bin_reply(rig, &f);
+	if (ret != RIG_OK)
+		return ret;
+	while (binproto_peek(&f) == BINPROTO_STR) {
+		ret = binproto_get_str(&f, priv->tbuf + priv->tlen,
+				NETRIGCTL_RBUF - priv->tlen);
+		if (ret < 0)
+			return ret;
+		priv->tlen += ret;
+	}
+  }
+
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret < 0)
 	return ret;
+  if (!priv->binary)
+	priv->pending--;
+
   if (strncmp(buf, NETRIGCTL_RET, strlen(NETRIGCTL_RET))==0) {
 	return atoi(buf+strlen(NETRIGCTL_RET));
   }
@@ -75,21 +434,86 @@ static int netrigctl_transaction(RIG *rig, char *cmd, int len, char *buf)
   return ret;
 }
 
+/*
+ * Helper function with protocol return code parsing
+ */
+static int netrigctl_transaction(RIG *rig, char *cmd, int len, char *buf)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  int ret;
+
+  rig_debug(RIG_DEBUG_VERBOSE,"%s: called len=%d\n",__FUNCTION__,len);
+
+  /* replies left over from an abandoned batch would be taken for ours */
+  if (priv->pending > 0)
+	priv->desync = 1;
+
+  ret = netrigctl_queue(rig, cmd, len);
+  if (ret != RIG_OK)
+	return ret;
+
+  ret = netrigctl_send(rig);
+  if (ret != RIG_OK)
+	return ret;
+
+  return netrigctl_reply(rig, buf);
+}
+
+/*
+ * Send a typed request frame and read its reply into the same frame.
+ * Returns the status of the reply, its values follow in f.
+ */
+static int netrigctl_bin_transaction(RIG *rig, struct binproto_frame *f)
+{
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  int ret;
+
+  rig_debug(RIG_DEBUG_VERBOSE,"%s: called cmd=0x%02x\n",__FUNCTION__, BINPROTO_CMD(f));
+
+  if (priv->pending > 0)
+	priv->desync = 1;
+
+  ret = netrigctl_queue_frame(rig, f);
+  if (ret != RIG_OK)
+	return ret;
+
+  ret = netrigctl_send(rig);
+  if (ret != RIG_OK)
+	return ret;
+
+  return netrigctl_bin_reply(rig, f);
+}
+
 
 static int netrigctl_open(RIG *rig)
 {
   int ret, len, i;
   struct rig_state *rs = &rig->state;
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rs->priv;
   int prot_ver;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
-
-  len = sprintf(cmd, "\\dump_state\n");
-
-  ret = netrigctl_transaction(rig, cmd, len, buf);
+  priv->rpos = priv->rlen = priv->wlen = 0;
+  priv->tpos = priv->tlen = 0;
+  priv->wlast = -1;
+  priv->pending = priv->desync = 0;
+  priv->has_vfo = 0;
+  priv->binary = 0;
+
+  /*
+   * rig_open asks for the VFO right after, so send that query along
+   * with dump_state: the whole handshake costs a single round trip.
+   */
+  len = sprintf(cmd, "\\dump_state\nv\n");
+
+  ret = netrigctl_queue(rig, cmd, len);
+  if (ret == RIG_OK)
+	ret = netrigctl_send(rig);
+  if (ret == RIG_OK)
+	ret = netrigctl_reply(rig, buf);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -98,18 +522,18 @@ static int netrigctl_open(RIG *rig)
   if (prot_ver < RIGCTLD_PROT_VER)
 	  return -RIG_EPROTO;
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->itu_region = atoi(buf);
 
   for (i=0; i<FRQRANGESIZ; i++) {
-	ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+	ret = netrigctl_read_line(rig, buf, BUF_MAX);
 	if (ret <= 0)
 		return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -128,7 +552,7 @@ static int netrigctl_open(RIG *rig)
 		break;
   }
   for (i=0; i<FRQRANGESIZ; i++) {
-	ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+	ret = netrigctl_read_line(rig, buf, BUF_MAX);
 	if (ret <= 0)
 		return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -147,7 +571,7 @@ static int netrigctl_open(RIG *rig)
 		break;
   }
   for (i=0; i<TSLSTSIZ; i++) {
-	ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+	ret = netrigctl_read_line(rig, buf, BUF_MAX);
   	if (ret <= 0)
 		return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -161,7 +585,7 @@ static int netrigctl_open(RIG *rig)
   }
 
   for (i=0; i<FLTLSTSIZ; i++) {
-	ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+	ret = netrigctl_read_line(rig, buf, BUF_MAX);
   	if (ret <= 0)
 		return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -179,31 +603,31 @@ static int netrigctl_open(RIG *rig)
 chan_t chan_list[CHANLSTSIZ]; /*!< Channel list, zero ended */
 #endif
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->max_rit = atol(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->max_xit = atol(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->max_ifshift = atol(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->announces = atoi(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -216,7 +640,7 @@ chan_t chan_list[CHANLSTSIZ]; /*!< Channel list, zero ended */
 	  ret = 0;
   rs->preamp[ret] = RIG_DBLST_END;
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -229,19 +653,19 @@ chan_t chan_list[CHANLSTSIZ]; /*!< Channel list, zero ended */
 	  ret = 0;
   rs->attenuator[ret] = RIG_DBLST_END;
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->has_get_func = strtol(buf, NULL, 0);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->has_set_func = strtol(buf, NULL, 0);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -254,19 +678,19 @@ chan_t chan_list[CHANLSTSIZ]; /*!< Channel list, zero ended */
       rs->has_get_level |= RIG_LEVEL_STRENGTH;
     }
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->has_set_level = strtol(buf, NULL, 0);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
   rs->has_get_parm = strtol(buf, NULL, 0);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -286,27 +710,74 @@ gran_t parm_gran[RIG_SETTING_MAX];    /*!< parm granularity */
 	rs->vfo_list |= rs->tx_range_list[i].vfo;
   }
 
+  /* keep the get_vfo answer for the first netrigctl_get_vfo */
+  ret = netrigctl_reply(rig, buf);
+  if (ret < 0 && priv->desync)
+	return ret;
+  priv->vfo_ret = ret;
+  priv->vfo = RIG_VFO_CURR;
+  if (ret > 0) {
+	if (buf[ret-1]=='\n') buf[ret-1] = '\0';	/* chomp */
+	priv->vfo = rig_parse_vfo(buf);
+	if (priv->vfo == RIG_VFO_NONE) {
+		/* more dump_state than we know of, ask again later */
+		priv->desync = 1;
+	}
+  }
+
+  /* rigctld from protocol version 1 on can switch to binary frames */
+  if (priv->binary_conf && prot_ver >= 1) {
+	len = sprintf(cmd, "\\set_binary %d\n", BINPROTO_VERSION);
+	ret = netrigctl_transaction(rig, cmd, len, buf);
+	if (ret == RIG_OK)
+		priv->binary = 1;
+	else if (ret < 0 && priv->desync)
+		return ret;
+	else
+		rig_debug(RIG_DEBUG_WARN, "%s: binary protocol refused (%d)\n", __FUNCTION__, ret);
+  } else if (priv->binary_conf) {
+	rig_debug(RIG_DEBUG_WARN, "%s: rigctld has no binary protocol\n", __FUNCTION__);
+  }
+
+  priv->has_vfo = priv->vfo != RIG_VFO_NONE;
+
   return RIG_OK;
 }
 
 static int netrigctl_close(RIG *rig)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
   /* clean signoff, no read back */
-  write_block(&rig->state.rigport, "q\n", 2);
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'q');
+	write_block(&rig->state.rigport, (const char *)f.buf, f.len);
+  } else {
+	write_block(&rig->state.rigport, "q\n", 2);
+  }
 
   return RIG_OK;
 }
 
 static int netrigctl_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'F');
+	binproto_put_real(&f, freq);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "F %"FREQFMT"\n", freq);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -318,12 +789,22 @@ static int netrigctl_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
 
 static int netrigctl_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'f');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_real(&f, freq);
+	return ret;
+  }
+
   len = sprintf(cmd, "f\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -338,12 +819,21 @@ static int netrigctl_get_freq(RIG *rig, vfo_t vfo, freq_t *freq)
 
 static int netrigctl_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'M');
+	binproto_put_str(&f, rig_strrmode(mode), -1);
+	binproto_put_int(&f, width);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "M %s %li\n",
   		rig_strrmode(mode), width);
 
@@ -357,12 +847,29 @@ static int netrigctl_set_mode(RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width
 
 static int netrigctl_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'm');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_str(&f, buf, BUF_MAX);
+	if (ret >= 0) {
+		*mode = rig_parse_mode(buf);
+		ret = binproto_get_int(&f, &v);
+		if (ret == RIG_OK)
+			*width = v;
+	}
+	return ret;
+  }
+
   len = sprintf(cmd, "m\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -372,7 +879,7 @@ static int netrigctl_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *wid
   if (ret > 0 && buf[ret-1]=='\n') buf[ret-1] = '\0';	/* chomp */
   *mode = rig_parse_mode(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -384,12 +891,20 @@ static int netrigctl_get_mode(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *wid
 
 static int netrigctl_set_vfo(RIG *rig, vfo_t vfo)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'V');
+	binproto_put_str(&f, rig_strvfo(vfo), -1);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "V %s\n", rig_strvfo(vfo));
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -403,11 +918,34 @@ static int netrigctl_set_vfo(RIG *rig, vfo_t vfo)
 static int netrigctl_get_vfo(RIG *rig, vfo_t *vfo)
 {
   int ret, len;
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  /* answered along with dump_state at open time */
+  if (priv->has_vfo) {
+	priv->has_vfo = 0;
+	if (priv->vfo_ret == -RIG_ENAVAIL) return priv->vfo_ret;
+	if (priv->vfo_ret <= 0)
+		return (priv->vfo_ret < 0) ? priv->vfo_ret : -RIG_EPROTO;
+	*vfo = priv->vfo;
+	return RIG_OK;
+  }
+
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'v');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_str(&f, buf, BUF_MAX);
+	if (ret < 0)
+		return ret;
+	*vfo = rig_parse_vfo(buf);
+	return RIG_OK;
+  }
+
   len = sprintf(cmd, "v\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -424,12 +962,20 @@ static int netrigctl_get_vfo(RIG *rig, vfo_t *vfo)
 
 static int netrigctl_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'T');
+	binproto_put_int(&f, ptt);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "T %d\n", ptt);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -442,12 +988,25 @@ static int netrigctl_set_ptt(RIG *rig, vfo_t vfo, ptt_t ptt)
 
 static int netrigctl_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 't');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*ptt = v;
+	return ret;
+  }
+
   len = sprintf(cmd, "t\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -461,12 +1020,25 @@ static int netrigctl_get_ptt(RIG *rig, vfo_t vfo, ptt_t *ptt)
 
 static int netrigctl_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 0x8b);
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*dcd = v;
+	return ret;
+  }
+
   len = sprintf(cmd, "\\get_dcd\n");	/* FIXME */
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -710,12 +1282,20 @@ static int netrigctl_get_dcs_sql(RIG *rig, vfo_t vfo, unsigned int *code)
 
 static int netrigctl_set_split_freq(RIG *rig, vfo_t vfo, freq_t tx_freq)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'I');
+	binproto_put_real(&f, tx_freq);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "I %"FREQFMT"\n", tx_freq);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -728,12 +1308,22 @@ static int netrigctl_set_split_freq(RIG *rig, vfo_t vfo, freq_t tx_freq)
 
 static int netrigctl_get_split_freq(RIG *rig, vfo_t vfo, freq_t *tx_freq)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'i');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_real(&f, tx_freq);
+	return ret;
+  }
+
   len = sprintf(cmd, "i\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -747,12 +1337,21 @@ static int netrigctl_get_split_freq(RIG *rig, vfo_t vfo, freq_t *tx_freq)
 
 static int netrigctl_set_split_mode(RIG *rig, vfo_t vfo, rmode_t tx_mode, pbwidth_t tx_width)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'X');
+	binproto_put_str(&f, rig_strrmode(tx_mode), -1);
+	binproto_put_int(&f, tx_width);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "X %s %li\n",
   		rig_strrmode(tx_mode), tx_width);
 
@@ -765,12 +1364,29 @@ static int netrigctl_set_split_mode(RIG *rig, vfo_t vfo, rmode_t tx_mode, pbwidt
 
 static int netrigctl_get_split_mode(RIG *rig, vfo_t vfo, rmode_t *tx_mode, pbwidth_t *tx_width)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'x');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_str(&f, buf, BUF_MAX);
+	if (ret >= 0) {
+		*tx_mode = rig_parse_mode(buf);
+		ret = binproto_get_int(&f, &v);
+		if (ret == RIG_OK)
+			*tx_width = v;
+	}
+	return ret;
+  }
+
   len = sprintf(cmd, "x\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -780,7 +1396,7 @@ static int netrigctl_get_split_mode(RIG *rig, vfo_t vfo, rmode_t *tx_mode, pbwid
   if (ret > 0 && buf[ret-1]=='\n') buf[ret-1] = '\0';	/* chomp */
   *tx_mode = rig_parse_mode(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -791,12 +1407,21 @@ static int netrigctl_get_split_mode(RIG *rig, vfo_t vfo, rmode_t *tx_mode, pbwid
 
 static int netrigctl_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_vfo)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'S');
+	binproto_put_int(&f, split);
+	binproto_put_str(&f, rig_strvfo(tx_vfo), -1);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "S %d %s\n", split, rig_strvfo(tx_vfo));
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -809,12 +1434,31 @@ static int netrigctl_set_split_vfo(RIG *rig, vfo_t vfo, split_t split, vfo_t tx_
 
 static int netrigctl_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split, vfo_t *tx_vfo)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 's');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK) {
+		*split = v;
+		ret = binproto_get_str(&f, buf, BUF_MAX);
+		if (ret < 0)
+			return ret;
+		*tx_vfo = rig_parse_vfo(buf);
+		ret = RIG_OK;
+	}
+	return ret;
+  }
+
   len = sprintf(cmd, "s\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -823,7 +1467,7 @@ static int netrigctl_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split, vfo_t *t
 
   *split = atoi(buf);
 
-  ret = read_string(&rig->state.rigport, buf, BUF_MAX, "\n", 1);
+  ret = netrigctl_read_line(rig, buf, BUF_MAX);
   if (ret <= 0)
 	return (ret < 0) ? ret : -RIG_EPROTO;
 
@@ -836,12 +1480,20 @@ static int netrigctl_get_split_vfo(RIG *rig, vfo_t vfo, split_t *split, vfo_t *t
 
 static int netrigctl_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'J');
+	binproto_put_int(&f, rit);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "J %ld\n", rit);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -854,12 +1506,25 @@ static int netrigctl_set_rit(RIG *rig, vfo_t vfo, shortfreq_t rit)
 
 static int netrigctl_get_rit(RIG *rig, vfo_t vfo, shortfreq_t *rit)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'j');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*rit = v;
+	return ret;
+  }
+
   len = sprintf(cmd, "j\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -874,12 +1539,20 @@ static int netrigctl_get_rit(RIG *rig, vfo_t vfo, shortfreq_t *rit)
 
 static int netrigctl_set_xit(RIG *rig, vfo_t vfo, shortfreq_t xit)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'Z');
+	binproto_put_int(&f, xit);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "Z %ld\n", xit);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -892,12 +1565,25 @@ static int netrigctl_set_xit(RIG *rig, vfo_t vfo, shortfreq_t xit)
 
 static int netrigctl_get_xit(RIG *rig, vfo_t vfo, shortfreq_t *xit)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'z');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*xit = v;
+	return ret;
+  }
+
   len = sprintf(cmd, "z\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -912,12 +1598,20 @@ static int netrigctl_get_xit(RIG *rig, vfo_t vfo, shortfreq_t *xit)
 
 static int netrigctl_set_ts(RIG *rig, vfo_t vfo, shortfreq_t ts)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'N');
+	binproto_put_int(&f, ts);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "N %ld\n", ts);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -930,12 +1624,25 @@ static int netrigctl_set_ts(RIG *rig, vfo_t vfo, shortfreq_t ts)
 
 static int netrigctl_get_ts(RIG *rig, vfo_t vfo, shortfreq_t *ts)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'n');
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*ts = v;
+	return ret;
+  }
+
   len = sprintf(cmd, "n\n");
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -950,12 +1657,21 @@ static int netrigctl_get_ts(RIG *rig, vfo_t vfo, shortfreq_t *ts)
 
 static int netrigctl_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'U');
+	binproto_put_str(&f, rig_strfunc(func), -1);
+	binproto_put_int(&f, status);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   len = sprintf(cmd, "U %s %i\n", rig_strfunc(func), status);
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -968,12 +1684,26 @@ static int netrigctl_set_func(RIG *rig, vfo_t vfo, setting_t func, int status)
 
 static int netrigctl_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'u');
+	binproto_put_str(&f, rig_strfunc(func), -1);
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*status = v;
+	return ret;
+  }
+
   len = sprintf(cmd, "u %s\n", rig_strfunc(func));
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -988,6 +1718,8 @@ static int netrigctl_get_func(RIG *rig, vfo_t vfo, setting_t func, int *status)
 
 static int netrigctl_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
@@ -995,6 +1727,16 @@ static int netrigctl_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val
 
   rig_debug(RIG_DEBUG_VERBOSE,"%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'L');
+	binproto_put_str(&f, rig_strlevel(level), -1);
+	if (RIG_LEVEL_IS_FLOAT(level))
+		binproto_put_real(&f, val.f);
+	else
+		binproto_put_int(&f, val.i);
+	return netrigctl_bin_transaction(rig, &f);
+  }
+
   if (RIG_LEVEL_IS_FLOAT(level))
 	sprintf(lstr, "%f", val.f);
   else
@@ -1013,12 +1755,32 @@ static int netrigctl_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val
 
 static int netrigctl_get_level(RIG *rig, vfo_t vfo, setting_t level, value_t *val)
 {
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
+  double d;
   int ret, len;
   char cmd[CMD_MAX];
   char buf[BUF_MAX];
 
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
 
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'l');
+	binproto_put_str(&f, rig_strlevel(level), -1);
+	ret = netrigctl_bin_transaction(rig, &f);
+	if (ret == RIG_OK && RIG_LEVEL_IS_FLOAT(level)) {
+		ret = binproto_get_real(&f, &d);
+		if (ret == RIG_OK)
+			val->f = d;
+	} else if (ret == RIG_OK) {
+		ret = binproto_get_int(&f, &v);
+		if (ret == RIG_OK)
+			val->i = v;
+	}
+	return ret;
+  }
+
   len = sprintf(cmd, "l %s\n", rig_strlevel(level));
 
   ret = netrigctl_transaction(rig, cmd, len, buf);
@@ -1251,9 +2013,168 @@ static int netrigctl_set_channel(RIG *rig, const channel_t *chan)
 }
 
 
+/*
+ * Read the current VFO in one batch: all the queries go out in a single
+ * TCP segment and the replies are matched in order, so the channel costs
+ * one round trip instead of one per field.
+ */
 static int netrigctl_get_channel(RIG *rig, channel_t *chan)
 {
-  return -RIG_ENIMPL;
+  static const char batch[] = "f\nm\ns\ni\nx\nj\nz\nr\no\nn\nc\nd\n";
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  int ret, i, chan_num;
+  char buf[BUF_MAX];
+
+  rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  if (chan->vfo != RIG_VFO_CURR)
+	return -RIG_ENIMPL;
+
+  chan_num = chan->channel_num;
+  memset(chan, 0, sizeof(channel_t));
+  chan->channel_num = chan_num;
+  chan->vfo = RIG_VFO_CURR;
+
+  if (priv->pending > 0)
+	priv->desync = 1;
+
+  ret = netrigctl_queue(rig, batch, sizeof(batch)-1);
+  if (ret == RIG_OK)
+	ret = netrigctl_send(rig);
+  if (ret != RIG_OK)
+	return ret;
+
+  for (i=0; batch[i]; i+=2) {
+	ret = netrigctl_reply(rig, buf);
+	if (ret < 0 && priv->desync)
+		return ret;
+	if (ret <= 0)
+		continue;	/* not available on the remote rig */
+	if (buf[ret-1]=='\n') buf[ret-1] = '\0';	/* chomp */
+
+	switch (batch[i]) {
+	case 'f':
+		num_sscanf(buf, "%"SCNfreq, &chan->freq);
+		break;
+	case 'm':
+		chan->mode = rig_parse_mode(buf);
+		ret = netrigctl_read_line(rig, buf, BUF_MAX);
+		if (ret < 0)
+			return ret;
+		chan->width = atol(buf);
+		break;
+	case 's':
+		chan->split = atoi(buf);
+		ret = netrigctl_read_line(rig, buf, BUF_MAX);
+		if (ret < 0)
+			return ret;
+		if (ret > 0 && buf[ret-1]=='\n') buf[ret-1] = '\0';	/* chomp */
+		chan->tx_vfo = rig_parse_vfo(buf);
+		break;
+	case 'i':
+		num_sscanf(buf, "%"SCNfreq, &chan->tx_freq);
+		break;
+	case 'x':
+		chan->tx_mode = rig_parse_mode(buf);
+		ret = netrigctl_read_line(rig, buf, BUF_MAX);
+		if (ret < 0)
+			return ret;
+		chan->tx_width = atol(buf);
+		break;
+	case 'j':
+		chan->rit = atol(buf);
+		break;
+	case 'z':
+		chan->xit = atol(buf);
+		break;
+	case 'r':
+		chan->rptr_shift = rig_parse_rptr_shift(buf);
+		break;
+	case 'o':
+		chan->rptr_offs = atol(buf);
+		break;
+	case 'n':
+		chan->tuning_step = atol(buf);
+		break;
+	case 'c':
+		chan->ctcss_tone = atoi(buf);
+		break;
+	case 'd':
+		chan->dcs_code = atoi(buf);
+		break;
+	}
+  }
+
+  return RIG_OK;
+}
+
+
+/*
+ * For the software scan: the squelch query goes out right behind the
+ * tune request instead of a round trip later
+ */
+static int netrigctl_tune_get_dcd(RIG *rig, vfo_t vfo, freq_t freq, dcd_t *dcd)
+{
+  int ret, tune_ret, len;
+  struct netrigctl_priv_data *priv = (struct netrigctl_priv_data *)rig->state.priv;
+  struct binproto_frame f;
+  int64_t v;
+  char cmd[CMD_MAX];
+  char buf[BUF_MAX];
+
+  rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __FUNCTION__);
+
+  if (priv->pending > 0)
+	priv->desync = 1;
+
+  if (priv->binary) {
+	netrigctl_frame(rig, &f, 'F');
+	binproto_put_real(&f, freq);
+	ret = netrigctl_queue_frame(rig, &f);
+	if (ret == RIG_OK) {
+		netrigctl_frame(rig, &f, 0x8b);
+		ret = netrigctl_queue_frame(rig, &f);
+	}
+	if (ret == RIG_OK)
+		ret = netrigctl_send(rig);
+	if (ret != RIG_OK)
+		return ret;
+
+	tune_ret = netrigctl_bin_reply(rig, &f);
+	if (tune_ret < 0 && priv->desync)
+		return tune_ret;
+	ret = netrigctl_bin_reply(rig, &f);
+	if (tune_ret != RIG_OK)
+		return tune_ret;
+	if (ret == RIG_OK)
+		ret = binproto_get_int(&f, &v);
+	if (ret == RIG_OK)
+		*dcd = v;
+	return ret;
+  }
+
+  len = sprintf(cmd, "F %"FREQFMT"\n\\get_dcd\n", freq);
+
+  ret = netrigctl_queue(rig, cmd, len);
+  if (ret == RIG_OK)
+	ret = netrigctl_send(rig);
+  if (ret != RIG_OK)
+	return ret;
+
+  /* both replies are read, whatever the first one says */
+  tune_ret = netrigctl_reply(rig, buf);
+  if (tune_ret < 0 && priv->desync)
+	return tune_ret;
+
+  ret = netrigctl_reply(rig, buf);
+  if (tune_ret != 0)
+	return (tune_ret < 0) ? tune_ret : -RIG_EPROTO;
+  if (ret <= 0)
+	return (ret < 0) ? ret : -RIG_EPROTO;
+
+  *dcd = atoi(buf);
+
+  return RIG_OK;
 }
 
 
@@ -1359,7 +2280,7 @@ const struct rig_caps netrigctl_caps = {
   .rig_model =      RIG_MODEL_NETRIGCTL,
   .model_name =     "NET rigctl",
   .mfg_name =       "Hamlib",
-  .version =        "1.0",
+  .version =        "1.2",
   .copyright =      "LGPL",
   .status =         RIG_STATUS_STABLE,
   .rig_type =       RIG_TYPE_OTHER,
@@ -1394,8 +2315,12 @@ const struct rig_caps netrigctl_caps = {
   .max_ifshift = 0,
   .priv =  NULL,
 
-  .rig_init =     NULL,
-  .rig_cleanup =  NULL,
+  .cfgparams =    netrigctl_cfg_params,
+
+  .rig_init =     netrigctl_init,
+  .rig_cleanup =  netrigctl_cleanup,
+  .set_conf =     netrigctl_set_conf,
+  .get_conf =     netrigctl_get_conf,
   .rig_open =     netrigctl_open,
   .rig_close =    netrigctl_close,
 
@@ -1457,4 +2382,5 @@ const struct rig_caps netrigctl_caps = {
   .send_morse =  netrigctl_send_morse,
   .set_channel = 	netrigctl_set_channel,
   .get_channel = 	netrigctl_get_channel,
+  .tune_get_dcd = 	netrigctl_tune_get_dcd,
 };
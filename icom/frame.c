@@ -259,6 +259,10 @@ int icom_transaction (RIG *rig, int cmd, int subcmd, const unsigned char *payloa
 		retval = icom_one_transaction (rig, cmd, subcmd, payload, payload_len, data, data_len);
 		if (retval == RIG_OK || retval == -RIG_ERJCTED)
 			break;
+		if (retval == -RIG_EPROTO || retval == -RIG_BUSERROR)
+			rig->state.rigport.stats.protocol_errors++;
+		if (retry > 0)
+			rig->state.rigport.stats.retries++;
 	} while (retry-- > 0);
 
 	return retval;
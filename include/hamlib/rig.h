@@ -198,6 +198,7 @@ typedef enum rig_port_e {
     RIG_PORT_CM108,         /*!< CM108 GPIO */
     RIG_PORT_GPIO,          /*!< GPIO */
     RIG_PORT_GPION,         /*!< GPIO inverted */
+    RIG_PORT_REPLAY,        /*!< Replay of a recorded session, see record_pathname */
 } rig_port_t;
 
 
@@ -1291,6 +1292,97 @@ typedef int (* confval_cb_t)(RIG *,
                              rig_ptr_t);
 
 
+/**
+ * \brief Memory channel synchronisation report
+ *
+ * Filled in by rig_sync_chan_all().
+ */
+struct rig_chan_sync_stats {
+    int channels;       /*!< Channels in the desired set */
+    int written;        /*!< Channels written to the rig */
+    int unchanged;      /*!< Channels skipped, the image matched */
+    int verified;       /*!< Written channels read back */
+    int mismatched;     /*!< Read back channels that differ */
+};
+
+
+/**
+ * \brief Software scan list entry, see rig_scan_soft()
+ */
+struct rig_scan_entry {
+    int channel_num;    /*!< Memory channel, or -1 to tune to freq */
+    freq_t freq;        /*!< Frequency, when channel_num is -1 */
+    int priority;       /*!< Priority entry, visited every priority_ms */
+};
+
+/**
+ * \brief How the software scan tells a busy channel
+ */
+enum rig_scan_sense_e {
+    RIG_SCAN_SENSE_DCD = 0,     /*!< rig_get_dcd() */
+    RIG_SCAN_SENSE_STRENGTH     /*!< RIG_LEVEL_STRENGTH at or above a threshold */
+};
+
+/**
+ * \brief Software scan parameters, see rig_scan_soft()
+ */
+struct rig_scan_params {
+    const struct rig_scan_entry *entries;   /*!< Channels and frequencies to scan */
+    int nentries;                           /*!< Number of entries */
+    enum rig_scan_sense_e sense;            /*!< Busy channel detection */
+    int threshold;                          /*!< STRENGTH threshold, dB relative to S9 */
+    int dwell_min_ms;                       /*!< Dwell on a quiet channel */
+    int dwell_max_ms;                       /*!< Dwell on the most active channels */
+    int hang_ms;                            /*!< Stay after a busy channel turns quiet */
+    int hold_max_ms;                        /*!< Longest stay on a busy channel, 0 for no limit */
+    int priority_ms;                        /*!< Period of the priority entries visits */
+    int passes;                             /*!< Passes over the list, 0 for no limit */
+};
+
+/**
+ * \brief Busy channel found by the software scan
+ */
+struct rig_scan_hit {
+    int index;          /*!< Index of the entry in the list */
+    int channel_num;    /*!< Memory channel, or -1 */
+    freq_t freq;        /*!< Frequency, when channel_num is -1 */
+    int strength;       /*!< STRENGTH, when sensed this way */
+    int priority;       /*!< Priority entry */
+};
+
+/**
+ * \brief Software scan hit callback, returns non zero to stop the scan
+ */
+typedef int (*scan_hit_cb_t)(RIG *, const struct rig_scan_hit *, rig_ptr_t);
+
+
+/**
+ * \brief Frequency sweep parameters, see rig_sweep()
+ */
+struct rig_sweep_params {
+    freq_t start;       /*!< First frequency */
+    freq_t stop;        /*!< Last frequency, included */
+    freq_t step;        /*!< Frequency step */
+    setting_t level;    /*!< Level read at each point, e.g. RIG_LEVEL_STRENGTH */
+    int settle_ms;      /*!< Wait before reading, negative to measure it */
+    int ptt;            /*!< Key the transmitter around each reading */
+};
+
+/**
+ * \brief Frequency sweep point
+ */
+struct rig_sweep_point {
+    int index;          /*!< Point number, from 0 */
+    freq_t freq;        /*!< Frequency */
+    value_t val;        /*!< Level read */
+};
+
+/**
+ * \brief Frequency sweep callback, returns non zero to stop the sweep
+ */
+typedef int (*sweep_cb_t)(RIG *, const struct rig_sweep_point *, rig_ptr_t);
+
+
 /**
  * \brief Rig data structure.
  *
@@ -1545,9 +1637,59 @@ struct rig_caps {
 
     const char *clone_combo_set;    /*!< String describing key combination to enter load cloning mode */
     const char *clone_combo_get;    /*!< String describing key combination to enter save cloning mode */
+
+    /*
+     * Optional, for the rig_get_channel() emulation: fills in the fields
+     * of the current VFO the rig reports in one exchange, and flags them
+     * in filled.
+     */
+    int (*get_chan_snapshot)(RIG *rig, channel_t *chan, channel_cap_t *filled);
+
+    /*
+     * Optional, for the software scan: tunes to freq and reads the
+     * squelch status right after, without waiting for the tune answer
+     * in between.
+     */
+    int (*tune_get_dcd)(RIG *rig, vfo_t vfo, freq_t freq, dcd_t *dcd);
 };
 
 
+/**
+ * \brief Number of buckets of the port latency histograms
+ *
+ * Bucket i counts latencies, in microseconds, from rig_port_hist_value(i)
+ * up to rig_port_hist_value(i+1), with four buckets per power of two.
+ * The last bucket also counts anything above 33 seconds.
+ */
+#define RIG_PORT_HIST_SIZE 96
+
+/**
+ * \brief Port I/O statistics
+ *
+ * Maintained by write_block(), read_block() and read_string(), and by the
+ * backend transaction loops for retries and protocol errors.
+ *
+ * \sa rig_get_port_stats()
+ */
+typedef struct hamlib_port_stats {
+    unsigned long bytes_out;        /*!< Bytes written */
+    unsigned long bytes_in;         /*!< Bytes read */
+    unsigned long transactions;     /*!< Writes that got a reply */
+    unsigned long timeouts;         /*!< Reads that timed out */
+    unsigned long retries;          /*!< Commands resent by the backend */
+    unsigned long flushed;          /*!< Unsolicited bytes discarded by a flush */
+    unsigned long protocol_errors;  /*!< Malformed or unexpected replies */
+    unsigned long first_byte_hist[RIG_PORT_HIST_SIZE];  /*!< Write to first reply byte latency */
+    unsigned long last_byte_hist[RIG_PORT_HIST_SIZE];   /*!< Write to last reply byte latency */
+
+    struct {
+        long tv_sec, tv_usec;
+    } tx_date, rx_date;             /*!< hamlib internal use */
+    int tx_pending;                 /*!< hamlib internal use */
+    int rx_seen;                    /*!< hamlib internal use */
+} hamlib_port_stats_t;
+
+
 /**
  * \brief Port definition
  *
@@ -1561,7 +1703,7 @@ typedef struct hamlib_port {
     } type;
 
     int fd;                 /*!< File descriptor */
-    void *handle;           /*!< handle for USB */
+    void *handle;           /*!< handle for USB, or replay state */
 
     int write_delay;        /*!< Delay between each byte sent out, in mS */
     int post_write_delay;   /*!< Delay between each commands send out, in mS */
@@ -1609,6 +1751,12 @@ typedef struct hamlib_port {
             int value;      /*!< Toggle PTT ON or OFF */
         } gpio;             /*!< GPIO attributes */
     } parm;                 /*!< Port parameter union */
+
+    hamlib_port_stats_t stats;  /*!< I/O statistics */
+
+    char record_pathname[FILPATHLEN];   /*!< Record the I/O to this file, empty for none */
+    void *record;                       /*!< hamlib internal use */
+    float replay_scale;     /*!< RIG_PORT_REPLAY reply latency factor, 0 for no delay */
 } hamlib_port_t;
 
 #if !defined(__APPLE__) || !defined(__cplusplus)
@@ -1811,6 +1959,11 @@ extern HAMLIB_EXPORT(int)
 rig_get_dcd HAMLIB_PARAMS((RIG *rig,
                            vfo_t vfo,
                            dcd_t *dcd));
+extern HAMLIB_EXPORT(int)
+rig_tune_get_dcd HAMLIB_PARAMS((RIG *rig,
+                                vfo_t vfo,
+                                freq_t freq,
+                                dcd_t *dcd));
 
 extern HAMLIB_EXPORT(int)
 rig_set_rptr_shift HAMLIB_PARAMS((RIG *rig,
@@ -2147,6 +2300,19 @@ rig_scan HAMLIB_PARAMS((RIG *rig,
                         vfo_t vfo,
                         scan_t scan,
                         int ch));
+extern HAMLIB_EXPORT(int)
+rig_scan_soft HAMLIB_PARAMS((RIG *rig,
+                             vfo_t vfo,
+                             const struct rig_scan_params *params,
+                             scan_hit_cb_t hit_cb,
+                             rig_ptr_t arg));
+
+extern HAMLIB_EXPORT(int)
+rig_sweep HAMLIB_PARAMS((RIG *rig,
+                         vfo_t vfo,
+                         const struct rig_sweep_params *params,
+                         sweep_cb_t sweep_cb,
+                         rig_ptr_t arg));
 
 extern HAMLIB_EXPORT(scan_t)
 rig_has_scan HAMLIB_PARAMS((RIG *rig,
@@ -2175,6 +2341,66 @@ rig_get_chan_all_cb HAMLIB_PARAMS((RIG *rig,
                                    chan_cb_t chan_cb,
                                    rig_ptr_t));
 
+extern HAMLIB_EXPORT(int)
+rig_sync_chan_all HAMLIB_PARAMS((RIG *rig,
+                                 const channel_t chans[],
+                                 int nchans,
+                                 const char *image_path,
+                                 int verify,
+                                 struct rig_chan_sync_stats *stats));
+
+struct rig_chan_image;
+
+extern HAMLIB_EXPORT(int)
+rig_chan_image_save HAMLIB_PARAMS((RIG *rig,
+                                   const char *path,
+                                   const channel_t chans[],
+                                   int nchans));
+extern HAMLIB_EXPORT(int)
+rig_chan_image_open HAMLIB_PARAMS((const char *path,
+                                   struct rig_chan_image **img));
+extern HAMLIB_EXPORT(int)
+rig_chan_image_close HAMLIB_PARAMS((struct rig_chan_image *img));
+extern HAMLIB_EXPORT(int)
+rig_chan_image_count HAMLIB_PARAMS((const struct rig_chan_image *img));
+extern HAMLIB_EXPORT(int)
+rig_chan_image_load HAMLIB_PARAMS((RIG *rig,
+                                   const struct rig_chan_image *img,
+                                   int idx,
+                                   channel_t *chan));
+
+/**
+ * \brief Rig state as kept in a shared state page
+ *
+ * See rig_state_page_publish() and rig_state_page_read().
+ */
+struct rig_state_snapshot {
+    vfo_t vfo;              /*!< Current VFO */
+    freq_t freq;            /*!< Frequency of the current VFO */
+    rmode_t mode;           /*!< Mode of the current VFO */
+    pbwidth_t width;        /*!< Passband width */
+    ptt_t ptt;              /*!< PTT state */
+    unsigned long count;    /*!< Updates since the page was created */
+    double stamp;           /*!< Time of the update, seconds since the Epoch */
+};
+
+struct rig_state_page;
+
+extern HAMLIB_EXPORT(int)
+rig_state_page_create HAMLIB_PARAMS((const char *path,
+                                     struct rig_state_page **page));
+extern HAMLIB_EXPORT(int)
+rig_state_page_open HAMLIB_PARAMS((const char *path,
+                                   struct rig_state_page **page));
+extern HAMLIB_EXPORT(int)
+rig_state_page_close HAMLIB_PARAMS((struct rig_state_page *page));
+extern HAMLIB_EXPORT(int)
+rig_state_page_publish HAMLIB_PARAMS((struct rig_state_page *page,
+                                      const struct rig_state_snapshot *snap));
+extern HAMLIB_EXPORT(int)
+rig_state_page_read HAMLIB_PARAMS((const struct rig_state_page *page,
+                                   struct rig_state_snapshot *snap));
+
 extern HAMLIB_EXPORT(int)
 rig_set_mem_all_cb HAMLIB_PARAMS((RIG *rig,
                                   chan_cb_t chan_cb,
@@ -2287,6 +2513,39 @@ extern HAMLIB_EXPORT(void)
 rig_debug HAMLIB_PARAMS((enum rig_debug_level_e debug_level,
                          const char *fmt, ...));
 
+/*
+ * Current debug level, as set by rig_set_debug().  Exported so that the
+ * rig_debug() macro below can test it inline; use rig_set_debug() to change it.
+ */
+extern HAMLIB_EXPORT_VAR(int) rig_debug_level;
+
+/*
+ * Messages above RIG_DEBUG_COMPILE_LEVEL are compiled out entirely.
+ * Define it (e.g. configure --with-debug-level) before including this file.
+ */
+#ifndef RIG_DEBUG_COMPILE_LEVEL
+#  define RIG_DEBUG_COMPILE_LEVEL RIG_DEBUG_TRACE
+#endif
+
+/**
+ * \brief Cheap test whether a message at \a level would be emitted
+ */
+#define rig_debug_enabled(level) \
+    ((int)(level) <= (int)RIG_DEBUG_COMPILE_LEVEL \
+     && (int)(level) <= rig_debug_level)
+
+#ifndef SWIG
+/*
+ * Check the level before evaluating any argument, so that a disabled
+ * message costs one compare instead of a call into the library.
+ */
+#define rig_debug(level, ...) \
+    do { \
+        if (rig_debug_enabled(level)) \
+            (rig_debug)((level), __VA_ARGS__); \
+    } while (0)
+#endif
+
 extern HAMLIB_EXPORT(vprintf_cb_t)
 rig_set_debug_callback HAMLIB_PARAMS((vprintf_cb_t cb,
                                       rig_ptr_t arg));
@@ -2294,6 +2553,26 @@ rig_set_debug_callback HAMLIB_PARAMS((vprintf_cb_t cb,
 extern HAMLIB_EXPORT(FILE *)
 rig_set_debug_file HAMLIB_PARAMS((FILE *stream));
 
+extern HAMLIB_EXPORT(int)
+rig_get_port_stats HAMLIB_PARAMS((RIG *rig,
+                                  hamlib_port_stats_t *stats));
+
+extern HAMLIB_EXPORT(int)
+rig_reset_port_stats HAMLIB_PARAMS((RIG *rig));
+
+extern HAMLIB_EXPORT(unsigned long)
+rig_port_hist_value HAMLIB_PARAMS((int bucket));
+
+extern HAMLIB_EXPORT(unsigned long)
+rig_port_hist_percentile HAMLIB_PARAMS((const unsigned long hist[],
+                                        double percent));
+
+extern HAMLIB_EXPORT(int)
+rig_trace_open HAMLIB_PARAMS((const char *path));
+
+extern HAMLIB_EXPORT(int)
+rig_trace_close HAMLIB_PARAMS((void));
+
 extern HAMLIB_EXPORT(int)
 rig_register HAMLIB_PARAMS((const struct rig_caps *caps));
 
@@ -306,6 +306,12 @@ struct rot_state {
     azimuth_t max_az;       /*!< Upper limit for azimuth (overridable). */
     elevation_t min_el;     /*!< Lower limit for elevation (overridable). */
     elevation_t max_el;     /*!< Upper limit for elevation (overridable). */
+    float az_rate;          /*!< Azimuth slew rate in deg/s, 0 if unknown (overridable). */
+    float el_rate;          /*!< Elevation slew rate in deg/s, 0 if unknown (overridable). */
+    float track_deadband;   /*!< Smallest move when tracking, in degrees (overridable). */
+    int poll_interval;      /*!< Position polling period in ms while moving, 0 for none (overridable). */
+    int poll_idle;          /*!< Position polling period in ms when still (overridable). */
+    char motion_file[FILPATHLEN]; /*!< File keeping the learned motion, none if empty (overridable). */
 
     /*
      * non overridable fields, internal use
@@ -315,11 +321,39 @@ struct rot_state {
     int comm_state;         /*!< Comm port state, opened/closed. */
     rig_ptr_t priv;         /*!< Pointer to private rotator state data. */
     rig_ptr_t obj;          /*!< Internal use by hamlib++ for event handling. */
+    rig_ptr_t track;        /*!< Trajectory tracking state (internal use). */
+    rig_ptr_t poll;         /*!< Position cache state (internal use). */
+    rig_ptr_t motion;       /*!< Motion model state (internal use). */
 
     /* etc... */
 };
 
 
+/**
+ * \brief A point of a trajectory to track
+ *
+ * \sa rot_track_add()
+ */
+struct rot_track_point {
+    double time;            /*!< Seconds since the Epoch, UTC, may have decimals. */
+    azimuth_t azimuth;      /*!< Azimuth at that time, in degrees. */
+    elevation_t elevation;  /*!< Elevation at that time, in degrees. */
+};
+
+
+/**
+ * \brief Progress of the trajectory tracking
+ *
+ * \sa rot_track_get_status()
+ */
+struct rot_track_status {
+    int active;             /*!< Non zero while a trajectory is followed. */
+    int points;             /*!< Points of the trajectory not passed yet. */
+    unsigned long commands; /*!< Positions sent to the rotator. */
+    int latency_ms;         /*!< Measured duration of a position command. */
+};
+
+
 /**
  * Rotator structure
  * \struct rot
@@ -373,6 +407,24 @@ extern HAMLIB_EXPORT(int)
 rot_get_position HAMLIB_PARAMS((ROT *rot,
                                 azimuth_t *azimuth,
                                 elevation_t *elevation));
+extern HAMLIB_EXPORT(int)
+rot_get_cached_position HAMLIB_PARAMS((ROT *rot,
+                                       azimuth_t *azimuth,
+                                       elevation_t *elevation,
+                                       int *age_ms));
+extern HAMLIB_EXPORT(int)
+rot_get_eta HAMLIB_PARAMS((ROT *rot,
+                           double *eta));
+
+extern HAMLIB_EXPORT(int)
+rot_track_add HAMLIB_PARAMS((ROT *rot,
+                             const struct rot_track_point *points,
+                             int count));
+extern HAMLIB_EXPORT(int)
+rot_track_stop HAMLIB_PARAMS((ROT *rot));
+extern HAMLIB_EXPORT(int)
+rot_track_get_status HAMLIB_PARAMS((ROT *rot,
+                                    struct rot_track_status *status));
 
 extern HAMLIB_EXPORT(int)
 rot_stop HAMLIB_PARAMS((ROT *rot));
@@ -457,6 +509,28 @@ locator2longlat HAMLIB_PARAMS((double *longitude,
                                double *latitude,
                                const char *locator));
 
+extern HAMLIB_EXPORT(int)
+qrb_batch HAMLIB_PARAMS((double lon1,
+                         double lat1,
+                         int n,
+                         const double *lon2,
+                         const double *lat2,
+                         double *distance,
+                         double *azimuth));
+
+extern HAMLIB_EXPORT(int)
+longlat2locator_batch HAMLIB_PARAMS((int n,
+                                     const double *longitude,
+                                     const double *latitude,
+                                     char *locator_res,
+                                     int pair_count));
+
+extern HAMLIB_EXPORT(int)
+locator2longlat_batch HAMLIB_PARAMS((int n,
+                                     const char *const *locator,
+                                     double *longitude,
+                                     double *latitude));
+
 extern HAMLIB_EXPORT(double)
 dms2dec HAMLIB_PARAMS((int degrees,
                        int minutes,
@@ -285,21 +285,29 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasiz
   len = min (datasize ? datasize + 1 : strlen (priv->verify_cmd) + 13, KENWOOD_MAX_BUF_LEN);
   retval = read_string(&rs->rigport, buffer, len, cmdtrm, strlen(cmdtrm));
   if (retval < 0) {
-    if (retry_read++ < rs->rigport.retry)
+    if (retry_read++ < rs->rigport.retry) {
+      rs->rigport.stats.retries++;
       goto transaction_write;
+    }
     goto transaction_quit;
   }
 
   /* Check that command termination is correct */
   if (strchr(cmdtrm, buffer[strlen(buffer)-1])==NULL) {
     rig_debug(RIG_DEBUG_ERR, "%s: Command is not correctly terminated '%s'\n", __func__, buffer);
-    if (retry_read++ < rs->rigport.retry)
+    rs->rigport.stats.protocol_errors++;
+    if (retry_read++ < rs->rigport.retry) {
+      rs->rigport.stats.retries++;
       goto transaction_write;
+    }
     retval = -RIG_EPROTO;
     goto transaction_quit;
   }
 
   if (strlen(buffer) == 2) {
+    if (strchr("OE?", buffer[0]))
+      rs->rigport.stats.protocol_errors++;
+
     switch (buffer[0]) {
     case 'N':
       /* Command recognised by rig but invalid data entered. */
@@ -315,8 +323,10 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasiz
         {
           rig_debug(RIG_DEBUG_VERBOSE, "%s: Overflow for '%s'\n", __func__, cmdstr);
         }
-      if (retry_read++ < rs->rigport.retry)
+      if (retry_read++ < rs->rigport.retry) {
+        rs->rigport.stats.retries++;
         goto transaction_write;
+      }
       retval = -RIG_EPROTO;
       goto transaction_quit;
     case 'E':
@@ -325,8 +335,10 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasiz
         {
           rig_debug(RIG_DEBUG_VERBOSE, "%s: Communication error for '%s'\n", __func__, cmdstr);
         }
-      if (retry_read++ < rs->rigport.retry)
+      if (retry_read++ < rs->rigport.retry) {
+        rs->rigport.stats.retries++;
         goto transaction_write;
+      }
       retval = -RIG_EIO;
       goto transaction_quit;
     case '?':
@@ -337,6 +349,7 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasiz
         }
       if (retry_read++ < rs->rigport.retry)
         {
+          rs->rigport.stats.retries++;
           rig_debug(RIG_DEBUG_ERR, "%s: Retrying shortly\n", __func__);
           usleep (rig->caps->timeout * 1000);
           goto transaction_read;
@@ -363,9 +376,12 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasiz
            */
           rig_debug(RIG_DEBUG_ERR, "%s: wrong reply %c%c for command %c%c\n",
                     __func__, buffer[0], buffer[1], cmdstr[0], cmdstr[1]);
+          rs->rigport.stats.protocol_errors++;
 
-          if (retry_read++ < rs->rigport.retry)
+          if (retry_read++ < rs->rigport.retry) {
+            rs->rigport.stats.retries++;
             goto transaction_write;
+          }
 
           retval =  -RIG_EPROTO;
           goto transaction_quit;
@@ -393,9 +409,12 @@ int kenwood_transaction(RIG *rig, const char *cmdstr, char *data, size_t datasiz
           rig_debug(RIG_DEBUG_ERR, "%s: wrong reply %c%c for command verification %c%c\n",
                     __func__, buffer[0], buffer[1]
                     , priv->verify_cmd[0], priv->verify_cmd[1]);
+          rs->rigport.stats.protocol_errors++;
 
-          if (retry_read++ < rs->rigport.retry)
+          if (retry_read++ < rs->rigport.retry) {
+            rs->rigport.stats.retries++;
             goto transaction_write;
+          }
 
           retval =  -RIG_EPROTO;
           goto transaction_quit;
@@ -710,6 +729,12 @@ static int kenwood_get_if(RIG *rig)
           KENWOOD_MAX_BUF_LEN, caps->if_len);
 }
 
+static int kenwood_if_split(RIG *rig, split_t *split, vfo_t *txvfo);
+static int kenwood_if_vfo(RIG *rig, vfo_t *vfo);
+static void kenwood_if_freq(RIG *rig, freq_t *freq);
+static shortfreq_t kenwood_if_rit(RIG *rig);
+static int kenwood_mode_if_reads_filter(RIG *rig);
+
 
 /* FN FR FT
  *  Sets the RX/TX VFO or M.CH mode of the transceiver, does not set split
@@ -982,7 +1007,6 @@ int kenwood_get_split_vfo_if(RIG *rig, vfo_t rxvfo, split_t *split, vfo_t *txvfo
   if (!rig || !split || !txvfo)
     return -RIG_EINVAL;
 
-  struct kenwood_priv_data *priv = rig->state.priv;
   int retval;
 
   if (RIG_MODEL_TS990S == rig->caps->rig_model)
@@ -1008,6 +1032,16 @@ int kenwood_get_split_vfo_if(RIG *rig, vfo_t rxvfo, split_t *split, vfo_t *txvfo
   if (retval != RIG_OK)
     return retval;
 
+  return kenwood_if_split(rig, split, txvfo);
+}
+
+/*
+ * Split VFO status from the last IF answer
+ */
+static int kenwood_if_split(RIG *rig, split_t *split, vfo_t *txvfo)
+{
+  struct kenwood_priv_data *priv = rig->state.priv;
+
   switch (priv->info[32]) {
   case '0':
     *split = RIG_SPLIT_OFF;
@@ -1070,12 +1104,21 @@ int kenwood_get_vfo_if(RIG *rig, vfo_t *vfo)
     return -RIG_EINVAL;
 
   int retval;
-  struct kenwood_priv_data *priv = rig->state.priv;
 
   retval = kenwood_get_if(rig);
   if (retval != RIG_OK)
     return retval;
 
+  return kenwood_if_vfo(rig, vfo);
+}
+
+/*
+ * RX VFO from the last IF answer
+ */
+static int kenwood_if_vfo(RIG *rig, vfo_t *vfo)
+{
+  struct kenwood_priv_data *priv = rig->state.priv;
+
   /* Elecraft info[30] does not track split VFO when transmitting */
   int split_and_transmitting =
     '1' == priv->info[28] /* transmitting */
@@ -1194,19 +1237,25 @@ int kenwood_get_freq_if(RIG *rig, vfo_t vfo, freq_t *freq)
   if (!rig || !freq)
     return -RIG_EINVAL;
 
-  struct kenwood_priv_data *priv = rig->state.priv;
-  char freqbuf[50];
   int retval;
 
   retval = kenwood_get_if(rig);
   if (retval != RIG_OK)
     return retval;
 
+  kenwood_if_freq(rig, freq);
+
+  return RIG_OK;
+}
+
+static void kenwood_if_freq(RIG *rig, freq_t *freq)
+{
+  struct kenwood_priv_data *priv = rig->state.priv;
+  char freqbuf[50];
+
   memcpy(freqbuf, priv->info, 15);
   freqbuf[14] = '\0';
   sscanf(freqbuf + 2, "%"SCNfreq, freq);
-
-  return RIG_OK;
 }
 
 /*
@@ -1275,19 +1324,26 @@ int kenwood_get_rit(RIG *rig, vfo_t vfo, shortfreq_t *rit)
     return -RIG_EINVAL;
 
   int retval;
-  char buf[6];
-  struct kenwood_priv_data *priv = rig->state.priv;
 
   retval = kenwood_get_if(rig);
   if (retval != RIG_OK)
     return retval;
 
+  *rit = kenwood_if_rit(rig);
+
+  return RIG_OK;
+}
+
+/* RIT/XIT offset from the last IF answer */
+static shortfreq_t kenwood_if_rit(RIG *rig)
+{
+  struct kenwood_priv_data *priv = rig->state.priv;
+  char buf[6];
+
   memcpy(buf, &priv->info[18], 5);
 
   buf[5] = '\0';
-  *rit = atoi(buf);
-
-  return RIG_OK;
+  return atoi(buf);
 }
 
 /*
@@ -1687,10 +1743,7 @@ int kenwood_get_mode_if(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
 
   *width = rig_passband_normal(rig, *mode);
 
-  if (rig->caps->rig_model == RIG_MODEL_TS450S
-    || rig->caps->rig_model == RIG_MODEL_TS690S
-    || rig->caps->rig_model == RIG_MODEL_TS850
-    || rig->caps->rig_model == RIG_MODEL_TS950SDX) {
+  if (kenwood_mode_if_reads_filter(rig)) {
 
     err = kenwood_get_filter(rig, width);
     /* non fatal */
@@ -1699,6 +1752,83 @@ int kenwood_get_mode_if(RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
   return RIG_OK;
 }
 
+/* rigs whose passband is not the normal one of the IF mode */
+static int kenwood_mode_if_reads_filter(RIG *rig)
+{
+  return rig->caps->rig_model == RIG_MODEL_TS450S
+    || rig->caps->rig_model == RIG_MODEL_TS690S
+    || rig->caps->rig_model == RIG_MODEL_TS850
+    || rig->caps->rig_model == RIG_MODEL_TS950SDX;
+}
+
+/*
+ * kenwood_get_chan_snapshot
+ *
+ * One IF answer carries what kenwood_get_freq_if, kenwood_get_mode_if,
+ * kenwood_get_vfo_if, kenwood_get_split_vfo_if and kenwood_get_rit would
+ * each fetch with their own IF.  Fill in the fields the backend would get
+ * from IF anyway, so that the rig_get_channel emulation asks only once.
+ */
+int kenwood_get_chan_snapshot(RIG *rig, channel_t *chan, channel_cap_t *filled)
+{
+  rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+  if (!rig || !chan || !filled)
+    return -RIG_EINVAL;
+
+  const struct rig_caps *rc = rig->caps;
+  struct kenwood_priv_caps *caps = kenwood_caps(rig);
+  struct kenwood_priv_data *priv = rig->state.priv;
+  int err;
+
+  int if_freq = rc->get_freq == kenwood_get_freq_if
+    || (rc->get_freq == kenwood_get_freq
+        && rig->state.current_vfo == RIG_VFO_MEM);
+  int if_mode = rc->get_mode == kenwood_get_mode_if
+    && !kenwood_mode_if_reads_filter(rig);
+  int if_vfo = rc->get_vfo == kenwood_get_vfo_if;
+  int if_split = rc->get_split_vfo == kenwood_get_split_vfo_if
+    && RIG_MODEL_TS990S != rc->rig_model;
+  int if_rit = rc->get_rit == kenwood_get_rit;
+  int if_xit = rc->get_xit == kenwood_get_xit;
+
+  if (!(if_freq || if_mode || if_vfo || if_split || if_rit || if_xit))
+    return -RIG_ENAVAIL;
+
+  err = kenwood_get_if(rig);
+  if (err != RIG_OK)
+    return err;
+
+  if (if_freq) {
+    kenwood_if_freq(rig, &chan->freq);
+    filled->freq = 1;
+  }
+
+  if (if_mode) {
+    chan->mode = kenwood2rmode(priv->info[29] - '0', caps->mode_table);
+    chan->width = rig_passband_normal(rig, chan->mode);
+    filled->mode = filled->width = 1;
+  }
+
+  if (if_vfo && kenwood_if_vfo(rig, &chan->vfo) == RIG_OK)
+    filled->vfo = 1;
+
+  if (if_split && kenwood_if_split(rig, &chan->split, &chan->tx_vfo) == RIG_OK)
+    filled->split = filled->tx_vfo = 1;
+
+  if (if_rit) {
+    chan->rit = kenwood_if_rit(rig);
+    filled->rit = 1;
+  }
+
+  if (if_xit) {
+    chan->xit = kenwood_if_rit(rig);
+    filled->xit = 1;
+  }
+
+  return RIG_OK;
+}
+
 int kenwood_set_level(RIG *rig, vfo_t vfo, setting_t level, value_t val)
 {
   rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
@@ -150,6 +150,7 @@ int kenwood_get_mem(RIG *rig, vfo_t vfo, int *ch);
 int kenwood_get_mem_if(RIG *rig, vfo_t vfo, int *ch);
 int kenwood_get_channel(RIG *rig, channel_t *chan);
 int kenwood_set_channel(RIG *rig, const channel_t *chan);
+int kenwood_get_chan_snapshot(RIG *rig, channel_t *chan, channel_cap_t *filled);
 int kenwood_scan(RIG *rig, vfo_t vfo, scan_t scan, int ch);
 const char * kenwood_get_info(RIG *rig);
 int kenwood_get_id(RIG *rig, char *buf);
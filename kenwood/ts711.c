@@ -197,6 +197,7 @@ const struct rig_caps ts711_caps = {
 .vfo_op =  kenwood_vfo_op,
 .set_mem =  kenwood_set_mem,
 .get_mem = kenwood_get_mem_if,
+.get_chan_snapshot = kenwood_get_chan_snapshot,
 .reset =  kenwood_reset,
 
 };
@@ -343,6 +343,7 @@ const struct rig_caps ts990s_caps = {
 .scan =  kenwood_scan,
 .set_mem =  kenwood_set_mem,
 .get_mem =  kenwood_get_mem,
+.get_chan_snapshot =  kenwood_get_chan_snapshot,
 .set_trn =  kenwood_set_trn,
 .get_trn =  kenwood_get_trn,
 .set_powerstat =  kenwood_set_powerstat,
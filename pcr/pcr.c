@@ -660,13 +660,28 @@ pcr_get_vfo(RIG * rig, vfo_t *vfo)
  *
  */
 
+static void
+pcr_freq_cmd(RIG * rig, vfo_t vfo, freq_t freq, char *buf)
+{
+	struct pcr_priv_data *priv = (struct pcr_priv_data *) rig->state.priv;
+	struct pcr_rcvr *rcvr = is_sub_rcvr(rig, vfo) ? &priv->sub_rcvr : &priv->main_rcvr;
+	int freq_len;
+
+	freq_len = sprintf(buf, "K%c%010" PRIll "0%c0%c00",
+			   is_sub_rcvr(rig, vfo) ? '1':'0',
+			   (int64_t) freq,
+			   rcvr->last_mode, rcvr->last_filter);
+
+	buf[freq_len] = '\0';
+}
+
 int
 pcr_set_freq(RIG * rig, vfo_t vfo, freq_t freq)
 {
 	struct pcr_priv_data *priv;
 	struct pcr_rcvr *rcvr;
-	unsigned char buf[20];
-	int freq_len, err;
+	char buf[20];
+	int err;
 
 	rig_debug(RIG_DEBUG_VERBOSE, "%s: vfo = %s, freq = %.0f\n",
 		  __func__, rig_strvfo(vfo), freq);
@@ -674,14 +689,9 @@ pcr_set_freq(RIG * rig, vfo_t vfo, freq_t freq)
 	priv = (struct pcr_priv_data *) rig->state.priv;
 	rcvr = is_sub_rcvr(rig, vfo) ? &priv->sub_rcvr : &priv->main_rcvr;
 
-	freq_len = sprintf((char *) buf, "K%c%010" PRIll "0%c0%c00",
-			   is_sub_rcvr(rig, vfo) ? '1':'0',
-			   (int64_t) freq,
-			   rcvr->last_mode, rcvr->last_filter);
-
-	buf[freq_len] = '\0';
+	pcr_freq_cmd(rig, vfo, freq, buf);
 
-	err = pcr_transaction(rig, (char *) buf);
+	err = pcr_transaction(rig, buf);
 	if (err != RIG_OK)
 		return err;
 
@@ -1711,6 +1721,69 @@ int pcr_get_dcd(RIG * rig, vfo_t vfo, dcd_t *dcd)
 	return RIG_OK;
 }
 
+/*
+ * pcr_tune_get_dcd
+ * Software scan step: the tune and squelch status commands are sent
+ * back to back, and both answers read afterwards, which saves a round
+ * trip per channel.
+ */
+int pcr_tune_get_dcd(RIG * rig, vfo_t vfo, freq_t freq, dcd_t *dcd)
+{
+	struct rig_state *rs = &rig->state;
+	struct pcr_priv_caps *caps = pcr_caps(rig);
+	struct pcr_priv_data *priv = (struct pcr_priv_data *) rs->priv;
+	struct pcr_rcvr *rcvr = is_sub_rcvr(rig, vfo) ? &priv->sub_rcvr : &priv->main_rcvr;
+	char buf[20];
+	int i, err;
+
+	rig_debug(RIG_DEBUG_VERBOSE, "%s: vfo = %s, freq = %.0f\n",
+		  __func__, rig_strvfo(vfo), freq);
+
+	/* no answers to wait for in auto update mode */
+	if (priv->auto_update) {
+		err = pcr_set_freq(rig, vfo, freq);
+		if (err != RIG_OK)
+			return err;
+
+		return pcr_get_dcd(rig, vfo, dcd);
+	}
+
+	pcr_freq_cmd(rig, vfo, freq, buf);
+
+	serial_flush(&rs->rigport);
+
+	err = pcr_send(rig, buf);
+	if (err != RIG_OK)
+		return err;
+
+	err = pcr_send(rig, is_sub_rcvr(rig, vfo) ? "I4?" : "I0?");
+	if (err != RIG_OK)
+		return err;
+
+	/* G000, then I0xx */
+	for (i = 0; i < 2; i++) {
+		err = pcr_read_block(rig, priv->reply_buf, caps->reply_size);
+		if (err < 0)
+			return err;
+
+		if (err != caps->reply_size) {
+			priv->sync = 0;
+			return -RIG_EPROTO;
+		}
+
+		err = pcr_parse_answer(rig, &priv->reply_buf[caps->reply_offset], err);
+		if (err != RIG_OK)
+			return err;
+
+		if (i == 0)
+			rcvr->last_freq = freq;
+	}
+
+	*dcd = rcvr->squelch_status & 0x02 ? RIG_DCD_ON : RIG_DCD_OFF;
+
+	return RIG_OK;
+}
+
 /* *********************************************************************************************
  * int pcr_set_comm_mode(RIG *rig, int mode_type);  // Set radio to fast/diagnostic mode  G3xx
  * int pcr_soft_reset(RIG *rig);                    // Ask rig to reset itself            H0xx
@@ -115,6 +115,7 @@ int pcr_decode_event(RIG *rig);
 int pcr_set_powerstat(RIG * rig, powerstat_t status);
 int pcr_get_powerstat(RIG * rig, powerstat_t *status);
 int pcr_get_dcd(RIG * rig, vfo_t vfo, dcd_t *dcd);
+int pcr_tune_get_dcd(RIG * rig, vfo_t vfo, freq_t freq, dcd_t *dcd);
 
 /* ------------------------------------------------------------------ */
 
@@ -190,5 +190,7 @@ const struct rig_caps pcr2500_caps = {
 
 	.set_powerstat  = pcr_set_powerstat,
 	.get_powerstat  = pcr_get_powerstat,
+
+	.tune_get_dcd	= pcr_tune_get_dcd,
 };
 
@@ -29,6 +29,10 @@
 #include <unistd.h>
 #include <math.h>
 
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
 #include "hamlib/rotator.h"
 #include "serial.h"
 #include "misc.h"
@@ -38,10 +42,21 @@
 
 #define TOK_AZRES 1
 #define TOK_ELRES 2
+#define TOK_STREAM 3
+
+#define SPID_STATUS_CMD "\x57\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x1F\x20"
+
+/* Most status requests kept in flight, and how old their answers may be */
+#define SPID_STREAM_MAX 8
+#define SPID_STREAM_AGE_MS 1000
 
 struct spid_rot2prog_priv_data {
     int az_resolution;
     int el_resolution;
+    int stream_depth;
+    int inflight;       /* status requests not answered yet */
+    int first;          /* in sent[], the oldest of them */
+    struct timeval sent[SPID_STREAM_MAX + 1];
 };
 
 static int spid_rot_init(ROT *rot)
@@ -64,6 +79,9 @@ static int spid_rot_init(ROT *rot)
 
         priv->az_resolution = 0;
         priv->el_resolution = 0;
+        priv->stream_depth = 0;
+        priv->inflight = 0;
+        priv->first = 0;
     }
 
     return RIG_OK;
@@ -101,6 +119,9 @@ static int spid_get_conf(ROT *rot, token_t token, char *val)
         case TOK_ELRES:
             sprintf(val, "%d", priv->el_resolution);
             break;
+        case TOK_STREAM:
+            sprintf(val, "%d", priv->stream_depth);
+            break;
         default:
             return -RIG_EINVAL;
     }
@@ -124,12 +145,99 @@ static int spid_set_conf(ROT *rot, token_t token, const char *val)
         case TOK_ELRES:
             priv->el_resolution = atoi(val);
             break;
+        case TOK_STREAM:
+            priv->stream_depth = atoi(val);
+            if (priv->stream_depth < 0 || priv->stream_depth > SPID_STREAM_MAX)
+                return -RIG_EINVAL;
+            break;
         default:
             return -RIG_EINVAL;
     }
     return RIG_OK;
 }
 
+/*
+ * Streaming of the position, Rot2Prog only: stream_depth status requests
+ * stay in flight, so that the answer to an earlier request is already
+ * on its way when the position is asked for.  Their answers are all
+ * 12 bytes long, starting with 0x57.
+ */
+static void spid_stream_reset(ROT *rot)
+{
+    struct spid_rot2prog_priv_data *priv = (struct spid_rot2prog_priv_data*)rot->state.priv;
+
+    serial_flush(&rot->state.rotport);
+    priv->inflight = 0;
+    priv->first = 0;
+}
+
+static int spid_stream_read_one(ROT *rot, char *posbuf)
+{
+    struct spid_rot2prog_priv_data *priv = (struct spid_rot2prog_priv_data*)rot->state.priv;
+    int retval;
+
+    memset(posbuf, 0, 12);
+    retval = read_block(&rot->state.rotport, posbuf, 12);
+    if (retval < 0 || posbuf[0] != 0x57) {
+        /* lost track of the answers, start again */
+        spid_stream_reset(rot);
+        return retval < 0 ? retval : -RIG_EPROTO;
+    }
+
+    priv->first = (priv->first + 1) % (SPID_STREAM_MAX + 1);
+    priv->inflight--;
+
+    return RIG_OK;
+}
+
+/* Reads the answers still in flight, before another command */
+static int spid_stream_drain(ROT *rot)
+{
+    struct spid_rot2prog_priv_data *priv = (struct spid_rot2prog_priv_data*)rot->state.priv;
+    char posbuf[12];
+    int retval;
+
+    while (priv && priv->inflight > 0) {
+        retval = spid_stream_read_one(rot, posbuf);
+        if (retval != RIG_OK)
+            return retval;
+    }
+
+    return RIG_OK;
+}
+
+static int spid_stream_get_position(ROT *rot, char *posbuf)
+{
+    struct spid_rot2prog_priv_data *priv = (struct spid_rot2prog_priv_data*)rot->state.priv;
+    struct timeval now, *oldest;
+    int retval;
+
+    gettimeofday(&now, NULL);
+
+    /* answers that old no longer tell where the rotator is */
+    oldest = &priv->sent[priv->first];
+    if (priv->inflight > 0 &&
+        (now.tv_sec - oldest->tv_sec) * 1000 +
+        (now.tv_usec - oldest->tv_usec) / 1000 > SPID_STREAM_AGE_MS) {
+        retval = spid_stream_drain(rot);
+        if (retval != RIG_OK)
+            return retval;
+    }
+
+    while (priv->inflight <= priv->stream_depth) {
+        retval = write_block(&rot->state.rotport, SPID_STATUS_CMD, 13);
+        if (retval != RIG_OK) {
+            spid_stream_reset(rot);
+            return retval;
+        }
+
+        priv->sent[(priv->first + priv->inflight) % (SPID_STREAM_MAX + 1)] = now;
+        priv->inflight++;
+    }
+
+    return spid_stream_read_one(rot, posbuf);
+}
+
 static int spid_rot1prog_rot_set_position(ROT *rot, azimuth_t az, elevation_t el)
 {
     struct rot_state *rs = &rot->state;
@@ -174,6 +282,10 @@ static int spid_rot2prog_rot_set_position(ROT *rot, azimuth_t az, elevation_t el
 
     rig_debug(RIG_DEBUG_TRACE, "%s called: %f %f\n", __FUNCTION__, az, el);
 
+    retval = spid_stream_drain(rot);
+    if (retval != RIG_OK)
+        return retval;
+
     if (!priv->az_resolution || !priv->el_resolution) {
         do {
             retval = write_block(&rs->rotport, "\x57\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x1F\x20", 13);
@@ -228,27 +340,35 @@ static int spid_rot2prog_rot_set_position(ROT *rot, azimuth_t az, elevation_t el
 static int spid_rot_get_position(ROT *rot, azimuth_t *az, elevation_t *el)
 {
     struct rot_state *rs = &rot->state;
+    struct spid_rot2prog_priv_data *priv = (struct spid_rot2prog_priv_data*)rs->priv;
     int retval;
     int retry_read = 0;
     char posbuf[12];
 
     rig_debug(RIG_DEBUG_TRACE, "%s called\n", __FUNCTION__);
 
-    do {
-        retval = write_block(&rs->rotport, "\x57\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x1F\x20", 13);
-        if (retval != RIG_OK) {
-            return retval;
-        }
+    retval = -RIG_EINVAL;
+    if (priv && priv->stream_depth > 0)
+        retval = spid_stream_get_position(rot, posbuf);
 
-        memset(posbuf, 0, 12);
-        if (rot->caps->rot_model == ROT_MODEL_SPID_ROT1PROG)
-            retval = read_block(&rs->rotport, posbuf, 5);
-        else if (rot->caps->rot_model == ROT_MODEL_SPID_ROT2PROG ||
-                 rot->caps->rot_model == ROT_MODEL_SPID_MD01_ROT2PROG)
-            retval = read_block(&rs->rotport, posbuf, 12);
-        else
-            retval = -RIG_EINVAL;
-    } while (retval < 0 && retry_read++ < rot->state.rotport.retry);
+    /* one request at a time, also when the stream failed */
+    if (retval != RIG_OK) {
+        do {
+            retval = write_block(&rs->rotport, SPID_STATUS_CMD, 13);
+            if (retval != RIG_OK) {
+                return retval;
+            }
+
+            memset(posbuf, 0, 12);
+            if (rot->caps->rot_model == ROT_MODEL_SPID_ROT1PROG)
+                retval = read_block(&rs->rotport, posbuf, 5);
+            else if (rot->caps->rot_model == ROT_MODEL_SPID_ROT2PROG ||
+                     rot->caps->rot_model == ROT_MODEL_SPID_MD01_ROT2PROG)
+                retval = read_block(&rs->rotport, posbuf, 12);
+            else
+                retval = -RIG_EINVAL;
+        } while (retval < 0 && retry_read++ < rot->state.rotport.retry);
+    }
     if (retval < 0)
         return retval;
 
@@ -285,6 +405,10 @@ static int spid_rot_stop(ROT *rot)
 
     rig_debug(RIG_DEBUG_TRACE, "%s called\n", __FUNCTION__);
 
+    retval = spid_stream_drain(rot);
+    if (retval != RIG_OK)
+        return retval;
+
     do {
         retval = write_block(&rs->rotport, "\x57\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x0F\x20", 13);
         if (retval != RIG_OK) {
@@ -359,6 +483,20 @@ const struct confparams spid_cfg_params[] = {
     { RIG_CONF_END, NULL, }
 };
 
+/* the status stream needs the Rot2Prog private data */
+const struct confparams spid_rot2prog_cfg_params[] = {
+    { TOK_AZRES, "az_resolution", "Azimuth resolution", "Number of pulses per degree, 0 = auto sense",
+      "0", RIG_CONF_NUMERIC, { .n = { 0, 0xff, 1 } }
+    },
+    { TOK_ELRES, "el_resolution", "Eleveation resolution", "Number of pulses per degree, 0 = auto sense",
+      "0", RIG_CONF_NUMERIC, { .n = { 0, 0xff, 1 } }
+    },
+    { TOK_STREAM, "stream_depth", "Status stream depth", "Number of status requests kept in flight, 0 = one at a time",
+      "0", RIG_CONF_NUMERIC, { .n = { 0, SPID_STREAM_MAX, 1 } }
+    },
+    { RIG_CONF_END, NULL, }
+};
+
 const struct rot_caps spid_rot1prog_rot_caps = {
     .rot_model =         ROT_MODEL_SPID_ROT1PROG,
     .model_name =        "Rot1Prog",
@@ -420,7 +558,7 @@ const struct rot_caps spid_rot2prog_rot_caps = {
     .min_el =            -20.0,
     .max_el =            210.0,
 
-    .cfgparams =         spid_cfg_params,
+    .cfgparams =         spid_rot2prog_cfg_params,
     .get_conf =          spid_get_conf,
     .set_conf =          spid_set_conf,
 
@@ -456,7 +594,7 @@ const struct rot_caps spid_md01_rot2prog_rot_caps = {
     .min_el =            -20.0,
     .max_el =            210.0,
 
-    .cfgparams =         spid_cfg_params,
+    .cfgparams =         spid_rot2prog_cfg_params,
     .get_conf =          spid_get_conf,
     .set_conf =          spid_set_conf,
 
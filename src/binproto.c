@@ -0,0 +1,361 @@
+/*
+ *  Hamlib Interface - rigctld binary framing
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig_internal
+ * @{
+ */
+
+/**
+ * \file binproto.c
+ * \brief Frame encoding shared by rigctld and the netrigctl backend
+ *
+ * Numbers travel as they are held in memory, so a frequency comes back
+ * with every bit the rig gave, where the text protocol rounds it to the
+ * Hz.  Integers are sent in as few bytes as hold them, a PTT state is a
+ * 3 byte field, and a real with no fraction goes as an integer, so most
+ * frequencies take 6 bytes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+
+#include <hamlib/rig.h>
+#include "binproto.h"
+
+
+static void binproto_set_len(struct binproto_frame *f)
+{
+    f->buf[0] = ((f->len - 2) >> 8) & 0xff;
+    f->buf[1] = (f->len - 2) & 0xff;
+}
+
+
+static int binproto_put(struct binproto_frame *f,
+                        int type,
+                        const unsigned char *val,
+                        int size)
+{
+    if (size > 255 || f->len + 2 + size > BINPROTO_MAXLEN)
+    {
+        return -RIG_EINVAL;
+    }
+
+    f->buf[f->len++] = type;
+    f->buf[f->len++] = size;
+    memcpy(f->buf + f->len, val, size);
+    f->len += size;
+    binproto_set_len(f);
+
+    return RIG_OK;
+}
+
+
+static int binproto_get(struct binproto_frame *f,
+                        int type,
+                        const unsigned char **val,
+                        int *size)
+{
+    if (binproto_peek(f) != type)
+    {
+        return -RIG_EPROTO;
+    }
+
+    *size = f->buf[f->pos + 1];
+
+    if (f->pos + 2 + *size > f->len)
+    {
+        return -RIG_EPROTO;
+    }
+
+    *val = f->buf + f->pos + 2;
+    f->pos += 2 + *size;
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief Start a frame
+ * \param f the frame
+ * \param id request id, a reply carries the one of its request
+ * \param flags BINPROTO_MORE, BINPROTO_VFO, BINPROTO_ERROR, or 0
+ * \param cmd short command of the text protocol, or BINPROTO_TEXT
+ */
+void HAMLIB_API binproto_init(struct binproto_frame *f,
+                              int id,
+                              int flags,
+                              int cmd)
+{
+    f->buf[2] = (id >> 8) & 0xff;
+    f->buf[3] = id & 0xff;
+    f->buf[4] = flags;
+    f->buf[5] = cmd;
+    f->len = f->pos = BINPROTO_HDRLEN;
+    binproto_set_len(f);
+}
+
+
+/**
+ * \brief Load a received frame, ready to get its fields
+ * \param f the frame
+ * \param buf the frame as received, length included
+ * \param len size of buf
+ * \return RIG_OK, or -RIG_EPROTO when the length does not match
+ */
+int HAMLIB_API binproto_parse(struct binproto_frame *f,
+                              const unsigned char *buf,
+                              int len)
+{
+    if (len < BINPROTO_HDRLEN
+            || len > BINPROTO_MAXLEN
+            || BINPROTO_FRAMELEN(buf) != len)
+    {
+        return -RIG_EPROTO;
+    }
+
+    memcpy(f->buf, buf, len);
+    f->len = len;
+    f->pos = BINPROTO_HDRLEN;
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief Append an integer field
+ * \return RIG_OK, or -RIG_EINVAL when the frame is full
+ */
+int HAMLIB_API binproto_put_int(struct binproto_frame *f, int64_t val)
+{
+    unsigned char b[8];
+    uint64_t u = (uint64_t)val;
+    int i;
+
+    for (i = 7; i >= 0; i--)
+    {
+        b[i] = u & 0xff;
+        u >>= 8;
+    }
+
+    /* leading bytes that only repeat the sign bit are left out */
+    for (i = 0; i < 7; i++)
+    {
+        if (!(b[i] == 0x00 && !(b[i + 1] & 0x80))
+                && !(b[i] == 0xff && (b[i + 1] & 0x80)))
+        {
+            break;
+        }
+    }
+
+    return binproto_put(f, BINPROTO_INT, b + i, 8 - i);
+}
+
+
+/**
+ * \brief Append a floating point field
+ * \return RIG_OK, or -RIG_EINVAL when the frame is full
+ *
+ * An integral value goes as an integer field, binproto_get_real() takes
+ * both.
+ */
+int HAMLIB_API binproto_put_real(struct binproto_frame *f, double val)
+{
+    unsigned char b[8];
+    uint64_t u;
+    int i;
+
+    /* doubles hold every integer up to 2^53 */
+    if (val > -9007199254740992.0 && val < 9007199254740992.0
+            && val == (double)(int64_t)val)
+    {
+        return binproto_put_int(f, (int64_t)val);
+    }
+
+    memcpy(&u, &val, sizeof(u));
+
+    for (i = 7; i >= 0; i--)
+    {
+        b[i] = u & 0xff;
+        u >>= 8;
+    }
+
+    return binproto_put(f, BINPROTO_REAL, b, 8);
+}
+
+
+/**
+ * \brief Append a string field
+ * \param f the frame
+ * \param s the string
+ * \param len its length, or -1 for strlen(s)
+ * \return RIG_OK, or -RIG_EINVAL when longer than 255 or the frame is full
+ */
+int HAMLIB_API binproto_put_str(struct binproto_frame *f,
+                                const char *s,
+                                int len)
+{
+    if (len < 0)
+    {
+        len = strlen(s);
+    }
+
+    return binproto_put(f, BINPROTO_STR, (const unsigned char *)s, len);
+}
+
+
+/**
+ * \brief Type of the next field
+ * \return BINPROTO_INT, BINPROTO_REAL, BINPROTO_STR, or 0 past the last one
+ */
+int HAMLIB_API binproto_peek(const struct binproto_frame *f)
+{
+    if (f->pos + 2 > f->len)
+    {
+        return 0;
+    }
+
+    return f->buf[f->pos];
+}
+
+
+/**
+ * \brief Get the next field, an integer
+ * \return RIG_OK, or -RIG_EPROTO when the next field is not an integer
+ */
+int HAMLIB_API binproto_get_int(struct binproto_frame *f, int64_t *val)
+{
+    const unsigned char *b;
+    uint64_t u;
+    int size, i, ret;
+
+    ret = binproto_get(f, BINPROTO_INT, &b, &size);
+
+    if (ret != RIG_OK)
+    {
+        return ret;
+    }
+
+    if (size < 1 || size > 8)
+    {
+        return -RIG_EPROTO;
+    }
+
+    /* sign extend */
+    u = (b[0] & 0x80) ? ~(uint64_t)0 : 0;
+
+    for (i = 0; i < size; i++)
+    {
+        u = (u << 8) | b[i];
+    }
+
+    *val = (int64_t)u;
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief Get the next field, a floating point value or an integer
+ * \return RIG_OK, or -RIG_EPROTO when the next field is neither
+ */
+int HAMLIB_API binproto_get_real(struct binproto_frame *f, double *val)
+{
+    const unsigned char *b;
+    uint64_t u = 0;
+    int64_t n;
+    int size, i, ret;
+
+    if (binproto_peek(f) == BINPROTO_INT)
+    {
+        ret = binproto_get_int(f, &n);
+
+        if (ret == RIG_OK)
+        {
+            *val = n;
+        }
+
+        return ret;
+    }
+
+    ret = binproto_get(f, BINPROTO_REAL, &b, &size);
+
+    if (ret != RIG_OK)
+    {
+        return ret;
+    }
+
+    if (size != 8)
+    {
+        return -RIG_EPROTO;
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        u = (u << 8) | b[i];
+    }
+
+    memcpy(val, &u, sizeof(*val));
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief Get the next field, a string
+ * \param f the frame
+ * \param s where to copy it, NUL terminated, truncated to size - 1
+ * \param size size of s
+ * \return the length copied, or -RIG_EPROTO when the next field is not a
+ * string
+ */
+int HAMLIB_API binproto_get_str(struct binproto_frame *f, char *s, int size)
+{
+    const unsigned char *b;
+    int len, ret;
+
+    if (size < 1)
+    {
+        return -RIG_EINVAL;
+    }
+
+    ret = binproto_get(f, BINPROTO_STR, &b, &len);
+
+    if (ret != RIG_OK)
+    {
+        return ret;
+    }
+
+    if (len > size - 1)
+    {
+        len = size - 1;
+    }
+
+    memcpy(s, b, len);
+    s[len] = '\0';
+
+    return len;
+}
+
+/** @} */
@@ -0,0 +1,101 @@
+/*
+ *  Hamlib Interface - rigctld binary framing header
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _BINPROTO_H
+#define _BINPROTO_H 1
+
+#include <stdint.h>
+#include <hamlib/rig.h>
+
+/*
+ * Once a client has sent "\set_binary 2" and got "RPRT 0" back, rigctld
+ * and the client exchange frames instead of text lines:
+ *
+ *   length  2 bytes, big endian, what follows the length itself
+ *   id      2 bytes, big endian, echoed in the reply
+ *   flags   1 byte
+ *   command 1 byte, the short command of the text protocol
+ *   fields  type (1 byte), size (1 byte), value (size bytes)
+ *
+ * A request acts on the current VFO, or on the one in its first field
+ * when flagged BINPROTO_VFO.  A reply holds the values the text protocol
+ * would print, or, flagged BINPROTO_ERROR, the -RIG_E* code alone.
+ *
+ * Modes, VFOs, levels and functions go as strings, the names the text
+ * protocol uses, never as their bit values.  Bump BINPROTO_VERSION on
+ * any change to the encoding of a command.
+ */
+#define BINPROTO_VERSION    2
+#define BINPROTO_HDRLEN     6
+#define BINPROTO_MAXLEN     4096
+
+/* flags */
+#define BINPROTO_MORE       0x01    /* more requests follow, hold the replies */
+#define BINPROTO_VFO        0x02    /* the first field of the request is the VFO */
+#define BINPROTO_ERROR      0x04    /* the reply is an error code */
+
+/* field types */
+#define BINPROTO_INT        'i'     /* two's complement, 1 to 8 bytes */
+#define BINPROTO_REAL       'd'     /* IEEE 754 double, when not integral */
+#define BINPROTO_STR        's'     /* up to 255 bytes, not NUL terminated */
+
+/* commands besides the text protocol ones */
+#define BINPROTO_TEXT       0x00    /* a text protocol line in string fields */
+
+struct binproto_frame
+{
+    unsigned char buf[BINPROTO_MAXLEN];
+    int len;    /* bytes used in buf */
+    int pos;    /* next field to get */
+};
+
+#define BINPROTO_FRAMELEN(b)    (2 + (((b)[0] << 8) | (b)[1]))
+#define BINPROTO_ID(f)          (((f)->buf[2] << 8) | (f)->buf[3])
+#define BINPROTO_FLAGS(f)       ((f)->buf[4])
+#define BINPROTO_CMD(f)         ((f)->buf[5])
+
+extern HAMLIB_EXPORT(void) binproto_init(struct binproto_frame *f,
+                                         int id,
+                                         int flags,
+                                         int cmd);
+
+extern HAMLIB_EXPORT(int) binproto_parse(struct binproto_frame *f,
+                                         const unsigned char *buf,
+                                         int len);
+
+extern HAMLIB_EXPORT(int) binproto_put_int(struct binproto_frame *f,
+                                           int64_t val);
+extern HAMLIB_EXPORT(int) binproto_put_real(struct binproto_frame *f,
+                                            double val);
+extern HAMLIB_EXPORT(int) binproto_put_str(struct binproto_frame *f,
+                                           const char *s,
+                                           int len);
+
+extern HAMLIB_EXPORT(int) binproto_peek(const struct binproto_frame *f);
+extern HAMLIB_EXPORT(int) binproto_get_int(struct binproto_frame *f,
+                                           int64_t *val);
+extern HAMLIB_EXPORT(int) binproto_get_real(struct binproto_frame *f,
+                                            double *val);
+extern HAMLIB_EXPORT(int) binproto_get_str(struct binproto_frame *f,
+                                           char *s,
+                                           int size);
+
+#endif /* _BINPROTO_H */
@@ -113,6 +113,21 @@ static const struct confparams frontend_cfg_params[] =
         "Path name to the device file of the Data Carrier Detect (or squelch)",
         "/dev/rig", RIG_CONF_STRING,
     },
+    {
+        TOK_RECORD_PATHNAME, "record_pathname", "Record path name",
+        "File to record the rig port I/O to, for replay_pathname",
+        "", RIG_CONF_STRING,
+    },
+    {
+        TOK_REPLAY_PATHNAME, "replay_pathname", "Replay path name",
+        "Recorded session to play back instead of talking to the rig",
+        "", RIG_CONF_STRING,
+    },
+    {
+        TOK_REPLAY_SCALE, "replay_scale", "Replay latency scale",
+        "Factor applied to the recorded reply delays, 0 for no delay",
+        "1", RIG_CONF_NUMERIC, { .n = { 0.0, 100.0, .01 } }
+    },
     {
 	TOK_LO_FREQ, "lo_freq", "LO Frequency",
 	"Frequency to add to the VFO frequency for use with a transverter",
@@ -508,6 +523,19 @@ static int frontend_set_conf(RIG *rig, token_t token, const char *val)
         break;
 
 
+    case TOK_RECORD_PATHNAME:
+        strncpy(rs->rigport.record_pathname, val, FILPATHLEN - 1);
+        break;
+
+    case TOK_REPLAY_PATHNAME:
+        rs->rigport.type.rig = RIG_PORT_REPLAY;
+        strncpy(rs->rigport.pathname, val, FILPATHLEN - 1);
+        break;
+
+    case TOK_REPLAY_SCALE:
+        rs->rigport.replay_scale = atof(val);
+        break;
+
     case TOK_VFO_COMP:
         rs->vfo_comp = atof(val);
         break;
@@ -709,6 +737,19 @@ static int frontend_get_conf(RIG *rig, token_t token, char *val)
         strcpy(val, s);
         break;
 
+    case TOK_RECORD_PATHNAME:
+        strcpy(val, rs->rigport.record_pathname);
+        break;
+
+    case TOK_REPLAY_PATHNAME:
+        strcpy(val, rs->rigport.type.rig == RIG_PORT_REPLAY
+               ? rs->rigport.pathname : "");
+        break;
+
+    case TOK_REPLAY_SCALE:
+        sprintf(val, "%g", rs->rigport.replay_scale);
+        break;
+
     case TOK_VFO_COMP:
         sprintf(val, "%f", rs->vfo_comp);
         break;
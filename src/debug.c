@@ -51,10 +51,14 @@
 #include <hamlib/rig.h>
 #include "misc.h"
 
+/* this file defines the functions behind the inline-check macros */
+#undef rig_debug
+#undef dump_hex
+
 #define DUMP_HEX_WIDTH 16
 
 
-static int rig_debug_level = RIG_DEBUG_TRACE;
+int rig_debug_level = RIG_DEBUG_TRACE;
 static int rig_debug_time_stamp = 0;
 static FILE *rig_debug_stream;
 static vprintf_cb_t rig_vprintf_cb;
@@ -72,9 +76,10 @@ void dump_hex(const unsigned char ptr[], size_t size)
      * 0000  4b 30 30 31 34 35 30 30 30 30 30 30 30 35 30 32  K001450000000502
      * 0010  30 30 0d 0a                                      00..
      */
+    static const char hexdigit[] = "0123456789abcdef";
     char line[4 + 4 + 3 * DUMP_HEX_WIDTH + 4 + DUMP_HEX_WIDTH + 1];
     unsigned char c;
-    int i;
+    int i, col;
 
     if (!rig_need_debug(RIG_DEBUG_TRACE))
     {
@@ -85,25 +90,29 @@ void dump_hex(const unsigned char ptr[], size_t size)
 
     for (i = 0; i < size; ++i)
     {
-        if (i % DUMP_HEX_WIDTH == 0)
+        col = i % DUMP_HEX_WIDTH;
+
+        if (col == 0)
         {
-            /* new line */
-            sprintf(line + 0, "%04x", i);
+            /* new line, offset is at most 4 hex digits wide */
+            line[0] = hexdigit[(i >> 12) & 0xf];
+            line[1] = hexdigit[(i >> 8) & 0xf];
+            line[2] = hexdigit[(i >> 4) & 0xf];
+            line[3] = hexdigit[i & 0xf];
             memset(line + 4, ' ', sizeof(line) - 4 - 1);
         }
 
         c = ptr[i];
 
-        /* hex print */
-        sprintf(line + 8 + 3 * (i % DUMP_HEX_WIDTH), "%02x", c);
-        line[8 + 3 * (i % DUMP_HEX_WIDTH) + 2] = ' '; /* no \0 */
+        /* hex print, no sprintf per byte */
+        line[8 + 3 * col] = hexdigit[c >> 4];
+        line[8 + 3 * col + 1] = hexdigit[c & 0xf];
 
         /* ascii print */
-        line[8 + 3 * DUMP_HEX_WIDTH + 4 + (i % DUMP_HEX_WIDTH)] = (c >= ' '
-                && c < 0x7f) ? c : '.';
+        line[8 + 3 * DUMP_HEX_WIDTH + 4 + col] = (c >= ' ' && c < 0x7f) ? c : '.';
 
         /* actually print the line */
-        if (i + 1 == size || (i && i % DUMP_HEX_WIDTH == DUMP_HEX_WIDTH - 1))
+        if (i + 1 == size || col == DUMP_HEX_WIDTH - 1)
         {
             rig_debug(RIG_DEBUG_TRACE, "%s\n", line);
         }
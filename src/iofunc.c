@@ -53,6 +53,178 @@
 #include "usb_port.h"
 #include "network.h"
 #include "cm108.h"
+#include "trace.h"
+#include "replay.h"
+
+/*
+ * Port statistics.  A transaction starts with write_block() and lasts
+ * until the next write or close, so that replies spanning several reads
+ * (e.g. CI-V echo then answer) count as one.
+ */
+
+/* bucket of a latency in microseconds, see RIG_PORT_HIST_SIZE */
+static int port_hist_bucket(unsigned long us)
+{
+    unsigned long v;
+    int msb = 0;
+    int idx;
+
+    if (us < 4)
+    {
+        return us;
+    }
+
+    for (v = us; v > 1; v >>= 1)
+    {
+        msb++;
+    }
+
+    idx = 4 * (msb - 1) + ((us >> (msb - 2)) & 3);
+
+    return idx < RIG_PORT_HIST_SIZE ? idx : RIG_PORT_HIST_SIZE - 1;
+}
+
+
+static unsigned long port_stats_since_tx(const hamlib_port_stats_t *s,
+                                         const struct timeval *tv)
+{
+    long us = (tv->tv_sec - s->tx_date.tv_sec) * 1000000
+              + (tv->tv_usec - s->tx_date.tv_usec);
+
+    return us > 0 ? us : 0;
+}
+
+
+/* account the pending transaction, if it got any reply */
+static void port_stats_close(hamlib_port_t *p)
+{
+    hamlib_port_stats_t *s = &p->stats;
+    struct timeval tv;
+
+    if (s->tx_pending && s->rx_seen)
+    {
+        tv.tv_sec = s->rx_date.tv_sec;
+        tv.tv_usec = s->rx_date.tv_usec;
+        s->last_byte_hist[port_hist_bucket(port_stats_since_tx(s, &tv))]++;
+        s->transactions++;
+    }
+
+    s->tx_pending = 0;
+}
+
+
+static void port_stats_tx(hamlib_port_t *p, size_t count)
+{
+    hamlib_port_stats_t *s = &p->stats;
+    struct timeval tv;
+
+    port_stats_close(p);
+
+    gettimeofday(&tv, NULL);
+    s->tx_date.tv_sec = tv.tv_sec;
+    s->tx_date.tv_usec = tv.tv_usec;
+    s->tx_pending = 1;
+    s->rx_seen = 0;
+    s->bytes_out += count;
+}
+
+
+/* first_tv is the arrival time of the first byte of this read */
+static void port_stats_rx(hamlib_port_t *p,
+                          size_t count,
+                          const struct timeval *first_tv)
+{
+    hamlib_port_stats_t *s = &p->stats;
+    struct timeval tv;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    s->bytes_in += count;
+
+    if (!s->tx_pending)
+    {
+        return;
+    }
+
+    if (!s->rx_seen)
+    {
+        s->first_byte_hist[port_hist_bucket(port_stats_since_tx(s,
+                                            first_tv))]++;
+        s->rx_seen = 1;
+    }
+
+    gettimeofday(&tv, NULL);
+    s->rx_date.tv_sec = tv.tv_sec;
+    s->rx_date.tv_usec = tv.tv_usec;
+}
+
+
+/**
+ * \brief Lower bound of a latency histogram bucket
+ * \param bucket bucket index, 0 to RIG_PORT_HIST_SIZE
+ * \return latency in microseconds
+ *
+ * \sa hamlib_port_stats_t
+ */
+unsigned long HAMLIB_API rig_port_hist_value(int bucket)
+{
+    if (bucket < 4)
+    {
+        return bucket < 0 ? 0 : bucket;
+    }
+
+    return (unsigned long)(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+
+/**
+ * \brief Estimate a percentile of a latency histogram
+ * \param hist histogram of RIG_PORT_HIST_SIZE buckets
+ * \param percent percentile wanted, e.g. 99.0
+ * \return upper bound of the bucket holding the percentile, in
+ * microseconds, or 0 if the histogram is empty
+ *
+ * \sa rig_get_port_stats()
+ */
+unsigned long HAMLIB_API rig_port_hist_percentile(const unsigned long hist[],
+                                                  double percent)
+{
+    unsigned long total = 0, target, sum = 0;
+    int i;
+
+    for (i = 0; i < RIG_PORT_HIST_SIZE; i++)
+    {
+        total += hist[i];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    target = (unsigned long)(total * percent / 100.0 + 0.999999);
+
+    if (target < 1)
+    {
+        target = 1;
+    }
+
+    for (i = 0; i < RIG_PORT_HIST_SIZE - 1; i++)
+    {
+        sum += hist[i];
+
+        if (sum >= target)
+        {
+            break;
+        }
+    }
+
+    return rig_port_hist_value(i + 1);
+}
+
 
 /**
  * \brief Open a hamlib_port based on its rig port type
@@ -67,6 +239,7 @@ int HAMLIB_API port_open(hamlib_port_t *p)
     rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
     p->fd = -1;
+    memset(&p->stats, 0, sizeof(p->stats));
 
     switch (p->type.rig)
     {
@@ -171,10 +344,31 @@ int HAMLIB_API port_open(hamlib_port_t *p)
 
         break;
 
+    case RIG_PORT_REPLAY:
+        status = replay_open(p);
+
+        if (status < 0)
+        {
+            return status;
+        }
+
+        break;
+
     default:
         return -RIG_EINVAL;
     }
 
+    if (p->record_pathname[0] != '\0')
+    {
+        status = port_record_open(p);
+
+        if (status < 0)
+        {
+            port_close(p, p->type.rig);
+            return status;
+        }
+    }
+
     return RIG_OK;
 }
 
@@ -193,6 +387,9 @@ int HAMLIB_API port_close(hamlib_port_t *p, rig_port_t port_type)
 
     rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
+    port_stats_close(p);
+    port_record_close(p);
+
     if (p->fd != -1)
     {
         switch (port_type)
@@ -218,6 +415,10 @@ int HAMLIB_API port_close(hamlib_port_t *p, rig_port_t port_type)
             ret = network_close(p);
             break;
 
+        case RIG_PORT_REPLAY:
+            ret = replay_close(p);
+            break;
+
         default:
             rig_debug(RIG_DEBUG_ERR, "%s(): Unknown port type %d\n",
                       __func__, port_type);
@@ -496,6 +697,10 @@ int HAMLIB_API write_block(hamlib_port_t *p, const char *txbuffer, size_t count)
         }
     }
 
+    /* reply latencies are measured from here */
+    port_stats_tx(p, count);
+    port_record(p, RIG_TRACE_TX, RIG_TRACE_FN_WRITE_BLOCK, txbuffer, count);
+
     if (p->post_write_delay > 0)
     {
 #ifdef WANT_NON_ACTIVE_POST_WRITE_DELAY
@@ -518,11 +723,37 @@ int HAMLIB_API write_block(hamlib_port_t *p, const char *txbuffer, size_t count)
 
     rig_debug(RIG_DEBUG_TRACE, "%s(): TX %d bytes\n", __func__, count);
     dump_hex((unsigned char *) txbuffer, count);
+    rig_trace(p, RIG_TRACE_TX, RIG_TRACE_FN_WRITE_BLOCK, txbuffer, count);
 
     return RIG_OK;
 }
 
 
+/*
+ * A read that ends on a timeout or an error: the bytes that did arrive
+ * count in the port statistics, and go to the trace and the recording,
+ * the same way for read_block, read_avail and read_string.
+ */
+static void port_rx_fail(hamlib_port_t *p,
+                         enum rig_trace_dir_e dir,
+                         enum rig_trace_func_e func,
+                         const char *rxbuffer,
+                         int count,
+                         const struct timeval *first_tv)
+{
+    if (dir == RIG_TRACE_TIMEOUT)
+    {
+        p->stats.timeouts++;
+    }
+
+    port_stats_rx(p, count, first_tv);
+
+    dump_hex((unsigned char *) rxbuffer, count);
+    rig_trace(p, dir, func, rxbuffer, count);
+    port_record(p, dir, func, rxbuffer, count);
+}
+
+
 /**
  * \brief Read bytes from an fd
  * \param p rig port descriptor
@@ -545,6 +776,7 @@ int HAMLIB_API read_block(hamlib_port_t *p, char *rxbuffer, size_t count)
 {
     fd_set rfds, efds;
     struct timeval tv, tv_timeout, start_time, end_time, elapsed_time;
+    struct timeval first_time;
     int rd_count, total_count = 0;
     int retval;
 
@@ -575,7 +807,8 @@ int HAMLIB_API read_block(hamlib_port_t *p, char *rxbuffer, size_t count)
             gettimeofday(&end_time, NULL);
             timersub(&end_time, &start_time, &elapsed_time);
 
-            dump_hex((unsigned char *) rxbuffer, total_count);
+            port_rx_fail(p, RIG_TRACE_TIMEOUT, RIG_TRACE_FN_READ_BLOCK,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_WARN,
                       "%s(): Timed out %d.%d seconds after %d chars\n",
                       __func__,
@@ -588,7 +821,8 @@ int HAMLIB_API read_block(hamlib_port_t *p, char *rxbuffer, size_t count)
 
         if (retval < 0)
         {
-            dump_hex((unsigned char *) rxbuffer, total_count);
+            port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_BLOCK,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_ERR,
                       "%s(): select() error after %d chars: %s\n",
                       __func__,
@@ -600,6 +834,8 @@ int HAMLIB_API read_block(hamlib_port_t *p, char *rxbuffer, size_t count)
 
         if (FD_ISSET(p->fd, &efds))
         {
+            port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_BLOCK,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_ERR,
                       "%s(): fd error after %d chars\n",
                       __func__,
@@ -616,6 +852,8 @@ int HAMLIB_API read_block(hamlib_port_t *p, char *rxbuffer, size_t count)
 
         if (rd_count < 0)
         {
+            port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_BLOCK,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_ERR,
                       "%s(): read() failed - %s\n",
                       __func__,
@@ -624,17 +862,118 @@ int HAMLIB_API read_block(hamlib_port_t *p, char *rxbuffer, size_t count)
             return -RIG_EIO;
         }
 
+        if (total_count == 0 && rd_count > 0)
+        {
+            gettimeofday(&first_time, NULL);
+        }
+
         total_count += rd_count;
         count -= rd_count;
     }
 
+    port_stats_rx(p, total_count, &first_time);
+
     rig_debug(RIG_DEBUG_TRACE, "%s(): RX %d bytes\n", __func__, total_count);
     dump_hex((unsigned char *) rxbuffer, total_count);
+    rig_trace(p, RIG_TRACE_RX, RIG_TRACE_FN_READ_BLOCK, rxbuffer, total_count);
+    port_record(p, RIG_TRACE_RX, RIG_TRACE_FN_READ_BLOCK,
+                   rxbuffer, total_count);
 
     return total_count;           /* return bytes count read */
 }
 
 
+/**
+ * \brief Read whatever bytes an fd has ready
+ * \param p rig port descriptor
+ * \param rxbuffer buffer to receive bytes
+ * \param rxmax size of rxbuffer
+ * \return count of bytes received, at least one, or a negative value on
+ * error or timeout
+ *
+ * Blocks until the first byte arrives or timeout hits, then returns
+ * everything a single read gives, up to rxmax bytes.
+ *
+ * Lets a caller that buffers the port itself, e.g. to split the replies
+ * of several pipelined requests, fetch many lines with one system call
+ * where read_string would make one per character.
+ */
+
+int HAMLIB_API read_avail(hamlib_port_t *p, char *rxbuffer, size_t rxmax)
+{
+    fd_set rfds, efds;
+    struct timeval tv, first_time;
+    int rd_count;
+    int retval;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!p || !rxbuffer || rxmax < 1)
+    {
+        return -RIG_EINVAL;
+    }
+
+    tv.tv_sec = p->timeout / 1000;
+    tv.tv_usec = (p->timeout % 1000) * 1000;
+
+    FD_ZERO(&rfds);
+    FD_SET(p->fd, &rfds);
+    efds = rfds;
+
+    retval = port_select(p, p->fd + 1, &rfds, NULL, &efds, &tv);
+
+    if (retval == 0)
+    {
+        port_rx_fail(p, RIG_TRACE_TIMEOUT, RIG_TRACE_FN_READ_AVAIL,
+                     rxbuffer, 0, NULL);
+        rig_debug(RIG_DEBUG_WARN,
+                  "%s(): Timed out %d.%03d seconds\n",
+                  __func__,
+                  p->timeout / 1000,
+                  p->timeout % 1000);
+
+        return -RIG_ETIMEOUT;
+    }
+
+    if (retval < 0 || FD_ISSET(p->fd, &efds))
+    {
+        port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_AVAIL,
+                     rxbuffer, 0, NULL);
+        rig_debug(RIG_DEBUG_ERR,
+                  "%s(): select() error: %s\n",
+                  __func__,
+                  strerror(errno));
+
+        return -RIG_EIO;
+    }
+
+    gettimeofday(&first_time, NULL);
+    rd_count = port_read(p, rxbuffer, rxmax);
+
+    /* readable but nothing to read means the peer has gone */
+    if (rd_count <= 0)
+    {
+        port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_AVAIL,
+                     rxbuffer, 0, NULL);
+        rig_debug(RIG_DEBUG_ERR,
+                  "%s(): read() failed - %s\n",
+                  __func__,
+                  rd_count < 0 ? strerror(errno) : "end of file");
+
+        return -RIG_EIO;
+    }
+
+    port_stats_rx(p, rd_count, &first_time);
+
+    rig_debug(RIG_DEBUG_TRACE, "%s(): RX %d bytes\n", __func__, rd_count);
+    dump_hex((unsigned char *) rxbuffer, rd_count);
+    rig_trace(p, RIG_TRACE_RX, RIG_TRACE_FN_READ_AVAIL, rxbuffer, rd_count);
+    port_record(p, RIG_TRACE_RX, RIG_TRACE_FN_READ_AVAIL, rxbuffer, rd_count);
+
+    return rd_count;
+}
+
+
 /**
  * \brief Read a string from an fd
  * \param p Hamlib port descriptor
@@ -668,6 +1007,7 @@ int HAMLIB_API read_string(hamlib_port_t *p,
 {
     fd_set rfds, efds;
     struct timeval tv, tv_timeout, start_time, end_time, elapsed_time;
+    struct timeval first_time;
     int rd_count, total_count = 0;
     int retval;
 
@@ -712,7 +1052,8 @@ int HAMLIB_API read_string(hamlib_port_t *p,
                 gettimeofday(&end_time, NULL);
                 timersub(&end_time, &start_time, &elapsed_time);
 
-                dump_hex((unsigned char *) rxbuffer, total_count);
+                port_rx_fail(p, RIG_TRACE_TIMEOUT, RIG_TRACE_FN_READ_STRING,
+                             rxbuffer, total_count, &first_time);
                 rig_debug(RIG_DEBUG_WARN,
                           "%s(): Timed out %d.%d seconds after %d chars\n",
                           __func__,
@@ -728,7 +1069,8 @@ int HAMLIB_API read_string(hamlib_port_t *p,
 
         if (retval < 0)
         {
-            dump_hex((unsigned char *) rxbuffer, total_count);
+            port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_STRING,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_ERR,
                       "%s(): select() error after %d chars: %s\n",
                       __func__,
@@ -740,6 +1082,8 @@ int HAMLIB_API read_string(hamlib_port_t *p,
 
         if (FD_ISSET(p->fd, &efds))
         {
+            port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_STRING,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_ERR,
                       "%s(): fd error after %d chars\n",
                       __func__,
@@ -756,7 +1100,8 @@ int HAMLIB_API read_string(hamlib_port_t *p,
 
         if (rd_count < 0)
         {
-            dump_hex((unsigned char *) rxbuffer, total_count);
+            port_rx_fail(p, RIG_TRACE_ERROR, RIG_TRACE_FN_READ_STRING,
+                         rxbuffer, total_count, &first_time);
             rig_debug(RIG_DEBUG_ERR,
                       "%s(): read() failed - %s\n",
                       __func__,
@@ -765,6 +1110,11 @@ int HAMLIB_API read_string(hamlib_port_t *p,
             return -RIG_EIO;
         }
 
+        if (total_count == 0)
+        {
+            gettimeofday(&first_time, NULL);
+        }
+
         ++total_count;
 
         if (stopset && memchr(stopset, rxbuffer[total_count - 1], stopset_len))
@@ -779,12 +1129,17 @@ int HAMLIB_API read_string(hamlib_port_t *p,
      */
     rxbuffer[total_count] = '\000';
 
+    port_stats_rx(p, total_count, &first_time);
+
     rig_debug(RIG_DEBUG_TRACE,
               "%s(): RX %d characters\n",
               __func__,
               total_count);
 
     dump_hex((unsigned char *) rxbuffer, total_count);
+    rig_trace(p, RIG_TRACE_RX, RIG_TRACE_FN_READ_STRING, rxbuffer, total_count);
+    port_record(p, RIG_TRACE_RX, RIG_TRACE_FN_READ_STRING,
+                   rxbuffer, total_count);
 
     return total_count;           /* return bytes count read */
 }
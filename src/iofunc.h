@@ -34,6 +34,10 @@ extern HAMLIB_EXPORT(int) read_block(hamlib_port_t *p,
                                      char *rxbuffer,
                                      size_t count);
 
+extern HAMLIB_EXPORT(int) read_avail(hamlib_port_t *p,
+                                     char *rxbuffer,
+                                     size_t rxmax);
+
 extern HAMLIB_EXPORT(int) write_block(hamlib_port_t *p,
                                       const char *txbuffer,
                                       size_t count);
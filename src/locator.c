@@ -115,6 +115,100 @@ const static int loc_char_range[] = { 18, 10, 24, 10, 24, 10 };
 
 /* end dph */
 
+
+/* begin dph */
+/* locator2longlat() without the checks of the pointers */
+static int loc2ll(double *longitude, double *latitude, const char *locator)
+{
+    int x_or_y, paircount;
+    int locvalue, pair;
+    int divisions;
+    double xy[2], ordinate;
+
+    paircount = strlen(locator) / 2;
+
+    /* verify paircount is within limits */
+    if (paircount > MAX_LOCATOR_PAIRS)
+    {
+        paircount = MAX_LOCATOR_PAIRS;
+    }
+    else if (paircount < MIN_LOCATOR_PAIRS)
+    {
+        return -RIG_EINVAL;
+    }
+
+    /* For x(=longitude) and y(=latitude) */
+    for (x_or_y = 0;  x_or_y < 2;  ++x_or_y)
+    {
+        ordinate = -90.0;
+        divisions = 1;
+
+        for (pair = 0;  pair < paircount;  ++pair)
+        {
+            locvalue = locator[pair * 2 + x_or_y];
+
+            /* Value of digit or letter */
+            locvalue -= (loc_char_range[pair] == 10) ? '0' :
+                (isupper(locvalue)) ? 'A' : 'a';
+
+            /* Check range for non-letter/digit or out of range */
+            if ((locvalue < 0) || (locvalue >= loc_char_range[pair]))
+            {
+                return -RIG_EINVAL;
+            }
+
+            divisions *= loc_char_range[pair];
+            ordinate += locvalue * 180.0 / divisions;
+        }
+
+        /* Center ordinate in the Maidenhead "square" or "subsquare" */
+        ordinate += 90.0 / divisions;
+
+        xy[x_or_y] = ordinate;
+    }
+
+    *longitude = xy[0] * 2.0;
+    *latitude = xy[1];
+
+    return RIG_OK;
+}
+/* end dph */
+
+
+/* begin dph */
+/* longlat2locator() without the checks of the arguments */
+static void ll2loc(double longitude,
+                   double latitude,
+                   char *locator,
+                   int pair_count)
+{
+    int x_or_y, pair, locvalue, divisions;
+    double square_size, ordinate;
+
+    for (x_or_y = 0;  x_or_y < 2;  ++x_or_y)
+    {
+        ordinate = (x_or_y == 0) ? longitude / 2.0 : latitude;
+        divisions = 1;
+
+        /* The 1e-6 here guards against floating point rounding errors */
+        ordinate = fmod(ordinate + 270.000001, 180.0);
+
+        for (pair = 0;  pair < pair_count;  ++pair)
+        {
+            divisions *= loc_char_range[pair];
+            square_size = 180.0 / divisions;
+
+            locvalue = (int)(ordinate / square_size);
+            ordinate -= square_size * locvalue;
+            locvalue += (loc_char_range[pair] == 10) ? '0' : 'A';
+            locator[pair * 2 + x_or_y] = locvalue;
+        }
+    }
+
+    locator[pair_count * 2] = '\0';
+}
+/* end dph */
+
 #endif  /* !DOC_HIDDEN */
 
 
@@ -398,11 +492,6 @@ int HAMLIB_API locator2longlat(double *longitude,
                                double *latitude,
                                const char *locator)
 {
-    int x_or_y, paircount;
-    int locvalue, pair;
-    int divisions;
-    double xy[2], ordinate;
-
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
     /* bail if NULL pointers passed */
@@ -411,52 +500,7 @@ int HAMLIB_API locator2longlat(double *longitude,
         return -RIG_EINVAL;
     }
 
-    paircount = strlen(locator) / 2;
-
-    /* verify paircount is within limits */
-    if (paircount > MAX_LOCATOR_PAIRS)
-    {
-        paircount = MAX_LOCATOR_PAIRS;
-    }
-    else if (paircount < MIN_LOCATOR_PAIRS)
-    {
-        return -RIG_EINVAL;
-    }
-
-    /* For x(=longitude) and y(=latitude) */
-    for (x_or_y = 0;  x_or_y < 2;  ++x_or_y)
-    {
-        ordinate = -90.0;
-        divisions = 1;
-
-        for (pair = 0;  pair < paircount;  ++pair)
-        {
-            locvalue = locator[pair * 2 + x_or_y];
-
-            /* Value of digit or letter */
-            locvalue -= (loc_char_range[pair] == 10) ? '0' :
-                (isupper(locvalue)) ? 'A' : 'a';
-
-            /* Check range for non-letter/digit or out of range */
-            if ((locvalue < 0) || (locvalue >= loc_char_range[pair]))
-            {
-                return -RIG_EINVAL;
-            }
-
-            divisions *= loc_char_range[pair];
-            ordinate += locvalue * 180.0 / divisions;
-        }
-
-        /* Center ordinate in the Maidenhead "square" or "subsquare" */
-        ordinate += 90.0 / divisions;
-
-        xy[x_or_y] = ordinate;
-    }
-
-    *longitude = xy[0] * 2.0;
-    *latitude = xy[1];
-
-    return RIG_OK;
+    return loc2ll(longitude, latitude, locator);
 }
 /* end dph */
 
@@ -488,9 +532,6 @@ int HAMLIB_API longlat2locator(double longitude,
                                char *locator,
                                int pair_count)
 {
-    int x_or_y, pair, locvalue, divisions;
-    double square_size, ordinate;
-
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
     if (!locator)
@@ -503,27 +544,7 @@ int HAMLIB_API longlat2locator(double longitude,
         return -RIG_EINVAL;
     }
 
-    for (x_or_y = 0;  x_or_y < 2;  ++x_or_y)
-    {
-        ordinate = (x_or_y == 0) ? longitude / 2.0 : latitude;
-        divisions = 1;
-
-        /* The 1e-6 here guards against floating point rounding errors */
-        ordinate = fmod(ordinate + 270.000001, 180.0);
-
-        for (pair = 0;  pair < pair_count;  ++pair)
-        {
-            divisions *= loc_char_range[pair];
-            square_size = 180.0 / divisions;
-
-            locvalue = (int)(ordinate / square_size);
-            ordinate -= square_size * locvalue;
-            locvalue += (loc_char_range[pair] == 10) ? '0' : 'A';
-            locator[pair * 2 + x_or_y] = locvalue;
-        }
-    }
-
-    locator[pair_count * 2] = '\0';
+    ll2loc(longitude, latitude, locator, pair_count);
 
     return RIG_OK;
 }
@@ -720,4 +741,238 @@ double HAMLIB_API azimuth_long_path(double azimuth)
     }
 }
 
+
+/**
+ * \brief Convert Maidenhead grid locators to Longitude/Latitude
+ * \param n         The number of locators
+ * \param locator   The Maidenhead grid locators
+ * \param longitude Array for the calculated Longitudes
+ * \param latitude  Array for the calculated Latitudes
+ *
+ *  Like locator2longlat(), for \a n locators at once.  4 character
+ *  locators, the most common in logs and spots, take a shortcut.
+ *
+ *  The longitude and latitude of a malformed locator are NAN, and the
+ *  other locators are still converted.
+ *
+ * \retval -RIG_EINVAL if a NULL pointer was passed, or a locator is
+ *  malformed.
+ * \retval RIG_OK if all the conversions went OK.
+ *
+ * \sa locator2longlat()
+ */
+int HAMLIB_API locator2longlat_batch(int n,
+                                     const char *const *locator,
+                                     double *longitude,
+                                     double *latitude)
+{
+    int i, retval = RIG_OK;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (n < 0 || (n > 0 && (!locator || !longitude || !latitude)))
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        const char *loc = locator[i];
+        unsigned int f0, f1, s0, s1;
+
+        if (!loc)
+        {
+            longitude[i] = latitude[i] = NAN;
+            retval = -RIG_EINVAL;
+            continue;
+        }
+
+        /* the terminators first, not to read past a short locator */
+        if (loc[0] && loc[1] && loc[2] && loc[3] && !loc[4])
+        {
+            /* field (letter, case insensitive) and square (digit) values */
+            f0 = (loc[0] | 0x20) - 'a';
+            f1 = (loc[1] | 0x20) - 'a';
+            s0 = loc[2] - '0';
+            s1 = loc[3] - '0';
+
+            if (f0 < 18 && f1 < 18 && s0 < 10 && s1 < 10)
+            {
+                /* center of the square, as computed by loc2ll() */
+                longitude[i] = f0 * 20.0 + s0 * 2.0 - 179.0;
+                latitude[i] = f1 * 10.0 + s1 - 89.5;
+                continue;
+            }
+        }
+
+        if (loc2ll(&longitude[i], &latitude[i], loc) != RIG_OK)
+        {
+            longitude[i] = latitude[i] = NAN;
+            retval = -RIG_EINVAL;
+        }
+    }
+
+    return retval;
+}
+
+
+/**
+ * \brief Convert Longitudes/Latitudes to Maidenhead grid locators
+ * \param n             The number of positions
+ * \param longitude     Longitudes, decimal degrees
+ * \param latitude      Latitudes, decimal degrees
+ * \param locator       Buffer for the Maidenhead Locators
+ * \param pair_count    Precision expressed as lon/lat pairs in the locator
+ *
+ *  Like longlat2locator(), for \a n positions at once.  The locators are
+ *  stored one after the other in \a locator, each one \a pair_count * 2
+ *  char + '\\0' long, so \a locator must point to an array of at least
+ *  \a n * (\a pair_count * 2 + 1) char.
+ *
+ * \retval -RIG_EINVAL if a NULL pointer was passed, or \a pair_count
+ *  exceeds length limit.  Currently 1 to 6 lon/lat pairs.
+ * \retval RIG_OK if conversion went OK.
+ *
+ * \sa longlat2locator()
+ */
+int HAMLIB_API longlat2locator_batch(int n,
+                                     const double *longitude,
+                                     const double *latitude,
+                                     char *locator,
+                                     int pair_count)
+{
+    int i;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (n < 0 || (n > 0 && (!longitude || !latitude || !locator)))
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (pair_count < MIN_LOCATOR_PAIRS || pair_count > MAX_LOCATOR_PAIRS)
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        ll2loc(longitude[i], latitude[i], locator + i * (pair_count * 2 + 1),
+               pair_count);
+    }
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief Calculate the distances and bearings from one point to many.
+ * \param lon1      The local Longitude, decimal degrees
+ * \param lat1      The local Latitude, decimal degrees
+ * \param n         The number of remote points
+ * \param lon2      The remote Longitudes, decimal degrees
+ * \param lat2      The remote Latitudes, decimal degrees
+ * \param distance  Array for the distances, km
+ * \param azimuth   Array for the bearings, decimal degrees
+ *
+ *  Like qrb(), from \a lon1, \a lat1 to each of the \a n points of
+ *  \a lon2, \a lat2, with the same results.  The terms of the local
+ *  point are computed once, and the loop has no calls but the maths
+ *  library, so that the compiler may vectorize it.
+ *
+ *  The distance and bearing of a remote point out of range are NAN, and
+ *  the other points are still calculated.
+ *
+ * \retval -RIG_EINVAL if NULL pointer passed or lat and lon values
+ * exceed -90 to 90 or -180 to 180.
+ * \retval RIG_OK if calculations are successful.
+ *
+ * \sa qrb(), distance_long_path(), azimuth_long_path()
+ */
+int HAMLIB_API qrb_batch(double lon1,
+                         double lat1,
+                         int n,
+                         const double *lon2,
+                         const double *lat2,
+                         double *distance,
+                         double *azimuth)
+{
+    double sin_lat1, cos_lat1;
+    int i, retval = RIG_OK;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (n < 0 || (n > 0 && (!lon2 || !lat2 || !distance || !azimuth)))
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (lat1 > 90.0 || lat1 < -90.0 || lon1 > 180.0 || lon1 < -180.0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    /* Prevent ACOS() Domain Error */
+    if (lat1 == 90.0)
+    {
+        lat1 = 89.999999999;
+    }
+    else if (lat1 == -90.0)
+    {
+        lat1 = -89.999999999;
+    }
+
+    lat1 /= RADIAN;
+    lon1 /= RADIAN;
+    sin_lat1 = sin(lat1);
+    cos_lat1 = cos(lat1);
+
+    for (i = 0; i < n; i++)
+    {
+        double lat = lat2[i], delta_long, sin_lat, cos_lat, cos_dl;
+        double tmp, az;
+
+        if (lat > 90.0 || lat < -90.0 || lon2[i] > 180.0 || lon2[i] < -180.0)
+        {
+            distance[i] = azimuth[i] = NAN;
+            retval = -RIG_EINVAL;
+            continue;
+        }
+
+        lat = lat == 90.0 ? 89.999999999 : lat == -90.0 ? -89.999999999 : lat;
+        lat /= RADIAN;
+        delta_long = lon2[i] / RADIAN - lon1;
+
+        sin_lat = sin(lat);
+        cos_lat = cos(lat);
+        cos_dl = cos(delta_long);
+
+        tmp = sin_lat1 * sin_lat + cos_lat1 * cos_lat * cos_dl;
+
+        az = RADIAN * atan2(sin(delta_long) * cos_lat,
+                            cos_lat1 * sin_lat - sin_lat1 * cos_lat * cos_dl);
+        az = fmod(360.0 + az, 360.0);
+        az += az < 0.0 ? 360.0 : (az >= 360.0 ? -360.0 : 0.0);
+
+        /* coincident and antipodal points, as in qrb() */
+        if (tmp > .999999999999999)
+        {
+            distance[i] = 0.0;
+            azimuth[i] = 0.0;
+        }
+        else if (tmp < -.999999)
+        {
+            distance[i] = 180.0 * ARC_IN_KM;
+            azimuth[i] = 0.0;
+        }
+        else
+        {
+            distance[i] = ARC_IN_KM * RADIAN * acos(tmp);
+            azimuth[i] = floor(az + 0.5);
+        }
+    }
+
+    return retval;
+}
+
 /*! @} */
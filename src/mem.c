@@ -45,6 +45,7 @@
 #include <fcntl.h>
 
 #include <hamlib/rig.h>
+#include "misc.h"
 
 #ifndef DOC_HIDDEN
 
@@ -352,6 +353,56 @@ static int rig_mem_caps_empty(const channel_cap_t *mem_cap)
 }
 
 
+/*
+ * Narrows mem_cap down to the fields the backend is able to get (or set),
+ * so that the emulation does not spend calls bound to fail.  The split
+ * frequency and mode are emulated by the frontend, they are kept.
+ */
+static void generic_chan_caps(RIG *rig,
+                              const channel_cap_t *mem_cap,
+                              channel_cap_t *caps,
+                              int set)
+{
+    const struct rig_caps *rc = rig->caps;
+    const struct rig_state *rs = &rig->state;
+
+    *caps = *mem_cap;
+
+#define GENERIC_CAP(field, func) \
+    do { \
+        if (set ? rc->set_##func == NULL : rc->get_##func == NULL) \
+            caps->field = 0; \
+    } while (0)
+
+    GENERIC_CAP(vfo, vfo);
+    GENERIC_CAP(ant, ant);
+    GENERIC_CAP(freq, freq);
+    GENERIC_CAP(mode, mode);
+    GENERIC_CAP(width, mode);
+    GENERIC_CAP(split, split_vfo);
+    GENERIC_CAP(tx_vfo, split_vfo);
+    GENERIC_CAP(rptr_shift, rptr_shift);
+    GENERIC_CAP(rptr_offs, rptr_offs);
+    GENERIC_CAP(tuning_step, ts);
+    GENERIC_CAP(rit, rit);
+    GENERIC_CAP(xit, xit);
+    GENERIC_CAP(ctcss_tone, ctcss_tone);
+    GENERIC_CAP(ctcss_sql, ctcss_sql);
+    GENERIC_CAP(dcs_code, dcs_code);
+    GENERIC_CAP(dcs_sql, dcs_sql);
+
+#undef GENERIC_CAP
+
+    caps->levels &= set ? rs->has_set_level : rs->has_get_level;
+    caps->funcs &= set ? rs->has_set_func : rs->has_get_func;
+
+    if (set ? rc->set_ext_level == NULL : rc->get_ext_level == NULL)
+    {
+        caps->ext_levels = 0;
+    }
+}
+
+
 /*
  * stores current VFO state into chan by emulating rig_get_channel
  */
@@ -362,6 +413,7 @@ static int generic_save_channel(RIG *rig, channel_t *chan)
     vfo_t vfo;
     setting_t setting;
     const channel_cap_t *mem_cap = NULL;
+    channel_cap_t caps;
 
     chan_num = chan->channel_num;
     vfo = chan->vfo;
@@ -386,7 +438,45 @@ static int generic_save_channel(RIG *rig, channel_t *chan)
         mem_cap = &mem_cap_all;
     }
 
-    if (mem_cap->freq)
+    generic_chan_caps(rig, mem_cap, &caps, 0);
+
+    chan->split = RIG_SPLIT_OFF;
+
+    /*
+     * Let the backend fill in whatever it gets in one exchange,
+     * the fields it did are not queried one by one below.
+     */
+    if (rig->caps->get_chan_snapshot)
+    {
+        channel_cap_t filled;
+
+        memset(&filled, 0, sizeof(filled));
+
+        if (rig->caps->get_chan_snapshot(rig, chan, &filled) == RIG_OK)
+        {
+            if (filled.freq && caps.freq && chan->freq == RIG_FREQ_NONE)
+            {
+                return -RIG_ENAVAIL;
+            }
+
+            /* the backend read it raw, correct it as rig_get_freq() would */
+            if (filled.freq)
+            {
+                chan->freq = rig_freq_from_rig(rig, chan->freq);
+            }
+
+            caps.vfo &= !filled.vfo;
+            caps.freq &= !filled.freq;
+            caps.mode &= !(filled.mode && filled.width);
+            caps.width &= !(filled.mode && filled.width);
+            caps.split &= !(filled.split && filled.tx_vfo);
+            caps.tx_vfo &= !(filled.split && filled.tx_vfo);
+            caps.rit &= !filled.rit;
+            caps.xit &= !filled.xit;
+        }
+    }
+
+    if (caps.freq)
     {
         retval = rig_get_freq(rig, RIG_VFO_CURR, &chan->freq);
 
@@ -397,31 +487,29 @@ static int generic_save_channel(RIG *rig, channel_t *chan)
         }
     }
 
-    if (mem_cap->vfo)
+    if (caps.vfo)
     {
         rig_get_vfo(rig, &chan->vfo);
     }
 
-    if (mem_cap->mode || mem_cap->width)
+    if (caps.mode || caps.width)
     {
         rig_get_mode(rig, RIG_VFO_CURR, &chan->mode, &chan->width);
     }
 
-    chan->split = RIG_SPLIT_OFF;
-
-    if (mem_cap->split)
+    if (caps.split)
     {
         rig_get_split_vfo(rig, RIG_VFO_CURR, &chan->split, &chan->tx_vfo);
     }
 
     if (chan->split != RIG_SPLIT_OFF)
     {
-        if (mem_cap->tx_freq)
+        if (caps.tx_freq)
         {
             rig_get_split_freq(rig, RIG_VFO_CURR, &chan->tx_freq);
         }
 
-        if (mem_cap->tx_mode || mem_cap->tx_width)
+        if (caps.tx_mode || caps.tx_width)
         {
             rig_get_split_mode(rig, RIG_VFO_CURR, &chan->tx_mode, &chan->tx_width);
         }
@@ -433,74 +521,74 @@ static int generic_save_channel(RIG *rig, channel_t *chan)
         chan->tx_width = chan->width;
     }
 
-    if (mem_cap->rptr_shift)
+    if (caps.rptr_shift)
     {
         rig_get_rptr_shift(rig, RIG_VFO_CURR, &chan->rptr_shift);
     }
 
-    if (mem_cap->rptr_offs)
+    if (caps.rptr_offs)
     {
         rig_get_rptr_offs(rig, RIG_VFO_CURR, &chan->rptr_offs);
     }
 
-    if (mem_cap->ant)
+    if (caps.ant)
     {
         rig_get_ant(rig, RIG_VFO_CURR, &chan->ant);
     }
 
-    if (mem_cap->tuning_step)
+    if (caps.tuning_step)
     {
         rig_get_ts(rig, RIG_VFO_CURR, &chan->tuning_step);
     }
 
-    if (mem_cap->rit)
+    if (caps.rit)
     {
         rig_get_rit(rig, RIG_VFO_CURR, &chan->rit);
     }
 
-    if (mem_cap->xit)
+    if (caps.xit)
     {
         rig_get_xit(rig, RIG_VFO_CURR, &chan->xit);
     }
 
-    for (i = 0; i < RIG_SETTING_MAX; i++)
+    for (i = 0; i < RIG_SETTING_MAX && caps.levels; i++)
     {
         setting = rig_idx2setting(i);
 
-        if ((setting & mem_cap->levels) && RIG_LEVEL_SET(setting))
+        if ((setting & caps.levels) && RIG_LEVEL_SET(setting))
         {
             rig_get_level(rig, RIG_VFO_CURR, setting, &chan->levels[i]);
         }
     }
 
-    for (i = 0; i < RIG_SETTING_MAX; i++)
+    for (i = 0; i < RIG_SETTING_MAX && caps.funcs; i++)
     {
         int fstatus;
         setting = rig_idx2setting(i);
 
-        if ((setting & mem_cap->funcs)
+        if ((setting & caps.funcs)
             && (rig_get_func(rig, RIG_VFO_CURR, setting, &fstatus) == RIG_OK))
         {
             chan->funcs |= fstatus ? setting : 0;
         }
     }
 
-    if (mem_cap->ctcss_tone)
+    if (caps.ctcss_tone)
     {
         rig_get_ctcss_tone(rig, RIG_VFO_CURR, &chan->ctcss_tone);
     }
 
-    if (mem_cap->ctcss_sql)
+    if (caps.ctcss_sql)
     {
         rig_get_ctcss_sql(rig, RIG_VFO_CURR, &chan->ctcss_sql);
     }
 
-    if (mem_cap->dcs_code)
+    if (caps.dcs_code)
     {
         rig_get_dcs_code(rig, RIG_VFO_CURR, &chan->dcs_code);
     }
 
-    if (mem_cap->dcs_sql)
+    if (caps.dcs_sql)
     {
         rig_get_dcs_sql(rig, RIG_VFO_CURR, &chan->dcs_sql);
     }
@@ -513,7 +601,10 @@ static int generic_save_channel(RIG *rig, channel_t *chan)
      * - flags
      */
 
-    rig_ext_level_foreach(rig, generic_retr_extl, (rig_ptr_t)chan);
+    if (caps.ext_levels)
+    {
+        rig_ext_level_foreach(rig, generic_retr_extl, (rig_ptr_t)chan);
+    }
 
     return RIG_OK;
 }
@@ -528,6 +619,7 @@ static int generic_restore_channel(RIG *rig, const channel_t *chan)
     struct ext_list *p;
     setting_t setting;
     const channel_cap_t *mem_cap = NULL;
+    channel_cap_t caps;
 
     if (chan->vfo == RIG_VFO_MEM)
     {
@@ -546,98 +638,107 @@ static int generic_restore_channel(RIG *rig, const channel_t *chan)
         mem_cap = &mem_cap_all;
     }
 
-    rig_set_vfo(rig, chan->vfo);
+    generic_chan_caps(rig, mem_cap, &caps, 1);
+
+    /* already there when walking the memories */
+    if (chan->vfo != RIG_VFO_CURR && chan->vfo != rig->state.current_vfo)
+    {
+        rig_set_vfo(rig, chan->vfo);
+    }
 
-    if (mem_cap->freq)
+    if (caps.freq)
     {
         rig_set_freq(rig, RIG_VFO_CURR, chan->freq);
     }
 
-    if (mem_cap->mode || mem_cap->width)
+    if (caps.mode || caps.width)
     {
         rig_set_mode(rig, RIG_VFO_CURR, chan->mode, chan->width);
     }
 
-    rig_set_split_vfo(rig, RIG_VFO_CURR, chan->split, chan->tx_vfo);
+    if (caps.split)
+    {
+        rig_set_split_vfo(rig, RIG_VFO_CURR, chan->split, chan->tx_vfo);
+    }
 
     if (chan->split != RIG_SPLIT_OFF)
     {
-        if (mem_cap->tx_freq)
+        if (caps.tx_freq)
         {
             rig_set_split_freq(rig, RIG_VFO_CURR, chan->tx_freq);
         }
 
-        if (mem_cap->tx_mode || mem_cap->tx_width)
+        if (caps.tx_mode || caps.tx_width)
         {
             rig_set_split_mode(rig, RIG_VFO_CURR, chan->tx_mode, chan->tx_width);
         }
     }
 
-    if (mem_cap->rptr_shift)
+    if (caps.rptr_shift)
     {
         rig_set_rptr_shift(rig, RIG_VFO_CURR, chan->rptr_shift);
     }
 
-    if (mem_cap->rptr_offs)
+    if (caps.rptr_offs)
     {
         rig_set_rptr_offs(rig, RIG_VFO_CURR, chan->rptr_offs);
     }
 
-    for (i = 0; i < RIG_SETTING_MAX; i++)
+    for (i = 0; i < RIG_SETTING_MAX && caps.levels; i++)
     {
         setting = rig_idx2setting(i);
 
-        if (setting & mem_cap->levels)
+        if (setting & caps.levels)
         {
             rig_set_level(rig, RIG_VFO_CURR, setting, chan->levels[i]);
         }
     }
 
-    if (mem_cap->ant)
+    if (caps.ant)
     {
         rig_set_ant(rig, RIG_VFO_CURR, chan->ant);
     }
 
-    if (mem_cap->tuning_step)
+    if (caps.tuning_step)
     {
         rig_set_ts(rig, RIG_VFO_CURR, chan->tuning_step);
     }
 
-    if (mem_cap->rit)
+    if (caps.rit)
     {
         rig_set_rit(rig, RIG_VFO_CURR, chan->rit);
     }
 
-    if (mem_cap->xit)
+    if (caps.xit)
     {
         rig_set_xit(rig, RIG_VFO_CURR, chan->xit);
     }
 
-    for (i = 0; i < RIG_SETTING_MAX; i++)
+    for (i = 0; i < RIG_SETTING_MAX && caps.funcs; i++)
     {
         setting = rig_idx2setting(i);
 
-        if (setting & mem_cap->funcs)
+        if (setting & caps.funcs)
             rig_set_func(rig, RIG_VFO_CURR, setting,
                          chan->funcs & rig_idx2setting(i));
     }
 
-    if (mem_cap->ctcss_tone)
+    if (caps.ctcss_tone)
     {
         rig_set_ctcss_tone(rig, RIG_VFO_CURR, chan->ctcss_tone);
     }
 
-    if (mem_cap->ctcss_sql)
+    if (caps.ctcss_sql)
     {
         rig_set_ctcss_sql(rig, RIG_VFO_CURR, chan->ctcss_sql);
     }
 
-    if (mem_cap->dcs_code)
+    if (caps.dcs_code)
     {
         rig_set_dcs_code(rig, RIG_VFO_CURR, chan->dcs_code);
     }
 
-    if (mem_cap->dcs_sql)
+    if (caps.dcs_sql)
     {
         rig_set_dcs_sql(rig, RIG_VFO_CURR, chan->dcs_sql);
     }
@@ -650,13 +751,146 @@ static int generic_restore_channel(RIG *rig, const channel_t *chan)
      * - flags
      */
 
-    for (p = chan->ext_levels; p && !RIG_IS_EXT_END(*p); p++)
+    for (p = chan->ext_levels; caps.ext_levels && p && !RIG_IS_EXT_END(*p);
+            p++)
     {
         rig_set_ext_level(rig, RIG_VFO_CURR, p->token, p->val);
     }
 
     return RIG_OK;
 }
+
+
+/*
+ * State saved while walking memory channels with the VFO emulation,
+ * so that the current VFO and memory number are restored only once
+ * for a whole range of channels.
+ */
+struct chan_walk
+{
+    vfo_t vfo;              /* requested vfo */
+    vfo_t curr_vfo;
+    int curr_chan_num;
+    int get_mem_status;
+    int by_vfo_mem;
+    int by_vfo_op;
+    int switched;           /* begin moved off curr_vfo */
+};
+
+
+static int generic_walk_begin(RIG *rig,
+                              vfo_t vfo,
+                              vfo_op_t op,
+                              struct chan_walk *walk)
+{
+    const struct rig_caps *rc = rig->caps;
+    int retcode;
+
+    /* any emulation requires set_mem() */
+    if (vfo == RIG_VFO_MEM && !rc->set_mem)
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    walk->vfo = vfo;
+
+    walk->by_vfo_mem = rc->set_vfo
+                       && ((rig->state.vfo_list & RIG_VFO_MEM) == RIG_VFO_MEM);
+
+    walk->by_vfo_op = rc->vfo_op && rig_has_vfo_op(rig, op);
+
+    if (!walk->by_vfo_mem && !walk->by_vfo_op)
+    {
+        return -RIG_ENTARGET;
+    }
+
+    walk->curr_vfo = rig->state.current_vfo;
+    walk->switched = 0;
+    walk->get_mem_status = -RIG_ENAVAIL;
+
+    if (vfo == RIG_VFO_MEM)
+    {
+        walk->get_mem_status = rig_get_mem(rig, RIG_VFO_CURR,
+                                           &walk->curr_chan_num);
+    }
+
+    if (walk->by_vfo_mem && walk->curr_vfo != vfo)
+    {
+        retcode = rig_set_vfo(rig, vfo);
+
+        if (retcode != RIG_OK)
+        {
+            return retcode;
+        }
+
+        walk->switched = 1;
+    }
+
+    return RIG_OK;
+}
+
+
+static void generic_walk_end(RIG *rig, const struct chan_walk *walk)
+{
+    /* restore current memory number */
+    if (walk->vfo == RIG_VFO_MEM && walk->get_mem_status == RIG_OK)
+    {
+        rig_set_mem(rig, RIG_VFO_CURR, walk->curr_chan_num);
+    }
+
+    /* the cached current_vfo may have been changed by the walk */
+    if (walk->switched)
+    {
+        rig_set_vfo(rig, walk->curr_vfo);
+    }
+}
+
+
+static int generic_walk_get(RIG *rig,
+                            const struct chan_walk *walk,
+                            channel_t *chan)
+{
+    int retcode;
+
+    if (walk->vfo == RIG_VFO_MEM)
+    {
+        rig_set_mem(rig, RIG_VFO_CURR, chan->channel_num);
+    }
+
+    if (!walk->by_vfo_mem && walk->by_vfo_op)
+    {
+        retcode = rig_vfo_op(rig, RIG_VFO_CURR, RIG_OP_TO_VFO);
+
+        if (retcode != RIG_OK)
+        {
+            return retcode;
+        }
+    }
+
+    return generic_save_channel(rig, chan);
+}
+
+
+static int generic_walk_set(RIG *rig,
+                            const struct chan_walk *walk,
+                            const channel_t *chan)
+{
+    int retcode;
+
+    if (walk->vfo == RIG_VFO_MEM)
+    {
+        rig_set_mem(rig, RIG_VFO_CURR, chan->channel_num);
+    }
+
+    retcode = generic_restore_channel(rig, chan);
+
+    if (!walk->by_vfo_mem && walk->by_vfo_op)
+    {
+        retcode = rig_vfo_op(rig, RIG_VFO_CURR, RIG_OP_FROM_VFO);
+    }
+
+    return retcode;
+}
 #endif  /* !DOC_HIDDEN */
 
 
@@ -683,11 +917,8 @@ static int generic_restore_channel(RIG *rig, const channel_t *chan)
 int HAMLIB_API rig_set_channel(RIG *rig, const channel_t *chan)
 {
     struct rig_caps *rc;
-    int curr_chan_num, get_mem_status = RIG_OK;
-    vfo_t curr_vfo;
-    vfo_t vfo; /* requested vfo */
+    struct chan_walk walk;
     int retcode;
-    int can_emulate_by_vfo_mem, can_emulate_by_vfo_op;
 #ifdef PARANOID_CHANNEL_HANDLING
     channel_t curr_chan;
 #endif
@@ -715,78 +946,26 @@ int HAMLIB_API rig_set_channel(RIG *rig, const channel_t *chan)
      * Optional: get_vfo, set_vfo,
      */
 
-    vfo = chan->vfo;
-
-    if (vfo == RIG_VFO_CURR)
+    if (chan->vfo == RIG_VFO_CURR)
     {
         return generic_restore_channel(rig, chan);
     }
 
-    /* any emulation requires set_mem() */
-    if (vfo == RIG_VFO_MEM && !rc->set_mem)
-    {
-        return -RIG_ENAVAIL;
-    }
-
-    can_emulate_by_vfo_mem = rc->set_vfo
-        && ((rig->state.vfo_list & RIG_VFO_MEM) == RIG_VFO_MEM);
-
-    can_emulate_by_vfo_op = rc->vfo_op
-        && rig_has_vfo_op(rig, RIG_OP_FROM_VFO);
-
-    if (!can_emulate_by_vfo_mem && !can_emulate_by_vfo_op)
-    {
-        return -RIG_ENTARGET;
-    }
-
-    curr_vfo = rig->state.current_vfo;
     /* may be needed if the restore_channel has some side effects */
 #ifdef PARANOID_CHANNEL_HANDLING
     generic_save_channel(rig, &curr_chan);
 #endif
 
-    if (vfo == RIG_VFO_MEM)
-    {
-        get_mem_status = rig_get_mem(rig, RIG_VFO_CURR, &curr_chan_num);
-    }
-
-    if (can_emulate_by_vfo_mem && curr_vfo != vfo)
-    {
-        retcode = rig_set_vfo(rig, vfo);
-
-        if (retcode != RIG_OK)
-        {
-            return retcode;
-        }
-    }
+    retcode = generic_walk_begin(rig, chan->vfo, RIG_OP_FROM_VFO, &walk);
 
-    if (vfo == RIG_VFO_MEM)
-    {
-        rig_set_mem(rig, RIG_VFO_CURR, chan->channel_num);
-    }
-
-    retcode = generic_restore_channel(rig, chan);
-
-    if (!can_emulate_by_vfo_mem && can_emulate_by_vfo_op)
+    if (retcode != RIG_OK)
     {
-        retcode = rig_vfo_op(rig, RIG_VFO_CURR, RIG_OP_FROM_VFO);
-
-        if (retcode != RIG_OK)
-        {
-            return retcode;
-        }
+        return retcode;
     }
 
-    /* restore current memory number */
-    if (vfo == RIG_VFO_MEM && get_mem_status == RIG_OK)
-    {
-        rig_set_mem(rig, RIG_VFO_CURR, curr_chan_num);
-    }
+    retcode = generic_walk_set(rig, &walk, chan);
 
-    if (can_emulate_by_vfo_mem)
-    {
-        rig_set_vfo(rig, curr_vfo);
-    }
+    generic_walk_end(rig, &walk);
 
 #ifdef PARANOID_CHANNEL_HANDLING
     generic_restore_channel(rig, &curr_chan);
@@ -835,11 +1014,8 @@ int HAMLIB_API rig_set_channel(RIG *rig, const channel_t *chan)
 int HAMLIB_API rig_get_channel(RIG *rig, channel_t *chan)
 {
     struct rig_caps *rc;
-    int curr_chan_num, get_mem_status = RIG_OK;
-    vfo_t curr_vfo;
-    vfo_t vfo;  /* requested vfo */
+    struct chan_walk walk;
     int retcode;
-    int can_emulate_by_vfo_mem, can_emulate_by_vfo_op;
 #ifdef PARANOID_CHANNEL_HANDLING
     channel_t curr_chan;
 #endif
@@ -867,78 +1043,26 @@ int HAMLIB_API rig_get_channel(RIG *rig, channel_t *chan)
      * Optional: get_vfo, set_vfo
      * TODO: check return codes
      */
-    vfo = chan->vfo;
-
-    if (vfo == RIG_VFO_CURR)
+    if (chan->vfo == RIG_VFO_CURR)
     {
         return generic_save_channel(rig, chan);
     }
 
-    /* any emulation requires set_mem() */
-    if (vfo == RIG_VFO_MEM && !rc->set_mem)
-    {
-        return -RIG_ENAVAIL;
-    }
-
-    can_emulate_by_vfo_mem = rc->set_vfo
-        && ((rig->state.vfo_list & RIG_VFO_MEM) == RIG_VFO_MEM);
-
-    can_emulate_by_vfo_op = rc->vfo_op
-        && rig_has_vfo_op(rig, RIG_OP_TO_VFO);
-
-    if (!can_emulate_by_vfo_mem && !can_emulate_by_vfo_op)
-    {
-        return -RIG_ENTARGET;
-    }
-
-    curr_vfo = rig->state.current_vfo;
     /* may be needed if the restore_channel has some side effects */
 #ifdef PARANOID_CHANNEL_HANDLING
     generic_save_channel(rig, &curr_chan);
 #endif
 
-    if (vfo == RIG_VFO_MEM)
-    {
-        get_mem_status = rig_get_mem(rig, RIG_VFO_CURR, &curr_chan_num);
-    }
-
-    if (can_emulate_by_vfo_mem && curr_vfo != vfo)
-    {
-        retcode = rig_set_vfo(rig, vfo);
-
-        if (retcode != RIG_OK)
-        {
-            return retcode;
-        }
-    }
-
-    if (vfo == RIG_VFO_MEM)
-    {
-        rig_set_mem(rig, RIG_VFO_CURR, chan->channel_num);
-    }
+    retcode = generic_walk_begin(rig, chan->vfo, RIG_OP_TO_VFO, &walk);
 
-    if (!can_emulate_by_vfo_mem && can_emulate_by_vfo_op)
+    if (retcode != RIG_OK)
     {
-        retcode = rig_vfo_op(rig, RIG_VFO_CURR, RIG_OP_TO_VFO);
-
-        if (retcode != RIG_OK)
-        {
-            return retcode;
-        }
+        return retcode;
     }
 
-    retcode = generic_save_channel(rig, chan);
-
-    /* restore current memory number */
-    if (vfo == RIG_VFO_MEM && get_mem_status == RIG_OK)
-    {
-        rig_set_mem(rig, RIG_VFO_CURR, curr_chan_num);
-    }
+    retcode = generic_walk_get(rig, &walk, chan);
 
-    if (can_emulate_by_vfo_mem)
-    {
-        rig_set_vfo(rig, curr_vfo);
-    }
+    generic_walk_end(rig, &walk);
 
 #ifdef PARANOID_CHANNEL_HANDLING
     generic_restore_channel(rig, &curr_chan);
@@ -950,9 +1074,21 @@ int HAMLIB_API rig_get_channel(RIG *rig, channel_t *chan)
 #ifndef DOC_HIDDEN
 int get_chan_all_cb_generic(RIG *rig, chan_cb_t chan_cb, rig_ptr_t arg)
 {
-    int i, j, retval;
+    int i, j, retval = RIG_OK;
     chan_t *chan_list = rig->state.chan_list;
     channel_t *chan;
+    struct chan_walk walk;
+    int walking = 0;
+
+    /*
+     * Without get_channel, switch to memory mode once for all
+     * the channels, rather than back and forth for each one.
+     */
+    if (!rig->caps->get_channel)
+    {
+        walking = generic_walk_begin(rig, RIG_VFO_MEM, RIG_OP_TO_VFO,
+                                     &walk) == RIG_OK;
+    }
 
     for (i = 0; !RIG_IS_CHAN_END(chan_list[i]) && i < CHANLSTSIZ; i++)
     {
@@ -967,12 +1103,13 @@ int get_chan_all_cb_generic(RIG *rig, chan_cb_t chan_cb, rig_ptr_t arg)
 
         if (retval != RIG_OK)
         {
-            return retval;
+            break;
         }
 
         if (chan == NULL)
         {
-            return -RIG_ENOMEM;
+            retval = -RIG_ENOMEM;
+            break;
         }
 
         for (j = chan_list[i].start; j <= chan_list[i].end; j++)
@@ -982,10 +1119,14 @@ int get_chan_all_cb_generic(RIG *rig, chan_cb_t chan_cb, rig_ptr_t arg)
             chan->vfo = RIG_VFO_MEM;
             chan->channel_num = j;
 
-            /*
-             * TODO: if doesn't have rc->get_channel, special generic
-             */
-            retval = rig_get_channel(rig, chan);
+            if (walking)
+            {
+                retval = generic_walk_get(rig, &walk, chan);
+            }
+            else
+            {
+                retval = rig_get_channel(rig, chan);
+            }
 
             if (retval == -RIG_ENAVAIL)
             {
@@ -999,24 +1140,44 @@ int get_chan_all_cb_generic(RIG *rig, chan_cb_t chan_cb, rig_ptr_t arg)
 
             if (retval != RIG_OK)
             {
-                return retval;
+                break;
             }
 
             chan_next = j < chan_list[i].end ? j + 1 : j;
 
             chan_cb(rig, &chan, chan_next, chan_list, arg);
         }
+
+        if (retval != RIG_OK && retval != -RIG_ENAVAIL)
+        {
+            break;
+        }
+
+        retval = RIG_OK;
     }
 
-    return RIG_OK;
+    if (walking)
+    {
+        generic_walk_end(rig, &walk);
+    }
+
+    return retval;
 }
 
 
 int set_chan_all_cb_generic(RIG *rig, chan_cb_t chan_cb, rig_ptr_t arg)
 {
-    int i, j, retval;
+    int i, j, retval = RIG_OK;
     chan_t *chan_list = rig->state.chan_list;
     channel_t *chan;
+    struct chan_walk walk;
+    int walking = 0;
+
+    if (!rig->caps->set_channel)
+    {
+        walking = generic_walk_begin(rig, RIG_VFO_MEM, RIG_OP_FROM_VFO,
+                                     &walk) == RIG_OK;
+    }
 
     for (i = 0; !RIG_IS_CHAN_END(chan_list[i]) && i < CHANLSTSIZ; i++)
     {
@@ -1027,16 +1188,33 @@ int set_chan_all_cb_generic(RIG *rig, chan_cb_t chan_cb, rig_ptr_t arg)
             chan_cb(rig, &chan, j, chan_list, arg);
             chan->vfo = RIG_VFO_MEM;
 
-            retval = rig_set_channel(rig, chan);
+            if (walking)
+            {
+                retval = generic_walk_set(rig, &walk, chan);
+            }
+            else
+            {
+                retval = rig_set_channel(rig, chan);
+            }
 
             if (retval != RIG_OK)
             {
-                return retval;
+                break;
             }
         }
+
+        if (retval != RIG_OK)
+        {
+            break;
+        }
     }
 
-    return RIG_OK;
+    if (walking)
+    {
+        generic_walk_end(rig, &walk);
+    }
+
+    return retval;
 }
 
 
@@ -0,0 +1,683 @@
+/*
+ *  Hamlib Interface - binary memory channel image
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file memimage.c
+ * \brief Binary memory channel image
+ *
+ * A channel image holds a set of channel_t in a compact binary file: a
+ * header, one fixed size record per channel, then a side table with the
+ * extension level values of all the channels.  Opening an image maps
+ * the file in memory, so that channels are decoded on demand by index,
+ * without parsing the whole file.
+ *
+ * The image is host endian; an image made on a machine of the other
+ * byte order is refused.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_STAT_H
+#  include <sys/stat.h>
+#endif
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#  include <sys/mman.h>
+#  define CHAN_IMAGE_MMAP 1
+#endif
+
+#ifndef O_BINARY
+#  define O_BINARY 0
+#endif
+
+#include <hamlib/rig.h>
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_RIG_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define CHAN_IMAGE_MAGIC        "HLCHIMG"
+#define CHAN_IMAGE_VERSION      1
+#define CHAN_IMAGE_BYTE_ORDER   0x01020304
+#define CHAN_IMAGE_LEVELS       64
+#define CHAN_IMAGE_DESCLEN      32
+
+/*
+ * All the fields have a fixed width, and the records and the side table
+ * stay 8 byte aligned within the file.
+ */
+struct chan_image_hdr
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t rig_model;
+    uint32_t count;         /* records */
+    uint32_t rec_size;
+    uint32_t ext_count;     /* entries of the side table */
+    uint64_t ext_offset;    /* from the start of the file */
+};
+
+/* level and extension level values are either int or float */
+union chan_image_val
+{
+    int32_t i;
+    float f;
+};
+
+struct chan_image_rec
+{
+    int32_t channel_num;
+    int32_t bank_num;
+    int32_t vfo;
+    int32_t ant;
+    double freq;
+    uint64_t mode;
+    int64_t width;
+    double tx_freq;
+    uint64_t tx_mode;
+    int64_t tx_width;
+    int32_t split;
+    int32_t tx_vfo;
+    int32_t rptr_shift;
+    int32_t pad;
+    int64_t rptr_offs;
+    int64_t tuning_step;
+    int64_t rit;
+    int64_t xit;
+    uint64_t funcs;
+    union chan_image_val levels[CHAN_IMAGE_LEVELS];
+    uint32_t ctcss_tone;
+    uint32_t ctcss_sql;
+    uint32_t dcs_code;
+    uint32_t dcs_sql;
+    int32_t scan_group;
+    int32_t flags;
+    char channel_desc[CHAN_IMAGE_DESCLEN];
+    uint32_t ext_first;     /* index in the side table */
+    uint32_t ext_count;
+};
+
+struct chan_image_ext
+{
+    int64_t token;
+    union chan_image_val val;
+    uint32_t pad;
+};
+
+#endif  /* !DOC_HIDDEN */
+
+/**
+ * \brief Opened memory channel image
+ *
+ * Opaque, see rig_chan_image_open().
+ */
+struct rig_chan_image
+{
+    void *base;                         /*!< Start of the file contents */
+    size_t size;                        /*!< Size of the file */
+    int mapped;                         /*!< base is mmap()'ed */
+    const struct chan_image_hdr *hdr;   /*!< Header */
+    const struct chan_image_rec *recs;  /*!< Records */
+    const struct chan_image_ext *exts;  /*!< Side table */
+};
+
+#ifndef DOC_HIDDEN
+
+static int ext_count(const channel_t *chan)
+{
+    const struct ext_list *elp;
+    int n = 0;
+
+    for (elp = chan->ext_levels; elp && elp->token != 0; elp++)
+    {
+        n++;
+    }
+
+    return n;
+}
+
+
+static void chan_to_rec(RIG *rig,
+                        const channel_t *chan,
+                        struct chan_image_rec *rec,
+                        struct chan_image_ext *exts,
+                        uint32_t *next_ext)
+{
+    const struct ext_list *elp;
+    int i;
+
+    rec->channel_num = chan->channel_num;
+    rec->bank_num = chan->bank_num;
+    rec->vfo = chan->vfo;
+    rec->ant = chan->ant;
+    rec->freq = chan->freq;
+    rec->mode = chan->mode;
+    rec->width = chan->width;
+    rec->tx_freq = chan->tx_freq;
+    rec->tx_mode = chan->tx_mode;
+    rec->tx_width = chan->tx_width;
+    rec->split = chan->split;
+    rec->tx_vfo = chan->tx_vfo;
+    rec->rptr_shift = chan->rptr_shift;
+    rec->rptr_offs = chan->rptr_offs;
+    rec->tuning_step = chan->tuning_step;
+    rec->rit = chan->rit;
+    rec->xit = chan->xit;
+    rec->funcs = chan->funcs;
+
+    /* the bits of the int member carry the float ones as well */
+    for (i = 0; i < CHAN_IMAGE_LEVELS && i < RIG_SETTING_MAX; i++)
+    {
+        rec->levels[i].i = chan->levels[i].i;
+    }
+
+    rec->ctcss_tone = chan->ctcss_tone;
+    rec->ctcss_sql = chan->ctcss_sql;
+    rec->dcs_code = chan->dcs_code;
+    rec->dcs_sql = chan->dcs_sql;
+    rec->scan_group = chan->scan_group;
+    rec->flags = chan->flags;
+    strncpy(rec->channel_desc, chan->channel_desc,
+            CHAN_IMAGE_DESCLEN < MAXCHANDESC ? CHAN_IMAGE_DESCLEN : MAXCHANDESC);
+    rec->channel_desc[CHAN_IMAGE_DESCLEN - 1] = '\0';
+
+    rec->ext_first = *next_ext;
+
+    for (elp = chan->ext_levels; elp && elp->token != 0; elp++)
+    {
+        const struct confparams *cfp = rig_ext_lookup_tok(rig, elp->token);
+
+        /* string values would need a string pool, not worth it so far */
+        if (!cfp || cfp->type == RIG_CONF_STRING)
+        {
+            continue;
+        }
+
+        exts[*next_ext].token = elp->token;
+        exts[*next_ext].val.i = elp->val.i;
+        (*next_ext)++;
+    }
+
+    rec->ext_count = *next_ext - rec->ext_first;
+}
+
+
+static void rec_to_chan(const struct rig_chan_image *img,
+                        const struct chan_image_rec *rec,
+                        int with_ext,
+                        channel_t *chan)
+{
+    struct ext_list *ext_levels = chan->ext_levels;
+    struct ext_list *elp;
+    int i;
+
+    memset(chan, 0, sizeof(channel_t));
+
+    chan->channel_num = rec->channel_num;
+    chan->bank_num = rec->bank_num;
+    chan->vfo = rec->vfo;
+    chan->ant = rec->ant;
+    chan->freq = rec->freq;
+    chan->mode = rec->mode;
+    chan->width = rec->width;
+    chan->tx_freq = rec->tx_freq;
+    chan->tx_mode = rec->tx_mode;
+    chan->tx_width = rec->tx_width;
+    chan->split = rec->split;
+    chan->tx_vfo = rec->tx_vfo;
+    chan->rptr_shift = rec->rptr_shift;
+    chan->rptr_offs = rec->rptr_offs;
+    chan->tuning_step = rec->tuning_step;
+    chan->rit = rec->rit;
+    chan->xit = rec->xit;
+    chan->funcs = rec->funcs;
+
+    for (i = 0; i < CHAN_IMAGE_LEVELS && i < RIG_SETTING_MAX; i++)
+    {
+        chan->levels[i].i = rec->levels[i].i;
+    }
+
+    chan->ctcss_tone = rec->ctcss_tone;
+    chan->ctcss_sql = rec->ctcss_sql;
+    chan->dcs_code = rec->dcs_code;
+    chan->dcs_sql = rec->dcs_sql;
+    chan->scan_group = rec->scan_group;
+    chan->flags = rec->flags;
+    memcpy(chan->channel_desc, rec->channel_desc, MAXCHANDESC - 1);
+
+    chan->ext_levels = ext_levels;
+
+    if (!with_ext)
+    {
+        return;
+    }
+
+    /* only fill the extension levels the caller asks for */
+    for (elp = ext_levels; elp && elp->token != 0; elp++)
+    {
+        uint32_t j;
+
+        for (j = 0; j < rec->ext_count; j++)
+        {
+            const struct chan_image_ext *ext = &img->exts[rec->ext_first + j];
+
+            if (ext->token == elp->token)
+            {
+                elp->val.i = ext->val.i;
+                break;
+            }
+        }
+    }
+}
+
+
+static int write_file(const char *path, const void *buf, size_t len)
+{
+    size_t plen = strlen(path) + sizeof(".tmp");
+    char *tmp_path;
+    FILE *fp;
+    int ok;
+
+    tmp_path = malloc(plen);
+
+    if (!tmp_path)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    snprintf(tmp_path, plen, "%s.tmp", path);
+
+    fp = fopen(tmp_path, "wb");
+
+    if (!fp)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot create '%s'\n", __func__,
+                  tmp_path);
+        free(tmp_path);
+        return -RIG_EIO;
+    }
+
+    ok = fwrite(buf, len, 1, fp) == 1;
+
+    if (fclose(fp) != 0 || !ok)
+    {
+        remove(tmp_path);
+        free(tmp_path);
+        return -RIG_EIO;
+    }
+
+#ifdef _WIN32
+    remove(path);
+#endif
+
+    if (rename(tmp_path, path) != 0)
+    {
+        remove(tmp_path);
+        free(tmp_path);
+        return -RIG_EIO;
+    }
+
+    free(tmp_path);
+
+    return RIG_OK;
+}
+
+
+static int read_file(int fd, struct rig_chan_image *img)
+{
+#ifdef CHAN_IMAGE_MMAP
+    img->base = mmap(NULL, img->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (img->base != MAP_FAILED)
+    {
+        img->mapped = 1;
+        return RIG_OK;
+    }
+
+    rig_debug(RIG_DEBUG_WARN, "%s: mmap failed, reading the file\n",
+              __func__);
+#endif
+
+    img->mapped = 0;
+    img->base = malloc(img->size);
+
+    if (!img->base)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    if (read(fd, img->base, img->size) != (ssize_t) img->size)
+    {
+        free(img->base);
+        img->base = NULL;
+        return -RIG_EIO;
+    }
+
+    return RIG_OK;
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief write a set of memory channels to a binary image file
+ * \param rig           The rig handle
+ * \param path          The image file
+ * \param chans         The channels to store
+ * \param nchans        Number of entries of \a chans
+ *
+ *  Stores \a chans in the image file \a path, in the same order.  The
+ *  file is replaced atomically.  The extension levels are stored along,
+ *  save for the string ones; their tokens are only meaningful to the
+ *  rig model of \a rig, which is recorded in the image.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_chan_image_open(), rig_chan_image_load()
+ */
+int HAMLIB_API rig_chan_image_save(RIG *rig,
+                                   const char *path,
+                                   const channel_t chans[],
+                                   int nchans)
+{
+    struct chan_image_hdr *hdr;
+    struct chan_image_rec *recs;
+    struct chan_image_ext *exts;
+    uint32_t next_ext = 0;
+    size_t next_max = 0;
+    size_t len;
+    char *buf;
+    int i, retval;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig) || !path || (!chans && nchans) || nchans < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (i = 0; i < nchans; i++)
+    {
+        next_max += ext_count(&chans[i]);
+    }
+
+    len = sizeof(*hdr) + nchans * sizeof(*recs) + next_max * sizeof(*exts);
+
+    buf = calloc(1, len);
+
+    if (!buf)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    hdr = (struct chan_image_hdr *) buf;
+    recs = (struct chan_image_rec *)(buf + sizeof(*hdr));
+    exts = (struct chan_image_ext *)(buf + sizeof(*hdr)
+                                     + nchans * sizeof(*recs));
+
+    for (i = 0; i < nchans; i++)
+    {
+        chan_to_rec(rig, &chans[i], &recs[i], exts, &next_ext);
+    }
+
+    memcpy(hdr->magic, CHAN_IMAGE_MAGIC, sizeof(hdr->magic));
+    hdr->byte_order = CHAN_IMAGE_BYTE_ORDER;
+    hdr->version = CHAN_IMAGE_VERSION;
+    hdr->rig_model = rig->caps->rig_model;
+    hdr->count = nchans;
+    hdr->rec_size = sizeof(*recs);
+    hdr->ext_count = next_ext;
+    hdr->ext_offset = (char *) exts - buf;
+
+    /* skipped string extension levels leave room at the end */
+    len = (char *)(exts + next_ext) - buf;
+
+    retval = write_file(path, buf, len);
+
+    free(buf);
+
+    return retval;
+}
+
+
+/**
+ * \brief open a binary memory channel image
+ * \param path          The image file
+ * \param img           Where to store the opened image
+ *
+ *  Maps the image file \a path in memory, where available, and checks
+ *  its header.  The channels are then decoded one at a time with
+ *  rig_chan_image_load().  The image must be released with
+ *  rig_chan_image_close().
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_EPROTO if
+ * \a path is not a channel image of this version and byte order,
+ * otherwise a negative value if an error occured (in which case, cause
+ * is set appropriately).
+ *
+ * \sa rig_chan_image_save(), rig_chan_image_close()
+ */
+int HAMLIB_API rig_chan_image_open(const char *path,
+                                   struct rig_chan_image **img)
+{
+    struct rig_chan_image *im;
+    const struct chan_image_hdr *hdr;
+    struct stat st;
+    int fd, retval;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!path || !img)
+    {
+        return -RIG_EINVAL;
+    }
+
+    fd = open(path, O_RDONLY | O_BINARY);
+
+    if (fd < 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot open '%s'\n", __func__, path);
+        return -RIG_EIO;
+    }
+
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return -RIG_EIO;
+    }
+
+    if ((size_t) st.st_size < sizeof(*hdr))
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is not a channel image\n",
+                  __func__, path);
+        close(fd);
+        return -RIG_EPROTO;
+    }
+
+    im = calloc(1, sizeof(*im));
+
+    if (!im)
+    {
+        close(fd);
+        return -RIG_ENOMEM;
+    }
+
+    im->size = st.st_size;
+
+    retval = read_file(fd, im);
+
+    close(fd);
+
+    if (retval != RIG_OK)
+    {
+        free(im);
+        return retval;
+    }
+
+    hdr = im->base;
+
+    if (memcmp(hdr->magic, CHAN_IMAGE_MAGIC, sizeof(hdr->magic))
+            || hdr->byte_order != CHAN_IMAGE_BYTE_ORDER
+            || hdr->version != CHAN_IMAGE_VERSION
+            || hdr->rec_size != sizeof(struct chan_image_rec)
+            || hdr->ext_offset != sizeof(*hdr)
+            + (uint64_t) hdr->count * sizeof(struct chan_image_rec)
+            || hdr->ext_offset
+            + (uint64_t) hdr->ext_count * sizeof(struct chan_image_ext)
+            > im->size)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is not a channel image of "
+                  "this version\n", __func__, path);
+        rig_chan_image_close(im);
+        return -RIG_EPROTO;
+    }
+
+    im->hdr = hdr;
+    im->recs = (const struct chan_image_rec *)((char *) im->base
+               + sizeof(*hdr));
+    im->exts = (const struct chan_image_ext *)((char *) im->base
+               + hdr->ext_offset);
+
+    *img = im;
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief release a memory channel image
+ * \param img           The image, from rig_chan_image_open()
+ *
+ * \return RIG_OK
+ *
+ * \sa rig_chan_image_open()
+ */
+int HAMLIB_API rig_chan_image_close(struct rig_chan_image *img)
+{
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!img)
+    {
+        return -RIG_EINVAL;
+    }
+
+#ifdef CHAN_IMAGE_MMAP
+
+    if (img->mapped)
+    {
+        munmap(img->base, img->size);
+    }
+    else
+#endif
+    {
+        free(img->base);
+    }
+
+    free(img);
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief number of channels of a memory channel image
+ * \param img           The image, from rig_chan_image_open()
+ *
+ * \return the number of channels, or a negative value if \a img is NULL.
+ */
+int HAMLIB_API rig_chan_image_count(const struct rig_chan_image *img)
+{
+    if (!img)
+    {
+        return -RIG_EINVAL;
+    }
+
+    return img->hdr->count;
+}
+
+
+/**
+ * \brief decode a channel of a memory channel image
+ * \param rig           The rig handle, or NULL
+ * \param img           The image, from rig_chan_image_open()
+ * \param idx           Index of the channel in the image
+ * \param chan          Where to store the channel
+ *
+ *  Fills \a chan with the channel stored at index \a idx of \a img.  As
+ *  with rig_get_channel(), \a chan->ext_levels is kept and tells which
+ *  extension levels to fill; they are only filled when \a rig is of the
+ *  model the image was made for.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_chan_image_open(), rig_chan_image_count()
+ */
+int HAMLIB_API rig_chan_image_load(RIG *rig,
+                                   const struct rig_chan_image *img,
+                                   int idx,
+                                   channel_t *chan)
+{
+    const struct chan_image_rec *rec;
+    int with_ext;
+
+    if (!img || !chan || idx < 0 || (uint32_t) idx >= img->hdr->count)
+    {
+        return -RIG_EINVAL;
+    }
+
+    rec = &img->recs[idx];
+
+    if ((uint64_t) rec->ext_first + rec->ext_count > img->hdr->ext_count)
+    {
+        return -RIG_EPROTO;
+    }
+
+    with_ext = rig && rig->caps
+               && rig->caps->rig_model == (rig_model_t) img->hdr->rig_model;
+
+    rec_to_chan(img, rec, with_ext, chan);
+
+    return RIG_OK;
+}
+
+/*! @} */
@@ -0,0 +1,655 @@
+/*
+ *  Hamlib Interface - differential memory channel synchronisation
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file memsync.c
+ * \brief Differential memory channel synchronisation
+ *
+ * Programming a full memory bank with rig_set_chan_all() rewrites every
+ * slot, even the ones already holding the wanted contents.  The sync
+ * engine keeps an image file with a digest of the last contents written
+ * to each slot, so that pushing a frequency plan again only writes the
+ * channels that changed since.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <hamlib/rig.h>
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_RIG_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define CHAN_SYNC_MAGIC         "HLCHSYNC"
+#define CHAN_SYNC_VERSION       1
+#define CHAN_SYNC_BYTE_ORDER    0x01020304
+#define CHAN_SYNC_IDLEN         64
+
+/*
+ * The image is host endian, it does not leave the machine driving the rig.
+ * Entries are sorted by channel number.
+ */
+struct chan_sync_hdr
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t rig_model;
+    uint32_t count;
+    char id[CHAN_SYNC_IDLEN];   /* rig_get_info(), tells rigs of a model apart */
+};
+
+struct chan_sync_ent
+{
+    int32_t channel_num;
+    uint32_t valid;
+    uint64_t digest;
+};
+
+struct chan_sync_image
+{
+    struct chan_sync_ent *ents;
+    size_t count;
+    size_t alloc;
+};
+
+
+#define FNV_OFFSET  0xcbf29ce484222325ULL
+#define FNV_PRIME   0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    while (len--)
+    {
+        h ^= *p++;
+        h *= FNV_PRIME;
+    }
+
+    return h;
+}
+
+
+static const channel_cap_t mem_cap_all =
+{
+    .bank_num = 1,
+    .vfo = 1,
+    .ant = 1,
+    .freq = 1,
+    .mode = 1,
+    .width = 1,
+    .tx_freq = 1,
+    .tx_mode = 1,
+    .tx_width = 1,
+    .split = 1,
+    .tx_vfo = 1,
+    .rptr_shift = 1,
+    .rptr_offs = 1,
+    .tuning_step = 1,
+    .rit = 1,
+    .xit = 1,
+    .funcs = (setting_t) - 1,
+    .levels = (setting_t) - 1,
+    .ctcss_tone = 1,
+    .ctcss_sql = 1,
+    .dcs_code = 1,
+    .dcs_sql = 1,
+    .scan_group = 1,
+    .flags = 1,
+    .channel_desc = 1,
+    .ext_levels = 1,
+};
+
+
+static const channel_cap_t *sync_mem_caps(RIG *rig, int channel_num)
+{
+    static const channel_cap_t mem_cap_none;
+    const chan_t *chan_cap;
+
+    chan_cap = rig_lookup_mem_caps(rig, channel_num);
+
+    if (chan_cap && memcmp(&chan_cap->mem_caps, &mem_cap_none,
+                           sizeof(mem_cap_none)))
+    {
+        return &chan_cap->mem_caps;
+    }
+
+    /* incomplete backend, compare every field like rig_get_channel does */
+    return &mem_cap_all;
+}
+
+
+static const struct ext_list *find_ext(const struct ext_list *elp,
+                                       token_t token)
+{
+    for (; elp && !RIG_IS_EXT_END(*elp); elp++)
+    {
+        if (elp->token == token)
+        {
+            return elp;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Digest of the fields of chan the memory caps of the slot say the rig
+ * stores.  The ext levels taken into account are the ones listed in ref,
+ * so that a channel read back can be compared with the one written.
+ */
+static uint64_t chan_digest(RIG *rig,
+                            const channel_t *chan,
+                            const channel_t *ref)
+{
+    const channel_cap_t *caps = sync_mem_caps(rig, ref->channel_num);
+    const struct ext_list *p;
+    uint64_t h = FNV_OFFSET;
+    setting_t funcs;
+    int i;
+
+#define DIGEST(field) \
+    do { \
+        if (caps->field) \
+            h = fnv1a(h, &chan->field, sizeof(chan->field)); \
+    } while (0)
+
+    /* the vfo of a memory channel is the memory itself, not compared */
+    DIGEST(bank_num);
+    DIGEST(ant);
+    DIGEST(freq);
+    DIGEST(mode);
+    DIGEST(width);
+    DIGEST(tx_freq);
+    DIGEST(tx_mode);
+    DIGEST(tx_width);
+    DIGEST(split);
+    DIGEST(tx_vfo);
+    DIGEST(rptr_shift);
+    DIGEST(rptr_offs);
+    DIGEST(tuning_step);
+    DIGEST(rit);
+    DIGEST(xit);
+    DIGEST(ctcss_tone);
+    DIGEST(ctcss_sql);
+    DIGEST(dcs_code);
+    DIGEST(dcs_sql);
+    DIGEST(scan_group);
+    DIGEST(flags);
+
+#undef DIGEST
+
+    funcs = chan->funcs & caps->funcs;
+    h = fnv1a(h, &funcs, sizeof(funcs));
+
+    for (i = 0; i < RIG_SETTING_MAX; i++)
+    {
+        setting_t level = rig_idx2setting(i);
+
+        if (!(level & caps->levels))
+        {
+            continue;
+        }
+
+        if (RIG_LEVEL_IS_FLOAT(level))
+        {
+            h = fnv1a(h, &chan->levels[i].f, sizeof(chan->levels[i].f));
+        }
+        else
+        {
+            h = fnv1a(h, &chan->levels[i].i, sizeof(chan->levels[i].i));
+        }
+    }
+
+    if (caps->channel_desc)
+    {
+        size_t len;
+
+        for (len = 0; len < MAXCHANDESC && chan->channel_desc[len]; len++)
+            ;
+
+        h = fnv1a(h, chan->channel_desc, len);
+    }
+
+    if (!caps->ext_levels)
+    {
+        return h;
+    }
+
+    for (p = ref->ext_levels; p && !RIG_IS_EXT_END(*p); p++)
+    {
+        const struct confparams *cfp = rig_ext_lookup_tok(rig, p->token);
+        const struct ext_list *elp = find_ext(chan->ext_levels, p->token);
+
+        h = fnv1a(h, &p->token, sizeof(p->token));
+
+        if (!elp)
+        {
+            /* missing on one side, make sure the digests differ */
+            h = fnv1a(h, "-", 1);
+            continue;
+        }
+
+        if (cfp && cfp->type == RIG_CONF_STRING)
+        {
+            if (elp->val.s)
+            {
+                h = fnv1a(h, elp->val.s, strlen(elp->val.s));
+            }
+        }
+        else if (cfp && cfp->type == RIG_CONF_NUMERIC)
+        {
+            h = fnv1a(h, &elp->val.f, sizeof(elp->val.f));
+        }
+        else
+        {
+            h = fnv1a(h, &elp->val.i, sizeof(elp->val.i));
+        }
+    }
+
+    return h;
+}
+
+
+static int ent_cmp(const void *a, const void *b)
+{
+    const struct chan_sync_ent *ea = a, *eb = b;
+
+    return ea->channel_num < eb->channel_num ? -1 :
+           ea->channel_num > eb->channel_num;
+}
+
+
+static struct chan_sync_ent *image_find(struct chan_sync_image *img,
+                                        int channel_num)
+{
+    struct chan_sync_ent key;
+
+    key.channel_num = channel_num;
+
+    return bsearch(&key, img->ents, img->count, sizeof(key), ent_cmp);
+}
+
+
+/* caller makes sure there is room for one more entry */
+static struct chan_sync_ent *image_insert(struct chan_sync_image *img,
+                                          int channel_num)
+{
+    size_t i;
+
+    for (i = img->count; i > 0 && img->ents[i - 1].channel_num > channel_num;
+            i--)
+        ;
+
+    memmove(&img->ents[i + 1], &img->ents[i],
+            (img->count - i) * sizeof(img->ents[0]));
+    img->count++;
+
+    memset(&img->ents[i], 0, sizeof(img->ents[i]));
+    img->ents[i].channel_num = channel_num;
+
+    return &img->ents[i];
+}
+
+
+static void image_key(RIG *rig, struct chan_sync_hdr *hdr)
+{
+    const char *info = NULL;
+
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, CHAN_SYNC_MAGIC, sizeof(hdr->magic));
+    hdr->byte_order = CHAN_SYNC_BYTE_ORDER;
+    hdr->version = CHAN_SYNC_VERSION;
+    hdr->rig_model = rig->caps->rig_model;
+
+    if (rig->caps->get_info)
+    {
+        info = rig_get_info(rig);
+    }
+
+    if (info)
+    {
+        strncpy(hdr->id, info, sizeof(hdr->id) - 1);
+    }
+}
+
+
+/*
+ * Load the image, leaving it empty when there is none yet or when it was
+ * made for another rig.
+ */
+static int image_load(const char *path,
+                      const struct chan_sync_hdr *key,
+                      struct chan_sync_image *img,
+                      size_t extra)
+{
+    struct chan_sync_hdr hdr;
+    FILE *fp;
+
+    img->count = 0;
+    img->alloc = extra;
+
+    fp = path ? fopen(path, "rb") : NULL;
+
+    if (fp)
+    {
+        if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+                || memcmp(hdr.magic, key->magic, sizeof(hdr.magic))
+                || hdr.byte_order != key->byte_order
+                || hdr.version != key->version)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: '%s' is not a channel image, "
+                      "ignored\n", __func__, path);
+            hdr.count = 0;
+        }
+        else if (hdr.rig_model != key->rig_model
+                 || strncmp(hdr.id, key->id, sizeof(hdr.id)))
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: '%s' was made for another rig, "
+                      "ignored\n", __func__, path);
+            hdr.count = 0;
+        }
+
+        img->alloc += hdr.count;
+    }
+
+    img->ents = calloc(img->alloc ? img->alloc : 1, sizeof(img->ents[0]));
+
+    if (!img->ents)
+    {
+        if (fp)
+        {
+            fclose(fp);
+        }
+
+        return -RIG_ENOMEM;
+    }
+
+    if (fp)
+    {
+        img->count = fread(img->ents, sizeof(img->ents[0]), hdr.count, fp);
+        fclose(fp);
+
+        qsort(img->ents, img->count, sizeof(img->ents[0]), ent_cmp);
+    }
+
+    return RIG_OK;
+}
+
+
+static int image_save(const char *path,
+                      const struct chan_sync_hdr *key,
+                      const struct chan_sync_image *img)
+{
+    struct chan_sync_hdr hdr = *key;
+    size_t len = strlen(path) + sizeof(".tmp");
+    char *tmp_path;
+    FILE *fp;
+    int ok;
+
+    tmp_path = malloc(len);
+
+    if (!tmp_path)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    snprintf(tmp_path, len, "%s.tmp", path);
+
+    fp = fopen(tmp_path, "wb");
+
+    if (!fp)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot create '%s'\n", __func__,
+                  tmp_path);
+        free(tmp_path);
+        return -RIG_EIO;
+    }
+
+    hdr.count = img->count;
+
+    ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1
+         && fwrite(img->ents, sizeof(img->ents[0]), img->count, fp)
+         == img->count;
+
+    if (fclose(fp) != 0 || !ok)
+    {
+        remove(tmp_path);
+        free(tmp_path);
+        return -RIG_EIO;
+    }
+
+#ifdef _WIN32
+    remove(path);
+#endif
+
+    if (rename(tmp_path, path) != 0)
+    {
+        remove(tmp_path);
+        free(tmp_path);
+        return -RIG_EIO;
+    }
+
+    free(tmp_path);
+
+    return RIG_OK;
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief write a set of memory channels, skipping the unchanged ones
+ * \param rig           The rig handle
+ * \param chans         The wanted contents of the channels
+ * \param nchans        Number of entries of \a chans
+ * \param image_path    Image of the last contents written, or NULL
+ * \param verify        Number of written channels to read back, -1 for all
+ * \param stats         Where to store the report, or NULL
+ *
+ *  Writes the memory channels of \a chans with rig_set_channel(), except
+ *  those whose contents are the same as the last time they were written
+ *  according to the image file \a image_path.  Only the fields the memory
+ *  caps of the slot list are compared.  The image is then updated, and
+ *  created if needed.
+ *
+ *  The image is made for the rig model and rig_get_info() string it was
+ *  written with; an image of another rig is ignored, and all the channels
+ *  are written.  Changes made on the rig itself, e.g. from the front
+ *  panel, are not seen, use a separate image per rig and remove it to
+ *  force a full write.
+ *
+ *  Once written, an evenly spread sample of \a verify channels is read
+ *  back with rig_get_channel() and compared.  A channel which differs is
+ *  dropped from the image so that the next sync writes it again.
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_EPROTO if
+ * a channel read back differs from what was written, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_set_chan_all(), rig_set_channel()
+ */
+int HAMLIB_API rig_sync_chan_all(RIG *rig,
+                                 const channel_t chans[],
+                                 int nchans,
+                                 const char *image_path,
+                                 int verify,
+                                 struct rig_chan_sync_stats *stats)
+{
+    struct rig_chan_sync_stats st;
+    struct chan_sync_hdr key;
+    struct chan_sync_image img;
+    int *written;
+    int i, retval;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig) || !chans || nchans < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    memset(&st, 0, sizeof(st));
+    st.channels = nchans;
+
+    image_key(rig, &key);
+
+    retval = image_load(image_path, &key, &img, nchans);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    written = malloc((nchans ? nchans : 1) * sizeof(int));
+
+    if (!written)
+    {
+        free(img.ents);
+        return -RIG_ENOMEM;
+    }
+
+    for (i = 0; i < nchans; i++)
+    {
+        struct chan_sync_ent *ent;
+        channel_t chan = chans[i];
+        uint64_t digest;
+
+        chan.vfo = RIG_VFO_MEM;
+        digest = chan_digest(rig, &chan, &chan);
+
+        ent = image_find(&img, chan.channel_num);
+
+        if (ent && ent->valid && ent->digest == digest)
+        {
+            st.unchanged++;
+            continue;
+        }
+
+        retval = rig_set_channel(rig, &chan);
+
+        if (retval != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: writing channel %d failed: %s\n",
+                      __func__, chan.channel_num, rigerror(retval));
+
+            /* the slot is in an unknown state now */
+            if (ent)
+            {
+                ent->valid = 0;
+            }
+
+            break;
+        }
+
+        if (!ent)
+        {
+            ent = image_insert(&img, chan.channel_num);
+        }
+
+        ent->digest = digest;
+        ent->valid = 1;
+        written[st.written++] = i;
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: %d channels written, %d unchanged\n",
+              __func__, st.written, st.unchanged);
+
+    if (retval == RIG_OK && verify != 0 && st.written > 0)
+    {
+        int nv = (verify < 0 || verify > st.written) ? st.written : verify;
+        int k;
+
+        for (k = 0; k < nv; k++)
+        {
+            const channel_t *want = &chans[written[((2 * k + 1) * st.written)
+                                                   / (2 * nv)]];
+            channel_t back;
+
+            memset(&back, 0, sizeof(back));
+            back.vfo = RIG_VFO_MEM;
+            back.channel_num = want->channel_num;
+
+            retval = rig_get_channel(rig, &back);
+
+            if (retval != RIG_OK)
+            {
+                free(back.ext_levels);
+                break;
+            }
+
+            st.verified++;
+
+            if (chan_digest(rig, &back, want) != chan_digest(rig, want, want))
+            {
+                rig_debug(RIG_DEBUG_WARN, "%s: channel %d reads back "
+                          "differently\n", __func__, want->channel_num);
+                st.mismatched++;
+                image_find(&img, want->channel_num)->valid = 0;
+            }
+
+            free(back.ext_levels);
+        }
+
+        if (retval == RIG_OK && st.mismatched)
+        {
+            retval = -RIG_EPROTO;
+        }
+    }
+
+    /* keep what was done, even after a failure */
+    if (image_path)
+    {
+        int ret = image_save(image_path, &key, &img);
+
+        if (retval == RIG_OK)
+        {
+            retval = ret;
+        }
+    }
+
+    free(written);
+    free(img.ents);
+
+    if (stats)
+    {
+        *stats = st;
+    }
+
+    return retval;
+}
+
+/*! @} */
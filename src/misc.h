@@ -42,6 +42,13 @@ __BEGIN_DECLS
 
 void dump_hex(const unsigned char ptr[], size_t size);
 
+/* skip the call (and the buffer walk) unless tracing is enabled */
+#define dump_hex(ptr, size) \
+    do { \
+        if (rig_debug_enabled(RIG_DEBUG_TRACE)) \
+            (dump_hex)((ptr), (size)); \
+    } while (0)
+
 /*
  * BCD conversion routines.
  *
@@ -98,6 +105,10 @@ extern HAMLIB_EXPORT(void) rig_force_cache_timeout(struct timeval *tv);
 
 extern HAMLIB_EXPORT(setting_t) rig_idx2setting(int i);
 
+/* lo_freq and vfo_comp corrections of rig_set_freq() and rig_get_freq() */
+extern freq_t rig_freq_to_rig(const RIG *rig, freq_t freq);
+extern freq_t rig_freq_from_rig(const RIG *rig, freq_t freq);
+
 #ifdef PRId64
 /** \brief printf(3) format to be used for long long (64bits) type */
 #  define PRIll PRId64
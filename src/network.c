@@ -67,6 +67,10 @@
 #  endif
 #endif
 
+#ifdef HAVE_SYS_UN_H
+#  include <sys/un.h>
+#endif
+
 #include <hamlib/rig.h>
 #include "network.h"
 #include "misc.h"
@@ -113,12 +117,59 @@ static void handle_error(enum rig_debug_level_e lvl, const char *msg)
 }
 
 
+#ifdef HAVE_SYS_UN_H
+/* connect to a local server through its socket file */
+static int unix_open(hamlib_port_t *rp)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(rp->pathname) >= sizeof(addr.sun_path))
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: socket path too long \"%s\"\n",
+                  __func__, rp->pathname);
+        return -RIG_ECONF;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, rp->pathname);
+
+#ifdef SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+    {
+        handle_error(RIG_DEBUG_ERR, "socket");
+        return -RIG_EIO;
+    }
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        handle_error(RIG_DEBUG_ERR, "connect");
+        close(fd);
+        return -RIG_EIO;
+    }
+
+    rp->fd = fd;
+
+    return RIG_OK;
+}
+#endif
+
+
 /**
  * \brief Open network port using rig.state data
  *
  * Open Open network port using rig.state data.
  * NB: The signal PIPE will be ignored for the whole application.
  *
+ * A pathname starting with '/' is the socket file of a local server, where
+ * Unix domain sockets are available.
+ *
  * \param rp Port data structure (must spec port id eg hostname:port)
  * \param default_port Default network socket port
  * \return RIG_OK or < 0 if error
@@ -150,6 +201,15 @@ int network_open(hamlib_port_t *rp, int default_port)
         return -RIG_EINVAL;
     }
 
+#ifdef HAVE_SYS_UN_H
+
+    if (rp->pathname[0] == '/' && rp->type.rig != RIG_PORT_UDP_NETWORK)
+    {
+        return unix_open(rp);
+    }
+
+#endif
+
     memset(&hints, 0, sizeof(hints));
     hints.ai_family = PF_UNSPEC;
 
@@ -298,6 +358,12 @@ void network_flush(hamlib_port_t *rp)
         if (len > 0)
         {
             len = read(rp->fd, &buffer, len < NET_BUFFER_SIZE ? len : NET_BUFFER_SIZE);
+
+            if ((int)len > 0)
+            {
+                rp->stats.flushed += len;
+            }
+
             rig_debug(RIG_DEBUG_WARN,
                       "%s: network data cleared: %s\n",
                       __func__,
@@ -0,0 +1,665 @@
+/*
+ *  Hamlib Interface - port session record and replay
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig_internal
+ * @{
+ */
+
+/**
+ * \file replay.c
+ * \brief Recording of a port session, and its replay as a virtual radio
+ *
+ * When record_pathname is set, every block written to or read from the
+ * port is appended to that file, in the format of the binary I/O trace
+ * (see trace.h), so that rigtrace can decode it as well.
+ *
+ * A RIG_PORT_REPLAY port plays such a file back.  The backend talks to
+ * one end of a socket pair; a thread on the other end waits for a command
+ * that was recorded, and answers it with the bytes the radio sent back
+ * then, at the recorded delays multiplied by replay_scale.  Commands are
+ * looked up from the last one answered onwards, wrapping around, so that
+ * a session may be played in a loop and a backend that skips some of the
+ * recorded commands still gets answers to the others.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#ifdef HAVE_ERRNO_H
+#  include <errno.h>
+#endif
+
+#ifdef HAVE_SYS_SELECT_H
+#  include <sys/select.h>
+#endif
+
+#ifdef HAVE_SYS_SOCKET_H
+#  include <sys/socket.h>
+#endif
+
+#include <hamlib/rig.h>
+#include "replay.h"
+
+
+/**
+ * \brief Start recording the I/O of a port
+ * \param p port descriptor, with record_pathname set
+ * \return RIG_OK or < 0
+ */
+int port_record_open(hamlib_port_t *p)
+{
+    struct rig_trace_file_hdr hdr;
+    FILE *fp;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    fp = fopen(p->record_pathname, "wb");
+
+    if (!fp)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot open %s: %s\n",
+                  __func__, p->record_pathname, strerror(errno));
+        return -RIG_EIO;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, RIG_TRACE_MAGIC, sizeof(RIG_TRACE_MAGIC));
+    hdr.version = RIG_TRACE_VERSION;
+    hdr.byte_order = RIG_TRACE_BYTE_ORDER;
+
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+    {
+        fclose(fp);
+        return -RIG_EIO;
+    }
+
+    p->record = fp;
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief Stop recording the I/O of a port
+ * \param p port descriptor
+ * \return RIG_OK or < 0
+ */
+int port_record_close(hamlib_port_t *p)
+{
+    FILE *fp = p->record;
+
+    if (!fp)
+    {
+        return RIG_OK;
+    }
+
+    p->record = NULL;
+
+    return fclose(fp) ? -RIG_EIO : RIG_OK;
+}
+
+
+/**
+ * \brief Append one transfer to the recording of a port
+ *
+ * Called through the port_record() macro, which checks p->record.
+ * Unlike the trace, the payload is never truncated.
+ */
+void port_record_io(hamlib_port_t *p,
+                    enum rig_trace_dir_e dir,
+                    enum rig_trace_func_e func,
+                    const void *buf,
+                    size_t len)
+{
+    static const unsigned char zero[8];
+    struct rig_trace_rec rec;
+    FILE *fp = p->record;
+
+    rec.ts_ns = rig_trace_now_ns();
+    rec.port = (uint16_t)p->fd;
+    rec.dir = dir;
+    rec.func = func;
+    rec.len = len;
+
+    fwrite(&rec, sizeof(rec), 1, fp);
+
+    if (len > 0)
+    {
+        fwrite(buf, 1, len, fp);
+        fwrite(zero, 1, RIG_TRACE_PAD(len) - len, fp);
+    }
+}
+
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_SOCKETPAIR) && defined(HAVE_SELECT) \
+    && defined(__GNUC__)
+#define HAVE_REPLAY 1
+
+#include <pthread.h>
+
+#define REPLAY_INBUF_SIZE   4096
+#define REPLAY_PARTIAL_MS   200     /* drop an incomplete command after this */
+#define REPLAY_NAP_NS       (10 * 1000 * 1000)
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+
+struct replay_rec
+{
+    uint64_t ts_ns;
+    int dir;
+    size_t len;
+    unsigned char *data;
+    size_t seq;             /* file order, keeps the sort stable */
+};
+
+struct replay_priv
+{
+    struct replay_rec *recs;
+    size_t nrecs;
+    size_t cursor;          /* where to start looking for the next command */
+    int fd;                 /* radio side of the socket pair */
+    float scale;
+    int stop;
+    pthread_t thread;
+    unsigned char in[REPLAY_INBUF_SIZE];
+    size_t in_len;
+};
+
+
+static int replay_rec_cmp(const void *a, const void *b)
+{
+    const struct replay_rec *ra = a, *rb = b;
+
+    if (ra->ts_ns != rb->ts_ns)
+    {
+        return ra->ts_ns < rb->ts_ns ? -1 : 1;
+    }
+
+    return ra->seq < rb->seq ? -1 : (ra->seq > rb->seq);
+}
+
+
+static void replay_free(struct replay_priv *priv)
+{
+    size_t i;
+
+    for (i = 0; i < priv->nrecs; i++)
+    {
+        free(priv->recs[i].data);
+    }
+
+    free(priv->recs);
+    free(priv);
+}
+
+
+/*
+ * Load the records of the first port found in the file.  A trace
+ * written by rig_trace_open() may hold several ports and threads.
+ */
+static int replay_load(struct replay_priv *priv, const char *path)
+{
+    struct rig_trace_file_hdr hdr;
+    struct rig_trace_rec rec;
+    size_t alloc = 0;
+    int port = -1;
+    int ntx = 0;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+
+    if (!fp)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot open %s: %s\n",
+                  __func__, path, strerror(errno));
+        return -RIG_EIO;
+    }
+
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+            || strncmp(hdr.magic, RIG_TRACE_MAGIC, sizeof(hdr.magic))
+            || hdr.byte_order != RIG_TRACE_BYTE_ORDER
+            || hdr.version != RIG_TRACE_VERSION)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: %s is not a recording\n",
+                  __func__, path);
+        fclose(fp);
+        return -RIG_EPROTO;
+    }
+
+    while (fread(&rec, sizeof(rec), 1, fp) == 1)
+    {
+        struct replay_rec *r;
+        size_t padded;
+
+        if (rec.dir == RIG_TRACE_DROPPED)
+        {
+            continue;
+        }
+
+        padded = RIG_TRACE_PAD(rec.len);
+
+        if (port >= 0 && rec.port != port)
+        {
+            if (fseek(fp, padded, SEEK_CUR))
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        port = rec.port;
+
+        if (priv->nrecs == alloc)
+        {
+            alloc = alloc ? alloc * 2 : 256;
+            r = realloc(priv->recs, alloc * sizeof(*r));
+
+            if (!r)
+            {
+                fclose(fp);
+                return -RIG_ENOMEM;
+            }
+
+            priv->recs = r;
+        }
+
+        r = &priv->recs[priv->nrecs];
+        r->ts_ns = rec.ts_ns;
+        r->dir = rec.dir;
+        r->len = rec.len;
+        r->seq = priv->nrecs;
+        r->data = NULL;
+
+        if (padded > 0)
+        {
+            r->data = malloc(padded);
+
+            if (!r->data)
+            {
+                fclose(fp);
+                return -RIG_ENOMEM;
+            }
+
+            if (fread(r->data, padded, 1, fp) != 1)
+            {
+                rig_debug(RIG_DEBUG_WARN, "%s: %s: truncated record\n",
+                          __func__, path);
+                free(r->data);
+                break;
+            }
+        }
+
+        if (r->dir == RIG_TRACE_TX && r->len > 0)
+        {
+            ntx++;
+        }
+
+        priv->nrecs++;
+    }
+
+    fclose(fp);
+
+    if (ntx == 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: %s holds no command to replay\n",
+                  __func__, path);
+        return -RIG_EPROTO;
+    }
+
+    qsort(priv->recs, priv->nrecs, sizeof(*priv->recs), replay_rec_cmp);
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: %d records, %d commands\n",
+              __func__, (int)priv->nrecs, ntx);
+
+    return RIG_OK;
+}
+
+
+/* nap in slices, so that replay_close() does not wait for a long delay */
+static int replay_sleep_until(struct replay_priv *priv, uint64_t deadline)
+{
+    uint64_t now;
+
+    while ((now = rig_trace_now_ns()) < deadline)
+    {
+        struct timespec ts;
+        uint64_t left = deadline - now;
+
+        if (__atomic_load_n(&priv->stop, __ATOMIC_ACQUIRE))
+        {
+            return -1;
+        }
+
+        if (left > REPLAY_NAP_NS)
+        {
+            left = REPLAY_NAP_NS;
+        }
+
+        ts.tv_sec = 0;
+        ts.tv_nsec = left;
+        nanosleep(&ts, NULL);
+    }
+
+    return 0;
+}
+
+
+/*
+ * Send the replies recorded from record first up to the next command,
+ * delayed relatively to the time stamp ts0 of the command they answer.
+ */
+static int replay_answer(struct replay_priv *priv, size_t first, uint64_t ts0)
+{
+    uint64_t start = rig_trace_now_ns();
+    size_t i;
+
+    for (i = first; i < priv->nrecs && priv->recs[i].dir != RIG_TRACE_TX; i++)
+    {
+        const struct replay_rec *r = &priv->recs[i];
+        size_t done = 0;
+
+        if (r->len == 0)
+        {
+            continue;
+        }
+
+        if (replay_sleep_until(priv,
+                               start + (uint64_t)((r->ts_ns - ts0) * priv->scale)))
+        {
+            return -1;
+        }
+
+        while (done < r->len)
+        {
+            ssize_t n = send(priv->fd, r->data + done, r->len - done,
+                             MSG_NOSIGNAL);
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                return -1;
+            }
+
+            done += n;
+        }
+    }
+
+    priv->cursor = i < priv->nrecs ? i : 0;
+
+    return 0;
+}
+
+
+/*
+ * Look for the recorded command the pending input starts with.
+ * Returns its record index, -1 when more input could still make
+ * a match, or -2 when nothing can match.
+ */
+static long replay_match(const struct replay_priv *priv)
+{
+    int partial = 0;
+    size_t k;
+
+    for (k = 0; k < priv->nrecs; k++)
+    {
+        size_t i = (priv->cursor + k) % priv->nrecs;
+        const struct replay_rec *r = &priv->recs[i];
+
+        if (r->dir != RIG_TRACE_TX || r->len == 0)
+        {
+            continue;
+        }
+
+        if (r->len <= priv->in_len)
+        {
+            if (!memcmp(r->data, priv->in, r->len))
+            {
+                return i;
+            }
+        }
+        else if (!memcmp(r->data, priv->in, priv->in_len))
+        {
+            partial = 1;
+        }
+    }
+
+    return partial ? -1 : -2;
+}
+
+
+static void *replay_thread(void *arg)
+{
+    struct replay_priv *priv = arg;
+
+    /* whatever the radio sent before the first command */
+    if (replay_answer(priv, 0, priv->recs[0].ts_ns))
+    {
+        return NULL;
+    }
+
+    while (!__atomic_load_n(&priv->stop, __ATOMIC_ACQUIRE))
+    {
+        fd_set rfds;
+        struct timeval tv;
+        ssize_t n;
+        long cmd;
+        int ret;
+
+        FD_ZERO(&rfds);
+        FD_SET(priv->fd, &rfds);
+        tv.tv_sec = 0;
+        tv.tv_usec = REPLAY_PARTIAL_MS * 1000;
+
+        ret = select(priv->fd + 1, &rfds, NULL, NULL,
+                     priv->in_len ? &tv : NULL);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        if (ret == 0)
+        {
+            rig_debug(RIG_DEBUG_WARN,
+                      "%s: dropping %d bytes of an incomplete command\n",
+                      __func__, (int)priv->in_len);
+            priv->in_len = 0;
+            continue;
+        }
+
+        n = read(priv->fd, priv->in + priv->in_len,
+                 sizeof(priv->in) - priv->in_len);
+
+        if (n <= 0)
+        {
+            break;      /* port closed */
+        }
+
+        priv->in_len += n;
+
+        while (priv->in_len > 0 && (cmd = replay_match(priv)) != -1)
+        {
+            size_t len;
+
+            if (cmd == -2 || priv->in_len == sizeof(priv->in))
+            {
+                /* a real radio would ignore it as well */
+                rig_debug(RIG_DEBUG_WARN,
+                          "%s: no recorded command matches, "
+                          "dropping %d bytes\n",
+                          __func__, (int)priv->in_len);
+                priv->in_len = 0;
+                break;
+            }
+
+            len = priv->recs[cmd].len;
+            priv->in_len -= len;
+            memmove(priv->in, priv->in + len, priv->in_len);
+
+            if (replay_answer(priv, cmd + 1, priv->recs[cmd].ts_ns))
+            {
+                return NULL;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+#endif  /* HAVE_REPLAY */
+
+
+/**
+ * \brief Open a RIG_PORT_REPLAY port
+ * \param p port descriptor, pathname being the recording
+ * \return RIG_OK or < 0
+ */
+int replay_open(hamlib_port_t *p)
+{
+#ifdef HAVE_REPLAY
+    struct replay_priv *priv;
+    int sv[2];
+    int status;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    priv = calloc(1, sizeof(struct replay_priv));
+
+    if (!priv)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    status = replay_load(priv, p->pathname);
+
+    if (status != RIG_OK)
+    {
+        replay_free(priv);
+        return status;
+    }
+
+    priv->scale = p->replay_scale > 0 ? p->replay_scale : 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: socketpair failed: %s\n",
+                  __func__, strerror(errno));
+        replay_free(priv);
+        return -RIG_EIO;
+    }
+
+    /* same as a serial port opened with O_NDELAY */
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+
+    priv->fd = sv[1];
+
+    if (pthread_create(&priv->thread, NULL, replay_thread, priv))
+    {
+        close(sv[0]);
+        close(sv[1]);
+        replay_free(priv);
+        return -RIG_EINTERNAL;
+    }
+
+    p->fd = sv[0];
+    p->handle = priv;
+
+    return RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief Close a RIG_PORT_REPLAY port
+ * \param p port descriptor
+ * \return RIG_OK or < 0
+ */
+int replay_close(hamlib_port_t *p)
+{
+#ifdef HAVE_REPLAY
+    struct replay_priv *priv = p->handle;
+    int ret;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    ret = close(p->fd);
+
+    if (priv)
+    {
+        /* the thread sees the end of file, or the stop flag while napping */
+        __atomic_store_n(&priv->stop, 1, __ATOMIC_RELEASE);
+        pthread_join(priv->thread, NULL);
+        close(priv->fd);
+        replay_free(priv);
+        p->handle = NULL;
+    }
+
+    return ret;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief Discard unread replies of a RIG_PORT_REPLAY port
+ * \param p port descriptor
+ * \return RIG_OK
+ *
+ * The socket does not know tcflush(), see serial_flush().
+ */
+int replay_flush(hamlib_port_t *p)
+{
+    char buf[64];
+    ssize_t n;
+
+    while ((n = read(p->fd, buf, sizeof(buf))) > 0)
+    {
+        p->stats.flushed += n;
+    }
+
+    return RIG_OK;
+}
+
+/** @} */
@@ -0,0 +1,52 @@
+/*
+ *  Hamlib Interface - port session record and replay header
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _REPLAY_H
+#define _REPLAY_H 1
+
+#include <hamlib/rig.h>
+#include "trace.h"
+
+__BEGIN_DECLS
+
+/* recorder, enabled by a non empty record_pathname */
+extern int port_record_open(hamlib_port_t *p);
+extern int port_record_close(hamlib_port_t *p);
+extern void port_record_io(hamlib_port_t *p,
+                           enum rig_trace_dir_e dir,
+                           enum rig_trace_func_e func,
+                           const void *buf,
+                           size_t len);
+
+#define port_record(p, dir, func, buf, len) \
+    do { \
+        if ((p)->record) \
+            port_record_io((p), (dir), (func), (buf), (len)); \
+    } while (0)
+
+/* RIG_PORT_REPLAY */
+extern int replay_open(hamlib_port_t *p);
+extern int replay_close(hamlib_port_t *p);
+extern int replay_flush(hamlib_port_t *p);
+
+__END_DECLS
+
+#endif /* _REPLAY_H */
@@ -69,6 +69,7 @@
 #include "event.h"
 #include "cm108.h"
 #include "gpio.h"
+#include "misc.h"
 
 /**
  * \brief Hamlib release number
@@ -396,6 +397,7 @@ RIG * HAMLIB_API rig_init(rig_model_t rig_model)
     rs->rigport.post_write_delay = caps->post_write_delay;
     rs->rigport.timeout = caps->timeout;
     rs->rigport.retry = caps->retry;
+    rs->rigport.replay_scale = 1.0;
     rs->pttport.type.ptt = caps->ptt_type;
     rs->dcdport.type.dcd = caps->dcd_type;
 
@@ -1065,6 +1067,47 @@ int HAMLIB_API rig_cleanup(RIG *rig)
 }
 
 
+#ifndef DOC_HIDDEN
+/*
+ * Frequency as the backend sets it, from the one the user asked for.
+ * For callers that reach the backend without rig_set_freq().
+ */
+freq_t rig_freq_to_rig(const RIG *rig, freq_t freq)
+{
+    if (rig->state.lo_freq != 0.0)
+    {
+        freq -= rig->state.lo_freq;
+    }
+
+    if (rig->state.vfo_comp != 0.0)
+    {
+        freq += (freq_t)((double)rig->state.vfo_comp * freq);
+    }
+
+    return freq;
+}
+
+
+/*
+ * Frequency as rig_get_freq() returns it, from the one the backend read.
+ */
+freq_t rig_freq_from_rig(const RIG *rig, freq_t freq)
+{
+    if (rig->state.vfo_comp != 0.0)
+    {
+        freq = (freq_t)(freq / (1.0 + (double)rig->state.vfo_comp));
+    }
+
+    if (rig->state.lo_freq != 0.0)
+    {
+        freq += rig->state.lo_freq;
+    }
+
+    return freq;
+}
+#endif  /* !DOC_HIDDEN */
+
+
 /**
  * \brief set the frequency of the target VFO
  * \param rig   The rig handle
@@ -1093,16 +1136,7 @@ int HAMLIB_API rig_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
     }
 
     caps = rig->caps;
-    if (rig->state.lo_freq != 0.0)
-    {
-	freq -= rig->state.lo_freq;
-    }
-	    
-
-    if (rig->state.vfo_comp != 0.0)
-    {
-        freq += (freq_t)((double)rig->state.vfo_comp * freq);
-    }
+    freq = rig_freq_to_rig(rig, freq);
 
     if (caps->set_freq == NULL)
     {
@@ -2092,6 +2126,67 @@ int HAMLIB_API rig_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
 }
 
 
+/**
+ * \brief tune the target VFO and get the status of the DCD
+ * \param rig   The rig handle
+ * \param vfo   The target VFO
+ * \param freq  The frequency to set to
+ * \param dcd   The location where to store the status of the DCD
+ *
+ *  Same as rig_set_freq() followed by rig_get_dcd(), in a single exchange
+ *  with the rig where the backend supports it.  Scanners call it for each
+ *  frequency.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_set_freq(), rig_get_dcd()
+ */
+int HAMLIB_API rig_tune_get_dcd(RIG *rig, vfo_t vfo, freq_t freq, dcd_t *dcd)
+{
+    const struct rig_caps *caps;
+    int retcode;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig) || !dcd)
+    {
+        return -RIG_EINVAL;
+    }
+
+    caps = rig->caps;
+
+    /* the hook does not switch VFO, and knows only the rig's own DCD */
+    if (caps->tune_get_dcd == NULL
+        || caps->set_freq == NULL
+        || caps->get_dcd == NULL
+        || rig->state.dcdport.type.dcd != RIG_DCD_RIG
+        || (vfo != RIG_VFO_CURR && vfo != rig->state.current_vfo))
+    {
+        retcode = rig_set_freq(rig, vfo, freq);
+
+        if (retcode != RIG_OK)
+        {
+            return retcode;
+        }
+
+        return rig_get_dcd(rig, vfo, dcd);
+    }
+
+    freq = rig_freq_to_rig(rig, freq);
+
+    retcode = caps->tune_get_dcd(rig, vfo, freq, dcd);
+
+    if (retcode == RIG_OK)
+    {
+        rig->state.current_freq = freq;
+    }
+
+    return retcode;
+}
+
+
 /**
  * \brief set the repeater shift
  * \param rig   The rig handle
@@ -3910,6 +4005,9 @@ rig_model_t HAMLIB_API rig_probe(hamlib_port_t *port)
         return RIG_MODEL_NONE;
     }
 
+    /* only port_open() starts a recording, probes do not go through it */
+    port->record = NULL;
+
     return rig_probe_first(port);
 }
 
@@ -3942,6 +4040,9 @@ int HAMLIB_API rig_probe_all(hamlib_port_t *port,
         return -RIG_EINVAL;
     }
 
+    /* only port_open() starts a recording, probes do not go through it */
+    port->record = NULL;
+
     return rig_probe_all_backends(port, cfunc, data);
 }
 
@@ -4417,6 +4518,62 @@ const char * HAMLIB_API rig_get_info(RIG *rig)
 }
 
 
+/**
+ * \brief get the I/O statistics of the rig port
+ * \param rig   The rig handle
+ * \param stats The location where to store the statistics
+ *
+ * Retrieves byte, transaction, timeout, retry, flush and protocol error
+ * counters of the rig port since it was opened or last reset, and the
+ * histograms of the latencies from each command to the first and last
+ * byte of its reply.  Use rig_port_hist_percentile() to summarize them.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_reset_port_stats()
+ */
+int HAMLIB_API rig_get_port_stats(RIG *rig, hamlib_port_stats_t *stats)
+{
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig) || !stats)
+    {
+        return -RIG_EINVAL;
+    }
+
+    *stats = rig->state.rigport.stats;
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief reset the I/O statistics of the rig port
+ * \param rig   The rig handle
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_get_port_stats()
+ */
+int HAMLIB_API rig_reset_port_stats(RIG *rig)
+{
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig))
+    {
+        return -RIG_EINVAL;
+    }
+
+    memset(&rig->state.rigport.stats, 0, sizeof(hamlib_port_stats_t));
+
+    return RIG_OK;
+}
+
+
 const char * HAMLIB_API rig_license()
 {
     return hamlib_license;
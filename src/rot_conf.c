@@ -82,7 +82,7 @@ static const struct confparams rotfrontend_cfg_params[] =
     {
         TOK_MAX_AZ, "max_az", "Maximum azimuth",
         "Maximum rotator azimuth in degrees",
-        "180", RIG_CONF_NUMERIC, { .n = { -360, 360, .001 } }
+        "180", RIG_CONF_NUMERIC, { .n = { -360, 540, .001 } }
     },
     {
         TOK_MIN_EL, "min_el", "Minimum elevation",
@@ -94,6 +94,37 @@ static const struct confparams rotfrontend_cfg_params[] =
         "Maximum rotator elevation in degrees",
         "90", RIG_CONF_NUMERIC, { .n = { -90, 180, .001 } }
     },
+    {
+        TOK_AZ_RATE, "az_rate", "Azimuth slew rate",
+        "Azimuth slew rate in degrees per second, 0 to measure it",
+        "0", RIG_CONF_NUMERIC, { .n = { 0, 100, .01 } }
+    },
+    {
+        TOK_EL_RATE, "el_rate", "Elevation slew rate",
+        "Elevation slew rate in degrees per second, 0 to measure it",
+        "0", RIG_CONF_NUMERIC, { .n = { 0, 100, .01 } }
+    },
+    {
+        TOK_TRACK_DEADBAND, "track_deadband", "Tracking dead band",
+        "Smallest move in degrees when tracking a trajectory",
+        "1", RIG_CONF_NUMERIC, { .n = { 0, 45, .01 } }
+    },
+    {
+        TOK_ROT_POLL_INTERVAL, "poll_interval", "Polling interval",
+        "Position polling interval in milliseconds while moving, "
+        "0 to read the rotator on each get_position",
+        "0", RIG_CONF_NUMERIC, { .n = { 0, 1000000, 1 } }
+    },
+    {
+        TOK_ROT_POLL_IDLE, "poll_idle", "Idle polling interval",
+        "Position polling interval in milliseconds once the rotator is still",
+        "2000", RIG_CONF_NUMERIC, { .n = { 0, 1000000, 1 } }
+    },
+    {
+        TOK_ROT_MOTION_FILE, "motion_file", "Motion file",
+        "File keeping the slew rates learned from the moves of the rotator",
+        "", RIG_CONF_STRING,
+    },
 
     { RIG_CONF_END, NULL, }
 };
@@ -307,6 +338,30 @@ int frontrot_set_conf(ROT *rot, token_t token, const char *val)
         rs->max_el = atof(val);
         break;
 
+    case TOK_AZ_RATE:
+        rs->az_rate = atof(val);
+        break;
+
+    case TOK_EL_RATE:
+        rs->el_rate = atof(val);
+        break;
+
+    case TOK_TRACK_DEADBAND:
+        rs->track_deadband = atof(val);
+        break;
+
+    case TOK_ROT_POLL_INTERVAL:
+        rs->poll_interval = atoi(val);
+        break;
+
+    case TOK_ROT_POLL_IDLE:
+        rs->poll_idle = atoi(val);
+        break;
+
+    case TOK_ROT_MOTION_FILE:
+        strncpy(rs->motion_file, val, FILPATHLEN - 1);
+        break;
+
     default:
         return -RIG_EINVAL;
     }
@@ -458,6 +513,30 @@ int frontrot_get_conf(ROT *rot, token_t token, char *val)
         sprintf(val, "%f", rs->max_el);
         break;
 
+    case TOK_AZ_RATE:
+        sprintf(val, "%f", rs->az_rate);
+        break;
+
+    case TOK_EL_RATE:
+        sprintf(val, "%f", rs->el_rate);
+        break;
+
+    case TOK_TRACK_DEADBAND:
+        sprintf(val, "%f", rs->track_deadband);
+        break;
+
+    case TOK_ROT_POLL_INTERVAL:
+        sprintf(val, "%d", rs->poll_interval);
+        break;
+
+    case TOK_ROT_POLL_IDLE:
+        sprintf(val, "%d", rs->poll_idle);
+        break;
+
+    case TOK_ROT_MOTION_FILE:
+        strcpy(val, rs->motion_file);
+        break;
+
     default:
         return -RIG_EINVAL;
     }
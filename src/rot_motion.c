@@ -0,0 +1,666 @@
+/*
+ *  Hamlib Interface - rotator motion model
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rotator
+ * @{
+ */
+
+/**
+ * \file rot_motion.c
+ * \brief Rotator motion model
+ *
+ * From the positions read while the rotator goes to the target of
+ * rot_set_position(), the library learns per axis the slew rate, the
+ * acceleration and the dead band of the rotator, i.e. how far from the
+ * target it stops.  Then rot_get_eta() predicts when the rotator gets to
+ * its target, so that the application can wait for that instead of
+ * polling the position.
+ *
+ * With the motion_file configuration parameter set, what was learned is
+ * kept in that file, written by rot_close() and read again by rot_open().
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#  include <pthread.h>
+#endif
+
+#include <hamlib/rotator.h>
+#include "rot_motion.h"
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_ROT_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define MOTION_STILL_DEG    0.1     /* smaller moves are noise */
+#define MOTION_SETTLE_S     1.0     /* still that long, the move is over */
+#define MOTION_RATE_S       0.5     /* shortest span to measure a rate */
+#define MOTION_MIN_DEG      2.0     /* shorter moves teach nothing */
+#define MOTION_NEAR_DEG     1.0     /* no move needed that close */
+#define MOTION_GIVEUP_S     300.0   /* never got there */
+#define MOTION_FRESH_S      10.0    /* older positions may be wrong */
+#define MOTION_ALPHA        0.3     /* weight of the last move */
+
+#ifdef HAVE_PTHREAD
+#  define motion_lock(m)    pthread_mutex_lock(&(m)->lock)
+#  define motion_unlock(m)  pthread_mutex_unlock(&(m)->lock)
+#else
+#  define motion_lock(m)
+#  define motion_unlock(m)
+#endif
+
+enum { AXIS_AZ, AXIS_EL, AXIS_COUNT };
+
+static const char *const axis_names[AXIS_COUNT] = { "az", "el" };
+
+struct motion_axis
+{
+    /* learned */
+    double rate;        /* deg/s, 0 if unknown */
+    double accel;       /* deg/s^2, 0 if instant or unknown */
+    double deadband;    /* deg */
+    int moves;
+
+    /* current move */
+    double start;
+    double target;
+    double pos;         /* last read */
+    double ref;         /* to measure the rate from */
+    double vmax;
+    int moved;
+    double end_time;    /* when the last step seen ended */
+    double still_since; /* 0 while moving */
+};
+
+struct rot_motion
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t lock;
+#endif
+    struct motion_axis ax[AXIS_COUNT];
+
+    int have_pos;
+    double pos_time;
+
+    int active;         /* going to the target */
+    int have_start;
+    double cmd_time;
+    double start_time;  /* of the start position */
+    double ref_time;
+    int dirty;          /* to save */
+};
+
+
+static double motion_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+/* the configured rate wins over the learned one */
+static double motion_rate(ROT *rot, const struct rot_motion *m, int axis)
+{
+    float conf = axis == AXIS_AZ ? rot->state.az_rate : rot->state.el_rate;
+
+    return conf > 0 ? conf : m->ax[axis].rate;
+}
+
+
+/* time to cover dist, speeding up then slowing down at accel */
+static double motion_profile(const struct motion_axis *ax, double rate,
+                             double dist)
+{
+    if (dist <= 0)
+    {
+        return 0;
+    }
+
+    if (ax->accel <= 0)
+    {
+        return dist / rate;
+    }
+
+    if (dist < rate * rate / ax->accel)
+    {
+        return 2 * sqrt(dist / ax->accel);
+    }
+
+    return dist / rate + rate / ax->accel;
+}
+
+
+static double motion_avg(double old, double val, int moves)
+{
+    return moves == 0 || old <= 0 ? val : old + MOTION_ALPHA * (val - old);
+}
+
+
+/* with m->lock held, each axis ended its move at its still_since */
+static void motion_learn(struct rot_motion *m)
+{
+    int i;
+
+    if (!m->have_start)
+    {
+        return;
+    }
+
+    for (i = 0; i < AXIS_COUNT; i++)
+    {
+        struct motion_axis *ax = &m->ax[i];
+        double dist = fabs(ax->pos - ax->start);
+        double duration = ax->still_since - m->start_time;
+        double rate, over;
+
+        if (!ax->moved || dist < MOTION_MIN_DEG || duration <= 0)
+        {
+            continue;
+        }
+
+        rate = fmax(ax->vmax, dist / duration);
+        over = duration - dist / rate;
+
+        if (over > 0.05)
+        {
+            ax->accel = motion_avg(ax->accel, rate / over, ax->moves);
+        }
+
+        ax->rate = motion_avg(ax->rate, rate, ax->moves);
+        ax->deadband = motion_avg(ax->deadband, fabs(ax->target - ax->pos),
+                                  ax->moves);
+        ax->moves++;
+
+        m->dirty = 1;
+
+        rot_debug(RIG_DEBUG_VERBOSE,
+                  "%s: %s %.1f deg in %.2f s, rate %.2f deg/s, "
+                  "accel %.2f deg/s^2, dead band %.2f deg\n",
+                  __func__, axis_names[i], dist, duration,
+                  ax->rate, ax->accel, ax->deadband);
+    }
+}
+
+
+/*
+ * Written aside then renamed over the old file, so that a crash or a full
+ * disk leaves the last complete file to rot_motion_load().
+ */
+static void motion_save(ROT *rot)
+{
+    struct rot_motion *m = rot->state.motion;
+    struct motion_axis ax[AXIS_COUNT];
+    char tmp_path[FILPATHLEN + sizeof(".tmp")];
+    FILE *f;
+    int i, ok;
+
+    if (!m || rot->state.motion_file[0] == '\0')
+    {
+        return;
+    }
+
+    motion_lock(m);
+    memcpy(ax, m->ax, sizeof(ax));
+    m->dirty = 0;
+    motion_unlock(m);
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", rot->state.motion_file);
+
+    f = fopen(tmp_path, "w");
+
+    if (!f)
+    {
+        rot_debug(RIG_DEBUG_WARN, "%s: cannot write '%s'\n", __func__,
+                  tmp_path);
+        return;
+    }
+
+    ok = fprintf(f, "# rotator motion, learned by hamlib\n") > 0
+         && fprintf(f, "model %d\n", rot->caps->rot_model) > 0;
+
+    for (i = 0; ok && i < AXIS_COUNT; i++)
+    {
+        ok = fprintf(f, "%s_rate %f\n", axis_names[i], ax[i].rate) > 0
+             && fprintf(f, "%s_accel %f\n", axis_names[i], ax[i].accel) > 0
+             && fprintf(f, "%s_deadband %f\n", axis_names[i],
+                        ax[i].deadband) > 0
+             && fprintf(f, "%s_moves %d\n", axis_names[i], ax[i].moves) > 0;
+    }
+
+    if (fclose(f) != 0 || !ok)
+    {
+        rot_debug(RIG_DEBUG_WARN, "%s: cannot write '%s'\n", __func__,
+                  tmp_path);
+        remove(tmp_path);
+        return;
+    }
+
+#ifdef _WIN32
+    remove(rot->state.motion_file);
+#endif
+
+    if (rename(tmp_path, rot->state.motion_file) != 0)
+    {
+        rot_debug(RIG_DEBUG_WARN, "%s: cannot rename '%s'\n", __func__,
+                  tmp_path);
+        remove(tmp_path);
+    }
+}
+
+
+int rot_motion_init(ROT *rot)
+{
+    struct rot_motion *m;
+
+    if (rot->state.motion)
+    {
+        return RIG_OK;
+    }
+
+    m = calloc(1, sizeof(struct rot_motion));
+
+    if (!m)
+    {
+        return -RIG_ENOMEM;
+    }
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&m->lock, NULL);
+#endif
+
+    rot->state.motion = m;
+
+    return RIG_OK;
+}
+
+
+void rot_motion_target(ROT *rot, azimuth_t azimuth, elevation_t elevation)
+{
+    struct rot_motion *m = rot->state.motion;
+    int i;
+
+    if (!m)
+    {
+        return;
+    }
+
+    motion_lock(m);
+
+    /* the last move ended, but no poll saw it settle */
+    if (m->active && m->ax[AXIS_AZ].still_since > 0
+            && m->ax[AXIS_EL].still_since > 0)
+    {
+        motion_learn(m);
+    }
+
+    m->ax[AXIS_AZ].target = azimuth;
+    m->ax[AXIS_EL].target = elevation;
+
+    for (i = 0; i < AXIS_COUNT; i++)
+    {
+        struct motion_axis *ax = &m->ax[i];
+
+        ax->start = ax->ref = ax->pos;
+        ax->vmax = 0;
+        ax->moved = 0;
+        ax->still_since = 0;
+    }
+
+    m->active = 1;
+    m->cmd_time = m->start_time = m->ref_time = motion_now();
+    m->have_start = m->have_pos
+                    && m->cmd_time - m->pos_time < MOTION_FRESH_S;
+
+    motion_unlock(m);
+}
+
+
+void rot_motion_sample(ROT *rot, azimuth_t azimuth, elevation_t elevation)
+{
+    struct rot_motion *m = rot->state.motion;
+    double pos[AXIS_COUNT] = { azimuth, elevation };
+    double now = motion_now();
+    int i;
+
+    if (!m)
+    {
+        return;
+    }
+
+    motion_lock(m);
+
+    if (m->active && !m->have_start)
+    {
+        /* first position since the command, the best start we have */
+        for (i = 0; i < AXIS_COUNT; i++)
+        {
+            m->ax[i].start = m->ax[i].ref = pos[i];
+        }
+
+        m->have_start = 1;
+        m->start_time = m->ref_time = now;
+    }
+    else if (m->active)
+    {
+        int settled = 1;
+        int moved = 0;
+        int near = 1;
+
+        for (i = 0; i < AXIS_COUNT; i++)
+        {
+            struct motion_axis *ax = &m->ax[i];
+
+            if (fabs(pos[i] - ax->pos) >= MOTION_STILL_DEG)
+            {
+                /* it may have stopped in between, at the rate seen */
+                ax->end_time = now;
+
+                if (ax->vmax > 0)
+                {
+                    ax->end_time = fmin(now, m->pos_time
+                                        + fabs(pos[i] - ax->pos) / ax->vmax);
+                }
+
+                ax->moved = 1;
+                ax->still_since = 0;
+            }
+            else if (ax->still_since == 0)
+            {
+                ax->still_since = ax->moved ? ax->end_time : m->pos_time;
+            }
+
+            if (ax->still_since == 0 || now - ax->still_since < MOTION_SETTLE_S)
+            {
+                settled = 0;
+            }
+
+            if (fabs(pos[i] - ax->target) > MOTION_NEAR_DEG)
+            {
+                near = 0;
+            }
+
+            moved |= ax->moved;
+
+            if (now - m->ref_time >= MOTION_RATE_S)
+            {
+                ax->vmax = fmax(ax->vmax,
+                                fabs(pos[i] - ax->ref) / (now - m->ref_time));
+                ax->ref = pos[i];
+            }
+        }
+
+        if (now - m->ref_time >= MOTION_RATE_S)
+        {
+            m->ref_time = now;
+        }
+
+        if (settled && (moved || near))
+        {
+            for (i = 0; i < AXIS_COUNT; i++)
+            {
+                m->ax[i].pos = pos[i];
+            }
+
+            motion_learn(m);
+            m->active = 0;
+        }
+        else if (now - m->cmd_time > MOTION_GIVEUP_S)
+        {
+            rot_debug(RIG_DEBUG_WARN, "%s: target never reached\n", __func__);
+            m->active = 0;
+        }
+    }
+
+    for (i = 0; i < AXIS_COUNT; i++)
+    {
+        m->ax[i].pos = pos[i];
+    }
+
+    m->have_pos = 1;
+    m->pos_time = now;
+
+    motion_unlock(m);
+}
+
+
+void rot_motion_clear(ROT *rot)
+{
+    struct rot_motion *m = rot->state.motion;
+
+    if (m)
+    {
+        motion_lock(m);
+        m->active = 0;
+        motion_unlock(m);
+    }
+}
+
+
+void rot_motion_load(ROT *rot)
+{
+    struct rot_motion *m = rot->state.motion;
+    char line[128];
+    FILE *f;
+
+    if (!m || rot->state.motion_file[0] == '\0')
+    {
+        return;
+    }
+
+    f = fopen(rot->state.motion_file, "r");
+
+    if (!f)
+    {
+        rot_debug(RIG_DEBUG_VERBOSE, "%s: no '%s' yet\n", __func__,
+                  rot->state.motion_file);
+        return;
+    }
+
+    motion_lock(m);
+
+    while (fgets(line, sizeof(line), f))
+    {
+        char key[32];
+        double val;
+        int i;
+
+        if (sscanf(line, "%31s %lf", key, &val) != 2 || key[0] == '#')
+        {
+            continue;
+        }
+
+        if (!strcmp(key, "model"))
+        {
+            if ((int)val != rot->caps->rot_model)
+            {
+                rot_debug(RIG_DEBUG_WARN, "%s: '%s' is for model %d\n",
+                          __func__, rot->state.motion_file, (int)val);
+                memset(m->ax, 0, sizeof(m->ax));
+                break;
+            }
+
+            continue;
+        }
+
+        for (i = 0; i < AXIS_COUNT; i++)
+        {
+            const char *name = axis_names[i];
+            size_t len = strlen(name);
+            struct motion_axis *ax = &m->ax[i];
+
+            if (strncmp(key, name, len) || key[len] != '_')
+            {
+                continue;
+            }
+
+            if (!strcmp(key + len + 1, "rate"))
+            {
+                ax->rate = fmax(val, 0);
+            }
+            else if (!strcmp(key + len + 1, "accel"))
+            {
+                ax->accel = fmax(val, 0);
+            }
+            else if (!strcmp(key + len + 1, "deadband"))
+            {
+                ax->deadband = fmax(val, 0);
+            }
+            else if (!strcmp(key + len + 1, "moves"))
+            {
+                ax->moves = (int)val;
+            }
+        }
+    }
+
+    motion_unlock(m);
+
+    fclose(f);
+}
+
+
+void rot_motion_free(ROT *rot)
+{
+    struct rot_motion *m = rot->state.motion;
+
+    if (!m)
+    {
+        return;
+    }
+
+    if (m->dirty)
+    {
+        motion_save(rot);
+    }
+
+#ifdef HAVE_PTHREAD
+    pthread_mutex_destroy(&m->lock);
+#endif
+    free(m);
+
+    rot->state.motion = NULL;
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief predict when the rotator gets to its target
+ * \param rot   The rot handle
+ * \param eta   The location where to store the time left, in seconds
+ *
+ *  Tells how long the rotator still needs to get to the position of the
+ *  last rot_set_position(), or 0 if it is there already, without any I/O.
+ *  The prediction comes from the slew rates, acceleration and dead band
+ *  learned from the positions read during the previous moves, and from
+ *  the last position read, see the \a poll_interval configuration
+ *  parameter.  The \a az_rate and \a el_rate configuration parameters,
+ *  when set, win over the learned slew rates.
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_ENAVAIL
+ * when the slew rate of an axis to move is not known yet, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rot_set_position(), rot_get_cached_position()
+ */
+int HAMLIB_API rot_get_eta(ROT *rot, double *eta)
+{
+    struct rot_motion *m;
+    double now, left = 0;
+    int i, retval = RIG_OK;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_ROT_ARG(rot) || !eta)
+    {
+        return -RIG_EINVAL;
+    }
+
+    *eta = 0;
+    m = rot->state.motion;
+
+    if (!m)
+    {
+        return RIG_OK;
+    }
+
+    now = motion_now();
+
+    motion_lock(m);
+
+    /* no position since the command */
+    if (m->active && !m->have_start)
+    {
+        retval = -RIG_ENAVAIL;
+    }
+
+    for (i = 0; m->active && retval == RIG_OK && i < AXIS_COUNT; i++)
+    {
+        const struct motion_axis *ax = &m->ax[i];
+        double rate = motion_rate(rot, m, i);
+        double dist = fabs(ax->target - ax->pos) - ax->deadband;
+        double t;
+
+        if (dist <= 0)
+        {
+            continue;
+        }
+
+        if (rate <= 0)
+        {
+            retval = -RIG_ENAVAIL;
+            break;
+        }
+
+        /* where it should be by now, unless it is late */
+        t = motion_profile(ax, rate, fabs(ax->target - ax->start)
+                           - ax->deadband) - (now - m->start_time);
+
+        left = fmax(left, fmax(t, dist / rate));
+    }
+
+    motion_unlock(m);
+
+    if (retval == RIG_OK)
+    {
+        *eta = left;
+    }
+
+    return retval;
+}
+
+/*! @} */
@@ -0,0 +1,49 @@
+/*
+ *  Hamlib Interface - rotator motion model header
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _ROT_MOTION_H
+#define _ROT_MOTION_H 1
+
+#include <hamlib/rotator.h>
+
+__BEGIN_DECLS
+
+/* creates the motion state, by rot_open(), before any thread shares it */
+extern int rot_motion_init(ROT *rot);
+
+/* the rotator was told to go there */
+extern void rot_motion_target(ROT *rot, azimuth_t azimuth, elevation_t elevation);
+
+/* the rotator was read there, learns from the moves it completes */
+extern void rot_motion_sample(ROT *rot, azimuth_t azimuth, elevation_t elevation);
+
+/* the rotator was stopped or moved elsewhere, no target anymore */
+extern void rot_motion_clear(ROT *rot);
+
+/* reads the motion_file, by rot_open() */
+extern void rot_motion_load(ROT *rot);
+
+/* frees the motion state, by rot_close() */
+extern void rot_motion_free(ROT *rot);
+
+__END_DECLS
+
+#endif /* _ROT_MOTION_H */
@@ -0,0 +1,424 @@
+/*
+ *  Hamlib Interface - rotator position cache
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rotator
+ * @{
+ */
+
+/**
+ * \file rot_poll.c
+ * \brief Rotator position cache
+ *
+ * With poll_interval set, a thread of the library reads the position of
+ * the rotator at that period, and rot_get_position() returns the last
+ * position read, without any I/O.  So the map, the logger and the
+ * tracking program connected to rotctld cost one poll of the rotator,
+ * not one each.
+ *
+ * Once two polls in a row find the rotator still, it is polled every
+ * poll_idle only, till the next command that moves it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#  include <pthread.h>
+#endif
+
+#include <hamlib/rotator.h>
+#include "rot_poll.h"
+#include "rot_track.h"
+#include "rot_motion.h"
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_ROT_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define POLL_STILL_DEG  0.1     /* smaller moves are noise */
+#define POLL_FAST_S     3.0     /* full rate after a command, to see it move */
+
+#ifdef HAVE_PTHREAD
+
+struct rot_poll
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;                /* thread to join */
+    int done;
+    int stop;
+    int wake;
+    double fast_until;
+
+    int valid;
+    int moving;
+    azimuth_t az;
+    elevation_t el;
+    double time;
+    double duration;            /* of the last get_position, s */
+    int error;                  /* of the last poll, RIG_OK if none */
+};
+
+
+static double poll_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+/* with rp->lock held */
+static void poll_store(struct rot_poll *rp, azimuth_t az, elevation_t el)
+{
+    rp->moving = rp->valid && (fabs(az - rp->az) >= POLL_STILL_DEG
+                               || fabs(el - rp->el) >= POLL_STILL_DEG);
+    rp->az = az;
+    rp->el = el;
+    rp->time = poll_now();
+    rp->valid = 1;
+    rp->error = RIG_OK;
+}
+
+
+/*
+ * With rp->lock held, whether the position is older than two polls,
+ * i.e. the poller fell behind or stopped getting answers.
+ */
+static int poll_stale(const struct rot_poll *rp, const struct rot_state *rs)
+{
+    int delay = rs->poll_idle > rs->poll_interval ? rs->poll_idle
+                : rs->poll_interval;
+
+    return poll_now() - rp->time > 2 * (delay / 1000. + rp->duration);
+}
+
+
+static void *poll_thread(void *arg)
+{
+    ROT *rot = arg;
+    struct rot_state *rs = &rot->state;
+    struct rot_poll *rp = rs->poll;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s: started\n", __func__);
+
+    pthread_mutex_lock(&rp->lock);
+
+    while (!rp->stop && rs->poll_interval > 0)
+    {
+        azimuth_t az;
+        elevation_t el;
+        struct timespec ts;
+        double deadline, t0;
+        int retval, delay;
+
+        pthread_mutex_unlock(&rp->lock);
+
+        t0 = poll_now();
+        rot_track_io_lock(rot);
+        retval = rot->caps->get_position(rot, &az, &el);
+        rot_track_io_unlock(rot);
+
+        if (retval == RIG_OK)
+        {
+            rot_motion_sample(rot, az, el);
+        }
+
+        pthread_mutex_lock(&rp->lock);
+
+        rp->duration = poll_now() - t0;
+
+        if (retval == RIG_OK)
+        {
+            poll_store(rp, az, el);
+        }
+        else
+        {
+            rot_debug(RIG_DEBUG_WARN, "%s: get_position failed: %s\n",
+                      __func__, rigerror(retval));
+            rp->error = retval;
+        }
+
+        delay = rs->poll_interval;
+
+        if (!rp->moving && poll_now() >= rp->fast_until
+                && rs->poll_idle > delay)
+        {
+            delay = rs->poll_idle;
+        }
+
+        deadline = poll_now() + delay / 1000.;
+        ts.tv_sec = (time_t)deadline;
+        ts.tv_nsec = (long)((deadline - ts.tv_sec) * 1e9);
+
+        while (!rp->stop && !rp->wake)
+        {
+            if (pthread_cond_timedwait(&rp->cond, &rp->lock, &ts) == ETIMEDOUT)
+            {
+                break;
+            }
+        }
+
+        rp->wake = 0;
+    }
+
+    rp->done = 1;
+
+    pthread_mutex_unlock(&rp->lock);
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s: done\n", __func__);
+
+    return NULL;
+}
+
+#endif  /* HAVE_PTHREAD */
+
+
+int rot_poll_get_position(ROT *rot,
+                          azimuth_t *azimuth,
+                          elevation_t *elevation,
+                          int *age_ms)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_poll *rp;
+    int retval = RIG_OK;
+
+    if (rot->state.poll_interval <= 0 || !rot->caps->get_position)
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    /* made by rot_open() */
+    rp = rot->state.poll;
+
+    if (!rp)
+    {
+        return -RIG_EINTERNAL;
+    }
+
+    pthread_mutex_lock(&rp->lock);
+
+    /* disabled in between, its thread can go */
+    if (rp->running && rp->done)
+    {
+        pthread_mutex_unlock(&rp->lock);
+        pthread_join(rp->thread, NULL);
+        pthread_mutex_lock(&rp->lock);
+        rp->running = 0;
+    }
+
+    if (!rp->running)
+    {
+        rp->stop = 0;
+        rp->done = 0;
+        rp->valid = 0;
+        rp->error = RIG_OK;
+        rp->duration = 0;
+        rp->fast_until = poll_now() + POLL_FAST_S;
+
+        if (pthread_create(&rp->thread, NULL, poll_thread, rot))
+        {
+            pthread_mutex_unlock(&rp->lock);
+            return -RIG_EINTERNAL;
+        }
+
+        rp->running = 1;
+    }
+
+    /* after a failed or late poll, the caller reads the rotator itself */
+    if (rp->valid && rp->error == RIG_OK && !poll_stale(rp, &rot->state))
+    {
+        *azimuth = rp->az;
+        *elevation = rp->el;
+
+        if (age_ms)
+        {
+            *age_ms = (int)((poll_now() - rp->time) * 1000);
+        }
+    }
+    else
+    {
+        retval = -RIG_ENAVAIL;
+    }
+
+    pthread_mutex_unlock(&rp->lock);
+
+    return retval;
+#else
+    return -RIG_ENAVAIL;
+#endif
+}
+
+
+int rot_poll_init(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_poll *rp;
+
+    if (rot->state.poll)
+    {
+        return RIG_OK;
+    }
+
+    rp = calloc(1, sizeof(struct rot_poll));
+
+    if (!rp)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    pthread_mutex_init(&rp->lock, NULL);
+    pthread_cond_init(&rp->cond, NULL);
+
+    rot->state.poll = rp;
+#endif
+
+    return RIG_OK;
+}
+
+
+void rot_poll_update(ROT *rot, azimuth_t azimuth, elevation_t elevation)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_poll *rp = rot->state.poll;
+
+    if (rp)
+    {
+        pthread_mutex_lock(&rp->lock);
+        poll_store(rp, azimuth, elevation);
+        pthread_mutex_unlock(&rp->lock);
+    }
+
+#endif
+}
+
+
+void rot_poll_wake(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_poll *rp = rot->state.poll;
+
+    if (rp)
+    {
+        pthread_mutex_lock(&rp->lock);
+        rp->fast_until = poll_now() + POLL_FAST_S;
+        rp->wake = 1;
+        pthread_cond_signal(&rp->cond);
+        pthread_mutex_unlock(&rp->lock);
+    }
+
+#endif
+}
+
+
+void rot_poll_free(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_poll *rp = rot->state.poll;
+
+    if (!rp)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&rp->lock);
+    rp->stop = 1;
+    pthread_cond_signal(&rp->cond);
+    pthread_mutex_unlock(&rp->lock);
+
+    if (rp->running)
+    {
+        pthread_join(rp->thread, NULL);
+    }
+
+    pthread_cond_destroy(&rp->cond);
+    pthread_mutex_destroy(&rp->lock);
+    free(rp);
+
+    rot->state.poll = NULL;
+#endif
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief get the last known position of the rotator
+ * \param rot       The rot handle
+ * \param azimuth   The location where to store the azimuth
+ * \param elevation The location where to store the elevation
+ * \param age_ms    The location where to store the age of the position
+ *
+ *  Like rot_get_position(), also telling how old the position is, in
+ *  milliseconds.  With the \a poll_interval configuration parameter set,
+ *  this is the last position read by the poller of the library, without
+ *  any I/O; otherwise the rotator is read, and the age is 0.  The rotator
+ *  is read as well when the last poll failed, or when the position is
+ *  older than two polls, so that an error is not hidden by the cache.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rot_get_position()
+ */
+int HAMLIB_API rot_get_cached_position(ROT *rot,
+                                       azimuth_t *azimuth,
+                                       elevation_t *elevation,
+                                       int *age_ms)
+{
+    int retval;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_ROT_ARG(rot) || !azimuth || !elevation || !age_ms)
+    {
+        return -RIG_EINVAL;
+    }
+
+    retval = rot_poll_get_position(rot, azimuth, elevation, age_ms);
+
+    if (retval != -RIG_ENAVAIL)
+    {
+        return retval;
+    }
+
+    *age_ms = 0;
+
+    return rot_get_position(rot, azimuth, elevation);
+}
+
+/*! @} */
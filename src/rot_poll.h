@@ -0,0 +1,53 @@
+/*
+ *  Hamlib Interface - rotator position cache header
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _ROT_POLL_H
+#define _ROT_POLL_H 1
+
+#include <hamlib/rotator.h>
+
+__BEGIN_DECLS
+
+/*
+ * Returns the last polled position, starting the poller if needed, or
+ * -RIG_ENAVAIL when poll_interval is 0, no position was read yet, the
+ * last poll failed or the position is older than two polls.
+ */
+extern int rot_poll_get_position(ROT *rot,
+                                 azimuth_t *azimuth,
+                                 elevation_t *elevation,
+                                 int *age_ms);
+
+/* creates the poller state, by rot_open(); the poller starts on demand */
+extern int rot_poll_init(ROT *rot);
+
+/* stores a position read by the caller */
+extern void rot_poll_update(ROT *rot, azimuth_t azimuth, elevation_t elevation);
+
+/* the rotator was told to move, poll at full rate again */
+extern void rot_poll_wake(ROT *rot);
+
+/* stops the poller and frees its state, by rot_close() */
+extern void rot_poll_free(ROT *rot);
+
+__END_DECLS
+
+#endif /* _ROT_POLL_H */
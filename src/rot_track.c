@@ -0,0 +1,803 @@
+/*
+ *  Hamlib Interface - rotator trajectory tracking
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rotator
+ * @{
+ */
+
+/**
+ * \file rot_track.c
+ * \brief Rotator trajectory tracking
+ *
+ * Instead of a new rot_set_position() every second from the tracking
+ * program, the whole pass is given as time stamped points, and a thread
+ * of the library sends the positions itself.
+ *
+ * Each position is sent ahead of time, by the measured duration of a
+ * command plus the time the rotator needs to slew there, and only when
+ * the antenna would be off by more than track_deadband, so that the
+ * rotator moves in a few smooth steps instead of one jerk per second.
+ *
+ * The azimuths of the pass are unwrapped, and placed once for all within
+ * min_az and max_az, so that a pass crossing north is followed through
+ * the overlap of a 450 degree rotator, or on the side of the stop that
+ * needs no full swing during the pass.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#  include <pthread.h>
+#endif
+
+#include <hamlib/rotator.h>
+#include "rot_track.h"
+#include "rot_poll.h"
+#include "rot_motion.h"
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_ROT_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define TRACK_TICK_US           100000
+#define TRACK_DEFAULT_RATE      3.0     /* deg/s, till measured */
+#define TRACK_MEASURE_US        500000  /* between slew rate polls */
+#define TRACK_MEASURE_SAMPLES   3
+#define TRACK_MAX_LEAD          600.    /* s */
+
+#ifdef HAVE_PTHREAD
+
+/* a point, with the azimuth unwrapped */
+struct track_pt
+{
+    double t;
+    double az;
+    double el;
+};
+
+/* rotator frame motion, from pos at pos_t towards cmd */
+struct track_axis
+{
+    double pos;
+    double cmd;
+    double rate;
+    int measured;
+    double max_rate;
+    int samples;
+};
+
+struct rot_track
+{
+    pthread_mutex_t lock;       /* all below, but the port */
+    pthread_mutex_t io_lock;    /* the port */
+    pthread_t thread;
+    int running;                /* thread to join */
+    int active;
+    int stop;
+
+    struct track_pt *pts;
+    int count;
+    int alloc;
+    int cur;                    /* segment start */
+
+    double shift;               /* rotator azimuth = az + shift */
+    int plan_end;               /* points fitting with shift */
+    int replan;
+
+    struct track_axis az;
+    struct track_axis el;
+    double pos_t;
+    int sent;
+
+    double latency;             /* s */
+    unsigned long commands;
+};
+
+
+static double track_now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+static void track_interp(const struct rot_track *tr, double t,
+                         double *az, double *el)
+{
+    const struct track_pt *p = tr->pts;
+    int i = tr->cur;
+
+    if (t <= p[i].t)
+    {
+        *az = p[i].az;
+        *el = p[i].el;
+        return;
+    }
+
+    while (i + 1 < tr->count && p[i + 1].t <= t)
+    {
+        i++;
+    }
+
+    if (i + 1 == tr->count)
+    {
+        *az = p[i].az;
+        *el = p[i].el;
+        return;
+    }
+
+    t = (t - p[i].t) / (p[i + 1].t - p[i].t);
+
+    *az = p[i].az + t * (p[i + 1].az - p[i].az);
+    *el = p[i].el + t * (p[i + 1].el - p[i].el);
+}
+
+
+/*
+ * Picks the turn of the unwrapped azimuths that keeps the most points
+ * from cur on within the limits, the one nearest to the rotator when
+ * several do.
+ */
+static void track_plan(struct rot_track *tr, const struct rot_state *rs)
+{
+    double best_shift = 0, best_dist = 1e9;
+    int best_end = -1;
+    int m, i;
+
+    for (m = -3; m <= 3; m++)
+    {
+        double shift = 360. * m;
+        double dist;
+
+        for (i = tr->cur; i < tr->count; i++)
+        {
+            double a = tr->pts[i].az + shift;
+
+            if (a < rs->min_az || a > rs->max_az)
+            {
+                break;
+            }
+        }
+
+        dist = fabs(tr->pts[tr->cur].az + shift - tr->az.pos);
+
+        if (i > best_end || (i == best_end && dist < best_dist))
+        {
+            best_shift = shift;
+            best_end = i;
+            best_dist = dist;
+        }
+    }
+
+    tr->shift = best_shift;
+    tr->plan_end = best_end;
+    tr->replan = 0;
+
+    rot_debug(RIG_DEBUG_TRACE, "%s: shift %.0f, points %d to %d\n",
+              __func__, tr->shift, tr->cur, tr->plan_end);
+}
+
+
+static double axis_pos(const struct track_axis *ax, double dt)
+{
+    double d = ax->cmd - ax->pos;
+    double moved = ax->rate * dt;
+
+    if (moved >= fabs(d))
+    {
+        return ax->cmd;
+    }
+
+    return ax->pos + (d > 0 ? moved : -moved);
+}
+
+
+static double clamp(double v, double lo, double hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+
+/* slew rate from two polls, while the rotator was still on its way */
+static void axis_measure(struct track_axis *ax, double prev, double pos,
+                         double dt)
+{
+    double rate;
+
+    if (ax->measured || dt <= 0 || fabs(ax->cmd - pos) < 2.
+            || fabs(pos - prev) < 1.)
+    {
+        return;
+    }
+
+    rate = fabs(pos - prev) / dt;
+
+    if (rate > ax->max_rate)
+    {
+        ax->max_rate = rate;
+    }
+
+    if (++ax->samples >= TRACK_MEASURE_SAMPLES)
+    {
+        ax->measured = 1;
+        ax->rate = ax->max_rate;
+
+        rot_debug(RIG_DEBUG_VERBOSE, "%s: measured slew rate %.2f deg/s\n",
+                  __func__, ax->max_rate);
+    }
+}
+
+
+static void *track_thread(void *arg)
+{
+    ROT *rot = arg;
+    struct rot_state *rs = &rot->state;
+    struct rot_track *tr = rs->track;
+    double poll_t = 0, poll_az = 0, poll_el = 0;
+    azimuth_t az;
+    elevation_t el;
+    double t0;
+    int retval;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s: started\n", __func__);
+
+    /* where the rotator starts from, and how long a command takes */
+    t0 = track_now();
+    rot_track_io_lock(rot);
+    retval = rot->caps->get_position
+             ? rot->caps->get_position(rot, &az, &el) : -RIG_ENAVAIL;
+    rot_track_io_unlock(rot);
+
+    pthread_mutex_lock(&tr->lock);
+
+    if (retval == RIG_OK)
+    {
+        tr->latency = track_now() - t0;
+        tr->az.pos = tr->az.cmd = az;
+        tr->el.pos = tr->el.cmd = el;
+        poll_t = track_now();
+        poll_az = az;
+        poll_el = el;
+    }
+    else
+    {
+        tr->az.pos = tr->az.cmd = (rs->min_az + rs->max_az) / 2;
+        tr->el.pos = tr->el.cmd = rs->min_el;
+    }
+
+    tr->pos_t = track_now();
+    tr->replan = 1;
+
+    while (!tr->stop)
+    {
+        double now = track_now();
+        double t, taz, tel, naz, nel, speed;
+        int i, need, measure;
+
+        while (tr->cur + 1 < tr->count && tr->pts[tr->cur + 1].t <= now)
+        {
+            tr->cur++;
+        }
+
+        if (tr->count == 0 || now > tr->pts[tr->count - 1].t)
+        {
+            break;
+        }
+
+        /* without get_position, the rates are never measured */
+        tr->az.rate = rs->az_rate > 0 ? rs->az_rate
+                      : (tr->az.measured ? tr->az.max_rate : TRACK_DEFAULT_RATE);
+        tr->el.rate = rs->el_rate > 0 ? rs->el_rate
+                      : (tr->el.measured ? tr->el.max_rate : TRACK_DEFAULT_RATE);
+
+        /* the model of where the rotator is now */
+        tr->az.pos = axis_pos(&tr->az, now - tr->pos_t);
+        tr->el.pos = axis_pos(&tr->el, now - tr->pos_t);
+        tr->pos_t = now;
+
+        if (tr->replan || tr->cur + 1 >= tr->plan_end)
+        {
+            track_plan(tr, rs);
+        }
+
+        /* when the rotator can be where the trajectory will be */
+        t = now + tr->latency;
+
+        for (i = 0; i < 4; i++)
+        {
+            double dt;
+
+            track_interp(tr, t, &taz, &tel);
+            dt = fmax(fabs(taz + tr->shift - tr->az.pos) / tr->az.rate,
+                      fabs(tel - tr->el.pos) / tr->el.rate);
+            t = now + tr->latency + fmin(dt, TRACK_MAX_LEAD);
+        }
+
+        /* lead by half the dead band, to center the steps on the target */
+        track_interp(tr, t, &taz, &tel);
+        track_interp(tr, t + 1, &naz, &nel);
+        speed = fmax(fabs(naz - taz), fabs(nel - tel));
+
+        if (speed > 0 && rs->track_deadband > 0)
+        {
+            track_interp(tr, t + fmin(rs->track_deadband / 2 / speed, 30),
+                         &taz, &tel);
+        }
+
+        taz = clamp(taz + tr->shift, rs->min_az, rs->max_az);
+        tel = clamp(tel, rs->min_el, rs->max_el);
+
+        need = !tr->sent
+               || fabs(taz - tr->az.cmd) >= rs->track_deadband
+               || fabs(tel - tr->el.cmd) >= rs->track_deadband;
+
+        measure = (rs->az_rate <= 0 && !tr->az.measured)
+                  || (rs->el_rate <= 0 && !tr->el.measured);
+
+        pthread_mutex_unlock(&tr->lock);
+
+        if (need)
+        {
+            t0 = track_now();
+            rot_track_io_lock(rot);
+            retval = rot->caps->set_position(rot, taz, tel);
+            rot_track_io_unlock(rot);
+
+            rot_poll_wake(rot);
+
+            pthread_mutex_lock(&tr->lock);
+
+            if (retval == RIG_OK)
+            {
+                double dt = track_now() - t0;
+
+                tr->latency = tr->sent ? 0.8 * tr->latency + 0.2 * dt : dt;
+                tr->az.cmd = taz;
+                tr->el.cmd = tel;
+                tr->sent = 1;
+                tr->commands++;
+            }
+            else
+            {
+                rot_debug(RIG_DEBUG_WARN, "%s: set_position failed: %s\n",
+                          __func__, rigerror(retval));
+            }
+
+            pthread_mutex_unlock(&tr->lock);
+        }
+
+        /* till the slew rates are known, follow the actual position */
+        if (measure && rot->caps->get_position
+                && track_now() - poll_t >= TRACK_MEASURE_US / 1e6)
+        {
+            rot_track_io_lock(rot);
+            retval = rot->caps->get_position(rot, &az, &el);
+            rot_track_io_unlock(rot);
+
+            if (retval == RIG_OK)
+            {
+                rot_poll_update(rot, az, el);
+                rot_motion_sample(rot, az, el);
+            }
+
+            pthread_mutex_lock(&tr->lock);
+
+            if (retval == RIG_OK)
+            {
+                double now2 = track_now();
+
+                axis_measure(&tr->az, poll_az, az, now2 - poll_t);
+                axis_measure(&tr->el, poll_el, el, now2 - poll_t);
+
+                tr->az.pos = poll_az = az;
+                tr->el.pos = poll_el = el;
+                tr->pos_t = poll_t = now2;
+            }
+
+            pthread_mutex_unlock(&tr->lock);
+        }
+
+        usleep(TRACK_TICK_US);
+
+        pthread_mutex_lock(&tr->lock);
+    }
+
+    tr->active = 0;
+
+    pthread_mutex_unlock(&tr->lock);
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s: done, %lu commands\n", __func__,
+              tr->commands);
+
+    return NULL;
+}
+
+#endif  /* HAVE_PTHREAD */
+
+
+void rot_track_io_lock(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr = rot->state.track;
+
+    if (tr)
+    {
+        pthread_mutex_lock(&tr->io_lock);
+    }
+
+#endif
+}
+
+
+void rot_track_io_unlock(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr = rot->state.track;
+
+    if (tr)
+    {
+        pthread_mutex_unlock(&tr->io_lock);
+    }
+
+#endif
+}
+
+
+int rot_track_init(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr;
+
+    if (rot->state.track)
+    {
+        return RIG_OK;
+    }
+
+    tr = calloc(1, sizeof(struct rot_track));
+
+    if (!tr)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    pthread_mutex_init(&tr->lock, NULL);
+    pthread_mutex_init(&tr->io_lock, NULL);
+
+    rot->state.track = tr;
+#endif
+
+    return RIG_OK;
+}
+
+
+void rot_track_free(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr = rot->state.track;
+
+    if (!tr)
+    {
+        return;
+    }
+
+    rot_track_stop(rot);
+
+    pthread_mutex_destroy(&tr->lock);
+    pthread_mutex_destroy(&tr->io_lock);
+    free(tr->pts);
+    free(tr);
+
+    rot->state.track = NULL;
+#endif
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief follow a trajectory
+ * \param rot       The rot handle
+ * \param points    The points to add to the trajectory
+ * \param count     The number of points
+ *
+ *  Adds time stamped positions to the trajectory followed by the rotator,
+ *  and starts following it if needed.  The points must come in time
+ *  order, after the points already given.  A thread of the library then
+ *  sends the positions to the rotator ahead of time, from the measured
+ *  duration of a command and the slew rates, \a az_rate and \a el_rate,
+ *  or measured during the first moves when not configured.  A new
+ *  position is only sent when it is \a track_deadband away from the
+ *  last one.
+ *
+ *  Before the first point, the rotator is moved to it.  The tracking ends
+ *  at the time of the last point, by rot_track_stop(), rot_set_position(),
+ *  rot_stop(), rot_park() or rot_close().
+ *
+ *  The azimuths may be given in any turn, e.g. from 0 to 360 degrees;
+ *  they are mapped within \a min_az and \a max_az for the whole pass.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rot_track_stop(), rot_track_get_status()
+ */
+int HAMLIB_API rot_track_add(ROT *rot,
+                             const struct rot_track_point *points,
+                             int count)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr;
+    int i, retval = RIG_OK;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_ROT_ARG(rot) || !points || count <= 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (rot->caps->set_position == NULL)
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    /* the moves of the tracking are not to learn from */
+    rot_motion_clear(rot);
+
+    /* made by rot_open() */
+    tr = rot->state.track;
+
+    if (!tr)
+    {
+        return -RIG_EINTERNAL;
+    }
+
+    /* a finished run, its thread can go */
+    pthread_mutex_lock(&tr->lock);
+
+    if (tr->running && !tr->active)
+    {
+        pthread_t thread = tr->thread;
+
+        tr->running = 0;
+        tr->count = tr->cur = 0;
+        pthread_mutex_unlock(&tr->lock);
+        pthread_join(thread, NULL);
+        pthread_mutex_lock(&tr->lock);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        const struct rot_track_point *p = &points[i];
+        struct track_pt *q;
+        double az = p->azimuth;
+
+        if (tr->count && p->time <= tr->pts[tr->count - 1].t)
+        {
+            retval = -RIG_EINVAL;
+            break;
+        }
+
+        if (tr->count == tr->alloc)
+        {
+            int alloc = tr->alloc ? 2 * tr->alloc : 64;
+            struct track_pt *pts;
+
+            pts = realloc(tr->pts, alloc * sizeof(struct track_pt));
+
+            if (!pts)
+            {
+                retval = -RIG_ENOMEM;
+                break;
+            }
+
+            tr->pts = pts;
+            tr->alloc = alloc;
+        }
+
+        /* unwrapped, within half a turn of the previous point */
+        if (tr->count)
+        {
+            double prev = tr->pts[tr->count - 1].az;
+
+            while (az - prev > 180)
+            {
+                az -= 360;
+            }
+
+            while (az - prev < -180)
+            {
+                az += 360;
+            }
+        }
+
+        q = &tr->pts[tr->count++];
+        q->t = p->time;
+        q->az = az;
+        q->el = p->elevation;
+    }
+
+    tr->replan = 1;
+
+    /* unless rot_track_stop() is still joining the last thread */
+    if (!tr->running && !tr->active && tr->count > 0)
+    {
+        tr->stop = 0;
+        tr->active = 1;
+        tr->sent = 0;
+        tr->commands = 0;
+        memset(&tr->az, 0, sizeof(tr->az));
+        memset(&tr->el, 0, sizeof(tr->el));
+
+        if (pthread_create(&tr->thread, NULL, track_thread, rot))
+        {
+            tr->active = 0;
+            retval = -RIG_EINTERNAL;
+        }
+        else
+        {
+            tr->running = 1;
+        }
+    }
+
+    pthread_mutex_unlock(&tr->lock);
+
+    return retval;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief stop following a trajectory
+ * \param rot       The rot handle
+ *
+ *  Stops sending the positions of the trajectory given to rot_track_add(),
+ *  and forgets it.  The rotator is not stopped, see rot_stop().
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rot_track_add()
+ */
+int HAMLIB_API rot_track_stop(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr;
+    pthread_t thread;
+    int running;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!rot || !rot->caps)
+    {
+        return -RIG_EINVAL;
+    }
+
+    tr = rot->state.track;
+
+    if (!tr)
+    {
+        return RIG_OK;
+    }
+
+    /* only one caller joins the thread, outside of the lock */
+    pthread_mutex_lock(&tr->lock);
+    tr->stop = 1;
+    running = tr->running;
+    thread = tr->thread;
+    tr->running = 0;
+    pthread_mutex_unlock(&tr->lock);
+
+    if (running)
+    {
+        pthread_join(thread, NULL);
+    }
+
+    pthread_mutex_lock(&tr->lock);
+
+    /* neither restarted since, nor still joined by another caller */
+    if (!tr->running && (running || !tr->active))
+    {
+        tr->active = 0;
+        tr->count = 0;
+        tr->cur = 0;
+    }
+
+    pthread_mutex_unlock(&tr->lock);
+
+    return RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief get the progress of the trajectory tracking
+ * \param rot       The rot handle
+ * \param status    The location where to store the progress
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rot_track_add()
+ */
+int HAMLIB_API rot_track_get_status(ROT *rot, struct rot_track_status *status)
+{
+#ifdef HAVE_PTHREAD
+    struct rot_track *tr;
+
+    rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_ROT_ARG(rot) || !status)
+    {
+        return -RIG_EINVAL;
+    }
+
+    memset(status, 0, sizeof(*status));
+
+    tr = rot->state.track;
+
+    if (!tr)
+    {
+        return RIG_OK;
+    }
+
+    pthread_mutex_lock(&tr->lock);
+
+    status->active = tr->active;
+    status->points = tr->active ? tr->count - tr->cur : 0;
+    status->commands = tr->commands;
+    status->latency_ms = (int)(tr->latency * 1000 + .5);
+
+    pthread_mutex_unlock(&tr->lock);
+
+    return RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+/*! @} */
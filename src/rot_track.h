@@ -0,0 +1,44 @@
+/*
+ *  Hamlib Interface - rotator trajectory tracking header
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _ROT_TRACK_H
+#define _ROT_TRACK_H 1
+
+#include <hamlib/rotator.h>
+
+__BEGIN_DECLS
+
+/*
+ * Serializes the port between the tracking thread, the position poller
+ * and the API calls, from rot_open() to rot_close().
+ */
+extern void rot_track_io_lock(ROT *rot);
+extern void rot_track_io_unlock(ROT *rot);
+
+/* creates the tracking state and the port lock, by rot_open() */
+extern int rot_track_init(ROT *rot);
+
+/* stops the tracking and frees its state, by rot_close() */
+extern void rot_track_free(ROT *rot);
+
+__END_DECLS
+
+#endif /* _ROT_TRACK_H */
@@ -61,6 +61,9 @@
 #include "network.h"
 #include "rot_conf.h"
 #include "token.h"
+#include "rot_track.h"
+#include "rot_poll.h"
+#include "rot_motion.h"
 
 
 #ifndef DOC_HIDDEN
@@ -273,6 +276,8 @@ ROT * HAMLIB_API rot_init(rot_model_t rot_model)
     rs->max_el = caps->max_el;
     rs->min_az = caps->min_az;
     rs->max_az = caps->max_az;
+    rs->track_deadband = 1;
+    rs->poll_idle = 2000;
 
     rs->rotport.fd = -1;
 
@@ -421,6 +426,26 @@ int HAMLIB_API rot_open(ROT *rot)
         }
     }
 
+    /* before any thread may share the port */
+    status = rot_track_init(rot);
+
+    if (status == RIG_OK)
+    {
+        status = rot_poll_init(rot);
+    }
+
+    if (status == RIG_OK)
+    {
+        status = rot_motion_init(rot);
+    }
+
+    if (status != RIG_OK)
+    {
+        return status;
+    }
+
+    rot_motion_load(rot);
+
     return RIG_OK;
 }
 
@@ -458,6 +483,10 @@ int HAMLIB_API rot_close(ROT *rot)
         return -RIG_EINVAL;
     }
 
+    rot_poll_free(rot);
+    rot_track_free(rot);
+    rot_motion_free(rot);
+
     /*
      * Let the backend say 73s to the rot.
      * and ignore the return code.
@@ -568,6 +597,7 @@ int HAMLIB_API rot_set_position(ROT *rot,
 {
     const struct rot_caps *caps;
     const struct rot_state *rs;
+    int retval;
 
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
@@ -592,7 +622,21 @@ int HAMLIB_API rot_set_position(ROT *rot,
         return -RIG_ENAVAIL;
     }
 
-    return caps->set_position(rot, azimuth, elevation);
+    /* a manual move ends the trajectory, which would fight it */
+    rot_track_stop(rot);
+
+    rot_track_io_lock(rot);
+    retval = caps->set_position(rot, azimuth, elevation);
+    rot_track_io_unlock(rot);
+
+    if (retval == RIG_OK)
+    {
+        rot_motion_target(rot, azimuth, elevation);
+    }
+
+    rot_poll_wake(rot);
+
+    return retval;
 }
 
 
@@ -604,17 +648,22 @@ int HAMLIB_API rot_set_position(ROT *rot,
  *
  *  Retrieves the current azimuth and elevation of the rotator.
  *
+ *  With the \a poll_interval configuration parameter set, returns the
+ *  last position read by the poller of the library instead, unless that
+ *  poll failed or is late, see rot_get_cached_position().
+ *
  * \return RIG_OK if the operation has been sucessful, otherwise
  * a negative value if an error occured (in which case, cause is
  * set appropriately).
  *
- * \sa rot_set_position()
+ * \sa rot_set_position(), rot_get_cached_position()
  */
 int HAMLIB_API rot_get_position(ROT *rot,
                                 azimuth_t *azimuth,
                                 elevation_t *elevation)
 {
     const struct rot_caps *caps;
+    int retval;
 
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
@@ -630,7 +679,22 @@ int HAMLIB_API rot_get_position(ROT *rot,
         return -RIG_ENAVAIL;
     }
 
-    return caps->get_position(rot, azimuth, elevation);
+    if (rot_poll_get_position(rot, azimuth, elevation, NULL) == RIG_OK)
+    {
+        return RIG_OK;
+    }
+
+    rot_track_io_lock(rot);
+    retval = caps->get_position(rot, azimuth, elevation);
+    rot_track_io_unlock(rot);
+
+    if (retval == RIG_OK)
+    {
+        rot_poll_update(rot, *azimuth, *elevation);
+        rot_motion_sample(rot, *azimuth, *elevation);
+    }
+
+    return retval;
 }
 
 
@@ -648,6 +712,7 @@ int HAMLIB_API rot_get_position(ROT *rot,
 int HAMLIB_API rot_park(ROT *rot)
 {
     const struct rot_caps *caps;
+    int retval;
 
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
@@ -658,12 +723,21 @@ int HAMLIB_API rot_park(ROT *rot)
 
     caps = rot->caps;
 
+    rot_track_stop(rot);
+
     if (caps->park == NULL)
     {
         return -RIG_ENAVAIL;
     }
 
-    return caps->park(rot);
+    rot_track_io_lock(rot);
+    retval = caps->park(rot);
+    rot_track_io_unlock(rot);
+
+    rot_motion_clear(rot);
+    rot_poll_wake(rot);
+
+    return retval;
 }
 
 
@@ -681,6 +755,7 @@ int HAMLIB_API rot_park(ROT *rot)
 int HAMLIB_API rot_stop(ROT *rot)
 {
     const struct rot_caps *caps;
+    int retval;
 
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
@@ -691,12 +766,21 @@ int HAMLIB_API rot_stop(ROT *rot)
 
     caps = rot->caps;
 
+    rot_track_stop(rot);
+
     if (caps->stop == NULL)
     {
         return -RIG_ENAVAIL;
     }
 
-    return caps->stop(rot);
+    rot_track_io_lock(rot);
+    retval = caps->stop(rot);
+    rot_track_io_unlock(rot);
+
+    rot_motion_clear(rot);
+    rot_poll_wake(rot);
+
+    return retval;
 }
 
 
@@ -715,6 +799,7 @@ int HAMLIB_API rot_stop(ROT *rot)
 int HAMLIB_API rot_reset(ROT *rot, rot_reset_t reset)
 {
     const struct rot_caps *caps;
+    int retval;
 
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
@@ -730,7 +815,14 @@ int HAMLIB_API rot_reset(ROT *rot, rot_reset_t reset)
         return -RIG_ENAVAIL;
     }
 
-    return caps->reset(rot, reset);
+    rot_track_io_lock(rot);
+    retval = caps->reset(rot, reset);
+    rot_track_io_unlock(rot);
+
+    rot_motion_clear(rot);
+    rot_poll_wake(rot);
+
+    return retval;
 }
 
 
@@ -746,6 +838,7 @@ int HAMLIB_API rot_reset(ROT *rot, rot_reset_t reset)
 int HAMLIB_API rot_move(ROT *rot, int direction, int speed)
 {
     const struct rot_caps *caps;
+    int retval;
 
     rot_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
 
@@ -761,7 +854,14 @@ int HAMLIB_API rot_move(ROT *rot, int direction, int speed)
         return -RIG_ENAVAIL;
     }
 
-    return caps->move(rot, direction, speed);
+    rot_track_io_lock(rot);
+    retval = caps->move(rot, direction, speed);
+    rot_track_io_unlock(rot);
+
+    rot_motion_clear(rot);
+    rot_poll_wake(rot);
+
+    return retval;
 }
 
 
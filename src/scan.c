@@ -0,0 +1,442 @@
+/*
+ *  Hamlib Interface - software channel scan
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file scan.c
+ * \brief Software channel scan
+ *
+ * rig_scan() only drives the scanner of the rig.  The software scan steps
+ * through a list of memory channels and frequencies itself, for rigs
+ * without a scanner, or when the scanner of the rig is too slow or too
+ * limited.
+ *
+ * Each channel keeps an activity score.  A quiet channel is left after
+ * dwell_min_ms, while the channels found busy lately are watched up to
+ * dwell_max_ms, so that the scan spends its time where the traffic is.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <hamlib/rig.h>
+#include "misc.h"
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_RIG_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define SCAN_ACTIVITY_MAX   255
+#define SCAN_POLL_MIN_US    2000    /* paces the polls of fast links */
+
+struct scan_state
+{
+    RIG *rig;
+    vfo_t vfo;
+    const struct rig_scan_params *p;
+    scan_hit_cb_t hit_cb;
+    rig_ptr_t arg;
+    unsigned char *activity;
+    int stop;
+};
+
+
+static uint64_t scan_now_us(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static int scan_sense(struct scan_state *ss, int *busy, int *strength)
+{
+    int retval;
+
+    if (ss->p->sense == RIG_SCAN_SENSE_STRENGTH)
+    {
+        value_t val;
+
+        retval = rig_get_level(ss->rig, ss->vfo, RIG_LEVEL_STRENGTH, &val);
+
+        if (retval == RIG_OK)
+        {
+            *strength = val.i;
+            *busy = val.i >= ss->p->threshold;
+        }
+    }
+    else
+    {
+        dcd_t dcd;
+
+        retval = rig_get_dcd(ss->rig, ss->vfo, &dcd);
+
+        if (retval == RIG_OK)
+        {
+            *busy = dcd == RIG_DCD_ON;
+        }
+    }
+
+    return retval;
+}
+
+
+/* like scan_sense, without returning sooner than SCAN_POLL_MIN_US */
+static int scan_poll(struct scan_state *ss, int *busy, int *strength)
+{
+    uint64_t start = scan_now_us();
+    uint64_t elapsed;
+    int retval;
+
+    retval = scan_sense(ss, busy, strength);
+
+    elapsed = scan_now_us() - start;
+
+    if (retval == RIG_OK && elapsed < SCAN_POLL_MIN_US)
+    {
+        usleep(SCAN_POLL_MIN_US - elapsed);
+    }
+
+    return retval;
+}
+
+
+static int scan_tune_sense(struct scan_state *ss,
+                           const struct rig_scan_entry *e,
+                           int *busy,
+                           int *strength)
+{
+    RIG *rig = ss->rig;
+    int retval;
+
+    if (e->channel_num >= 0)
+    {
+        retval = rig_set_mem(rig, ss->vfo, e->channel_num);
+    }
+    else if (ss->p->sense == RIG_SCAN_SENSE_DCD)
+    {
+        dcd_t dcd;
+
+        /* both commands in one exchange where the backend can */
+        retval = rig_tune_get_dcd(rig, ss->vfo, e->freq, &dcd);
+
+        if (retval == RIG_OK)
+        {
+            *busy = dcd == RIG_DCD_ON;
+        }
+
+        return retval;
+    }
+    else
+    {
+        retval = rig_set_freq(rig, ss->vfo, e->freq);
+    }
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    return scan_sense(ss, busy, strength);
+}
+
+
+static int scan_visit(struct scan_state *ss, int idx)
+{
+    const struct rig_scan_params *p = ss->p;
+    const struct rig_scan_entry *e = &p->entries[idx];
+    unsigned char *activity = &ss->activity[idx];
+    struct rig_scan_hit hit;
+    uint64_t start, last_busy, dwell_us;
+    int busy = 0, strength = 0;
+    int retval;
+
+    retval = scan_tune_sense(ss, e, &busy, &strength);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    /* the more active the channel lately, the longer the dwell */
+    dwell_us = 1000 * (uint64_t)p->dwell_min_ms;
+
+    if (p->dwell_max_ms > p->dwell_min_ms)
+    {
+        dwell_us += 1000 * (uint64_t)(p->dwell_max_ms - p->dwell_min_ms)
+                    * *activity / SCAN_ACTIVITY_MAX;
+    }
+
+    start = scan_now_us();
+
+    while (!busy && scan_now_us() - start < dwell_us)
+    {
+        retval = scan_poll(ss, &busy, &strength);
+
+        if (retval != RIG_OK)
+        {
+            return retval;
+        }
+    }
+
+    if (!busy)
+    {
+        *activity -= *activity / 8;
+        return RIG_OK;
+    }
+
+    *activity += (SCAN_ACTIVITY_MAX - *activity) / 4;
+
+    rig_debug(RIG_DEBUG_TRACE, "%s: hit on entry %d, activity %d\n",
+              __func__, idx, *activity);
+
+    if (ss->hit_cb)
+    {
+        hit.index = idx;
+        hit.channel_num = e->channel_num;
+        hit.freq = e->freq;
+        hit.strength = strength;
+        hit.priority = e->priority;
+
+        if (ss->hit_cb(ss->rig, &hit, ss->arg))
+        {
+            ss->stop = 1;
+            return RIG_OK;
+        }
+    }
+
+    /* stay while busy, and hang_ms after */
+    start = last_busy = scan_now_us();
+
+    while (scan_now_us() - last_busy < 1000 * (uint64_t)p->hang_ms)
+    {
+        if (p->hold_max_ms > 0
+                && scan_now_us() - start >= 1000 * (uint64_t)p->hold_max_ms)
+        {
+            break;
+        }
+
+        retval = scan_poll(ss, &busy, &strength);
+
+        if (retval != RIG_OK)
+        {
+            return retval;
+        }
+
+        if (busy)
+        {
+            last_busy = scan_now_us();
+        }
+    }
+
+    return RIG_OK;
+}
+
+
+static int scan_priority(struct scan_state *ss)
+{
+    int i, retval;
+
+    for (i = 0; i < ss->p->nentries && !ss->stop; i++)
+    {
+        if (!ss->p->entries[i].priority)
+        {
+            continue;
+        }
+
+        retval = scan_visit(ss, i);
+
+        if (retval != RIG_OK)
+        {
+            return retval;
+        }
+    }
+
+    return RIG_OK;
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief scan a list of channels and frequencies in software
+ * \param rig           The rig handle
+ * \param vfo           The target VFO
+ * \param params        The list and the timings of the scan
+ * \param hit_cb        Called for each busy channel found, or NULL
+ * \param arg           Passed to \a hit_cb
+ *
+ *  Steps through the entries of \a params, tuning to each with
+ *  rig_set_mem() or rig_set_freq(), and tells whether the channel is busy
+ *  with rig_get_dcd(), or with RIG_LEVEL_STRENGTH.  Memory channels
+ *  need the rig already in memory mode.  When the backend provides it,
+ *  tuning and reading the squelch status are done in a single exchange.
+ *
+ *  A quiet channel is left after \a params->dwell_min_ms, or later, up to
+ *  \a params->dwell_max_ms, for the channels found busy lately.  On a
+ *  busy channel, \a hit_cb is called, then the scan stays until the
+ *  channel has been quiet for \a params->hang_ms, or for at most
+ *  \a params->hold_max_ms when not 0.
+ *
+ *  When \a params->priority_ms is not 0, the priority entries are visited
+ *  at that period in between the other entries, instead of in turn.
+ *
+ *  The scan ends after \a params->passes passes over the list, or when
+ *  \a hit_cb returns non zero.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_scan()
+ */
+int HAMLIB_API rig_scan_soft(RIG *rig,
+                             vfo_t vfo,
+                             const struct rig_scan_params *params,
+                             scan_hit_cb_t hit_cb,
+                             rig_ptr_t arg)
+{
+    struct scan_state ss;
+    uint64_t last_priority = 0;
+    int has_priority = 0, has_normal = 0;
+    int pass, i, retval = RIG_OK;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig) || !params || !params->entries
+            || params->nentries <= 0 || params->dwell_min_ms < 0
+            || params->hang_ms < 0 || params->hold_max_ms < 0
+            || params->priority_ms < 0
+            || params->passes < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (params->sense == RIG_SCAN_SENSE_STRENGTH
+            && !rig_has_get_level(rig, RIG_LEVEL_STRENGTH))
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    memset(&ss, 0, sizeof(ss));
+    ss.rig = rig;
+    ss.vfo = vfo;
+    ss.p = params;
+    ss.hit_cb = hit_cb;
+    ss.arg = arg;
+
+    ss.activity = calloc(params->nentries, 1);
+
+    if (!ss.activity)
+    {
+        return -RIG_ENOMEM;
+    }
+
+    for (i = 0; i < params->nentries; i++)
+    {
+        if (params->entries[i].priority && params->priority_ms > 0)
+        {
+            has_priority = 1;
+        }
+        else
+        {
+            has_normal = 1;
+        }
+    }
+
+    for (pass = 0; !ss.stop && (params->passes == 0 || pass < params->passes);
+            pass++)
+    {
+        /* only priority entries, visit them once per pass */
+        if (!has_normal)
+        {
+            retval = scan_priority(&ss);
+
+            if (retval != RIG_OK)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        for (i = 0; i < params->nentries && !ss.stop; i++)
+        {
+            if (has_priority && params->entries[i].priority)
+            {
+                continue;
+            }
+
+            if (has_priority
+                    && scan_now_us() - last_priority
+                    >= 1000 * (uint64_t)params->priority_ms)
+            {
+                retval = scan_priority(&ss);
+
+                if (retval != RIG_OK)
+                {
+                    break;
+                }
+
+                last_priority = scan_now_us();
+
+                if (ss.stop)
+                {
+                    break;
+                }
+            }
+
+            retval = scan_visit(&ss, i);
+
+            if (retval != RIG_OK)
+            {
+                break;
+            }
+        }
+
+        if (retval != RIG_OK)
+        {
+            break;
+        }
+    }
+
+    free(ss.activity);
+
+    return retval;
+}
+
+/*! @} */
@@ -84,6 +84,7 @@
 #endif
 
 #include "microham.h"
+#include "replay.h"
 
 static int uh_ptt_fd   = -1;
 static int uh_radio_fd = -1;
@@ -537,11 +538,26 @@ int HAMLIB_API serial_flush(hamlib_port_t *p)
          * if fd corresponds to a microHam device drain the line
          * (which is a socket) by reading until it is empty.
          */
-        while (read(p->fd, buf, 32) > 0) {
-            /* do nothing */
+        int n;
+
+        while ((n = read(p->fd, buf, 32)) > 0) {
+            p->stats.flushed += n;
         }
         return RIG_OK;
     }
+    if (p->type.rig == RIG_PORT_REPLAY) {
+        return replay_flush(p);
+    }
+#ifdef FIONREAD
+    {
+        int pending = 0;
+
+        /* count what tcflush() is about to throw away */
+        if (IOCTL(p->fd, FIONREAD, &pending) == 0 && pending > 0) {
+            p->stats.flushed += pending;
+        }
+    }
+#endif
     tcflush(p->fd, TCIFLUSH);
     return RIG_OK;
 }
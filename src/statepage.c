@@ -0,0 +1,471 @@
+/*
+ *  Hamlib Interface - shared rig state page
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file statepage.c
+ * \brief Rig state shared in memory with local readers
+ *
+ * A state page is a small file mapped in memory by one writer, rigctld
+ * for instance, and by any number of readers on the same host.  The
+ * writer publishes the frequency, mode and PTT state of the rig; a
+ * reader gets them with a few loads, without a system call nor a round
+ * trip to the writer.
+ *
+ * The page is guarded by a sequence count: the writer makes it odd
+ * before it changes the page and even again once done, and a reader
+ * copies the page until it sees the same even count before and after.
+ * Readers never block the writer.
+ *
+ * The page is host endian, and only meant for readers of the same host.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_STAT_H
+#  include <sys/stat.h>
+#endif
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#  include <sys/mman.h>
+#  define STATE_PAGE_MMAP 1
+#endif
+
+#include <hamlib/rig.h>
+
+#ifndef DOC_HIDDEN
+
+#define STATE_PAGE_MAGIC        "HLSTATE"
+#define STATE_PAGE_VERSION      1
+#define STATE_PAGE_BYTE_ORDER   0x01020304
+
+/* a writer that died half way leaves the count odd, readers give up */
+#define STATE_PAGE_RETRIES      100000
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define SEQ_LOAD(p)           __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#  define SEQ_STORE(p, v)       __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#  define SEQ_FENCE_ACQ()       __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#  define SEQ_FENCE_REL()       __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#  define SEQ_LOAD(p)           (*(p))
+#  define SEQ_STORE(p, v)       (*(p) = (v))
+#  define SEQ_FENCE_ACQ()
+#  define SEQ_FENCE_REL()
+#endif
+
+/*
+ * All the fields have a fixed width, the page does not depend on the
+ * build of the writer nor of the readers.
+ */
+struct state_page_data
+{
+    double freq;
+    uint64_t mode;
+    int64_t width;
+    uint32_t vfo;
+    uint32_t ptt;
+    uint64_t count;
+    double stamp;
+};
+
+struct state_page_hdr
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t size;          /* of the whole page */
+    volatile uint32_t seq;  /* odd while the writer changes data */
+    struct state_page_data data;
+};
+
+#endif  /* !DOC_HIDDEN */
+
+/**
+ * \brief Mapped state page
+ *
+ * Opaque, see rig_state_page_create() and rig_state_page_open().
+ */
+struct rig_state_page
+{
+    struct state_page_hdr *hdr;         /*!< The mapped page */
+    int writable;                       /*!< Opened by the writer */
+};
+
+#ifndef DOC_HIDDEN
+
+#ifdef STATE_PAGE_MMAP
+/*
+ * Map the page of 'path'.  The writer creates the file if need be, and
+ * sizes it when empty, '*fresh' telling so; a file too short for a page
+ * is refused either way.
+ */
+static int map_page(const char *path, int writable,
+                    struct rig_state_page **page, int *fresh)
+{
+    struct rig_state_page *pg;
+    struct stat st;
+    void *base;
+    int fd;
+
+    fd = writable ? open(path, O_RDWR | O_CREAT, 0644) : open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot open '%s'\n", __func__, path);
+        return -RIG_EIO;
+    }
+
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return -RIG_EIO;
+    }
+
+    *fresh = writable && st.st_size == 0;
+
+    if (*fresh)
+    {
+        if (ftruncate(fd, sizeof(struct state_page_hdr)) < 0)
+        {
+            close(fd);
+            return -RIG_EIO;
+        }
+    }
+    else if ((size_t) st.st_size < sizeof(struct state_page_hdr))
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is not a state page\n",
+                  __func__, path);
+        close(fd);
+        return -RIG_EPROTO;
+    }
+
+    base = mmap(NULL, sizeof(struct state_page_hdr),
+                writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                MAP_SHARED, fd, 0);
+
+    /* the mapping holds the file */
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot map '%s'\n", __func__, path);
+        return -RIG_EIO;
+    }
+
+    pg = calloc(1, sizeof(*pg));
+
+    if (!pg)
+    {
+        munmap(base, sizeof(struct state_page_hdr));
+        return -RIG_ENOMEM;
+    }
+
+    pg->hdr = base;
+    pg->writable = writable;
+    *page = pg;
+
+    return RIG_OK;
+}
+#endif
+
+static int page_valid(const struct state_page_hdr *hdr)
+{
+    return !memcmp(hdr->magic, STATE_PAGE_MAGIC, sizeof(hdr->magic))
+           && hdr->byte_order == STATE_PAGE_BYTE_ORDER
+           && hdr->version == STATE_PAGE_VERSION
+           && hdr->size == sizeof(*hdr);
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief create a shared state page
+ * \param path          The page file, on a memory backed file system
+ * \param page          Where to store the page
+ *
+ *  Creates the file \a path, or takes over an existing page, and maps it
+ *  for writing.  An existing file which is neither empty nor a page of
+ *  this version is left alone.  There should be one writer per page; it
+ *  updates the page with rig_state_page_publish() and releases it with
+ *  rig_state_page_close().  The file is left in place for the next
+ *  writer, so that readers can keep their mapping.
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_EPROTO if
+ * \a path holds something else than a state page of this version and
+ * byte order, -RIG_ENIMPL where memory mapped files are not available,
+ * otherwise a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ *
+ * \sa rig_state_page_open()
+ */
+int HAMLIB_API rig_state_page_create(const char *path,
+                                     struct rig_state_page **page)
+{
+#ifdef STATE_PAGE_MMAP
+    struct state_page_hdr *hdr;
+    int retval;
+    int fresh;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!path || !page)
+    {
+        return -RIG_EINVAL;
+    }
+
+    retval = map_page(path, 1, page, &fresh);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    hdr = (*page)->hdr;
+
+    if (page_valid(hdr))
+    {
+        /* readers of the previous writer go on, the count stays monotonic */
+        if (hdr->seq & 1)
+        {
+            SEQ_STORE(&hdr->seq, hdr->seq + 1);
+        }
+
+        return RIG_OK;
+    }
+
+    if (!fresh)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is not a state page of "
+                  "this version, not overwritten\n", __func__, path);
+        rig_state_page_close(*page);
+        *page = NULL;
+        return -RIG_EPROTO;
+    }
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->byte_order = STATE_PAGE_BYTE_ORDER;
+    hdr->version = STATE_PAGE_VERSION;
+    hdr->size = sizeof(*hdr);
+    hdr->data.vfo = RIG_VFO_NONE;
+    hdr->data.ptt = RIG_PTT_OFF;
+    SEQ_FENCE_REL();
+    memcpy(hdr->magic, STATE_PAGE_MAGIC, sizeof(hdr->magic));
+
+    return RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief open a shared state page for reading
+ * \param path          The page file
+ * \param page          Where to store the page
+ *
+ *  Maps the page made by rig_state_page_create() read only.  The page
+ *  is then read with rig_state_page_read(), and released with
+ *  rig_state_page_close().
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_EPROTO if
+ * \a path is not a state page of this version and byte order, -RIG_ENIMPL
+ * where memory mapped files are not available, otherwise a negative value
+ * if an error occured (in which case, cause is set appropriately).
+ *
+ * \sa rig_state_page_create()
+ */
+int HAMLIB_API rig_state_page_open(const char *path,
+                                   struct rig_state_page **page)
+{
+#ifdef STATE_PAGE_MMAP
+    int retval;
+    int fresh;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!path || !page)
+    {
+        return -RIG_EINVAL;
+    }
+
+    retval = map_page(path, 0, page, &fresh);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    if (!page_valid((*page)->hdr))
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: '%s' is not a state page of "
+                  "this version\n", __func__, path);
+        rig_state_page_close(*page);
+        *page = NULL;
+        return -RIG_EPROTO;
+    }
+
+    return RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief release a shared state page
+ * \param page          The page
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise a negative
+ * value if an error occured.
+ */
+int HAMLIB_API rig_state_page_close(struct rig_state_page *page)
+{
+    if (!page)
+    {
+        return -RIG_EINVAL;
+    }
+
+#ifdef STATE_PAGE_MMAP
+    munmap((void *) page->hdr, sizeof(*page->hdr));
+#endif
+    free(page);
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief update a shared state page
+ * \param page          The page, from rig_state_page_create()
+ * \param snap          The new state
+ *
+ *  Copies \a snap to the page.  The count of \a snap is not used, the
+ *  page keeps its own.
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_EINVAL if
+ * the page was opened read only.
+ */
+int HAMLIB_API rig_state_page_publish(struct rig_state_page *page,
+                                      const struct rig_state_snapshot *snap)
+{
+    struct state_page_hdr *hdr;
+    uint32_t seq;
+
+    if (!page || !snap || !page->writable)
+    {
+        return -RIG_EINVAL;
+    }
+
+    hdr = page->hdr;
+    seq = hdr->seq;
+
+    SEQ_STORE(&hdr->seq, seq + 1);
+    SEQ_FENCE_REL();
+
+    hdr->data.freq = snap->freq;
+    hdr->data.mode = snap->mode;
+    hdr->data.width = snap->width;
+    hdr->data.vfo = snap->vfo;
+    hdr->data.ptt = snap->ptt;
+    hdr->data.count++;
+    hdr->data.stamp = snap->stamp;
+
+    SEQ_STORE(&hdr->seq, seq + 2);
+
+    return RIG_OK;
+}
+
+
+/**
+ * \brief read a shared state page
+ * \param page          The page
+ * \param snap          Where to store the state
+ *
+ *  Takes a consistent copy of the page, retrying while the writer is
+ *  changing it.  No system call is made.  The age of the state is given
+ *  by its stamp; a count that does not move tells the writer is gone.
+ *
+ * \return RIG_OK if the operation has been sucessful, -RIG_ETIMEOUT if
+ * the writer left the page half written.
+ */
+int HAMLIB_API rig_state_page_read(const struct rig_state_page *page,
+                                   struct rig_state_snapshot *snap)
+{
+    const struct state_page_hdr *hdr;
+    struct state_page_data data;
+    uint32_t seq1, seq2;
+    int retry;
+
+    if (!page || !snap)
+    {
+        return -RIG_EINVAL;
+    }
+
+    hdr = page->hdr;
+
+    for (retry = 0; retry < STATE_PAGE_RETRIES; retry++)
+    {
+        seq1 = SEQ_LOAD(&hdr->seq);
+
+        if (seq1 & 1)
+        {
+            continue;
+        }
+
+        memcpy(&data, (const void *) &hdr->data, sizeof(data));
+        SEQ_FENCE_ACQ();
+        seq2 = SEQ_LOAD(&hdr->seq);
+
+        if (seq1 == seq2)
+        {
+            snap->freq = data.freq;
+            snap->mode = data.mode;
+            snap->width = data.width;
+            snap->vfo = data.vfo;
+            snap->ptt = data.ptt;
+            snap->count = data.count;
+            snap->stamp = data.stamp;
+            return RIG_OK;
+        }
+    }
+
+    return -RIG_ETIMEOUT;
+}
+
+/** @} */
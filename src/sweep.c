@@ -0,0 +1,307 @@
+/*
+ *  Hamlib Interface - frequency sweep
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig
+ * @{
+ */
+
+/**
+ * \file sweep.c
+ * \brief Frequency sweep
+ *
+ * Steps the rig over a frequency range and reads a meter level at each
+ * point, e.g. RIG_LEVEL_STRENGTH for a panoramic view of a band, or
+ * RIG_LEVEL_SWR for the SWR curve of an antenna.
+ *
+ * The settling time between tuning and reading the meter is measured on
+ * the first point, unless given.  The rig is tuned to the next point
+ * before the current one is handed to the callback, so that the callback
+ * runs while the rig settles.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+
+#include <hamlib/rig.h>
+#include "misc.h"
+
+#ifndef DOC_HIDDEN
+
+#define CHECK_RIG_ARG(r) (!(r) || !(r)->caps || !(r)->state.comm_state)
+
+#define SWEEP_SETTLE_MAX_US     (1000 * 1000)
+
+
+static uint64_t sweep_now_us(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+static void sweep_wait_until(uint64_t date_us)
+{
+    uint64_t now = sweep_now_us();
+
+    if (now < date_us)
+    {
+        usleep(date_us - now);
+    }
+}
+
+
+static int sweep_read(RIG *rig,
+                      vfo_t vfo,
+                      const struct rig_sweep_params *p,
+                      uint64_t ready_us,
+                      value_t *val)
+{
+    int retval, rc2;
+
+    sweep_wait_until(ready_us);
+
+    retval = rig_get_level(rig, vfo, p->level, val);
+
+    if (p->ptt)
+    {
+        rc2 = rig_set_ptt(rig, vfo, RIG_PTT_OFF);
+
+        if (retval == RIG_OK)
+        {
+            retval = rc2;
+        }
+    }
+
+    return retval;
+}
+
+
+static int sweep_tune(RIG *rig,
+                      vfo_t vfo,
+                      const struct rig_sweep_params *p,
+                      freq_t freq)
+{
+    int retval;
+
+    retval = rig_set_freq(rig, vfo, freq);
+
+    if (retval == RIG_OK && p->ptt)
+    {
+        retval = rig_set_ptt(rig, vfo, RIG_PTT_ON);
+    }
+
+    return retval;
+}
+
+
+/*
+ * Reads the meter until two readings in a row agree, and returns the
+ * time it took since tuning, less the time of one reading.
+ */
+static int sweep_measure_settle(RIG *rig,
+                                vfo_t vfo,
+                                const struct rig_sweep_params *p,
+                                uint64_t tuned_us,
+                                value_t *val,
+                                uint64_t *settle_us)
+{
+    value_t prev;
+    uint64_t t0, t1;
+    int is_float = RIG_LEVEL_IS_FLOAT(p->level) != 0;
+    int retval;
+
+    t0 = sweep_now_us();
+    retval = rig_get_level(rig, vfo, p->level, &prev);
+    t1 = sweep_now_us();
+
+    while (retval == RIG_OK)
+    {
+        uint64_t t2;
+
+        retval = rig_get_level(rig, vfo, p->level, val);
+        t2 = sweep_now_us();
+
+        if (retval != RIG_OK)
+        {
+            break;
+        }
+
+        if ((is_float && val->f == prev.f) || (!is_float && val->i == prev.i)
+                || t2 - tuned_us >= SWEEP_SETTLE_MAX_US)
+        {
+            /* settled by the previous reading */
+            *settle_us = t0 - tuned_us;
+            break;
+        }
+
+        prev = *val;
+        t0 = t1;
+        t1 = t2;
+    }
+
+    if (p->ptt)
+    {
+        int rc2 = rig_set_ptt(rig, vfo, RIG_PTT_OFF);
+
+        if (retval == RIG_OK)
+        {
+            retval = rc2;
+        }
+    }
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: settle time %u ms\n", __func__,
+              (unsigned)(*settle_us / 1000));
+
+    return retval;
+}
+
+#endif  /* !DOC_HIDDEN */
+
+
+/**
+ * \brief sweep a frequency range, reading a meter at each point
+ * \param rig           The rig handle
+ * \param vfo           The target VFO
+ * \param params        The range, the level to read and the timings
+ * \param sweep_cb      Called with each point, may not be NULL
+ * \param arg           Passed to \a sweep_cb
+ *
+ *  Tunes from \a params->start to \a params->stop by \a params->step, and
+ *  reads the level \a params->level at each point, \a params->settle_ms
+ *  after tuning.  With a negative \a params->settle_ms, the settling time
+ *  is measured on the first point, as the time it takes for the meter
+ *  readings to stop changing, at most one second.
+ *
+ *  When \a params->ptt is set, the transmitter is keyed after tuning and
+ *  released after reading each point, e.g. for RIG_LEVEL_SWR.
+ *
+ *  The rig is tuned to the next point before \a sweep_cb is called with
+ *  the current one, so the callback runs during the settling time.  The
+ *  sweep stops when \a sweep_cb returns non zero.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause is
+ * set appropriately).
+ */
+int HAMLIB_API rig_sweep(RIG *rig,
+                         vfo_t vfo,
+                         const struct rig_sweep_params *params,
+                         sweep_cb_t sweep_cb,
+                         rig_ptr_t arg)
+{
+    struct rig_sweep_point point;
+    uint64_t settle_us, tuned_us;
+    freq_t freq;
+    int retval;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (CHECK_RIG_ARG(rig) || !params || !sweep_cb || params->step <= 0
+            || params->stop < params->start)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (!rig_has_get_level(rig, params->level))
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    freq = params->start;
+
+    retval = sweep_tune(rig, vfo, params, freq);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    tuned_us = sweep_now_us();
+    memset(&point, 0, sizeof(point));
+
+    if (params->settle_ms < 0)
+    {
+        settle_us = 0;
+        retval = sweep_measure_settle(rig, vfo, params, tuned_us,
+                                      &point.val, &settle_us);
+    }
+    else
+    {
+        settle_us = 1000 * (uint64_t)params->settle_ms;
+        retval = sweep_read(rig, vfo, params, tuned_us + settle_us,
+                            &point.val);
+    }
+
+    while (retval == RIG_OK)
+    {
+        freq_t next = params->start + (point.index + 1) * params->step;
+        int last = next > params->stop;
+
+        point.freq = freq;
+
+        /* the rig settles on the next point while the callback runs */
+        if (!last)
+        {
+            retval = sweep_tune(rig, vfo, params, next);
+
+            if (retval != RIG_OK)
+            {
+                break;
+            }
+
+            tuned_us = sweep_now_us();
+        }
+
+        if (sweep_cb(rig, &point, arg) || last)
+        {
+            if (!last && params->ptt)
+            {
+                rig_set_ptt(rig, vfo, RIG_PTT_OFF);
+            }
+
+            break;
+        }
+
+        freq = next;
+        point.index++;
+
+        retval = sweep_read(rig, vfo, params, tuned_us + settle_us,
+                            &point.val);
+    }
+
+    return retval;
+}
+
+/*! @} */
@@ -87,6 +87,12 @@
 #define TOK_DCD_PATHNAME    TOKEN_FRONTEND(33)
 /** \brief  CM108 GPIO bit number for PTT */
 #define TOK_PTT_BITNUM        TOKEN_FRONTEND(34)
+/** \brief  Record the port I/O to this file */
+#define TOK_RECORD_PATHNAME TOKEN_FRONTEND(40)
+/** \brief  Replay a recorded session instead of opening the port */
+#define TOK_REPLAY_PATHNAME TOKEN_FRONTEND(41)
+/** \brief  Reply latency factor of the replay */
+#define TOK_REPLAY_SCALE    TOKEN_FRONTEND(42)
 /*
  * rig specific tokens
  */
@@ -112,6 +118,18 @@
 #define TOK_MIN_EL  TOKEN_FRONTEND(112)
 /** \brief rot: Maximum Elevation */
 #define TOK_MAX_EL  TOKEN_FRONTEND(113)
+/** \brief rot: Azimuth slew rate */
+#define TOK_AZ_RATE TOKEN_FRONTEND(114)
+/** \brief rot: Elevation slew rate */
+#define TOK_EL_RATE TOKEN_FRONTEND(115)
+/** \brief rot: Tracking dead band */
+#define TOK_TRACK_DEADBAND  TOKEN_FRONTEND(116)
+/** \brief rot: Position polling interval */
+#define TOK_ROT_POLL_INTERVAL   TOKEN_FRONTEND(117)
+/** \brief rot: Position polling interval when still */
+#define TOK_ROT_POLL_IDLE   TOKEN_FRONTEND(118)
+/** \brief rot: File keeping the learned motion */
+#define TOK_ROT_MOTION_FILE TOKEN_FRONTEND(119)
 
 
 #endif /* _TOKEN_H */
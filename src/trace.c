@@ -0,0 +1,448 @@
+/*
+ *  Hamlib Interface - binary I/O trace
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/**
+ * \addtogroup rig_internal
+ * @{
+ */
+
+/**
+ * \file trace.c
+ * \brief Binary capture of port I/O
+ *
+ * Every thread doing port I/O gets its own ring buffer.  The I/O path
+ * only copies a compact record into it, without locking nor formatting;
+ * a drain thread empties the rings into the trace file.  When a ring is
+ * full, records are dropped and counted rather than stalling the I/O.
+ * Use the rigtrace utility to decode the file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <hamlib/rig.h>
+#include "trace.h"
+
+#if defined(HAVE_PTHREAD) && defined(__GNUC__)
+#  define HAVE_TRACE 1
+#  include <pthread.h>
+#endif
+
+int rig_trace_active;
+
+
+/* time stamp of the trace records, also used by the port recorder */
+uint64_t rig_trace_now_ns(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000000000 + (uint64_t)tv.tv_usec * 1000;
+#endif
+}
+
+
+#ifdef HAVE_TRACE
+
+#define TRACE_RING_SIZE     (64 * 1024)     /* must be a power of two */
+#define TRACE_RING_MASK     (TRACE_RING_SIZE - 1)
+#define TRACE_DRAIN_US      (20 * 1000)
+
+/*
+ * Single producer (the owning thread), single consumer (the drain thread).
+ * head and tail are free running byte counters.
+ */
+struct trace_ring {
+    unsigned char buf[TRACE_RING_SIZE];
+    unsigned long head;         /* written by the owner only */
+    unsigned long tail;         /* written by the drain thread only */
+    unsigned long dropped;      /* owner only */
+    int dead;                   /* owner thread has exited */
+    struct trace_ring *next;
+};
+
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t trace_once = PTHREAD_ONCE_INIT;
+static pthread_key_t trace_key;
+static pthread_t trace_thread;
+static struct trace_ring *trace_rings;  /* protected by trace_mutex */
+static FILE *trace_file;
+static int trace_stop;
+
+
+static void trace_ring_release(void *arg)
+{
+    struct trace_ring *ring = arg;
+
+    /* the drain thread frees it once emptied */
+    __atomic_store_n(&ring->dead, 1, __ATOMIC_RELEASE);
+}
+
+
+static void trace_key_init(void)
+{
+    pthread_key_create(&trace_key, trace_ring_release);
+}
+
+
+static struct trace_ring *trace_ring_get(void)
+{
+    struct trace_ring *ring;
+
+    pthread_once(&trace_once, trace_key_init);
+
+    ring = pthread_getspecific(trace_key);
+
+    if (ring)
+    {
+        return ring;
+    }
+
+    ring = calloc(1, sizeof(struct trace_ring));
+
+    if (!ring)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&trace_mutex);
+    ring->next = trace_rings;
+    trace_rings = ring;
+    pthread_mutex_unlock(&trace_mutex);
+
+    pthread_setspecific(trace_key, ring);
+
+    return ring;
+}
+
+
+static void trace_ring_put(struct trace_ring *ring,
+                           unsigned long pos,
+                           const void *data,
+                           size_t len)
+{
+    size_t off = pos & TRACE_RING_MASK;
+    size_t first = TRACE_RING_SIZE - off;
+
+    if (first >= len)
+    {
+        memcpy(ring->buf + off, data, len);
+    }
+    else
+    {
+        memcpy(ring->buf + off, data, first);
+        memcpy(ring->buf, (const unsigned char *)data + first, len - first);
+    }
+}
+
+
+/* returns 0 when there was no room for the record */
+static int trace_ring_push(struct trace_ring *ring,
+                           const struct rig_trace_rec *rec,
+                           const void *buf,
+                           size_t len)
+{
+    static const unsigned char zero[8];
+    unsigned long head = ring->head;
+    unsigned long tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t need = sizeof(*rec) + RIG_TRACE_PAD(len);
+
+    if (need > TRACE_RING_SIZE - (head - tail))
+    {
+        return 0;
+    }
+
+    trace_ring_put(ring, head, rec, sizeof(*rec));
+    head += sizeof(*rec);
+
+    if (len > 0)
+    {
+        trace_ring_put(ring, head, buf, len);
+        head += len;
+        trace_ring_put(ring, head, zero, RIG_TRACE_PAD(len) - len);
+        head += RIG_TRACE_PAD(len) - len;
+    }
+
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+
+/**
+ * \brief Record one port transfer in the calling thread's trace ring
+ * \param p port the transfer happened on
+ * \param dir direction or outcome of the transfer
+ * \param func I/O function that did the transfer
+ * \param buf bytes transferred
+ * \param len number of bytes
+ *
+ * Called through the rig_trace() macro, which checks rig_trace_active.
+ */
+void rig_trace_io(const hamlib_port_t *p,
+                  enum rig_trace_dir_e dir,
+                  enum rig_trace_func_e func,
+                  const void *buf,
+                  size_t len)
+{
+    struct trace_ring *ring = trace_ring_get();
+    struct rig_trace_rec rec;
+    size_t stored = len > RIG_TRACE_MAX_PAYLOAD ? RIG_TRACE_MAX_PAYLOAD : len;
+
+    if (!ring)
+    {
+        return;
+    }
+
+    rec.ts_ns = rig_trace_now_ns();
+    rec.port = p ? (uint16_t)p->fd : 0;
+    rec.func = func;
+
+    if (ring->dropped)
+    {
+        rec.dir = RIG_TRACE_DROPPED;
+        rec.len = ring->dropped;
+
+        if (!trace_ring_push(ring, &rec, NULL, 0))
+        {
+            ring->dropped++;
+            return;
+        }
+
+        ring->dropped = 0;
+    }
+
+    rec.dir = dir;
+    rec.len = stored;
+
+    if (!trace_ring_push(ring, &rec, buf, stored))
+    {
+        ring->dropped++;
+    }
+}
+
+
+/* copy out whatever the owner published, returns bytes written */
+static size_t trace_ring_drain(struct trace_ring *ring, FILE *fp)
+{
+    unsigned long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    unsigned long tail = ring->tail;
+    size_t len = head - tail;
+    size_t off = tail & TRACE_RING_MASK;
+    size_t first = TRACE_RING_SIZE - off;
+
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    if (fp)
+    {
+        if (first >= len)
+        {
+            fwrite(ring->buf + off, 1, len, fp);
+        }
+        else
+        {
+            fwrite(ring->buf + off, 1, first, fp);
+            fwrite(ring->buf, 1, len - first, fp);
+        }
+    }
+
+    __atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+
+    return len;
+}
+
+
+static void trace_drain_all(FILE *fp)
+{
+    struct trace_ring **pp, *ring;
+
+    pthread_mutex_lock(&trace_mutex);
+
+    for (pp = &trace_rings; (ring = *pp) != NULL;)
+    {
+        int dead = __atomic_load_n(&ring->dead, __ATOMIC_ACQUIRE);
+
+        trace_ring_drain(ring, fp);
+
+        if (dead)
+        {
+            *pp = ring->next;
+            free(ring);
+            continue;
+        }
+
+        pp = &ring->next;
+    }
+
+    pthread_mutex_unlock(&trace_mutex);
+
+    if (fp)
+    {
+        fflush(fp);
+    }
+}
+
+
+static void *trace_drain_thread(void *arg)
+{
+    (void)arg;
+
+    while (!__atomic_load_n(&trace_stop, __ATOMIC_ACQUIRE))
+    {
+        trace_drain_all(trace_file);
+        usleep(TRACE_DRAIN_US);
+    }
+
+    return NULL;
+}
+
+#endif  /* HAVE_TRACE */
+
+
+/**
+ * \brief Start capturing port I/O to a binary trace file
+ * \param path file to create
+ *
+ * All transfers done by write_block(), read_block() and read_string()
+ * are recorded, from any thread, until rig_trace_close() is called.
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause
+ * is set appropriately).
+ *
+ * \sa rig_trace_close()
+ */
+int HAMLIB_API rig_trace_open(const char *path)
+{
+#ifdef HAVE_TRACE
+    struct rig_trace_file_hdr hdr;
+    FILE *fp;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!path)
+    {
+        return -RIG_EINVAL;
+    }
+
+    if (trace_file)
+    {
+        return -RIG_EINVAL;
+    }
+
+    fp = fopen(path, "wb");
+
+    if (!fp)
+    {
+        rig_debug(RIG_DEBUG_ERR, "%s: cannot open %s: %s\n",
+                  __func__, path, strerror(errno));
+        return -RIG_EIO;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, RIG_TRACE_MAGIC, sizeof(RIG_TRACE_MAGIC));
+    hdr.version = RIG_TRACE_VERSION;
+    hdr.byte_order = RIG_TRACE_BYTE_ORDER;
+
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+    {
+        fclose(fp);
+        return -RIG_EIO;
+    }
+
+    /* discard leftovers of a previous session */
+    trace_drain_all(NULL);
+
+    trace_file = fp;
+    trace_stop = 0;
+
+    if (pthread_create(&trace_thread, NULL, trace_drain_thread, NULL))
+    {
+        trace_file = NULL;
+        fclose(fp);
+        return -RIG_EINTERNAL;
+    }
+
+    __atomic_store_n(&rig_trace_active, 1, __ATOMIC_RELEASE);
+
+    return RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+
+/**
+ * \brief Stop capturing port I/O and close the trace file
+ *
+ * \return RIG_OK if the operation has been sucessful, otherwise
+ * a negative value if an error occured (in which case, cause
+ * is set appropriately).
+ *
+ * \sa rig_trace_open()
+ */
+int HAMLIB_API rig_trace_close(void)
+{
+#ifdef HAVE_TRACE
+    FILE *fp = trace_file;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s called\n", __func__);
+
+    if (!fp)
+    {
+        return -RIG_EINVAL;
+    }
+
+    __atomic_store_n(&rig_trace_active, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&trace_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(trace_thread, NULL);
+
+    trace_drain_all(fp);
+
+    trace_file = NULL;
+
+    return fclose(fp) ? -RIG_EIO : RIG_OK;
+#else
+    return -RIG_ENIMPL;
+#endif
+}
+
+/** @} */
@@ -0,0 +1,92 @@
+/*
+ *  Hamlib Interface - binary I/O trace header
+ *  Copyright (c) 2020 by The Hamlib Group
+ *
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef _TRACE_H
+#define _TRACE_H 1
+
+#include <stdint.h>
+#include <hamlib/rig.h>
+
+/*
+ * Trace file layout: one struct rig_trace_file_hdr, followed by records.
+ * Each record is a struct rig_trace_rec followed by len bytes of payload,
+ * padded with zeros up to the next multiple of 8 bytes.
+ * All fields are in the byte order of the writing host, see byte_order.
+ */
+#define RIG_TRACE_MAGIC         "HLTRACE"
+#define RIG_TRACE_VERSION       1
+#define RIG_TRACE_BYTE_ORDER    0x01020304
+
+/* payloads longer than this are truncated to it */
+#define RIG_TRACE_MAX_PAYLOAD   1024
+
+#define RIG_TRACE_PAD(len)      (((len) + 7) & ~7)
+
+struct rig_trace_file_hdr {
+    char magic[8];          /* RIG_TRACE_MAGIC, nul padded */
+    uint32_t version;       /* RIG_TRACE_VERSION */
+    uint32_t byte_order;    /* RIG_TRACE_BYTE_ORDER as written by the host */
+};
+
+struct rig_trace_rec {
+    uint64_t ts_ns;         /* monotonic clock, nanoseconds */
+    uint16_t port;          /* file descriptor of the port */
+    uint8_t dir;            /* enum rig_trace_dir_e */
+    uint8_t func;           /* enum rig_trace_func_e */
+    uint32_t len;           /* byte count (dropped count for DROPPED) */
+};
+
+enum rig_trace_dir_e {
+    RIG_TRACE_TX = 0,       /* bytes written to the port */
+    RIG_TRACE_RX,           /* bytes read from the port */
+    RIG_TRACE_TIMEOUT,      /* read timed out, payload is what was read */
+    RIG_TRACE_ERROR,        /* I/O error, payload is what was read */
+    RIG_TRACE_DROPPED       /* ring was full, len records were lost */
+};
+
+enum rig_trace_func_e {
+    RIG_TRACE_FN_NONE = 0,
+    RIG_TRACE_FN_WRITE_BLOCK,
+    RIG_TRACE_FN_READ_BLOCK,
+    RIG_TRACE_FN_READ_STRING,
+    RIG_TRACE_FN_READ_AVAIL
+};
+
+/* monotonic clock of the time stamps, in nanoseconds */
+extern uint64_t rig_trace_now_ns(void);
+
+/* non-zero while a trace file is open */
+extern int rig_trace_active;
+
+extern void rig_trace_io(const hamlib_port_t *p,
+                         enum rig_trace_dir_e dir,
+                         enum rig_trace_func_e func,
+                         const void *buf,
+                         size_t len);
+
+/* only costs a load and a compare while tracing is off */
+#define rig_trace(p, dir, func, buf, len) \
+    do { \
+        if (rig_trace_active) \
+            rig_trace_io((p), (dir), (func), (buf), (len)); \
+    } while (0)
+
+#endif /* _TRACE_H */
@@ -0,0 +1,75 @@
+#!/bin/sh
+#
+# Run the benchmark suite without hardware: against the dummy rig, the
+# Kenwood backend on the rigemu radio emulator, and a rigctld of the
+# dummy rig on the loopback.  The results are written to bench.json.
+#
+# BENCH_FLAGS may add options to benchmark, e.g. BENCH_FLAGS="-n 10000".
+# BENCH_PORT forces the TCP port of rigctld, otherwise a free one is used.
+
+out=${1:-bench.json}
+tty=./bench-kenwood.tty
+
+# whether a rigctld answers on port $1
+answers()
+{
+    ./rigctl -m 2 -r 127.0.0.1:$1 f > /dev/null 2>&1
+}
+
+rm -f $tty
+./rigemu -p kenwood -l $tty > /dev/null &
+emu_pid=$!
+
+n=0
+while [ ! -e $tty ] && [ $n -lt 50 ]
+do
+    sleep 0.1
+    n=`expr $n + 1`
+done
+
+# a port nobody answers on, then wait till our rigctld does, unless it
+# lost the port to a parallel run
+ctld_pid=
+try=0
+while [ -z "$ctld_pid" ] && [ $try -lt 10 ]
+do
+    port=${BENCH_PORT:-`expr 20000 + \( $$ + $try \* 7919 \) % 40000`}
+    try=`expr $try + 1`
+
+    answers $port && continue
+
+    ./rigctld -m 1 -T 127.0.0.1 -t $port > /dev/null 2>&1 &
+    ctld_pid=$!
+
+    n=0
+    while ! answers $port && kill -0 $ctld_pid 2> /dev/null && [ $n -lt 50 ]
+    do
+        sleep 0.1
+        n=`expr $n + 1`
+    done
+
+    if ! kill -0 $ctld_pid 2> /dev/null || [ $n -eq 50 ]
+    then
+        kill $ctld_pid 2> /dev/null
+        wait $ctld_pid 2> /dev/null
+        ctld_pid=
+    fi
+done
+
+if [ -z "$ctld_pid" ]
+then
+    echo "rigctld did not start" >&2
+    kill $emu_pid
+    wait $emu_pid 2> /dev/null
+    exit 1
+fi
+
+./benchmark -e $tty -m 214 -P -t 127.0.0.1:$port -o $out $BENCH_FLAGS
+status=$?
+
+kill $emu_pid $ctld_pid
+wait $emu_pid $ctld_pid 2> /dev/null
+
+[ $status -eq 0 ] && echo "results in $out"
+
+exit $status
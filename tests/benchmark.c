@@ -0,0 +1,762 @@
+/*
+ * benchmark.c - (C) The Hamlib Group 2020
+ *
+ * Hardware free benchmark suite, writing its results as JSON.
+ *
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License
+ *   as published by the Free Software Foundation; either version 2
+ *   of the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * Measures, against the dummy rig, and optionally against a rig emulated
+ * by rigemu, a replayed session and a running rigctld:
+ *  - the latency distribution of the main API calls,
+ *  - the time to set up and open a rig, and to probe it,
+ *  - the cost of the parse and format helpers,
+ *  - the transactions per second of rigctld with several clients.
+ *
+ * Each result is a JSON object of the "results" array, with the number of
+ * samples and the mean, p50, p99 and max in nanoseconds, so that two runs
+ * can be compared by a script.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <getopt.h>
+
+#ifdef HAVE_PTHREAD
+#  include <pthread.h>
+#endif
+
+#ifdef HAVE_NETDB_H
+#  include <netdb.h>
+#endif
+
+#ifdef HAVE_SYS_SOCKET_H
+#  include <sys/socket.h>
+#endif
+
+#include <hamlib/rig.h>
+#include "misc.h"
+
+
+#define SHORT_OPTIONS "n:e:m:R:t:c:d:o:PhV"
+static struct option long_options[] =
+{
+    {"loops",           1, 0, 'n'},
+    {"emu-port",        1, 0, 'e'},
+    {"emu-model",       1, 0, 'm'},
+    {"replay",          1, 0, 'R'},
+    {"rigctld",         1, 0, 't'},
+    {"clients",         1, 0, 'c'},
+    {"duration",        1, 0, 'd'},
+    {"output",          1, 0, 'o'},
+    {"probe",           0, 0, 'P'},
+    {"help",            0, 0, 'h'},
+    {"version",         0, 0, 'V'},
+    {0, 0, 0, 0}
+};
+
+
+/* samples of one measurement */
+struct bench
+{
+    uint64_t *ns;
+    size_t count;
+    size_t alloc;
+};
+
+typedef int (*bench_op_t)(RIG *rig, int i);
+
+static FILE *out;
+static int n_results;
+
+
+static uint64_t now_ns(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000000000 + (uint64_t)tv.tv_usec * 1000;
+#endif
+}
+
+
+static void bench_add(struct bench *b, uint64_t ns)
+{
+    if (b->count == b->alloc)
+    {
+        size_t alloc = b->alloc ? b->alloc * 2 : 1024;
+        uint64_t *p = realloc(b->ns, alloc * sizeof(uint64_t));
+
+        if (!p)
+        {
+            return;
+        }
+
+        b->ns = p;
+        b->alloc = alloc;
+    }
+
+    b->ns[b->count++] = ns;
+}
+
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+
+/* sorts the samples, prints the result, and frees them */
+static void bench_report(struct bench *b,
+                         const char *name,
+                         const char *extra_fmt,
+                         double extra)
+{
+    uint64_t sum = 0;
+    size_t i;
+
+    if (b->count == 0)
+    {
+        fprintf(stderr, "%s: no samples\n", name);
+        return;
+    }
+
+    qsort(b->ns, b->count, sizeof(uint64_t), cmp_u64);
+
+    for (i = 0; i < b->count; i++)
+    {
+        sum += b->ns[i];
+    }
+
+    fprintf(out, "%s\n    {\"name\": \"%s\", \"n\": %u, \"mean_ns\": %.0f, "
+            "\"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu",
+            n_results++ ? "," : "",
+            name,
+            (unsigned) b->count,
+            (double) sum / b->count,
+            (unsigned long long) b->ns[b->count / 2],
+            (unsigned long long) b->ns[(b->count * 99) / 100],
+            (unsigned long long) b->ns[b->count - 1]);
+
+    if (extra_fmt)
+    {
+        fprintf(out, ", ");
+        fprintf(out, extra_fmt, extra);
+    }
+
+    fprintf(out, "}");
+
+    fprintf(stderr, "%-32s p50 %11.3f us  p99 %11.3f us\n", name,
+            b->ns[b->count / 2] / 1000.,
+            b->ns[(b->count * 99) / 100] / 1000.);
+
+    free(b->ns);
+    memset(b, 0, sizeof(*b));
+}
+
+
+/*
+ * API calls
+ */
+static int op_get_freq(RIG *rig, int i)
+{
+    freq_t freq;
+
+    return rig_get_freq(rig, RIG_VFO_CURR, &freq);
+}
+
+static int op_set_freq(RIG *rig, int i)
+{
+    return rig_set_freq(rig, RIG_VFO_CURR, 14000000 + (i % 100) * 1000);
+}
+
+static int op_get_mode(RIG *rig, int i)
+{
+    rmode_t mode;
+    pbwidth_t width;
+
+    return rig_get_mode(rig, RIG_VFO_CURR, &mode, &width);
+}
+
+static int op_get_strength(RIG *rig, int i)
+{
+    value_t val;
+
+    return rig_get_level(rig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH, &val);
+}
+
+static int op_get_ptt(RIG *rig, int i)
+{
+    ptt_t ptt;
+
+    return rig_get_ptt(rig, RIG_VFO_CURR, &ptt);
+}
+
+static const struct
+{
+    const char *name;
+    bench_op_t op;
+} api_ops[] =
+{
+    { "rig_get_freq", op_get_freq },
+    { "rig_set_freq", op_set_freq },
+    { "rig_get_mode", op_get_mode },
+    { "rig_get_level_strength", op_get_strength },
+    { "rig_get_ptt", op_get_ptt },
+    { NULL, NULL }
+};
+
+
+static void bench_api(RIG *rig, const char *prefix, int loops)
+{
+    char name[64];
+    int i, j;
+
+    for (j = 0; api_ops[j].name; j++)
+    {
+        struct bench b;
+        int errors = 0;
+
+        memset(&b, 0, sizeof(b));
+
+        for (i = 0; i < loops; i++)
+        {
+            uint64_t t0 = now_ns();
+
+            if (api_ops[j].op(rig, i) != RIG_OK)
+            {
+                errors++;
+                continue;
+            }
+
+            bench_add(&b, now_ns() - t0);
+        }
+
+        snprintf(name, sizeof(name), "%s.%s", prefix, api_ops[j].name);
+        bench_report(&b, name, "\"errors\": %.0f", errors);
+    }
+}
+
+
+/* a rig with its settings, opened or not */
+static RIG *bench_rig_init(rig_model_t model, const char *port,
+                           const char *replay)
+{
+    RIG *rig = rig_init(model);
+
+    if (!rig)
+    {
+        return NULL;
+    }
+
+    if (port)
+    {
+        strncpy(rig->state.rigport.pathname, port, FILPATHLEN - 1);
+    }
+
+    if (replay)
+    {
+        rig_set_conf(rig, rig_token_lookup(rig, "replay_pathname"), replay);
+        rig_set_conf(rig, rig_token_lookup(rig, "replay_scale"), "0");
+    }
+
+    return rig;
+}
+
+
+static void bench_rig(rig_model_t model,
+                      const char *port,
+                      const char *replay,
+                      const char *prefix,
+                      int loops,
+                      int startup_loops)
+{
+    struct bench b;
+    char name[64];
+    RIG *rig;
+    int i;
+
+    /* startup: init, open, close, cleanup */
+    memset(&b, 0, sizeof(b));
+
+    for (i = 0; i < startup_loops; i++)
+    {
+        uint64_t t0 = now_ns();
+
+        rig = bench_rig_init(model, port, replay);
+
+        if (!rig)
+        {
+            break;
+        }
+
+        if (rig_open(rig) == RIG_OK)
+        {
+            bench_add(&b, now_ns() - t0);
+            rig_close(rig);
+        }
+
+        rig_cleanup(rig);
+    }
+
+    snprintf(name, sizeof(name), "%s.startup", prefix);
+    bench_report(&b, name, NULL, 0);
+
+    rig = bench_rig_init(model, port, replay);
+
+    if (!rig || rig_open(rig) != RIG_OK)
+    {
+        fprintf(stderr, "%s: cannot open rig model %d\n", prefix, model);
+
+        if (rig)
+        {
+            rig_cleanup(rig);
+        }
+
+        return;
+    }
+
+    bench_api(rig, prefix, loops);
+
+    rig_close(rig);
+    rig_cleanup(rig);
+}
+
+
+static void bench_probe(const char *port)
+{
+    hamlib_port_t p;
+    struct bench b;
+    rig_model_t model;
+    uint64_t t0;
+
+    memset(&p, 0, sizeof(p));
+    p.type.rig = RIG_PORT_SERIAL;
+    p.parm.serial.rate = 9600;
+    p.parm.serial.data_bits = 8;
+    p.parm.serial.stop_bits = 1;
+    p.parm.serial.parity = RIG_PARITY_NONE;
+    p.parm.serial.handshake = RIG_HANDSHAKE_NONE;
+    strncpy(p.pathname, port, FILPATHLEN - 1);
+
+    rig_load_all_backends();
+
+    memset(&b, 0, sizeof(b));
+
+    t0 = now_ns();
+    model = rig_probe(&p);
+    bench_add(&b, now_ns() - t0);
+
+    bench_report(&b, "emu.probe", "\"model\": %.0f", model);
+}
+
+
+/*
+ * Parse and format helpers
+ */
+static void bench_helpers(int loops)
+{
+    static const char *modes[] = { "USB", "LSB", "CW", "FM", "AM", "PKTUSB" };
+    static const char *levels[] = { "AF", "RF", "SQL", "STRENGTH", "RFPOWER" };
+    static const char *vfos[] = { "VFOA", "VFOB", "Main", "Sub", "MEM" };
+    struct bench b;
+    unsigned char bcd[8];
+    char buf[32];
+    volatile unsigned long long sink = 0;
+    int i, j;
+
+#define BENCH_HELPER(name, expr) \
+    do { \
+        memset(&b, 0, sizeof(b)); \
+        for (i = 0; i < loops; i++) \
+        { \
+            uint64_t t0 = now_ns(); \
+            for (j = 0; j < 100; j++) \
+            { \
+                expr; \
+            } \
+            bench_add(&b, (now_ns() - t0) / 100); \
+        } \
+        bench_report(&b, "helpers." name, NULL, 0); \
+    } while (0)
+
+    BENCH_HELPER("rig_parse_mode", sink += rig_parse_mode(modes[j % 6]));
+    BENCH_HELPER("rig_parse_level", sink += rig_parse_level(levels[j % 5]));
+    BENCH_HELPER("rig_parse_vfo", sink += rig_parse_vfo(vfos[j % 5]));
+    BENCH_HELPER("rig_strrmode", sink += (uintptr_t) rig_strrmode(RIG_MODE_USB));
+    BENCH_HELPER("sprintf_freq", sink += sprintf_freq(buf, 14074000. + j));
+    BENCH_HELPER("to_bcd", sink += to_bcd(bcd, 146520000ULL + j, 10)[0]);
+    BENCH_HELPER("from_bcd", sink += from_bcd(bcd, 10));
+
+#undef BENCH_HELPER
+}
+
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_SYS_SOCKET_H)
+/*
+ * rigctld clients, each sending 'f' and waiting for the answer
+ */
+struct ctld_client
+{
+    const char *host;
+    const char *port;
+    uint64_t end_ns;
+    struct bench b;
+    int errors;
+};
+
+
+static int ctld_connect(const char *host, const char *port)
+{
+    struct addrinfo hints, *res, *ai;
+    int fd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host, port, &hints, &res) != 0)
+    {
+        return -1;
+    }
+
+    for (ai = res; ai; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+        {
+            break;
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(res);
+
+    return fd;
+}
+
+
+static void *ctld_client_thread(void *arg)
+{
+    struct ctld_client *c = arg;
+    char buf[64];
+    int fd;
+
+    fd = ctld_connect(c->host, c->port);
+
+    if (fd < 0)
+    {
+        c->errors++;
+        return NULL;
+    }
+
+    while (now_ns() < c->end_ns)
+    {
+        uint64_t t0 = now_ns();
+        ssize_t n;
+
+        if (write(fd, "f\n", 2) != 2)
+        {
+            c->errors++;
+            break;
+        }
+
+        /* the answer is a single line */
+        do
+        {
+            n = read(fd, buf, sizeof(buf));
+        }
+        while (n > 0 && buf[n - 1] != '\n');
+
+        if (n <= 0)
+        {
+            c->errors++;
+            break;
+        }
+
+        bench_add(&c->b, now_ns() - t0);
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+
+static void bench_rigctld(const char *addr, int nclients, int duration)
+{
+    char host[256];
+    const char *port = "4532";
+    struct ctld_client *clients;
+    pthread_t *threads;
+    struct bench all;
+    char name[64];
+    size_t total = 0;
+    char *colon;
+    int i, errors = 0;
+
+    strncpy(host, addr, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+
+    colon = strrchr(host, ':');
+
+    if (colon)
+    {
+        *colon = '\0';
+        port = addr + (colon - host) + 1;
+    }
+
+    clients = calloc(nclients, sizeof(*clients));
+    threads = calloc(nclients, sizeof(*threads));
+
+    if (!clients || !threads)
+    {
+        free(clients);
+        free(threads);
+        return;
+    }
+
+    for (i = 0; i < nclients; i++)
+    {
+        clients[i].host = host;
+        clients[i].port = port;
+        clients[i].end_ns = now_ns() + (uint64_t)duration * 1000000000;
+
+        if (pthread_create(&threads[i], NULL, ctld_client_thread,
+                           &clients[i]) != 0)
+        {
+            nclients = i;
+            break;
+        }
+    }
+
+    memset(&all, 0, sizeof(all));
+
+    for (i = 0; i < nclients; i++)
+    {
+        size_t j;
+
+        pthread_join(threads[i], NULL);
+
+        for (j = 0; j < clients[i].b.count; j++)
+        {
+            bench_add(&all, clients[i].b.ns[j]);
+        }
+
+        total += clients[i].b.count;
+        errors += clients[i].errors;
+        free(clients[i].b.ns);
+    }
+
+    if (errors)
+    {
+        fprintf(stderr, "rigctld: %d client errors\n", errors);
+    }
+
+    snprintf(name, sizeof(name), "rigctld.get_freq.%d_clients", nclients);
+    bench_report(&all, name, "\"tps\": %.0f", (double) total / duration);
+
+    free(clients);
+    free(threads);
+}
+#endif
+
+
+static void usage(void)
+{
+    printf("Usage: benchmark [OPTION]...\n"
+           "Benchmark Hamlib against the dummy rig, and optionally an emulated\n"
+           "rig, a replayed session and rigctld. Results are written as JSON.\n\n");
+
+    printf(
+        "  -n, --loops=N                 iterations per measurement, default 2000\n"
+        "  -e, --emu-port=DEVICE         also run against a rig emulated on DEVICE\n"
+        "  -m, --emu-model=ID            rig model of the emulated rig, default 214\n"
+        "  -P, --probe                   also time a probe of the emulated rig\n"
+        "  -R, --replay=FILE             also run against the replay of FILE\n"
+        "                                (recorded with --emu-model)\n"
+        "  -t, --rigctld=HOST[:PORT]     also load this rigctld\n"
+        "  -c, --clients=N               rigctld clients, default 4\n"
+        "  -d, --duration=S              rigctld load duration, default 2\n"
+        "  -o, --output=FILE             write the JSON to FILE, default stdout\n"
+        "  -h, --help                    display this help and exit\n"
+        "  -V, --version                 output version information and exit\n\n"
+    );
+}
+
+
+int main(int argc, char *argv[])
+{
+    int loops = 2000;
+    const char *emu_port = NULL;
+    rig_model_t emu_model = RIG_MODEL_TS2000;
+    const char *replay = NULL;
+    const char *rigctld = NULL;
+    int clients = 4, duration = 2;
+    int probe = 0;
+    const char *outfile = NULL;
+
+    while (1)
+    {
+        int c;
+        int option_index = 0;
+
+        c = getopt_long(argc, argv, SHORT_OPTIONS, long_options, &option_index);
+
+        if (c == -1)
+        {
+            break;
+        }
+
+        switch (c)
+        {
+        case 'h':
+            usage();
+            exit(0);
+
+        case 'V':
+            printf("benchmark, %s\n", hamlib_version);
+            exit(0);
+
+        case 'n':
+            loops = atoi(optarg);
+            break;
+
+        case 'e':
+            emu_port = optarg;
+            break;
+
+        case 'm':
+            emu_model = atoi(optarg);
+            break;
+
+        case 'P':
+            probe = 1;
+            break;
+
+        case 'R':
+            replay = optarg;
+            break;
+
+        case 't':
+            rigctld = optarg;
+            break;
+
+        case 'c':
+            clients = atoi(optarg);
+            break;
+
+        case 'd':
+            duration = atoi(optarg);
+            break;
+
+        case 'o':
+            outfile = optarg;
+            break;
+
+        default:
+            usage();
+            exit(1);
+        }
+    }
+
+    if (loops <= 0 || clients <= 0 || duration <= 0)
+    {
+        usage();
+        exit(1);
+    }
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    out = outfile ? fopen(outfile, "w") : stdout;
+
+    if (!out)
+    {
+        perror(outfile);
+        exit(2);
+    }
+
+    fprintf(out, "{\n  \"hamlib\": \"%s\",\n  \"loops\": %d,\n"
+            "  \"results\": [", hamlib_version, loops);
+
+    bench_rig(RIG_MODEL_DUMMY, NULL, NULL, "dummy", loops, loops / 10 + 1);
+
+    /* real backends behind a pty are slower, fewer loops */
+    if (emu_port)
+    {
+        bench_rig(emu_model, emu_port, NULL, "emu", loops / 40 + 1, 10);
+
+        if (probe)
+        {
+            bench_probe(emu_port);
+        }
+    }
+
+    if (replay)
+    {
+        bench_rig(emu_model, NULL, replay, "replay", loops / 40 + 1, 10);
+    }
+
+    bench_helpers(loops);
+
+    if (rigctld)
+    {
+#if defined(HAVE_PTHREAD) && defined(HAVE_SYS_SOCKET_H)
+        bench_rigctld(rigctld, clients, duration);
+#else
+        fprintf(stderr, "rigctld load needs threads and sockets\n");
+#endif
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    return 0;
+}
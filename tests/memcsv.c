@@ -72,8 +72,14 @@ static int  tokenize_line(char *line,
 
 static int find_on_list(char **list, char *what);
 
+static int csv_read_chans(RIG *rig, const char *infilename,
+                          channel_t **chans_p);
+
 int csv_save(RIG *rig, const char *outfilename);
 int csv_load(RIG *rig, const char *infilename);
+int csv_sync(RIG *rig, const char *infilename, const char *imagename);
+int csv_to_image(RIG *rig, const char *infilename, const char *imagename);
+int image_to_csv(RIG *rig, const char *imagename, const char *outfilename);
 
 int csv_parm_save(RIG *rig, const char *outfilename);
 int csv_parm_load(RIG *rig, const char *infilename);
@@ -191,6 +197,215 @@ int csv_load(RIG *rig, const char *infilename)
 }
 
 
+/**  Reads the whole csv file, in the format of csv_load, into an
+     allocated table of channels.
+     \param rig - a pointer to the rig
+     \param infilename - a string with a file name to read from
+     \param chans_p - where to store the table, to be freed by the caller
+     \return number of channels read, negative value on error
+*/
+static int csv_read_chans(RIG *rig, const char *infilename,
+                          channel_t **chans_p)
+{
+    FILE *f;
+    char *key_list[ 64 ];
+    char *value_list[ 64 ];
+    char keys[ 256 ];
+    char line[ 256 ];
+    channel_t *chans = NULL;
+    int nchans = 0, alloc = 0;
+
+    f = fopen(infilename, "r");
+
+    if (!f)
+    {
+        return -1;
+    }
+
+    if (fgets(keys, sizeof(keys), f) == NULL)
+    {
+        fclose(f);
+        return -1;
+    }
+
+    keys[ strlen(keys) - 1 ] = '\0';
+
+    if (!tokenize_line(keys,
+                       key_list,
+                       sizeof(key_list) / sizeof(char *),
+                       ','))
+    {
+        fprintf(stderr,
+                "Invalid (possibly too long or empty) key line, cannot continue.\n");
+        fclose(f);
+        return -1;
+    }
+
+    while (fgets(line, sizeof line, f) != NULL)
+    {
+        if (!tokenize_line(line,
+                           value_list,
+                           sizeof(value_list) / sizeof(char *),
+                           ','))
+        {
+            fprintf(stderr, "Invalid (possibly too long or empty) line ignored\n");
+            continue;
+        }
+
+        if (nchans == alloc)
+        {
+            channel_t *p;
+
+            alloc = alloc ? alloc * 2 : 64;
+            p = realloc(chans, alloc * sizeof(channel_t));
+
+            if (!p)
+            {
+                free(chans);
+                fclose(f);
+                return -RIG_ENOMEM;
+            }
+
+            chans = p;
+        }
+
+        if (set_channel_data(rig, &chans[nchans], key_list, value_list) < 0)
+        {
+            continue;
+        }
+
+        chans[nchans++].vfo = RIG_VFO_MEM;
+    }
+
+    fclose(f);
+
+    *chans_p = chans;
+
+    return nchans;
+}
+
+
+/**  csv_sync reads the whole csv file, in the format of csv_load,
+     then writes only the channels changed since the last sync, as
+     recorded in the image file.
+     \param rig - a pointer to the rig
+     \param infilename - a string with a file name to read from
+     \param imagename - a string with the image file name
+*/
+int csv_sync(RIG *rig, const char *infilename, const char *imagename)
+{
+    int status;
+    channel_t *chans = NULL;
+    int nchans;
+    struct rig_chan_sync_stats stats;
+
+    nchans = csv_read_chans(rig, infilename, &chans);
+
+    if (nchans < 0)
+    {
+        return nchans;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+
+    /* read back a few of the written channels */
+    status = rig_sync_chan_all(rig, chans, nchans, imagename, 3, &stats);
+
+    printf("%d channels, %d written, %d unchanged, %d of %d verified differ\n",
+           stats.channels, stats.written, stats.unchanged,
+           stats.mismatched, stats.verified);
+
+    free(chans);
+
+    return status;
+}
+
+
+/**  csv_to_image converts a csv file, in the format of csv_load,
+     to a binary channel image.  The rig is not accessed.
+     \param rig - a pointer to the rig
+     \param infilename - a string with a file name to read from
+     \param imagename - a string with the image file name to write to
+*/
+int csv_to_image(RIG *rig, const char *infilename, const char *imagename)
+{
+    int status;
+    channel_t *chans = NULL;
+    int nchans;
+
+    nchans = csv_read_chans(rig, infilename, &chans);
+
+    if (nchans < 0)
+    {
+        return nchans;
+    }
+
+    status = rig_chan_image_save(rig, imagename, chans, nchans);
+
+    free(chans);
+
+    return status;
+}
+
+
+/**  image_to_csv converts a binary channel image to a csv file, in
+     the format of csv_save.  The rig is not accessed, its memory caps
+     select the columns.
+     \param rig - a pointer to the rig
+     \param imagename - a string with the image file name to read from
+     \param outfilename - a string with a file name to write to
+*/
+int image_to_csv(RIG *rig, const char *imagename, const char *outfilename)
+{
+    int status;
+    struct rig_chan_image *img;
+    channel_t *chan = NULL;
+    const chan_t *chan_list;
+    FILE *f;
+    int i, n;
+
+    status = rig_chan_image_open(imagename, &img);
+
+    if (status != RIG_OK)
+    {
+        return status;
+    }
+
+    f = fopen(outfilename, "w");
+
+    if (!f)
+    {
+        rig_chan_image_close(img);
+        return -1;
+    }
+
+    n = rig_chan_image_count(img);
+
+    /* one set of columns for all the channels */
+    chan_list = rig_lookup_mem_caps(rig, RIG_MEM_CAPS_ALL);
+
+    /* first round, prints the key line and gets the channel_t to fill */
+    dump_csv_chan(rig, &chan, 0, chan_list, f);
+
+    for (i = 0; i < n; i++)
+    {
+        status = rig_chan_image_load(rig, img, i, chan);
+
+        if (status != RIG_OK)
+        {
+            break;
+        }
+
+        dump_csv_chan(rig, &chan, chan->channel_num, chan_list, f);
+    }
+
+    fclose(f);
+    rig_chan_image_close(img);
+
+    return status;
+}
+
+
 /**  Function to break a line into a list of tokens. Delimiters are
     replaced by end-of-string characters ('\0'), and a list of pointers
     to thus created substrings is created.
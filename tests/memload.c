@@ -33,85 +33,287 @@
 
 #ifdef HAVE_XML2
 #  include <libxml/parser.h>
-#  include <libxml/tree.h>
+#  include <libxml/xmlreader.h>
 
-static int set_chan(RIG *rig, channel_t *chan , xmlNodePtr node);
+#  ifdef HAVE_PTHREAD
+#    include <pthread.h>
+#  endif
+
+static int set_chan(RIG *rig, channel_t *chan, xmlTextReaderPtr reader);
+
+
+/*
+ * The file is read with a streaming reader, one channel element at
+ * a time, so that memory use does not grow with the size of the plan.
+ * When threads are available, a parser thread fills a bounded queue
+ * of channels ahead of the radio, which is the slow side.
+ */
+#define CHAN_QUEUE_LEN  64
+
+struct chan_queue
+{
+    RIG *rig;
+    xmlTextReaderPtr reader;
+    channel_t chans[CHAN_QUEUE_LEN];
+    int head;
+    int count;
+    int done;           /* producer finished, status tells how */
+    int status;
+    int stop;           /* consumer gave up */
+#  ifdef HAVE_PTHREAD
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+#  endif
+};
+
+
+/*
+ * Advance the reader to the next channel element of hamlib/channels.
+ * Returns 1 when there is one, 0 at the end, or a negative error,
+ * also for a file without channels element.
+ */
+static int next_chan_node(xmlTextReaderPtr reader, int *in_channels,
+                          int *have_channels)
+{
+    int ret;
+
+    while ((ret = xmlTextReaderRead(reader)) == 1)
+    {
+        const char *name;
+        int depth;
+
+        if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT)
+        {
+            continue;
+        }
+
+        name = (const char *) xmlTextReaderConstName(reader);
+        depth = xmlTextReaderDepth(reader);
+
+        if (depth == 0)
+        {
+            if (strcmp(name, "hamlib"))
+            {
+                fprintf(stderr, "no hamlib tag found\n");
+                return -RIG_EINVAL;
+            }
+        }
+        else if (depth == 1)
+        {
+            *in_channels = strcmp(name, "channels") == 0;
+            *have_channels |= *in_channels;
+        }
+        else if (depth == 2 && *in_channels)
+        {
+            return 1;
+        }
+    }
+
+    if (ret < 0)
+    {
+        fprintf(stderr, "xmlParse failed\n");
+        return -RIG_EINVAL;
+    }
+
+    if (!*have_channels)
+    {
+        fprintf(stderr, "no channels\n");
+        return -RIG_EINVAL;
+    }
+
+    return 0;
+}
+
+
+#  ifdef HAVE_PTHREAD
+static void *chan_producer(void *arg)
+{
+    struct chan_queue *q = arg;
+    int in_channels = 0, have_channels = 0;
+    int ret;
+
+    while (1)
+    {
+        channel_t *chan;
+
+        pthread_mutex_lock(&q->lock);
+
+        while (q->count == CHAN_QUEUE_LEN && !q->stop)
+        {
+            pthread_cond_wait(&q->not_full, &q->lock);
+        }
+
+        if (q->stop)
+        {
+            pthread_mutex_unlock(&q->lock);
+            break;
+        }
+
+        /* the slot is free, fill it without holding the lock */
+        chan = &q->chans[(q->head + q->count) % CHAN_QUEUE_LEN];
+        pthread_mutex_unlock(&q->lock);
+
+        ret = next_chan_node(q->reader, &in_channels, &have_channels);
+
+        if (ret == 1)
+        {
+            ret = set_chan(q->rig, chan, q->reader) == 0 ? 1 : -RIG_EINVAL;
+        }
+
+        pthread_mutex_lock(&q->lock);
+
+        if (ret == 1)
+        {
+            q->count++;
+        }
+        else
+        {
+            q->status = ret;
+            q->done = 1;
+        }
+
+        pthread_cond_signal(&q->not_empty);
+        pthread_mutex_unlock(&q->lock);
+
+        if (ret != 1)
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
+#  endif
 #endif
 
 
+/*
+ * Programs the channels of the channels element of infilename, in file
+ * order.  A file without channels element is refused with -RIG_EINVAL.
+ * The load stops at the first channel element without num attribute
+ * (-RIG_EINVAL) or at the first rig_set_channel() failure, whose error
+ * is returned; the channels before it are already programmed.
+ */
 int xml_load(RIG *my_rig, const char *infilename)
 {
 #ifdef HAVE_XML2
-    xmlDocPtr Doc;
-    xmlNodePtr node;
+    struct chan_queue *q;
+    int status = RIG_OK;
+#  ifdef HAVE_PTHREAD
+    pthread_t producer;
+#  endif
 
-    /* load xlm Doc */
-    Doc = xmlParseFile(infilename);
+    q = calloc(1, sizeof(*q));
 
-    if (Doc == NULL)
+    if (!q)
     {
-        fprintf(stderr, "xmlParse failed\n");
-        exit(2);
+        return -RIG_ENOMEM;
     }
 
-    node = xmlDocGetRootElement(Doc);
+    q->rig = my_rig;
+    q->reader = xmlReaderForFile(infilename, NULL, 0);
 
-    if (node == NULL)
+    if (q->reader == NULL)
     {
-        fprintf(stderr, "get root failed\n");
-        exit(2);
+        fprintf(stderr, "xmlParse failed\n");
+        free(q);
+        return -RIG_EIO;
     }
 
-    if (strcmp((char *) node->name, "hamlib"))
+#  ifdef HAVE_PTHREAD
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+
+    if (pthread_create(&producer, NULL, chan_producer, q) != 0)
     {
-        fprintf(stderr, "no hamlib tag found\n");
-        exit(2);
+        status = -RIG_EINTERNAL;
     }
 
-    for (node = node->xmlChildrenNode; node != NULL; node = node->next)
+    while (status == RIG_OK)
     {
-        if (xmlNodeIsText(node))
+        channel_t *chan;
+
+        pthread_mutex_lock(&q->lock);
+
+        while (q->count == 0 && !q->done)
         {
-            continue;
+            pthread_cond_wait(&q->not_empty, &q->lock);
         }
 
-        if (strcmp((char *) node->name, "channels") == 0)
+        if (q->count == 0)
         {
+            status = q->status;
+            pthread_mutex_unlock(&q->lock);
             break;
         }
+
+        chan = &q->chans[q->head];
+        pthread_mutex_unlock(&q->lock);
+
+        /* the radio I/O overlaps with the parsing of the next channels */
+        status = rig_set_channel(my_rig, chan);
+
+        if (status != RIG_OK)
+        {
+            printf("rig_set_channel: error = %s \n", rigerror(status));
+        }
+
+        pthread_mutex_lock(&q->lock);
+        q->head = (q->head + 1) % CHAN_QUEUE_LEN;
+        q->count--;
+
+        if (status != RIG_OK)
+        {
+            q->stop = 1;
+        }
+
+        pthread_cond_signal(&q->not_full);
+        pthread_mutex_unlock(&q->lock);
     }
 
-    if (node == NULL)
+    if (status != -RIG_EINTERNAL)
     {
-        fprintf(stderr, "no channels\n");
-        exit(2);
+        pthread_join(producer, NULL);
     }
 
-    for (node = node->xmlChildrenNode; node != NULL; node = node->next)
-    {
-        channel_t chan;
-        int status;
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->lock);
+#  else
+    int in_channels = 0, have_channels = 0;
+    int ret;
 
-        if (xmlNodeIsText(node))
+    while ((ret = next_chan_node(q->reader, &in_channels, &have_channels))
+            == 1)
+    {
+        if (set_chan(my_rig, &q->chans[0], q->reader) != 0)
         {
-            continue;
+            ret = -RIG_EINVAL;
+            break;
         }
 
-        set_chan(my_rig, &chan, node);
-
-        status = rig_set_channel(my_rig, &chan);
+        status = rig_set_channel(my_rig, &q->chans[0]);
 
         if (status != RIG_OK)
         {
-            printf("rig_get_channel: error = %s \n", rigerror(status));
-            return status;
+            printf("rig_set_channel: error = %s \n", rigerror(status));
+            break;
         }
     }
 
-    xmlFreeDoc(Doc);
+    if (status == RIG_OK)
+    {
+        status = ret;
+    }
+#  endif
+
+    xmlFreeTextReader(q->reader);
     xmlCleanupParser();
+    free(q);
 
-    return 0;
+    return status;
 #else
     return -RIG_ENAVAIL;
 #endif
@@ -125,16 +327,40 @@ int xml_parm_load(RIG *my_rig, const char *infilename)
 
 
 #ifdef HAVE_XML2
-int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
+/*
+ * Copy attribute name of the current element into buf,
+ * returns NULL if it is not there.
+ */
+static char *get_prop(xmlTextReaderPtr reader, const char *name,
+                      char *buf, size_t len)
+{
+    xmlChar *attr;
+
+    attr = xmlTextReaderGetAttribute(reader, (const xmlChar *) name);
+
+    if (attr == NULL)
+    {
+        return NULL;
+    }
+
+    snprintf(buf, len, "%s", (const char *) attr);
+    xmlFree(attr);
+
+    return buf;
+}
+
+
+int set_chan(RIG *rig, channel_t *chan, xmlTextReaderPtr reader)
 {
-    xmlChar *prop;
+    char propbuf[MAXCHANDESC + 32];
+    char *prop;
     int i, n;
 
     memset(chan, 0, sizeof(channel_t));
     chan->vfo = RIG_VFO_MEM;
 
 
-    prop = xmlGetProp(node, (unsigned char *) "num");
+    prop = get_prop(reader, "num", propbuf, sizeof(propbuf));
 
     if (prop == NULL)
     {
@@ -159,7 +385,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.bank_num)
     {
-        prop = xmlGetProp(node, (unsigned char *) "bank_num");
+        prop = get_prop(reader, "bank_num", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -169,7 +395,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.channel_desc)
     {
-        prop = xmlGetProp(node, (unsigned char *) "channel_desc");
+        prop = get_prop(reader, "channel_desc", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -179,7 +405,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.ant)
     {
-        prop = xmlGetProp(node, (unsigned char *) "ant");
+        prop = get_prop(reader, "ant", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -189,7 +415,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.freq)
     {
-        prop = xmlGetProp(node, (unsigned char *) "freq");
+        prop = get_prop(reader, "freq", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -199,7 +425,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.mode)
     {
-        prop = xmlGetProp(node, (unsigned char *) "mode");
+        prop = get_prop(reader, "mode", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -209,7 +435,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.width)
     {
-        prop = xmlGetProp(node, (unsigned char *) "width");
+        prop = get_prop(reader, "width", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -219,7 +445,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.tx_freq)
     {
-        prop = xmlGetProp(node, (unsigned char *) "tx_freq");
+        prop = get_prop(reader, "tx_freq", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -229,7 +455,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.tx_mode)
     {
-        prop = xmlGetProp(node, (unsigned char *)"tx_mode");
+        prop = get_prop(reader, "tx_mode", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -239,7 +465,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.tx_width)
     {
-        prop = xmlGetProp(node, (unsigned char *)"tx_width");
+        prop = get_prop(reader, "tx_width", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -250,7 +476,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
     if (rig->state.chan_list[i].mem_caps.split)
     {
         chan->split = RIG_SPLIT_OFF;
-        prop = xmlGetProp(node, (unsigned char *)"split");
+        prop = get_prop(reader, "split", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -260,7 +486,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
                 if (rig->state.chan_list[i].mem_caps.tx_vfo)
                 {
-                    prop = xmlGetProp(node, (unsigned char *)"tx_vfo");
+                    prop = get_prop(reader, "tx_vfo", propbuf, sizeof(propbuf));
 
                     if (prop != NULL)
                     {
@@ -273,7 +499,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.rptr_shift)
     {
-        prop = xmlGetProp(node, (unsigned char *)"rptr_shift");
+        prop = get_prop(reader, "rptr_shift", propbuf, sizeof(propbuf));
 
         if (prop)
         {
@@ -296,7 +522,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
         if (rig->state.chan_list[i].mem_caps.rptr_offs
             && chan->rptr_shift != RIG_RPT_SHIFT_NONE)
         {
-            prop = xmlGetProp(node, (unsigned char *)"rptr_offs");
+            prop = get_prop(reader, "rptr_offs", propbuf, sizeof(propbuf));
 
             if (prop != NULL)
             {
@@ -307,7 +533,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.tuning_step)
     {
-        prop = xmlGetProp(node, (unsigned char *)"tuning_step");
+        prop = get_prop(reader, "tuning_step", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -317,7 +543,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.rit)
     {
-        prop = xmlGetProp(node, (unsigned char *)"rit");
+        prop = get_prop(reader, "rit", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -327,7 +553,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.xit)
     {
-        prop = xmlGetProp(node, (unsigned char *)"xit");
+        prop = get_prop(reader, "xit", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -337,7 +563,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.funcs)
     {
-        prop = xmlGetProp(node, (unsigned char *)"funcs");
+        prop = get_prop(reader, "funcs", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -347,7 +573,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.ctcss_tone)
     {
-        prop = xmlGetProp(node, (unsigned char *)"ctcss_tone");
+        prop = get_prop(reader, "ctcss_tone", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -357,7 +583,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.ctcss_sql)
     {
-        prop = xmlGetProp(node, (unsigned char *)"ctcss_sql");
+        prop = get_prop(reader, "ctcss_sql", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -367,7 +593,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.dcs_code)
     {
-        prop = xmlGetProp(node, (unsigned char *)"dcs_code");
+        prop = get_prop(reader, "dcs_code", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -377,7 +603,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.dcs_sql)
     {
-        prop = xmlGetProp(node, (unsigned char *)"dcs_sql");
+        prop = get_prop(reader, "dcs_sql", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -387,7 +613,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.scan_group)
     {
-        prop = xmlGetProp(node, (unsigned char *)"scan_group");
+        prop = get_prop(reader, "scan_group", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
@@ -397,7 +623,7 @@ int set_chan(RIG *rig, channel_t *chan, xmlNodePtr node)
 
     if (rig->state.chan_list[i].mem_caps.flags)
     {
-        prop = xmlGetProp(node, (unsigned char *)"flags");
+        prop = get_prop(reader, "flags", propbuf, sizeof(propbuf));
 
         if (prop != NULL)
         {
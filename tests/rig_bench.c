@@ -1,5 +1,14 @@
 /*
  * Hamlib rig_bench program
+ *
+ * Usage: rig_bench [model [recording [latency_scale]]]
+ *
+ * Without a recording, a real rig is expected on SERIAL_PORT.
+ * The recording is a session captured with the record_pathname
+ * config parameter, e.g.
+ *   rigctl -m 3011 -r /dev/ttyUSB0 -C record_pathname=ic706.rec f m
+ * It is played back instead of talking to the rig, with the recorded
+ * reply delays multiplied by latency_scale (default 1, 0 for none).
  */
 
 #include <stdio.h>
@@ -33,6 +42,7 @@ int main(int argc, char *argv[])
     if (argc < 2)
     {
         hamlib_port_t myport;
+        memset(&myport, 0, sizeof(myport));
         /* may be overriden by backend probe */
         myport.type.rig = RIG_PORT_SERIAL;
         myport.parm.serial.rate = 9600;
@@ -67,9 +77,26 @@ int main(int argc, char *argv[])
            my_rig->caps->version,
            rig_strstatus(my_rig->caps->status));
 
-    printf("Serial speed: %d bauds\n", my_rig->state.rigport.parm.serial.rate);
+    if (argc > 2)
+    {
+        rig_set_conf(my_rig, rig_token_lookup(my_rig, "replay_pathname"),
+                     argv[2]);
+
+        if (argc > 3)
+        {
+            rig_set_conf(my_rig, rig_token_lookup(my_rig, "replay_scale"),
+                         argv[3]);
+        }
+
+        printf("Replaying %s\n", argv[2]);
+    }
+    else
+    {
+        printf("Serial speed: %d bauds\n",
+               my_rig->state.rigport.parm.serial.rate);
 
-    strncpy(my_rig->state.rigport.pathname, SERIAL_PORT, FILPATHLEN - 1);
+        strncpy(my_rig->state.rigport.pathname, SERIAL_PORT, FILPATHLEN - 1);
+    }
 
     retcode = rig_open(my_rig);
 
@@ -79,7 +106,7 @@ int main(int argc, char *argv[])
         exit(2);
     }
 
-    printf("Port %s opened ok\n", SERIAL_PORT);
+    printf("Port %s opened ok\n", my_rig->state.rigport.pathname);
     printf("Perform %d loops...\n", LOOP_COUNT);
 
     /*
@@ -119,9 +146,10 @@ int main(int argc, char *argv[])
            elapsed / LOOP_COUNT);
 
     rig_close(my_rig);      /* close port */
-    rig_cleanup(my_rig);    /* if you care about memory */
 
-    printf("port %s closed ok \n", SERIAL_PORT);
+    printf("port %s closed ok \n", my_rig->state.rigport.pathname);
+
+    rig_cleanup(my_rig);    /* if you care about memory */
 
     return 0;
 }
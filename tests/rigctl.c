@@ -87,7 +87,7 @@ void usage(void);
  * NB: do NOT use -W since it's reserved by POSIX.
  * TODO: add an option to read from a file
  */
-#define SHORT_OPTIONS "+m:r:p:d:P:D:s:c:t:lC:LuonvhVZ"
+#define SHORT_OPTIONS "+m:r:p:d:P:D:s:c:t:lC:LuonvhVZX:"
 static struct option long_options[] =
 {
     {"model",           1, 0, 'm'},
@@ -106,6 +106,7 @@ static struct option long_options[] =
     {"vfo",             0, 0, 'o'},
     {"no-restore-ai",   0, 0, 'n'},
     {"debug-time-stamps",0, 0, 'Z'},
+    {"trace-file",      1, 0, 'X'},
 #ifdef HAVE_READLINE_HISTORY
     {"read-history",    0, 0, 'i'},
     {"save-history",    0, 0, 'I'},
@@ -152,6 +153,7 @@ int main(int argc, char *argv[])
 #endif  /* HAVE_READLINE_HISTORY */
 
     const char *rig_file = NULL, *ptt_file = NULL, *dcd_file = NULL;
+    const char *trace_file = NULL;
     ptt_type_t ptt_type = RIG_PTT_NONE;
     dcd_type_t dcd_type = RIG_DCD_NONE;
     int serial_rate = 0;
@@ -412,6 +414,16 @@ int main(int argc, char *argv[])
 	    rig_set_debug_time_stamp(1);
 	    break;
 
+        case 'X':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            trace_file = optarg;
+            break;
+
         default:
             usage();    /* unknown option? */
             exit(1);
@@ -510,6 +522,17 @@ int main(int argc, char *argv[])
         exit(0);
     }
 
+    if (trace_file)
+    {
+        retcode = rig_trace_open(trace_file);
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "rig_trace_open: error = %s \n", rigerror(retcode));
+            exit(2);
+        }
+    }
+
     retcode = rig_open(my_rig);
 
     if (retcode != RIG_OK)
@@ -615,6 +638,11 @@ int main(int argc, char *argv[])
     rig_close(my_rig);   /* close port */
     rig_cleanup(my_rig); /* if you care about memory */
 
+    if (trace_file)
+    {
+        rig_trace_close();
+    }
+
     return exitcode;
 }
 
@@ -647,6 +675,7 @@ void usage(void)
 #endif
         "  -v, --verbose                 set verbose mode, cumulative (-v to -vvvvv)\n"
         "  -Z, --debug-time-stamps       enable time stamps for debug messages\n"
+        "  -X, --trace-file=FILE         capture port I/O to binary FILE, see rigtrace\n"
         "  -h, --help                    display this help and exit\n"
         "  -V, --version                 output version information and exit\n\n"
     );
@@ -0,0 +1,686 @@
+/*
+ * rigctl_binary.c - (C) The Hamlib Group 2020
+ *
+ * Binary framing of the rigctld protocol, see src/binproto.h.
+ *
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program; if not, write to the Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hamlib/rig.h>
+#include "binproto.h"
+
+#include "rigctl_parse.h"
+
+
+/*
+ * A field of a request.  A number is kept both as an integer and as a
+ * real, so a level gets the kind of value it takes whatever the client
+ * sent.  Modes, VFOs, levels and functions come as their names, as in
+ * the text protocol, which keeps the frames apart from the bit layout
+ * of rmode_t, vfo_t and setting_t.
+ */
+struct binary_arg
+{
+    int type;
+    int64_t i;
+    double d;
+    char s[32];
+};
+
+
+static int binary_args(struct binproto_frame *req,
+                       struct binary_arg *args,
+                       int max)
+{
+    int n, ret;
+
+    for (n = 0; n < max && binproto_peek(req); n++)
+    {
+        args[n].type = binproto_peek(req);
+        args[n].i = 0;
+        args[n].d = 0;
+        args[n].s[0] = '\0';
+
+        if (args[n].type == BINPROTO_STR)
+        {
+            ret = binproto_get_str(req, args[n].s, sizeof(args[n].s));
+        }
+        else if (args[n].type == BINPROTO_REAL)
+        {
+            ret = binproto_get_real(req, &args[n].d);
+            args[n].i = args[n].d;
+        }
+        else
+        {
+            ret = binproto_get_int(req, &args[n].i);
+            args[n].d = args[n].i;
+        }
+
+        if (ret < 0)
+        {
+            return ret;
+        }
+    }
+
+    return binproto_peek(req) ? -RIG_EINVAL : n;
+}
+
+
+/*
+ * Check the count of fields of a request, and that those flagged in
+ * 'names', a bit per field, are strings and the others numbers
+ */
+static int binary_check(const struct binary_arg *args,
+                        int nargs,
+                        int want,
+                        unsigned names)
+{
+    int n;
+
+    if (nargs != want)
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (n = 0; n < nargs; n++)
+    {
+        if (((names >> n) & 1) != (args[n].type == BINPROTO_STR))
+        {
+            return -RIG_EINVAL;
+        }
+    }
+
+    return RIG_OK;
+}
+
+
+/* a reply carries the error code alone, or the values alone */
+static void binary_status(struct binproto_frame *rep, int ret)
+{
+    if (ret != RIG_OK)
+    {
+        BINPROTO_FLAGS(rep) |= BINPROTO_ERROR;
+        binproto_put_int(rep, ret);
+    }
+}
+
+
+/*
+ * The commands polled most get typed fields, in the order of the text
+ * protocol.  Whatever else comes as a BINPROTO_TEXT frame.
+ */
+static void binary_command(RIG *my_rig,
+                           struct binproto_frame *req,
+                           struct binproto_frame *rep)
+{
+    int cmd = BINPROTO_CMD(req);
+    struct binary_arg args[4];
+    struct binary_arg *a = args;
+    int nargs;
+    freq_t freq;
+    rmode_t mode;
+    pbwidth_t width;
+    vfo_t vfo = RIG_VFO_CURR;
+    vfo_t tx_vfo;
+    ptt_t ptt;
+    dcd_t dcd;
+    split_t split;
+    setting_t setting;
+    shortfreq_t sf;
+    value_t val;
+    int status;
+    int ret;
+
+    nargs = binary_args(req, args, 4);
+
+    if (nargs < 0)
+    {
+        binary_status(rep, nargs);
+        return;
+    }
+
+    if (BINPROTO_FLAGS(req) & BINPROTO_VFO)
+    {
+        if (nargs == 0 || args[0].type != BINPROTO_STR)
+        {
+            binary_status(rep, -RIG_EINVAL);
+            return;
+        }
+
+        vfo = rig_parse_vfo(args[0].s);
+        a++;
+        nargs--;
+    }
+
+    switch (cmd)
+    {
+    case 'F':
+        ret = binary_check(a, nargs, 1, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_set_freq(my_rig, vfo, a[0].d);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'f':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_freq(my_rig, vfo, &freq);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_real(rep, freq);
+        }
+
+        break;
+
+    case 'M':
+    case 'X':
+        ret = binary_check(a, nargs, 2, 0x1);
+
+        if (ret == RIG_OK && cmd == 'M')
+        {
+            ret = rig_set_mode(my_rig, vfo, rig_parse_mode(a[0].s), a[1].i);
+        }
+        else if (ret == RIG_OK)
+        {
+            ret = rig_set_split_mode(my_rig, vfo, rig_parse_mode(a[0].s),
+                                     a[1].i);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'm':
+    case 'x':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK && cmd == 'm')
+        {
+            ret = rig_get_mode(my_rig, vfo, &mode, &width);
+        }
+        else if (ret == RIG_OK)
+        {
+            ret = rig_get_split_mode(my_rig, vfo, &mode, &width);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_str(rep, rig_strrmode(mode), -1);
+            binproto_put_int(rep, width);
+        }
+
+        break;
+
+    case 'V':
+        ret = binary_check(a, nargs, 1, 0x1);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_set_vfo(my_rig, rig_parse_vfo(a[0].s));
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'v':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_vfo(my_rig, &tx_vfo);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_str(rep, rig_strvfo(tx_vfo), -1);
+        }
+
+        break;
+
+    case 'T':
+        ret = binary_check(a, nargs, 1, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_set_ptt(my_rig, vfo, a[0].i);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 't':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_ptt(my_rig, vfo, &ptt);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_int(rep, ptt);
+        }
+
+        break;
+
+    case 0x8b:  /* get_dcd */
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_dcd(my_rig, vfo, &dcd);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_int(rep, dcd);
+        }
+
+        break;
+
+    case 'I':
+        ret = binary_check(a, nargs, 1, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_set_split_freq(my_rig, vfo, a[0].d);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'i':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_split_freq(my_rig, vfo, &freq);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_real(rep, freq);
+        }
+
+        break;
+
+    case 'S':
+        ret = binary_check(a, nargs, 2, 0x2);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_set_split_vfo(my_rig, vfo, a[0].i,
+                                    rig_parse_vfo(a[1].s));
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 's':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_split_vfo(my_rig, vfo, &split, &tx_vfo);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_int(rep, split);
+            binproto_put_str(rep, rig_strvfo(tx_vfo), -1);
+        }
+
+        break;
+
+    case 'J':
+    case 'Z':
+    case 'N':
+        ret = binary_check(a, nargs, 1, 0);
+
+        if (ret == RIG_OK && cmd == 'J')
+        {
+            ret = rig_set_rit(my_rig, vfo, a[0].i);
+        }
+        else if (ret == RIG_OK && cmd == 'Z')
+        {
+            ret = rig_set_xit(my_rig, vfo, a[0].i);
+        }
+        else if (ret == RIG_OK)
+        {
+            ret = rig_set_ts(my_rig, vfo, a[0].i);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'j':
+    case 'z':
+    case 'n':
+        ret = binary_check(a, nargs, 0, 0);
+
+        if (ret == RIG_OK && cmd == 'j')
+        {
+            ret = rig_get_rit(my_rig, vfo, &sf);
+        }
+        else if (ret == RIG_OK && cmd == 'z')
+        {
+            ret = rig_get_xit(my_rig, vfo, &sf);
+        }
+        else if (ret == RIG_OK)
+        {
+            ret = rig_get_ts(my_rig, vfo, &sf);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_int(rep, sf);
+        }
+
+        break;
+
+    case 'L':
+        ret = binary_check(a, nargs, 2, 0x1);
+
+        if (ret == RIG_OK)
+        {
+            setting = rig_parse_level(a[0].s);
+
+            if (RIG_LEVEL_IS_FLOAT(setting))
+            {
+                val.f = a[1].d;
+            }
+            else
+            {
+                val.i = a[1].i;
+            }
+
+            ret = rig_set_level(my_rig, vfo, setting, val);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'l':
+        ret = binary_check(a, nargs, 1, 0x1);
+        setting = RIG_LEVEL_NONE;
+
+        if (ret == RIG_OK)
+        {
+            setting = rig_parse_level(a[0].s);
+            ret = rig_get_level(my_rig, vfo, setting, &val);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK && RIG_LEVEL_IS_FLOAT(setting))
+        {
+            binproto_put_real(rep, val.f);
+        }
+        else if (ret == RIG_OK)
+        {
+            binproto_put_int(rep, val.i);
+        }
+
+        break;
+
+    case 'U':
+        ret = binary_check(a, nargs, 2, 0x1);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_set_func(my_rig, vfo, rig_parse_func(a[0].s), a[1].i);
+        }
+
+        binary_status(rep, ret);
+        break;
+
+    case 'u':
+        ret = binary_check(a, nargs, 1, 0x1);
+
+        if (ret == RIG_OK)
+        {
+            ret = rig_get_func(my_rig, vfo, rig_parse_func(a[0].s), &status);
+        }
+
+        binary_status(rep, ret);
+
+        if (ret == RIG_OK)
+        {
+            binproto_put_int(rep, status);
+        }
+
+        break;
+
+    default:
+        binary_status(rep, -RIG_ENIMPL);
+        break;
+    }
+}
+
+
+/*
+ * Run one text protocol line through rigctl_parse(), the reply text goes
+ * back in string fields.  Keeps every command of rigctld within reach
+ * without a typed encoding for each.
+ */
+static void binary_text(RIG *my_rig,
+                        struct binproto_frame *req,
+                        struct binproto_frame *rep,
+                        sync_cb_t sync_cb)
+{
+    char text[BINPROTO_MAXLEN];
+    char *out = NULL;
+    size_t outlen = 0;
+    size_t i;
+    int len = 0;
+    int ret;
+    FILE *fin;
+    FILE *fout;
+
+    while (binproto_peek(req) == BINPROTO_STR)
+    {
+        ret = binproto_get_str(req, text + len, sizeof(text) - len);
+
+        if (ret < 0)
+        {
+            binary_status(rep, ret);
+            return;
+        }
+
+        len += ret;
+    }
+
+    if (len == 0)
+    {
+        binary_status(rep, -RIG_EINVAL);
+        return;
+    }
+
+#if defined(HAVE_FMEMOPEN) && defined(HAVE_OPEN_MEMSTREAM)
+    fin = fmemopen(text, len, "r");
+    fout = open_memstream(&out, &outlen);
+#else
+    fin = tmpfile();
+    fout = tmpfile();
+
+    if (fin)
+    {
+        fwrite(text, 1, len, fin);
+        rewind(fin);
+    }
+
+#endif
+
+    if (!fin || !fout)
+    {
+        if (fin)
+        {
+            fclose(fin);
+        }
+
+        if (fout)
+        {
+            fclose(fout);
+        }
+
+        binary_status(rep, -RIG_ENOMEM);
+        return;
+    }
+
+    rigctl_parse(my_rig, fin, fout, NULL, 0, sync_cb);
+    fclose(fin);
+
+#if defined(HAVE_FMEMOPEN) && defined(HAVE_OPEN_MEMSTREAM)
+    fclose(fout);
+#else
+    fflush(fout);
+    outlen = ftell(fout);
+    out = malloc(outlen + 1);
+
+    if (out)
+    {
+        rewind(fout);
+        outlen = fread(out, 1, outlen, fout);
+    }
+
+    fclose(fout);
+#endif
+
+    if (!out)
+    {
+        binary_status(rep, -RIG_ENOMEM);
+        return;
+    }
+
+    for (i = 0; i < outlen; i += 255)
+    {
+        if (binproto_put_str(rep, out + i, outlen - i > 255 ? 255 : outlen - i)
+                != RIG_OK)
+        {
+            rig_debug(RIG_DEBUG_WARN, "%s: reply truncated to %d bytes\n",
+                      __func__, (int)i);
+            break;
+        }
+    }
+
+    free(out);
+}
+
+
+/*
+ * Serve a connection that switched to binary frames, till the peer
+ * leaves.  The replies to requests flagged BINPROTO_MORE are held and
+ * sent along with the reply to the last request of the batch.
+ *
+ * Returns 1, like rigctl_parse() does on 'q'.
+ */
+int rigctl_binary(RIG *my_rig, FILE *fin, FILE *fout, sync_cb_t sync_cb)
+{
+    unsigned char buf[BINPROTO_MAXLEN];
+    struct binproto_frame req;
+    struct binproto_frame rep;
+    int len;
+
+    rig_debug(RIG_DEBUG_VERBOSE, "%s: binary protocol version %d\n",
+              __func__, BINPROTO_VERSION);
+
+    for (;;)
+    {
+        if (fread(buf, 1, 2, fin) != 2)
+        {
+            return 1;
+        }
+
+        len = BINPROTO_FRAMELEN(buf);
+
+        if (len < BINPROTO_HDRLEN || len > BINPROTO_MAXLEN)
+        {
+            rig_debug(RIG_DEBUG_ERR, "%s: bad frame length %d\n",
+                      __func__, len);
+            return 1;
+        }
+
+        if (fread(buf + 2, 1, len - 2, fin) != (size_t)(len - 2)
+                || binproto_parse(&req, buf, len) != RIG_OK)
+        {
+            return 1;
+        }
+
+        if (BINPROTO_CMD(&req) == 'q' || BINPROTO_CMD(&req) == 'Q')
+        {
+            return 1;
+        }
+
+        binproto_init(&rep, BINPROTO_ID(&req), 0, BINPROTO_CMD(&req));
+
+        if (BINPROTO_CMD(&req) == BINPROTO_TEXT)
+        {
+            binary_text(my_rig, &req, &rep, sync_cb);
+        }
+        else
+        {
+            if (sync_cb) sync_cb (1);   /* lock if necessary */
+
+            binary_command(my_rig, &req, &rep);
+
+            if (sync_cb) sync_cb (0);   /* unlock if necessary */
+        }
+
+        fwrite(rep.buf, 1, rep.len, fout);
+
+        if (!(BINPROTO_FLAGS(&req) & BINPROTO_MORE))
+        {
+            fflush(fout);
+        }
+
+        if (ferror(fin) || ferror(fout))
+        {
+            return 1;
+        }
+    }
+}
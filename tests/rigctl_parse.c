@@ -67,6 +67,7 @@ extern int read_history();
 #include "iofunc.h"
 #include "serial.h"
 #include "sprintflst.h"
+#include "binproto.h"
 
 /* HAVE_SSLEEP is defined when Windows Sleep is found
  * HAVE_SLEEP is defined when POSIX sleep is found
@@ -218,6 +219,7 @@ declare_proto_rig(get_info);
 declare_proto_rig(dump_caps);
 declare_proto_rig(dump_conf);
 declare_proto_rig(dump_state);
+declare_proto_rig(dump_stats);
 declare_proto_rig(set_ant);
 declare_proto_rig(get_ant);
 declare_proto_rig(reset);
@@ -230,6 +232,7 @@ declare_proto_rig(recv_dtmf);
 declare_proto_rig(chk_vfo);
 declare_proto_rig(halt);
 declare_proto_rig(pause);
+declare_proto_rig(set_binary);
 
 
 /*
@@ -308,8 +311,10 @@ static struct test_table test_list[] =
     { '1',  "dump_caps",        ACTION(dump_caps),      ARG_NOVFO },
     { '3',  "dump_conf",        ACTION(dump_conf),      ARG_NOVFO },
     { 0x8f, "dump_state",       ACTION(dump_state),     ARG_OUT | ARG_NOVFO },
+    { 0x8d, "dump_stats",       ACTION(dump_stats),     ARG_NOVFO },
     { 0xf0, "chk_vfo",          ACTION(chk_vfo),        ARG_NOVFO },   /* rigctld only--check for VFO mode */
     { 0xf1, "halt",             ACTION(halt),           ARG_NOVFO },   /* rigctld only--halt the daemon */
+    { 0xf2, "set_binary",       ACTION(set_binary),     ARG_IN | ARG_NOVFO, "Version" },   /* rigctld only--switch to binary frames */
     { 0x8c, "pause",            ACTION(pause),          ARG_IN, "Seconds" },
     { 0x00, "", NULL },
 };
@@ -1615,6 +1620,11 @@ int rigctl_parse(RIG *my_rig, FILE *fin, FILE *fout, char *argv[], int argc, syn
         return retcode;
     }
 
+    if (retcode == RIG_OK && cmd == 0xf2)
+    {
+        return RIGCTL_PARSE_BINARY;
+    }
+
     return retcode != RIG_OK ? 2 : 0;
 }
 
@@ -3780,7 +3790,7 @@ declare_proto_rig(dump_state)
     /*
      * - Protocol version
      */
-#define RIGCTLD_PROT_VER 0
+#define RIGCTLD_PROT_VER 1
     fprintf(fout, "%d\n", RIGCTLD_PROT_VER);
     fprintf(fout, "%d\n", rig->caps->rig_model);
     fprintf(fout, "%d\n", rs->itu_region);
@@ -3874,6 +3884,41 @@ declare_proto_rig(dump_state)
 }
 
 
+/* 0x8d */
+declare_proto_rig(dump_stats)
+{
+    hamlib_port_stats_t stats;
+    int ret;
+
+    ret = rig_get_port_stats(rig, &stats);
+
+    if (ret != RIG_OK)
+    {
+        return ret;
+    }
+
+    fprintf(fout, "Bytes out: %lu\n", stats.bytes_out);
+    fprintf(fout, "Bytes in: %lu\n", stats.bytes_in);
+    fprintf(fout, "Transactions: %lu\n", stats.transactions);
+    fprintf(fout, "Timeouts: %lu\n", stats.timeouts);
+    fprintf(fout, "Retries: %lu\n", stats.retries);
+    fprintf(fout, "Flushed bytes: %lu\n", stats.flushed);
+    fprintf(fout, "Protocol errors: %lu\n", stats.protocol_errors);
+    fprintf(fout, "First byte latency us p50/p90/p99/max: %lu %lu %lu %lu\n",
+            rig_port_hist_percentile(stats.first_byte_hist, 50.0),
+            rig_port_hist_percentile(stats.first_byte_hist, 90.0),
+            rig_port_hist_percentile(stats.first_byte_hist, 99.0),
+            rig_port_hist_percentile(stats.first_byte_hist, 100.0));
+    fprintf(fout, "Last byte latency us p50/p90/p99/max: %lu %lu %lu %lu\n",
+            rig_port_hist_percentile(stats.last_byte_hist, 50.0),
+            rig_port_hist_percentile(stats.last_byte_hist, 90.0),
+            rig_port_hist_percentile(stats.last_byte_hist, 99.0),
+            rig_port_hist_percentile(stats.last_byte_hist, 100.0));
+
+    return RIG_OK;
+}
+
+
 /* '3' */
 declare_proto_rig(dump_conf)
 {
@@ -4126,6 +4171,35 @@ declare_proto_rig(halt)
 }
 
 
+/* '0xf2'--switch the rigctld connection to binary frames, see binproto.h */
+declare_proto_rig(set_binary)
+{
+    int version;
+    int c;
+
+    if (!(interactive && !prompt))
+    {
+        return -RIG_ENAVAIL;
+    }
+
+    CHKSCN1ARG(sscanf(arg1, "%d", &version));
+
+    if (version != BINPROTO_VERSION)
+    {
+        return -RIG_EINVAL;
+    }
+
+    /* frames start right after the end of this line */
+    do
+    {
+        c = fgetc(fin);
+    }
+    while (c != EOF && c != '\n');
+
+    return RIG_OK;
+}
+
+
 /* '0x8c'--pause processing */
 declare_proto_rig(pause)
 {
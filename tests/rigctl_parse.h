@@ -48,4 +48,8 @@ int set_conf(RIG *my_rig, char *conf_parms);
 typedef void (*sync_cb_t)(int);
 int rigctl_parse(RIG *my_rig, FILE *fin, FILE *fout, char *argv[], int argc, sync_cb_t sync_cb);
 
+/* rigctl_parse() return once the client asked for binary frames */
+#define RIGCTL_PARSE_BINARY 3
+int rigctl_binary(RIG *my_rig, FILE *fin, FILE *fout, sync_cb_t sync_cb);
+
 #endif  /* RIGCTL_PARSE_H */
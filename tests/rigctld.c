@@ -39,6 +39,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <signal.h>
+#include <time.h>
 
 #include <getopt.h>
 
@@ -66,6 +67,18 @@
 #  include <netdb.h>
 #endif
 
+#ifdef HAVE_SYS_UN_H
+#  include <sys/un.h>
+#endif
+
+#ifdef HAVE_SYS_STAT_H
+#  include <sys/stat.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
 #ifdef HAVE_PTHREAD
 #  include <pthread.h>
 #endif
@@ -85,7 +98,7 @@
  * NB: do NOT use -W since it's reserved by POSIX.
  * TODO: add an option to read from a file
  */
-#define SHORT_OPTIONS "m:r:p:d:P:D:s:c:T:t:C:lLuovhVZ"
+#define SHORT_OPTIONS "m:r:p:d:P:D:s:c:T:t:U:M:i:C:lLuovhVZX:"
 static struct option long_options[] =
 {
     {"model",           1, 0, 'm'},
@@ -98,6 +111,9 @@ static struct option long_options[] =
     {"civaddr",         1, 0, 'c'},
     {"listen-addr",     1, 0, 'T'},
     {"port",            1, 0, 't'},
+    {"unix-socket",     1, 0, 'U'},
+    {"state-file",      1, 0, 'M'},
+    {"state-interval",  1, 0, 'i'},
     {"set-conf",        1, 0, 'C'},
     {"list",            0, 0, 'l'},
     {"show-conf",       0, 0, 'L'},
@@ -107,6 +123,7 @@ static struct option long_options[] =
     {"help",            0, 0, 'h'},
     {"version",         0, 0, 'V'},
     {"debug-time-stamps",0, 0, 'Z'},
+    {"trace-file",      1, 0, 'X'},
     {0, 0, 0, 0}
 };
 
@@ -145,6 +162,9 @@ char send_cmd_term = '\r';  /* send_cmd termination char */
 
 const char *portno = "4532";
 const char *src_addr = NULL; /* INADDR_ANY */
+const char *unix_path = NULL;   /* no local socket */
+const char *state_file = NULL;  /* no shared state page */
+int state_interval = 1000;      /* ms between state page updates */
 
 #define MAXCONFLEN 128
 
@@ -227,6 +247,146 @@ static void handle_error(enum rig_debug_level_e lvl, const char *msg)
 }
 
 
+/* peer of a connection, for the log */
+static void peer_name(const struct handle_data *arg,
+                      char *host,
+                      size_t hostlen,
+                      char *serv,
+                      size_t servlen)
+{
+    int retcode;
+
+#ifdef HAVE_SYS_UN_H
+
+    if (arg->cli_addr.ss_family == AF_UNIX)
+    {
+        snprintf(host, hostlen, "%s", unix_path);
+        snprintf(serv, servlen, "local");
+        return;
+    }
+
+#endif
+
+    retcode = getnameinfo((struct sockaddr const *)&arg->cli_addr,
+                          arg->clilen,
+                          host,
+                          hostlen,
+                          serv,
+                          servlen,
+                          NI_NOFQDN);
+
+    if (retcode != 0)
+    {
+        rig_debug(RIG_DEBUG_WARN, "Peer lookup error: %s", gai_strerror(retcode));
+        snprintf(host, hostlen, "?");
+        snprintf(serv, servlen, "?");
+    }
+}
+
+
+#ifdef HAVE_PTHREAD
+/*
+ * Keeps the shared state page up to date.  It holds the rig open as a
+ * client would, and takes the client lock for each update, so that local
+ * readers see the state a client would get, at most state_interval old.
+ */
+static void *state_poll(void *arg)
+{
+    struct rig_state_page *page = (struct rig_state_page *)arg;
+    struct rig_state_snapshot snap;
+    struct timeval tv;
+    struct timespec ts;
+    int left;
+    int held = 0;
+    vfo_t vfo;
+    freq_t freq;
+    rmode_t mode;
+    pbwidth_t width;
+    ptt_t ptt;
+
+    memset(&snap, 0, sizeof(snap));
+    snap.vfo = RIG_VFO_CURR;
+    snap.ptt = RIG_PTT_OFF;
+
+    while (!ctrl_c)
+    {
+        sync_callback(1);
+
+        /*
+         * The poller counts as a client once the rig is open, and tries
+         * again each interval while it is off or busy.
+         */
+        if (!held)
+        {
+            if (client_count || rig_open(my_rig) == RIG_OK)
+            {
+                client_count++;
+                held = 1;
+            }
+            else
+            {
+                rig_debug(RIG_DEBUG_ERR, "%s: rig_open failed\n", __func__);
+                /* a failed rig_open() leaves the port to close */
+                rig_close(my_rig);
+            }
+        }
+
+        if (!held)
+        {
+            sync_callback(0);
+            goto next;
+        }
+
+        /* what the rig cannot tell keeps its last value */
+        if (my_rig->caps->get_vfo && rig_get_vfo(my_rig, &vfo) == RIG_OK)
+        {
+            snap.vfo = vfo;
+        }
+
+        if (rig_get_freq(my_rig, RIG_VFO_CURR, &freq) == RIG_OK)
+        {
+            snap.freq = freq;
+        }
+
+        if (rig_get_mode(my_rig, RIG_VFO_CURR, &mode, &width) == RIG_OK)
+        {
+            snap.mode = mode;
+            snap.width = width;
+        }
+
+        if (rig_get_ptt(my_rig, RIG_VFO_CURR, &ptt) == RIG_OK)
+        {
+            snap.ptt = ptt;
+        }
+
+        sync_callback(0);
+
+        gettimeofday(&tv, NULL);
+        snap.stamp = tv.tv_sec + tv.tv_usec / 1e6;
+        rig_state_page_publish(page, &snap);
+
+next:
+        /* by slices, the end of rigctld does not wait a whole interval */
+        for (left = state_interval; left > 0 && !ctrl_c; left -= 100)
+        {
+            ts.tv_sec = 0;
+            ts.tv_nsec = (left < 100 ? left : 100) * 1000000L;
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    if (held)
+    {
+        sync_callback(1);
+        client_count--;
+        sync_callback(0);
+    }
+
+    return NULL;
+}
+#endif
+
+
 int main(int argc, char *argv[])
 {
     rig_model_t my_model = RIG_MODEL_DUMMY;
@@ -236,6 +396,7 @@ int main(int argc, char *argv[])
     int show_conf = 0;
     int dump_caps_opt = 0;
     const char *rig_file = NULL, *ptt_file = NULL, *dcd_file = NULL;
+    const char *trace_file = NULL;
     ptt_type_t ptt_type = RIG_PTT_NONE;
     dcd_type_t dcd_type = RIG_DCD_NONE;
     int serial_rate = 0;
@@ -244,6 +405,9 @@ int main(int argc, char *argv[])
 
     struct addrinfo hints, *result, *saved_result;
     int sock_listen;
+    int sock_unix = -1;
+    int sock_max;
+    struct rig_state_page *state_page = NULL;
     int sockopt;
     int reuseaddr = 1;
     char host[NI_MAXHOST];
@@ -251,6 +415,7 @@ int main(int argc, char *argv[])
 
 #ifdef HAVE_PTHREAD
     pthread_t thread;
+    pthread_t state_thread;
     pthread_attr_t attr;
 #endif
     struct handle_data *arg;
@@ -452,6 +617,42 @@ int main(int argc, char *argv[])
             src_addr = optarg;
             break;
 
+        case 'U':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            unix_path = optarg;
+            break;
+
+        case 'M':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            state_file = optarg;
+            break;
+
+        case 'i':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            state_interval = atoi(optarg);
+
+            if (state_interval < 1)
+            {
+                state_interval = 1;
+            }
+
+            break;
+
         case 'o':
             vfo_mode++;
             break;
@@ -476,6 +677,16 @@ int main(int argc, char *argv[])
             rig_set_debug_time_stamp(1);
             break;
 
+        case 'X':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            trace_file = optarg;
+            break;
+
         default:
             usage();    /* unknown option? */
             exit(1);
@@ -566,6 +777,17 @@ int main(int argc, char *argv[])
         exit(0);
     }
 
+    if (trace_file)
+    {
+        retcode = rig_trace_open(trace_file);
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "rig_trace_open: error = %s \n", rigerror(retcode));
+            exit(2);
+        }
+    }
+
     /* open and close rig connection to check early for issues */
     retcode = rig_open(my_rig);
 
@@ -714,6 +936,107 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
+    sock_max = sock_listen;
+
+    /*
+     * Prepare the local socket, clients on this host skip the TCP stack
+     */
+    if (unix_path)
+    {
+#ifdef HAVE_SYS_UN_H
+        struct sockaddr_un addr;
+        struct stat st;
+        int probe;
+
+        if (strlen(unix_path) >= sizeof(addr.sun_path))
+        {
+            fprintf(stderr, "Socket path too long: %s\n", unix_path);
+            exit(1);
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, unix_path);
+
+        /* left behind by a previous run, unless a server still answers */
+        if (stat(unix_path, &st) == 0 && S_ISSOCK(st.st_mode))
+        {
+            probe = socket(AF_UNIX, SOCK_STREAM, 0);
+
+            if (probe >= 0
+                    && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+            {
+                fprintf(stderr, "A server is already listening on %s\n",
+                        unix_path);
+                close(probe);
+                exit(1);
+            }
+
+            if (probe >= 0)
+            {
+                close(probe);
+            }
+
+            unlink(unix_path);
+        }
+
+        sock_unix = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (sock_unix < 0)
+        {
+            handle_error(RIG_DEBUG_ERR, "socket");
+            exit(2);
+        }
+
+        if (bind(sock_unix, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            handle_error(RIG_DEBUG_ERR, "binding local socket");
+            exit(1);
+        }
+
+        if (listen(sock_unix, 4) < 0)
+        {
+            handle_error(RIG_DEBUG_ERR, "listening");
+            exit(1);
+        }
+
+        if (sock_unix > sock_max)
+        {
+            sock_max = sock_unix;
+        }
+
+#else
+        fprintf(stderr, "Unix domain sockets are not supported\n");
+        exit(1);
+#endif
+    }
+
+    if (state_file)
+    {
+#ifdef HAVE_PTHREAD
+        retcode = rig_state_page_create(state_file, &state_page);
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "rig_state_page_create: error = %s\n",
+                    rigerror(retcode));
+            exit(2);
+        }
+
+        retcode = pthread_create(&state_thread, NULL, state_poll, state_page);
+
+        if (retcode != 0)
+        {
+            rig_debug(RIG_DEBUG_ERR, "pthread_create: %s\n", strerror(retcode));
+            exit(1);
+        }
+
+#else
+        fprintf(stderr, "The state page needs thread support\n");
+        exit(1);
+#endif
+    }
+
 #if HAVE_SIGACTION
     struct sigaction act;
 
@@ -776,9 +1099,12 @@ int main(int argc, char *argv[])
         struct timeval timeout;
         FD_ZERO (&set);
         FD_SET (sock_listen, &set);
+        if (sock_unix >= 0) {
+          FD_SET (sock_unix, &set);
+        }
         timeout.tv_sec = 5;
         timeout.tv_usec = 0;
-        retcode = select (sock_listen + 1, &set, NULL, NULL, &timeout);
+        retcode = select (sock_max + 1, &set, NULL, NULL, &timeout);
         if (-1 == retcode) {
           rig_debug (RIG_DEBUG_ERR, "select\n");
         }
@@ -790,7 +1116,8 @@ int main(int argc, char *argv[])
         else {
           arg->rig = my_rig;
           arg->clilen = sizeof(arg->cli_addr);
-          arg->sock = accept(sock_listen,
+          arg->sock = accept((sock_unix >= 0 && FD_ISSET(sock_unix, &set))
+                             ? sock_unix : sock_listen,
                              (struct sockaddr *)&arg->cli_addr,
                              &arg->clilen);
 
@@ -800,19 +1127,8 @@ int main(int argc, char *argv[])
               break;
             }
 
-          if ((retcode = getnameinfo((struct sockaddr const *)&arg->cli_addr,
-                                     arg->clilen,
-                                     host,
-                                     sizeof(host),
-                                     serv,
-                                     sizeof(serv),
-                                     NI_NOFQDN))
-              < 0)
-            {
-              rig_debug(RIG_DEBUG_WARN,
-                        "Peer lookup error: %s",
-                        gai_strerror(retcode));
-            }
+          peer_name(arg, host, sizeof(host), serv, sizeof(serv));
+          retcode = 0;
 
           rig_debug(RIG_DEBUG_VERBOSE,
                     "Connection opened from %s:%s\n",
@@ -838,7 +1154,21 @@ int main(int argc, char *argv[])
     }
     while (retcode == 0 && !ctrl_c);
 
+    if (sock_unix >= 0)
+    {
+        close(sock_unix);
+        unlink(unix_path);
+    }
+
 #ifdef HAVE_PTHREAD
+    if (state_page)
+    {
+        /* ctrl_c also ends the state thread */
+        ctrl_c = 1;
+        pthread_join(state_thread, NULL);
+        rig_state_page_close(state_page);
+    }
+
     /* allow threads to finish current action */
     sync_callback (1);
     if (client_count) {
@@ -851,6 +1181,11 @@ int main(int argc, char *argv[])
 #endif
     rig_cleanup(my_rig); /* if you care about memory */
 
+    if (trace_file)
+    {
+        rig_trace_close();
+    }
+
 #ifdef __MINGW32__
     WSACleanup();
 #endif
@@ -934,6 +1269,12 @@ void * handle_socket(void *arg)
         {
           retcode = 1;
         }
+      if (retcode == RIGCTL_PARSE_BINARY)
+        {
+          /* the rest of the connection is binary frames */
+          retcode = rigctl_binary(handle_data_arg->rig, fsockin, fsockout, sync_callback);
+          break;
+        }
       if (retcode == 1)
         {
           retcode = rig_open(my_rig);
@@ -964,18 +1305,7 @@ void * handle_socket(void *arg)
     }
 #endif
 
-    if ((retcode = getnameinfo((struct sockaddr const *)&handle_data_arg->cli_addr,
-                               handle_data_arg->clilen,
-                               host,
-                               sizeof(host),
-                               serv,
-                               sizeof(serv),
-                               NI_NOFQDN))
-        < 0)
-    {
-
-        rig_debug(RIG_DEBUG_WARN, "Peer lookup error: %s", gai_strerror(retcode));
-    }
+    peer_name(handle_data_arg, host, sizeof(host), serv, sizeof(serv));
 
     rig_debug(RIG_DEBUG_VERBOSE,
               "Connection closed from %s:%s\n",
@@ -1019,6 +1349,9 @@ void usage(void)
         "  -c, --civaddr=ID              set CI-V address, decimal (for Icom rigs only)\n"
         "  -t, --port=NUM                set TCP listening port, default %s\n"
         "  -T, --listen-addr=IPADDR      set listening IP address, default ANY\n"
+        "  -U, --unix-socket=PATH        also listen on a local socket at PATH\n"
+        "  -M, --state-file=FILE         publish freq, mode and PTT in shared FILE\n"
+        "  -i, --state-interval=MS       set the update interval of FILE, default 1000\n"
         "  -C, --set-conf=PARM=VAL       set config parameters\n"
         "  -L, --show-conf               list all config parameters\n"
         "  -l, --list                    list all model numbers and exit\n"
@@ -1026,6 +1359,7 @@ void usage(void)
         "  -o, --vfo                     do not default to VFO_CURR, require extra vfo arg\n"
         "  -v, --verbose                 set verbose mode, cumulative (-v to -vvvvv)\n"
         "  -Z, --debug-time-stamps       enable time stamps for debug messages\n"
+        "  -X, --trace-file=FILE         capture port I/O to binary FILE, see rigtrace\n"
         "  -h, --help                    display this help and exit\n"
         "  -V, --version                 output version information and exit\n\n",
         portno);
@@ -0,0 +1,1078 @@
+/*
+ * rigemu.c - (C) The Hamlib Group 2020
+ *
+ * This program emulates a radio on a pseudo-terminal, speaking Icom CI-V,
+ * Kenwood or Yaesu newcat, so that the serial backends, with their
+ * framing, timeouts and retries, can be exercised without a radio.
+ *
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program; if not, write to the Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* posix_openpt() and friends */
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE 1
+#endif
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <getopt.h>
+
+#ifdef HAVE_TERMIOS_H
+#  include <termios.h>
+#endif
+
+#include <hamlib/rig.h>
+#include "misc.h"
+
+
+/*
+ * Prototypes
+ */
+static void usage();
+static void version();
+
+/*
+ * Reminder: when adding long options,
+ *  keep up to date SHORT_OPTIONS, usage()'s output and man page. thanks.
+ * NB: do NOT use -W since it's reserved by POSIX.
+ */
+#define SHORT_OPTIONS "p:a:i:s:d:e:S:l:nvhV"
+static struct option long_options[] =
+{
+    {"protocol",        1, 0, 'p'},
+    {"civaddr",         1, 0, 'a'},
+    {"id",              1, 0, 'i'},
+    {"serial-speed",    1, 0, 's'},
+    {"delay",           1, 0, 'd'},
+    {"error-rate",      1, 0, 'e'},
+    {"seed",            1, 0, 'S'},
+    {"link",            1, 0, 'l'},
+    {"no-echo",         0, 0, 'n'},
+    {"verbose",         0, 0, 'v'},
+    {"help",            0, 0, 'h'},
+    {"version",         0, 0, 'V'},
+    {0, 0, 0, 0}
+};
+
+enum emu_proto_e
+{
+    EMU_ICOM,
+    EMU_KENWOOD,
+    EMU_NEWCAT
+};
+
+#define EMU_BUF_LEN     256
+#define EMU_CAT_MAX     128     /* ASCII parameters held */
+
+/* CI-V */
+#define CIV_PR          0xfe
+#define CIV_FI          0xfd
+#define CIV_ACK         0xfb
+#define CIV_NAK         0xfa
+#define CIV_COL         0xfc
+
+/*
+ * Two letter command of the ASCII protocols.  A query is the name,
+ * followed by sel_len selector characters (e.g. the VFO digit of the
+ * newcat "MD0;"), and is answered with the current value; a set is the
+ * same followed by a value as long as init, and gets no answer.
+ */
+struct cat_cmd
+{
+    const char *name;
+    int sel_len;
+    const char *init;
+};
+
+static const struct cat_cmd kenwood_cmds[] =
+{
+    { "FA", 0, "00014250000" },
+    { "FB", 0, "00007100000" },
+    { "MD", 0, "2" },
+    { "FR", 0, "0" },
+    { "FT", 0, "0" },
+    { "AI", 0, "0" },
+    { "PS", 0, "1" },
+    { "AG", 1, "100" },
+    { "RG", 0, "255" },
+    { "SQ", 1, "000" },
+    { "PC", 0, "100" },
+    { "SM", 1, "0010" },
+    { "FW", 0, "0000" },
+    { "SH", 0, "00" },
+    { "SL", 0, "00" },
+    { "NB", 0, "0" },
+    { "NR", 0, "0" },
+    { "RT", 0, "0" },
+    { "XT", 0, "0" },
+    { "KS", 0, "020" },
+    { "FV", 0, "1.00" },
+    { NULL, 0, NULL }
+};
+
+static const struct cat_cmd newcat_cmds[] =
+{
+    { "FA", 0, "014250000" },
+    { "FB", 0, "007100000" },
+    { "MD", 1, "2" },
+    { "VS", 0, "0" },
+    { "FT", 0, "0" },
+    { "ST", 0, "0" },
+    { "AI", 0, "0" },
+    { "PS", 0, "1" },
+    { "TX", 0, "0" },
+    { "AG", 1, "100" },
+    { "RG", 1, "255" },
+    { "SQ", 1, "000" },
+    { "PC", 0, "100" },
+    { "SM", 1, "010" },
+    { "SH", 1, "00" },
+    { "NA", 1, "0" },
+    { "KS", 0, "020" },
+    { "VX", 0, "0" },
+    { NULL, 0, NULL }
+};
+
+struct cat_value
+{
+    char key[8];            /* name and selector */
+    char value[24];
+};
+
+struct emu
+{
+    enum emu_proto_e proto;
+    int fd;                 /* pty master */
+    int baud;               /* 0 for no line speed emulation */
+    int delay_ms;           /* processing delay */
+    int error_rate;         /* percent of commands answered wrong */
+    int echo;               /* CI-V bus echo */
+    int verbose;
+    unsigned char civ_addr;
+    const char *id;
+
+    /* ASCII protocols */
+    const struct cat_cmd *cmds;
+    struct cat_value values[EMU_CAT_MAX];
+    int nvalues;
+    int ptt;
+
+    /* CI-V */
+    unsigned long long freq[2];
+    unsigned char mode[2];
+    unsigned char filter[2];
+    int vfo;
+    int split;
+    int civ_ptt;
+    int level[256];
+    int meter[256];
+    int func[256];
+
+    unsigned char in[EMU_BUF_LEN];
+    int in_len;
+};
+
+static const char *link_path;
+
+
+static void emu_cleanup(int sig)
+{
+    if (link_path)
+    {
+        unlink(link_path);
+    }
+
+    _exit(sig ? 0 : 1);
+}
+
+
+static void emu_dump(struct emu *e, const char *what,
+                     const unsigned char *buf, int len)
+{
+    int i;
+
+    if (!e->verbose)
+    {
+        return;
+    }
+
+    fprintf(stderr, "%s ", what);
+
+    for (i = 0; i < len; i++)
+    {
+        if (e->proto == EMU_ICOM)
+        {
+            fprintf(stderr, "%02x ", buf[i]);
+        }
+        else
+        {
+            fputc(isprint(buf[i]) ? buf[i] : '.', stderr);
+        }
+    }
+
+    fputc('\n', stderr);
+}
+
+
+/* time the line takes to carry len bytes, 10 bits each */
+static void emu_line_delay(struct emu *e, int len)
+{
+    if (e->baud > 0)
+    {
+        usleep((useconds_t)(len * 10 * 1000000LL / e->baud));
+    }
+}
+
+
+static void emu_send(struct emu *e, const void *buf, int len)
+{
+    const unsigned char *p = buf;
+
+    emu_dump(e, "->", p, len);
+    emu_line_delay(e, len);
+
+    while (len > 0)
+    {
+        ssize_t n = write(e->fd, p, len);
+
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+
+            perror("write");
+            return;
+        }
+
+        p += n;
+        len -= n;
+    }
+}
+
+
+static int emu_inject(struct emu *e)
+{
+    return e->error_rate > 0 && rand() % 100 < e->error_rate;
+}
+
+
+/*
+ * Kenwood and Yaesu newcat
+ */
+
+static struct cat_value *cat_lookup(struct emu *e, const char *key,
+                                    const char *init)
+{
+    int i;
+
+    for (i = 0; i < e->nvalues; i++)
+    {
+        if (!strcmp(e->values[i].key, key))
+        {
+            return &e->values[i];
+        }
+    }
+
+    if (!init || e->nvalues == EMU_CAT_MAX)
+    {
+        return NULL;
+    }
+
+    strncpy(e->values[i].key, key, sizeof(e->values[i].key) - 1);
+    strncpy(e->values[i].value, init, sizeof(e->values[i].value) - 1);
+    e->nvalues++;
+
+    return &e->values[i];
+}
+
+
+static const char *cat_get(struct emu *e, const char *key)
+{
+    const struct cat_cmd *c;
+
+    for (c = e->cmds; c->name; c++)
+    {
+        if (!strncmp(c->name, key, 2))
+        {
+            struct cat_value *v = cat_lookup(e, key, c->init);
+
+            return v ? v->value : c->init;
+        }
+    }
+
+    return "";
+}
+
+
+static void cat_set(struct emu *e, const char *key, const char *value)
+{
+    struct cat_value *v = cat_lookup(e, key, value);
+
+    if (v)
+    {
+        snprintf(v->value, sizeof(v->value), "%.23s", value);
+    }
+}
+
+
+/* answer IF; from the individual parameters */
+static void cat_if(struct emu *e, char *reply)
+{
+    if (e->proto == EMU_KENWOOD)
+    {
+        const char *fr = cat_get(e, "FR");
+
+        sprintf(reply, "IF%s     +000000000%d%s%s0%d0000;",
+                cat_get(e, *fr == '1' ? "FB" : "FA"),
+                e->ptt,
+                cat_get(e, "MD"),
+                fr,
+                strcmp(fr, cat_get(e, "FT")) ? 1 : 0);
+    }
+    else
+    {
+        const char *vs = cat_get(e, "VS");
+
+        sprintf(reply, "IF001%s+000000%s00000;",
+                cat_get(e, *vs == '1' ? "FB" : "FA"),
+                cat_get(e, "MD0"));
+    }
+}
+
+
+/* handle one command, without its terminator */
+static void cat_command(struct emu *e, const char *cmd)
+{
+    char reply[EMU_BUF_LEN];
+    const struct cat_cmd *c;
+    int len = strlen(cmd);
+
+    reply[0] = '\0';
+
+    if (emu_inject(e))
+    {
+        static const char *errors[] = { "?;", "E;", "O;", "" };
+        const char *err = errors[rand() % 4];
+
+        if (e->verbose)
+        {
+            fprintf(stderr, "injecting '%s' for %s\n", err, cmd);
+        }
+
+        if (*err)
+        {
+            emu_send(e, err, strlen(err));
+        }
+
+        return;
+    }
+
+    if (len < 2)
+    {
+        strcpy(reply, "?;");
+    }
+    else if (!strcmp(cmd, "ID"))
+    {
+        sprintf(reply, "ID%s;", e->id);
+    }
+    else if (!strcmp(cmd, "IF"))
+    {
+        cat_if(e, reply);
+    }
+    else if (e->proto == EMU_KENWOOD && !strncmp(cmd, "TX", 2))
+    {
+        e->ptt = 1;
+    }
+    else if (e->proto == EMU_KENWOOD && !strncmp(cmd, "RX", 2))
+    {
+        e->ptt = 0;
+    }
+    else
+    {
+        for (c = e->cmds; c->name; c++)
+        {
+            if (!strncmp(c->name, cmd, 2))
+            {
+                break;
+            }
+        }
+
+        if (!c->name || len < 2 + c->sel_len)
+        {
+            strcpy(reply, "?;");
+        }
+        else
+        {
+            char key[8];
+
+            snprintf(key, sizeof(key), "%.*s", 2 + c->sel_len, cmd);
+
+            if (len == 2 + c->sel_len)
+            {
+                sprintf(reply, "%s%s;", key, cat_get(e, key));
+            }
+            else if (len == 2 + c->sel_len + (int)strlen(c->init))
+            {
+                cat_set(e, key, cmd + 2 + c->sel_len);
+
+                /* selecting the RX VFO selects the TX VFO as well */
+                if (e->proto == EMU_KENWOOD && !strcmp(key, "FR"))
+                {
+                    cat_set(e, "FT", cmd + 2);
+                }
+            }
+            else
+            {
+                strcpy(reply, "?;");
+            }
+        }
+    }
+
+    if (reply[0])
+    {
+        usleep(e->delay_ms * 1000);
+        emu_send(e, reply, strlen(reply));
+    }
+}
+
+
+static void cat_input(struct emu *e)
+{
+    int i, start = 0;
+
+    for (i = 0; i < e->in_len; i++)
+    {
+        if (e->in[i] == ';')
+        {
+            char cmd[EMU_BUF_LEN];
+            int len = i - start;
+
+            memcpy(cmd, e->in + start, len);
+            cmd[len] = '\0';
+            emu_dump(e, "<-", e->in + start, len + 1);
+            emu_line_delay(e, len + 1);
+            cat_command(e, cmd);
+            start = i + 1;
+        }
+        else if (e->in[i] == '\r' || e->in[i] == '\n')
+        {
+            start = i + 1;  /* some programs end lines, ignore */
+        }
+    }
+
+    e->in_len -= start;
+    memmove(e->in, e->in + start, e->in_len);
+
+    if (e->in_len == sizeof(e->in))
+    {
+        /* too many characters without a terminator */
+        e->in_len = 0;
+        emu_send(e, "O;", 2);
+    }
+}
+
+
+/*
+ * Icom CI-V, see icom/frame.c
+ */
+
+static void civ_reply(struct emu *e, unsigned char to,
+                      const unsigned char *data, int len)
+{
+    unsigned char frame[EMU_BUF_LEN];
+
+    frame[0] = CIV_PR;
+    frame[1] = CIV_PR;
+    frame[2] = to;
+    frame[3] = e->civ_addr;
+    memcpy(frame + 4, data, len);
+    frame[4 + len] = CIV_FI;
+
+    usleep(e->delay_ms * 1000);
+    emu_send(e, frame, len + 5);
+}
+
+
+static void civ_ack(struct emu *e, unsigned char to, unsigned char ack)
+{
+    civ_reply(e, to, &ack, 1);
+}
+
+
+/* frame holds FE FE to from cmd [sub] [data] FD */
+static void civ_frame(struct emu *e, unsigned char *frame, int len)
+{
+    unsigned char r[EMU_BUF_LEN];
+    unsigned char from = frame[3];
+    unsigned char cmd = frame[4];
+    unsigned char *data = frame + 5;
+    int dlen = len - 6;
+    int sub = dlen > 0 ? data[0] : -1;
+    int v = e->vfo;
+
+    emu_dump(e, "<-", frame, len);
+    emu_line_delay(e, len);
+
+    if (e->echo)
+    {
+        if (emu_inject(e) && rand() % 4 == 0)
+        {
+            if (e->verbose)
+            {
+                fprintf(stderr, "injecting a garbled echo\n");
+            }
+
+            /* garbled echo, as after a collision on the bus */
+            frame[len - 2] ^= 0x55;
+            emu_send(e, frame, len);
+            return;
+        }
+
+        emu_send(e, frame, len);
+    }
+
+    if (frame[2] != e->civ_addr && frame[2] != 0x00)
+    {
+        return;     /* for another radio on the bus */
+    }
+
+    if (emu_inject(e))
+    {
+        if (e->verbose)
+        {
+            fprintf(stderr, "injecting an error for command %02x\n", cmd);
+        }
+
+        switch (rand() % 3)
+        {
+        case 0:
+            civ_ack(e, from, CIV_NAK);
+            break;
+
+        case 1:
+            civ_ack(e, from, CIV_COL);
+            break;
+
+        default:
+            break;  /* no answer */
+        }
+
+        return;
+    }
+
+    r[0] = cmd;
+
+    switch (cmd)
+    {
+    case 0x00:  /* transceive frequency, never acknowledged */
+    case 0x05:
+        if (dlen != 5)
+        {
+            civ_ack(e, from, CIV_NAK);
+            break;
+        }
+
+        e->freq[v] = from_bcd(data, 10);
+
+        if (cmd == 0x05)
+        {
+            civ_ack(e, from, CIV_ACK);
+        }
+
+        break;
+
+    case 0x01:  /* transceive mode, never acknowledged */
+    case 0x06:
+        if (dlen < 1)
+        {
+            civ_ack(e, from, CIV_NAK);
+            break;
+        }
+
+        e->mode[v] = data[0];
+        e->filter[v] = dlen > 1 ? data[1] : 1;
+
+        if (cmd == 0x06)
+        {
+            civ_ack(e, from, CIV_ACK);
+        }
+
+        break;
+
+    case 0x03:
+        to_bcd(r + 1, e->freq[v], 10);
+        civ_reply(e, from, r, 6);
+        break;
+
+    case 0x04:
+        r[1] = e->mode[v];
+        r[2] = e->filter[v];
+        civ_reply(e, from, r, 3);
+        break;
+
+    case 0x07:
+        switch (sub)
+        {
+        case -1:        /* VFO mode */
+            break;
+
+        case 0x00:
+        case 0xd0:
+            e->vfo = 0;
+            break;
+
+        case 0x01:
+        case 0xd1:
+            e->vfo = 1;
+            break;
+
+        case 0xa0:      /* A=B */
+            e->freq[1] = e->freq[0];
+            e->mode[1] = e->mode[0];
+            e->filter[1] = e->filter[0];
+            break;
+
+        case 0xb0:      /* exchange */
+        {
+            unsigned long long f = e->freq[0];
+            unsigned char m = e->mode[0], fl = e->filter[0];
+
+            e->freq[0] = e->freq[1];
+            e->mode[0] = e->mode[1];
+            e->filter[0] = e->filter[1];
+            e->freq[1] = f;
+            e->mode[1] = m;
+            e->filter[1] = fl;
+            break;
+        }
+
+        default:
+            civ_ack(e, from, CIV_NAK);
+            return;
+        }
+
+        civ_ack(e, from, CIV_ACK);
+        break;
+
+    case 0x0f:
+        if (sub == -1)
+        {
+            r[1] = e->split;
+            civ_reply(e, from, r, 2);
+        }
+        else
+        {
+            e->split = sub == 0x01;
+            civ_ack(e, from, CIV_ACK);
+        }
+
+        break;
+
+    case 0x14:
+    case 0x15:
+        if (sub == -1)
+        {
+            civ_ack(e, from, CIV_NAK);
+        }
+        else if (dlen == 3 && cmd == 0x14)
+        {
+            e->level[sub] = from_bcd_be(data + 1, 4);
+            civ_ack(e, from, CIV_ACK);
+        }
+        else if (cmd == 0x15 && sub == 0x01)
+        {
+            /* squelch status */
+            r[1] = sub;
+            r[2] = e->meter[0x02] > e->level[0x03];
+            civ_reply(e, from, r, 3);
+        }
+        else
+        {
+            r[1] = sub;
+            to_bcd_be(r + 2, cmd == 0x14 ? e->level[sub] : e->meter[sub], 4);
+            civ_reply(e, from, r, 4);
+        }
+
+        break;
+
+    case 0x16:
+        if (sub == -1)
+        {
+            civ_ack(e, from, CIV_NAK);
+        }
+        else if (dlen == 2)
+        {
+            e->func[sub] = data[1];
+            civ_ack(e, from, CIV_ACK);
+        }
+        else
+        {
+            r[1] = sub;
+            r[2] = e->func[sub];
+            civ_reply(e, from, r, 3);
+        }
+
+        break;
+
+    case 0x19:
+        r[1] = 0x00;
+        r[2] = e->civ_addr;
+        civ_reply(e, from, r, 3);
+        break;
+
+    case 0x1c:
+        if (sub != 0x00)
+        {
+            civ_ack(e, from, CIV_NAK);
+        }
+        else if (dlen == 2)
+        {
+            e->civ_ptt = data[1];
+            civ_ack(e, from, CIV_ACK);
+        }
+        else
+        {
+            r[1] = 0x00;
+            r[2] = e->civ_ptt;
+            civ_reply(e, from, r, 3);
+        }
+
+        break;
+
+    default:
+        civ_ack(e, from, CIV_NAK);
+    }
+}
+
+
+static void civ_input(struct emu *e)
+{
+    int i, start = 0;
+
+    for (i = 0; i < e->in_len; i++)
+    {
+        if (e->in[i] != CIV_FI)
+        {
+            continue;
+        }
+
+        /* skip to the preamble, there may be several */
+        while (start < i && e->in[start] != CIV_PR)
+        {
+            start++;
+        }
+
+        while (start + 1 < i && e->in[start + 1] == CIV_PR
+                && start + 2 < i && e->in[start + 2] == CIV_PR)
+        {
+            start++;
+        }
+
+        if (i - start + 1 >= 6 && e->in[start + 1] == CIV_PR)
+        {
+            civ_frame(e, e->in + start, i - start + 1);
+        }
+
+        start = i + 1;
+    }
+
+    e->in_len -= start;
+    memmove(e->in, e->in + start, e->in_len);
+
+    if (e->in_len == sizeof(e->in))
+    {
+        e->in_len = 0;
+    }
+}
+
+
+static int emu_open_pty(struct emu *e)
+{
+#ifdef HAVE_POSIX_OPENPT
+    const char *name;
+    int slave;
+
+    e->fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (e->fd < 0 || grantpt(e->fd) || unlockpt(e->fd)
+            || !(name = ptsname(e->fd)))
+    {
+        perror("posix_openpt");
+        return -1;
+    }
+
+    /*
+     * Keep the slave open, so that reading the master does not fail
+     * while no client is connected, and make it raw until the backend
+     * sets it up itself, lest it echoes the replies back.
+     */
+    slave = open(name, O_RDWR | O_NOCTTY);
+
+    if (slave < 0)
+    {
+        perror(name);
+        return -1;
+    }
+
+#ifdef HAVE_TERMIOS_H
+    {
+        struct termios t;
+
+        if (!tcgetattr(slave, &t))
+        {
+#ifdef HAVE_CFMAKERAW
+            cfmakeraw(&t);
+#else
+            t.c_iflag = 0;
+            t.c_oflag = 0;
+            t.c_lflag = 0;
+#endif
+            tcsetattr(slave, TCSANOW, &t);
+        }
+    }
+#endif
+
+    if (link_path)
+    {
+        unlink(link_path);
+
+        if (symlink(name, link_path))
+        {
+            perror(link_path);
+            return -1;
+        }
+    }
+
+    printf("%s\n", link_path ? link_path : name);
+    fflush(stdout);
+
+    return 0;
+#else
+    fprintf(stderr, "rigemu: pseudo-terminals are not supported here\n");
+    return -1;
+#endif
+}
+
+
+int main(int argc, char *argv[])
+{
+    struct emu e;
+    const struct cat_cmd *c;
+
+    rig_set_debug(RIG_DEBUG_ERR);
+
+    memset(&e, 0, sizeof(e));
+    e.proto = EMU_KENWOOD;
+    e.echo = 1;
+    e.civ_addr = 0x58;
+    e.freq[0] = 14250000;
+    e.freq[1] = 7100000;
+    e.mode[0] = e.mode[1] = 0x01;   /* USB */
+    e.filter[0] = e.filter[1] = 1;
+    e.meter[0x02] = 120;            /* S9 */
+    e.level[0x01] = 128;
+    e.level[0x02] = 255;
+
+    while (1)
+    {
+        int ch;
+        int option_index = 0;
+
+        ch = getopt_long(argc, argv, SHORT_OPTIONS, long_options,
+                         &option_index);
+
+        if (ch == -1)
+        {
+            break;
+        }
+
+        switch (ch)
+        {
+        case 'h':
+            usage();
+            exit(0);
+
+        case 'V':
+            version();
+            exit(0);
+
+        case 'p':
+            if (!strcmp(optarg, "icom"))
+            {
+                e.proto = EMU_ICOM;
+            }
+            else if (!strcmp(optarg, "kenwood"))
+            {
+                e.proto = EMU_KENWOOD;
+            }
+            else if (!strcmp(optarg, "newcat"))
+            {
+                e.proto = EMU_NEWCAT;
+            }
+            else
+            {
+                usage();
+                exit(1);
+            }
+
+            break;
+
+        case 'a':
+            e.civ_addr = strtol(optarg, NULL, 16);
+            break;
+
+        case 'i':
+            e.id = optarg;
+            break;
+
+        case 's':
+            e.baud = atoi(optarg);
+            break;
+
+        case 'd':
+            e.delay_ms = atoi(optarg);
+            break;
+
+        case 'e':
+            e.error_rate = atoi(optarg);
+            break;
+
+        case 'S':
+            srand(atoi(optarg));
+            break;
+
+        case 'l':
+            link_path = optarg;
+            break;
+
+        case 'n':
+            e.echo = 0;
+            break;
+
+        case 'v':
+            e.verbose++;
+            break;
+
+        default:
+            usage();    /* unknown option? */
+            exit(1);
+        }
+    }
+
+    if (e.proto == EMU_KENWOOD)
+    {
+        e.cmds = kenwood_cmds;
+        e.id = e.id ? e.id : "019";     /* TS-2000 */
+    }
+    else if (e.proto == EMU_NEWCAT)
+    {
+        e.cmds = newcat_cmds;
+        e.id = e.id ? e.id : "0570";    /* FT-991 */
+    }
+
+    for (c = e.cmds; c && c->name; c++)
+    {
+        if (c->sel_len == 0)
+        {
+            cat_lookup(&e, c->name, c->init);
+        }
+    }
+
+    signal(SIGINT, emu_cleanup);
+    signal(SIGTERM, emu_cleanup);
+
+    if (emu_open_pty(&e) < 0)
+    {
+        exit(2);
+    }
+
+    while (1)
+    {
+        ssize_t n = read(e.fd, e.in + e.in_len, sizeof(e.in) - e.in_len);
+
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EIO)
+            {
+                usleep(10 * 1000);
+                continue;
+            }
+
+            perror("read");
+            emu_cleanup(0);
+        }
+
+        e.in_len += n;
+
+        if (e.proto == EMU_ICOM)
+        {
+            civ_input(&e);
+        }
+        else
+        {
+            cat_input(&e);
+        }
+    }
+
+    return 0;
+}
+
+
+void version()
+{
+    printf("rigemu, %s\n\n", hamlib_version);
+    printf("%s\n", hamlib_copyright);
+}
+
+
+void usage()
+{
+    printf("Usage: rigemu [OPTION]...\n"
+           "Emulate a radio on a pseudo-terminal, whose name is printed.\n\n");
+
+
+    printf(
+        "  -p, --protocol=NAME           icom, kenwood (default) or newcat\n"
+        "  -a, --civaddr=ID              CI-V address in hex, default 58\n"
+        "  -i, --id=ID                   ID; answer, default 019 or 0570\n"
+        "  -s, --serial-speed=BAUD       emulate the line speed\n"
+        "  -d, --delay=MS                processing delay before answering\n"
+        "  -e, --error-rate=PERCENT      answer this share of commands wrongly\n"
+        "  -S, --seed=N                  seed of the error injection\n"
+        "  -l, --link=PATH               symlink PATH to the pseudo-terminal\n"
+        "  -n, --no-echo                 no CI-V echo, as with a USB interface\n"
+        "  -v, --verbose                 dump the traffic to stderr\n"
+        "  -h, --help                    display this help and exit\n"
+        "  -V, --version                 output version information and exit\n\n"
+    );
+
+    printf("\nReport bugs to <hamlib-developer@lists.sourceforge.net>.\n");
+
+}
@@ -0,0 +1,890 @@
+/*
+ * rigload.c - (C) The Hamlib Group 2020
+ *
+ * This program loads a rigctld with concurrent clients, and reports the
+ * throughput, the latency and the memory use of the daemon over time.
+ *
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program; if not, write to the Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <getopt.h>
+
+#ifdef HAVE_PTHREAD
+#  include <pthread.h>
+#endif
+
+#ifdef HAVE_NETDB_H
+#  include <netdb.h>
+#endif
+
+#ifdef HAVE_SYS_SOCKET_H
+#  include <sys/socket.h>
+#endif
+
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
+#include <hamlib/rig.h>
+
+
+/*
+ * Prototypes
+ */
+static void usage();
+static void version();
+
+/*
+ * Reminder: when adding long options,
+ *  keep up to date SHORT_OPTIONS, usage()'s output and man page. thanks.
+ * NB: do NOT use -W since it's reserved by POSIX.
+ */
+#define SHORT_OPTIONS "r:t:c:d:R:b:x:i:p:w:hV"
+static struct option long_options[] =
+{
+    {"host",            1, 0, 'r'},
+    {"port",            1, 0, 't'},
+    {"connections",     1, 0, 'c'},
+    {"duration",        1, 0, 'd'},
+    {"rate",            1, 0, 'R'},
+    {"burst",           1, 0, 'b'},
+    {"mix",             1, 0, 'x'},
+    {"interval",        1, 0, 'i'},
+    {"pid",             1, 0, 'p'},
+    {"timeout",         1, 0, 'w'},
+    {"help",            0, 0, 'h'},
+    {"version",         0, 0, 'V'},
+    {0, 0, 0, 0}
+};
+
+/* named command mixes, see parse_mix() */
+static const struct
+{
+    const char *name;
+    const char *mix;
+} mix_presets[] =
+{
+    { "poll",   "4*f,2*m,2*l STRENGTH,t,v" },
+    { "set",    "F 14074000,F 14076000,M USB 2400,T 0" },
+    { "ext",    "+f,+m,+l STRENGTH,+t,+v" },
+    { "mixed",  "8*f,4*m,2*l STRENGTH,F 14074000,M USB 2400,+f" },
+    { NULL, NULL }
+};
+
+#define MAX_MIX     32
+#define MAX_BURST   64
+
+struct mix_entry
+{
+    char cmd[64];
+    int weight;
+    int lines;          /* answer lines of a plain get, 0 till RPRT */
+};
+
+/*
+ * Latency histogram, in us, 16 buckets per power of two, i.e. better
+ * than 7% resolution whatever the load.
+ */
+#define HIST_SUB    16
+#define HIST_SIZE   ((64 - 4) * HIST_SUB + HIST_SUB)
+
+struct stats
+{
+    uint64_t hist[HIST_SIZE];
+    uint64_t count;
+    uint64_t errors;
+    uint64_t max_us;
+};
+
+struct conn
+{
+    int id;
+    int fd;
+    char buf[4096];
+    size_t buf_len;
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+    pthread_mutex_t lock;
+#endif
+    struct stats interval;  /* under lock, taken by the reporter */
+};
+
+static const char *host = "localhost";
+static const char *port = "4532";
+static int rate;
+static int burst = 1;
+static int timeout_ms = 5000;
+static struct mix_entry mix[MAX_MIX];
+static int mix_count;
+static int mix_total;
+static volatile int stop;
+
+
+static uint64_t now_us(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+
+static int hist_index(uint64_t us)
+{
+    int msb = 0;
+
+    if (us < HIST_SUB)
+    {
+        return (int)us;
+    }
+
+    while ((us >> msb) > 1)
+    {
+        msb++;
+    }
+
+    return (msb - 3) * HIST_SUB + (int)((us >> (msb - 4)) & (HIST_SUB - 1));
+}
+
+
+static uint64_t hist_value(int idx)
+{
+    int msb;
+
+    if (idx < HIST_SUB)
+    {
+        return idx;
+    }
+
+    msb = idx / HIST_SUB + 3;
+
+    return (uint64_t)(HIST_SUB + idx % HIST_SUB) << (msb - 4);
+}
+
+
+static uint64_t stats_percentile(const struct stats *s, double pct)
+{
+    uint64_t rank = (uint64_t)(s->count * pct / 100.), seen = 0;
+    int i;
+
+    for (i = 0; i < HIST_SIZE; i++)
+    {
+        seen += s->hist[i];
+
+        if (seen > rank)
+        {
+            return hist_value(i);
+        }
+    }
+
+    return s->max_us;
+}
+
+
+static void stats_add(struct stats *dst, const struct stats *src)
+{
+    int i;
+
+    for (i = 0; i < HIST_SIZE; i++)
+    {
+        dst->hist[i] += src->hist[i];
+    }
+
+    dst->count += src->count;
+    dst->errors += src->errors;
+
+    if (src->max_us > dst->max_us)
+    {
+        dst->max_us = src->max_us;
+    }
+}
+
+
+/*
+ * Parses a list of [WEIGHT*]COMMAND separated by commas, or the name of
+ * a preset.
+ */
+static int parse_mix(const char *spec)
+{
+    char *copy, *tok, *save = NULL;
+    int i;
+
+    for (i = 0; mix_presets[i].name; i++)
+    {
+        if (!strcmp(spec, mix_presets[i].name))
+        {
+            spec = mix_presets[i].mix;
+            break;
+        }
+    }
+
+    copy = strdup(spec);
+
+    if (!copy)
+    {
+        return -1;
+    }
+
+    mix_count = mix_total = 0;
+
+    for (tok = strtok_r(copy, ",", &save); tok;
+            tok = strtok_r(NULL, ",", &save))
+    {
+        struct mix_entry *e = &mix[mix_count];
+        char *star = strchr(tok, '*');
+
+        if (mix_count == MAX_MIX)
+        {
+            break;
+        }
+
+        e->weight = 1;
+
+        if (star && isdigit((unsigned char)tok[0]))
+        {
+            e->weight = atoi(tok);
+            tok = star + 1;
+        }
+
+        while (*tok == ' ')
+        {
+            tok++;
+        }
+
+        if (!*tok || e->weight <= 0)
+        {
+            free(copy);
+            return -1;
+        }
+
+        snprintf(e->cmd, sizeof(e->cmd), "%s\n", tok);
+
+        /*
+         * Extended answers and sets end with RPRT, plain gets are one
+         * line per value.
+         */
+        if (tok[0] == '+' || isupper((unsigned char)tok[0])
+                || !strncmp(tok, "\\set_", 5))
+        {
+            e->lines = 0;
+        }
+        else if (tok[0] == 'm' || tok[0] == 's' || tok[0] == 'x')
+        {
+            e->lines = 2;
+        }
+        else
+        {
+            e->lines = 1;
+        }
+
+        mix_total += e->weight;
+        mix_count++;
+    }
+
+    free(copy);
+
+    return mix_count > 0 ? 0 : -1;
+}
+
+
+static const struct mix_entry *pick_mix(unsigned *seed)
+{
+    int r = rand_r(seed) % mix_total;
+    int i;
+
+    for (i = 0; i < mix_count - 1; i++)
+    {
+        r -= mix[i].weight;
+
+        if (r < 0)
+        {
+            break;
+        }
+    }
+
+    return &mix[i];
+}
+
+
+/* resident set of the server, in kB, or -1 */
+static long server_rss(long pid)
+{
+    char path[64], line[128];
+    long rss = -1;
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "/proc/%ld/status", pid);
+
+    fp = fopen(path, "r");
+
+    if (!fp)
+    {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (!strncmp(line, "VmRSS:", 6))
+        {
+            rss = atol(line + 6);
+            break;
+        }
+    }
+
+    fclose(fp);
+
+    return rss;
+}
+
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_SYS_SOCKET_H)
+
+static int conn_open(struct conn *c)
+{
+    struct addrinfo hints, *res, *ai;
+    struct timeval tv;
+    int fd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host, port, &hints, &res) != 0)
+    {
+        return -1;
+    }
+
+    for (ai = res; ai; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+        {
+            break;
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(res);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    pthread_mutex_lock(&c->lock);
+    c->fd = fd;
+    c->buf_len = 0;
+    pthread_mutex_unlock(&c->lock);
+
+    return 0;
+}
+
+
+static void conn_close(struct conn *c)
+{
+    pthread_mutex_lock(&c->lock);
+
+    if (c->fd >= 0)
+    {
+        close(c->fd);
+        c->fd = -1;
+    }
+
+    pthread_mutex_unlock(&c->lock);
+}
+
+
+/* reads one line, without the newline */
+static int conn_read_line(struct conn *c, char *line, size_t size)
+{
+    while (1)
+    {
+        char *nl = memchr(c->buf, '\n', c->buf_len);
+        ssize_t n;
+
+        if (nl)
+        {
+            size_t len = nl - c->buf;
+
+            if (len >= size)
+            {
+                len = size - 1;
+            }
+
+            memcpy(line, c->buf, len);
+            line[len] = '\0';
+
+            c->buf_len -= nl + 1 - c->buf;
+            memmove(c->buf, nl + 1, c->buf_len);
+
+            return 0;
+        }
+
+        if (c->buf_len == sizeof(c->buf))
+        {
+            c->buf_len = 0;     /* runaway line, drop it */
+        }
+
+        n = read(c->fd, c->buf + c->buf_len, sizeof(c->buf) - c->buf_len);
+
+        if (n <= 0)
+        {
+            return -1;
+        }
+
+        c->buf_len += n;
+    }
+}
+
+
+/* reads the answer of a command, returns < 0 on error */
+static int conn_read_answer(struct conn *c, const struct mix_entry *e)
+{
+    char line[256];
+    int lines = 0;
+
+    while (1)
+    {
+        if (conn_read_line(c, line, sizeof(line)) < 0)
+        {
+            return -RIG_EIO;
+        }
+
+        if (!strncmp(line, "RPRT ", 5))
+        {
+            return atoi(line + 5);
+        }
+
+        if (e->lines && ++lines == e->lines)
+        {
+            return RIG_OK;
+        }
+    }
+}
+
+
+static void conn_record(struct conn *c, uint64_t us, int err)
+{
+    pthread_mutex_lock(&c->lock);
+
+    if (err)
+    {
+        c->interval.errors++;
+    }
+    else
+    {
+        c->interval.hist[hist_index(us)]++;
+        c->interval.count++;
+
+        if (us > c->interval.max_us)
+        {
+            c->interval.max_us = us;
+        }
+    }
+
+    pthread_mutex_unlock(&c->lock);
+}
+
+
+static void *conn_thread(void *arg)
+{
+    struct conn *c = arg;
+    const struct mix_entry *sent[MAX_BURST];
+    unsigned seed = c->id + 1;
+    uint64_t next = now_us();
+
+    while (!stop)
+    {
+        char out[MAX_BURST * 64];
+        size_t out_len = 0;
+        uint64_t t0;
+        int i;
+
+        if (c->fd < 0 && conn_open(c) < 0)
+        {
+            conn_record(c, 0, 1);
+            usleep(100000);
+            continue;
+        }
+
+        if (rate > 0)
+        {
+            uint64_t now = now_us();
+
+            if (now < next)
+            {
+                usleep(next - now);
+            }
+
+            next += (uint64_t)burst * 1000000 / rate;
+
+            /* do not catch up after a stall */
+            if (next < now_us())
+            {
+                next = now_us();
+            }
+        }
+
+        /* a burst is written at once, then all the answers are read */
+        for (i = 0; i < burst; i++)
+        {
+            size_t len;
+
+            sent[i] = pick_mix(&seed);
+            len = strlen(sent[i]->cmd);
+            memcpy(out + out_len, sent[i]->cmd, len);
+            out_len += len;
+        }
+
+        t0 = now_us();
+
+        if (write(c->fd, out, out_len) != (ssize_t)out_len)
+        {
+            conn_record(c, 0, 1);
+            conn_close(c);
+            continue;
+        }
+
+        for (i = 0; i < burst; i++)
+        {
+            int ret = conn_read_answer(c, sent[i]);
+
+            conn_record(c, now_us() - t0, ret != RIG_OK);
+
+            if (ret == -RIG_EIO)
+            {
+                conn_close(c);
+                break;
+            }
+        }
+    }
+
+    conn_close(c);
+
+    return NULL;
+}
+
+#endif  /* HAVE_PTHREAD && HAVE_SYS_SOCKET_H */
+
+
+static void print_stats(FILE *fp, const char *label, const struct stats *s,
+                        double secs, long rss)
+{
+    fprintf(fp, "%-8s %9.0f %8llu %8llu %8llu %8llu %7llu",
+            label,
+            secs > 0 ? s->count / secs : 0.,
+            (unsigned long long) stats_percentile(s, 50),
+            (unsigned long long) stats_percentile(s, 90),
+            (unsigned long long) stats_percentile(s, 99),
+            (unsigned long long) s->max_us,
+            (unsigned long long) s->errors);
+
+    if (rss >= 0)
+    {
+        fprintf(fp, " %8ld", rss);
+    }
+    else
+    {
+        fprintf(fp, " %8s", "-");
+    }
+
+    fprintf(fp, "\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *mix_spec = "poll";
+    int nconn = 4;
+    int duration = 10;
+    int interval = 1;
+    long pid = 0;
+
+    while (1)
+    {
+        int c;
+        int option_index = 0;
+
+        c = getopt_long(argc, argv, SHORT_OPTIONS, long_options, &option_index);
+
+        if (c == -1)
+        {
+            break;
+        }
+
+        switch (c)
+        {
+        case 'h':
+            usage();
+            exit(0);
+
+        case 'V':
+            version();
+            exit(0);
+
+        case 'r':
+            host = optarg;
+            break;
+
+        case 't':
+            port = optarg;
+            break;
+
+        case 'c':
+            nconn = atoi(optarg);
+            break;
+
+        case 'd':
+            duration = atoi(optarg);
+            break;
+
+        case 'R':
+            rate = atoi(optarg);
+            break;
+
+        case 'b':
+            burst = atoi(optarg);
+            break;
+
+        case 'x':
+            mix_spec = optarg;
+            break;
+
+        case 'i':
+            interval = atoi(optarg);
+            break;
+
+        case 'p':
+            pid = atol(optarg);
+            break;
+
+        case 'w':
+            timeout_ms = atoi(optarg);
+            break;
+
+        default:
+            usage();    /* unknown option? */
+            exit(1);
+        }
+    }
+
+    if (nconn <= 0 || duration <= 0 || interval <= 0 || rate < 0
+            || burst <= 0 || burst > MAX_BURST || timeout_ms <= 0)
+    {
+        usage();
+        exit(1);
+    }
+
+    if (parse_mix(mix_spec) < 0)
+    {
+        fprintf(stderr, "invalid command mix '%s'\n", mix_spec);
+        exit(1);
+    }
+
+#if defined(HAVE_PTHREAD) && defined(HAVE_SYS_SOCKET_H)
+    {
+        struct conn *conns;
+        struct stats total, step;
+        uint64_t start, next;
+        int i, elapsed;
+
+        conns = calloc(nconn, sizeof(*conns));
+
+        if (!conns)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+
+        printf("# %d connections to %s:%s, ", nconn, host, port);
+
+        if (rate)
+        {
+            printf("%d/s per connection", rate);
+        }
+        else
+        {
+            printf("unpaced");
+        }
+
+        printf(", burst %d, mix %s\n", burst, mix_spec);
+        printf("#%-7s %9s %8s %8s %8s %8s %7s %8s\n", "time_s", "tps",
+               "p50_us", "p90_us", "p99_us", "max_us", "errors", "rss_kB");
+
+        start = now_us();
+
+        for (i = 0; i < nconn; i++)
+        {
+            conns[i].id = i;
+            conns[i].fd = -1;
+            pthread_mutex_init(&conns[i].lock, NULL);
+
+            if (pthread_create(&conns[i].thread, NULL, conn_thread,
+                               &conns[i]))
+            {
+                fprintf(stderr, "cannot start connection %d\n", i);
+                nconn = i;
+                break;
+            }
+        }
+
+        memset(&total, 0, sizeof(total));
+        next = start;
+
+        for (elapsed = interval; elapsed <= duration; elapsed += interval)
+        {
+            uint64_t now;
+            char label[16];
+
+            next += (uint64_t)interval * 1000000;
+            now = now_us();
+
+            if (now < next)
+            {
+                usleep(next - now);
+            }
+
+            memset(&step, 0, sizeof(step));
+
+            for (i = 0; i < nconn; i++)
+            {
+                pthread_mutex_lock(&conns[i].lock);
+                stats_add(&step, &conns[i].interval);
+                memset(&conns[i].interval, 0, sizeof(struct stats));
+                pthread_mutex_unlock(&conns[i].lock);
+            }
+
+            stats_add(&total, &step);
+
+            snprintf(label, sizeof(label), "%d", elapsed);
+            print_stats(stdout, label, &step, interval,
+                        pid ? server_rss(pid) : -1);
+            fflush(stdout);
+        }
+
+        stop = 1;
+
+        /* wake up the connections waiting for an answer */
+        for (i = 0; i < nconn; i++)
+        {
+            pthread_mutex_lock(&conns[i].lock);
+
+            if (conns[i].fd >= 0)
+            {
+                shutdown(conns[i].fd, SHUT_RDWR);
+            }
+
+            pthread_mutex_unlock(&conns[i].lock);
+        }
+
+        for (i = 0; i < nconn; i++)
+        {
+            pthread_join(conns[i].thread, NULL);
+            pthread_mutex_destroy(&conns[i].lock);
+        }
+
+        print_stats(stdout, "total", &total, (next - start) / 1e6,
+                    pid ? server_rss(pid) : -1);
+
+        free(conns);
+
+        return total.errors ? 3 : 0;
+    }
+#else
+    fprintf(stderr, "rigload needs threads and sockets\n");
+
+    return 2;
+#endif
+}
+
+
+void version()
+{
+    printf("rigload, %s\n\n", hamlib_version);
+    printf("%s\n", hamlib_copyright);
+}
+
+
+void usage()
+{
+    int i;
+
+    printf("Usage: rigload [OPTION]...\n"
+           "Load a rigctld with concurrent clients and report the throughput,\n"
+           "the latency and the memory use of the daemon over time.\n\n");
+
+
+    printf(
+        "  -r, --host=ADDR               address of rigctld, default localhost\n"
+        "  -t, --port=NUM                TCP port of rigctld, default 4532\n"
+        "  -c, --connections=N           concurrent connections, default 4\n"
+        "  -d, --duration=SECONDS        duration of the run, default 10\n"
+        "  -R, --rate=N                  commands per second per connection,\n"
+        "                                default 0, as fast as possible\n"
+        "  -b, --burst=N                 commands written at once, default 1\n"
+        "  -x, --mix=MIX                 command mix, a preset or a comma separated\n"
+        "                                list of [WEIGHT*]COMMAND, default poll\n"
+        "  -i, --interval=SECONDS        reporting interval, default 1\n"
+        "  -p, --pid=PID                 report the resident memory of this process\n"
+        "  -w, --timeout=MS              answer timeout, default 5000\n"
+        "  -h, --help                    display this help and exit\n"
+        "  -V, --version                 output version information and exit\n\n"
+    );
+
+    printf("Mix presets:\n");
+
+    for (i = 0; mix_presets[i].name; i++)
+    {
+        printf("  %-8s %s\n", mix_presets[i].name, mix_presets[i].mix);
+    }
+
+    printf("\nReport bugs to <hamlib-developer@lists.sourceforge.net>.\n");
+
+}
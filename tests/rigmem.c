@@ -54,6 +54,9 @@ extern int xml_parm_load(RIG *rig, const char *infilename);
 
 extern int csv_save(RIG *rig, const char *outfilename);
 extern int csv_load(RIG *rig, const char *infilename);
+extern int csv_sync(RIG *rig, const char *infilename, const char *imagename);
+extern int csv_to_image(RIG *rig, const char *infilename, const char *imagename);
+extern int image_to_csv(RIG *rig, const char *imagename, const char *outfilename);
 extern int csv_parm_save(RIG *rig, const char *outfilename);
 extern int csv_parm_load(RIG *rig, const char *infilename);
 
@@ -71,7 +74,7 @@ int clear_chans(RIG *rig, const char *infilename);
  *      keep up to date SHORT_OPTIONS, usage()'s output and man page. thanks.
  * NB: do NOT use -W since it's reserved by POSIX.
  */
-#define SHORT_OPTIONS "m:r:s:c:C:p:axvhV"
+#define SHORT_OPTIONS "m:r:s:c:C:p:i:axvhV"
 static struct option long_options[] =
 {
     {"model",           1, 0, 'm'},
@@ -80,6 +83,7 @@ static struct option long_options[] =
     {"civaddr",         1, 0, 'c'},
     {"set-conf",        1, 0, 'C'},
     {"set-separator",   1, 0, 'p'},
+    {"image",           1, 0, 'i'},
     {"all",             0, 0, 'a'},
 #ifdef HAVE_XML2
     {"xml",             0, 0, 'x'},
@@ -106,6 +110,8 @@ int main(int argc, char *argv[])
     int serial_rate = 0;
     char *civaddr = NULL;   /* NULL means no need to set conf */
     char conf_parms[MAXCONFLEN] = "";
+    const char *image_file = NULL;
+    char image_buf[1024];
     extern char csv_sep;
 
     while (1)
@@ -195,6 +201,16 @@ int main(int argc, char *argv[])
             csv_sep = optarg[0];
             break;
 
+        case 'i':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            image_file = optarg;
+            break;
+
         case 'a':
             all++;
             break;
@@ -353,6 +369,36 @@ int main(int argc, char *argv[])
             retcode = csv_parm_load(rig, argv[optind + 1]);
         }
     }
+    else if (!strcmp(argv[optind], "sync"))
+    {
+        if (!image_file)
+        {
+            snprintf(image_buf, sizeof(image_buf), "%s.sync",
+                     argv[optind + 1]);
+            image_file = image_buf;
+        }
+
+        retcode = csv_sync(rig, argv[optind + 1], image_file);
+    }
+    else if (!strcmp(argv[optind], "csv2img")
+             || !strcmp(argv[optind], "img2csv"))
+    {
+        if (!image_file)
+        {
+            snprintf(image_buf, sizeof(image_buf), "%s.img",
+                     argv[optind + 1]);
+            image_file = image_buf;
+        }
+
+        if (argv[optind][0] == 'c')
+        {
+            retcode = csv_to_image(rig, argv[optind + 1], image_file);
+        }
+        else
+        {
+            retcode = image_to_csv(rig, image_file, argv[optind + 1]);
+        }
+    }
     else if (!strcmp(argv[optind], "clear"))
     {
         retcode = clear_chans(rig, argv[optind + 1]);
@@ -396,6 +442,8 @@ void usage()
         "  -c, --civaddr=ID              set CI-V address, decimal (for Icom rigs only)\n"
         "  -C, --set-conf=PARM=VAL       set config parameters\n"
         "  -p, --set-separator=SEP       set character separator instead of the CSV comma\n"
+        "  -i, --image=FILE              set the image file of sync, FILE.sync by default,\n"
+        "                                or of csv2img and img2csv, FILE.img by default\n"
         "  -a, --all                     bypass mem_caps, apply to all fields of channel_t\n"
 #ifdef HAVE_XML2
         "  -x, --xml                     use XML format instead of CSV\n"
@@ -411,6 +459,9 @@ void usage()
         "  save\n"
         "  load_parm\n"
         "  save_parm\n"
+        "  sync\n"
+        "  csv2img\n"
+        "  img2csv\n"
         "  clear\n\n"
     );
 
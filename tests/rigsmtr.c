@@ -33,12 +33,48 @@
 #include <math.h>
 
 #include <getopt.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#ifdef HAVE_PTHREAD
+#  include <pthread.h>
+#endif
 
 #include <hamlib/rig.h>
 #include <hamlib/rotator.h>
 #include "misc.h"
 
 
+/* the samplers never poll faster than this */
+#define SAMPLE_MIN_US   1000
+
+struct sample
+{
+    uint64_t t_us;  /* monotonic, middle of the request */
+    double val;
+};
+
+struct series
+{
+    struct sample *samples;
+    size_t count;
+    size_t alloc;
+};
+
+struct sampler
+{
+    RIG *rig;
+    ROT *rot;
+    struct series azimuth;
+    struct series strength;
+    int done;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t lock;   /* guards done between the samplers */
+#endif
+};
+
+
 /*
  * Prototypes
  */
@@ -46,13 +82,26 @@ static void usage();
 static void version();
 static int set_conf_rig(RIG *rig, char *conf_parms);
 static int set_conf_rot(ROT *rot, char *conf_parms);
+static int print_point(RIG *rig, const struct rig_sweep_point *point,
+                       rig_ptr_t arg);
+static uint64_t now_us(void);
+static int series_add(struct series *series, uint64_t t_us, double val);
+#ifdef HAVE_PTHREAD
+static void *rot_sampler(void *arg);
+static void *rig_sampler(void *arg);
+static int sampler_done(struct sampler *smp);
+static void sampler_stop(struct sampler *smp);
+#endif
+static void sample_pace(uint64_t t0);
+static void print_pattern(const struct series *azimuth,
+                          const struct series *strength);
 
 /*
  * Reminder: when adding long options,
  *   keep up to date SHORT_OPTIONS, usage()'s output and man page. thanks.
  * NB: do NOT use -W since it's reserved by POSIX.
  */
-#define SHORT_OPTIONS "m:r:s:c:C:M:R:S:N:vhV"
+#define SHORT_OPTIONS "m:r:s:c:C:M:R:S:N:F:bvhV"
 static struct option long_options[] =
 {
     {"model",               1, 0, 'm'},
@@ -64,6 +113,8 @@ static struct option long_options[] =
     {"rot-file",            1, 0, 'R'},
     {"rot-serial-speed",    1, 0, 'S'},
     {"rot-set-conf",        1, 0, 'N'},
+    {"freq-sweep",          1, 0, 'F'},
+    {"binary",              0, 0, 'b'},
     {"verbose",             0, 0, 'v'},
     {"help",                0, 0, 'h'},
     {"version",             0, 0, 'V'},
@@ -94,6 +145,14 @@ int main(int argc, char *argv[])
     azimuth_t azimuth;
     elevation_t elevation;
     unsigned step = 1000000;    /* 1e6 us */
+    struct sampler smp;
+    struct rig_sweep_params sweep;
+    int binary = 0;
+
+    memset(&sweep, 0, sizeof(sweep));
+    sweep.step = kHz(10);
+    sweep.level = RIG_LEVEL_STRENGTH;
+    sweep.settle_ms = -1;   /* measured */
 
     while (1)
     {
@@ -217,6 +276,26 @@ int main(int argc, char *argv[])
             strncat(rot_conf_parms, optarg, MAXCONFLEN - strlen(rot_conf_parms));
             break;
 
+        case 'F':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            if (sscanf(optarg, "%lf,%lf,%lf", &sweep.start, &sweep.stop,
+                       &sweep.step) < 2)
+            {
+                usage();
+                exit(1);
+            }
+
+            break;
+
+        case 'b':
+            binary = 1;
+            break;
+
         case 'v':
             verbose++;
             break;
@@ -297,6 +376,23 @@ int main(int argc, char *argv[])
                rig->caps->model_name);
     }
 
+    /*
+     * Panoramic S-Meter, the rotator stays put
+     */
+    if (sweep.stop > 0)
+    {
+        retcode = rig_sweep(rig, RIG_VFO_CURR, &sweep, print_point, &binary);
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "rig_sweep: error = %s \n", rigerror(retcode));
+        }
+
+        rig_close(rig);
+
+        return retcode == RIG_OK ? 0 : 2;
+    }
+
     /*
      * The rotator
      */
@@ -365,8 +461,19 @@ int main(int argc, char *argv[])
 
     while (fabs(azimuth - rot->state.min_az) > 1.)
     {
+        double eta;
+
+        /* sleep till it should be there, rather than poll it */
+        if (rot_get_eta(rot, &eta) == RIG_OK && eta * 1e6 > step)
+        {
+            usleep(eta * 1e6);
+        }
+        else
+        {
+            usleep(step);
+        }
+
         rot_get_position(rot, &azimuth, &elevation);
-        usleep(step);
     }
 
     fprintf(stderr, "Now initiating full 360° rotation...\n");
@@ -375,17 +482,72 @@ int main(int argc, char *argv[])
     /* TODO: check CW or CCW */
     /* disable AGC? */
 
-    while (fabs(rot->state.max_az - azimuth) > 1.)
+    memset(&smp, 0, sizeof(smp));
+    smp.rig = rig;
+    smp.rot = rot;
+
+#ifdef HAVE_PTHREAD
+    {
+        pthread_t rot_thread, rig_thread;
+
+        pthread_mutex_init(&smp.lock, NULL);
+
+        /*
+         * Each device is polled as fast as it answers, in its own thread,
+         * the samples are joined on their time stamps afterwards.
+         */
+        if (pthread_create(&rot_thread, NULL, rot_sampler, &smp) != 0)
+        {
+            fprintf(stderr, "pthread_create: %s\n", strerror(errno));
+            exit(2);
+        }
+
+        if (pthread_create(&rig_thread, NULL, rig_sampler, &smp) != 0)
+        {
+            fprintf(stderr, "pthread_create: %s\n", strerror(errno));
+            sampler_stop(&smp);
+            pthread_join(rot_thread, NULL);
+            exit(2);
+        }
+
+        pthread_join(rot_thread, NULL);
+        pthread_join(rig_thread, NULL);
+        pthread_mutex_destroy(&smp.lock);
+    }
+#else
+
+    while (!smp.done)
     {
         value_t strength;
+        uint64_t t0 = now_us();
 
-        rig_get_level(rig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH, &strength);
+        if (rig_get_level(rig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH, &strength)
+                == RIG_OK)
+        {
+            series_add(&smp.strength, (t0 + now_us()) / 2, strength.i);
+        }
 
-        rot_get_position(rot, &azimuth, &elevation);
+        t0 = now_us();
 
-        printf("%.1f %d\n", azimuth, strength.i);
+        if (rot_get_position(rot, &azimuth, &elevation) == RIG_OK)
+        {
+            series_add(&smp.azimuth, (t0 + now_us()) / 2, azimuth);
+            smp.done = fabs(rot->state.max_az - azimuth) <= 1.;
+        }
+
+        sample_pace(t0);
     }
 
+#endif
+
+    fprintf(stderr, "%u azimuth and %u S-Meter samples\n",
+            (unsigned) smp.azimuth.count, (unsigned) smp.strength.count);
+
+    print_pattern(&smp.azimuth, &smp.strength);
+
+    free(smp.azimuth.samples);
+    free(smp.strength.samples);
+
     rig_close(rig);
     rot_close(rot);
 
@@ -394,6 +556,202 @@ int main(int argc, char *argv[])
 
 
 
+uint64_t now_us(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+
+int series_add(struct series *series, uint64_t t_us, double val)
+{
+    if (series->count == series->alloc)
+    {
+        size_t alloc = series->alloc ? series->alloc * 2 : 1024;
+        struct sample *samples;
+
+        samples = realloc(series->samples, alloc * sizeof(struct sample));
+
+        if (!samples)
+        {
+            return -RIG_ENOMEM;
+        }
+
+        series->samples = samples;
+        series->alloc = alloc;
+    }
+
+    series->samples[series->count].t_us = t_us;
+    series->samples[series->count].val = val;
+    series->count++;
+
+    return RIG_OK;
+}
+
+
+/* waits what is left of SAMPLE_MIN_US since t0 */
+void sample_pace(uint64_t t0)
+{
+    uint64_t elapsed = now_us() - t0;
+
+    if (elapsed < SAMPLE_MIN_US)
+    {
+        usleep(SAMPLE_MIN_US - elapsed);
+    }
+}
+
+
+#ifdef HAVE_PTHREAD
+int sampler_done(struct sampler *smp)
+{
+    int done;
+
+    pthread_mutex_lock(&smp->lock);
+    done = smp->done;
+    pthread_mutex_unlock(&smp->lock);
+
+    return done;
+}
+
+
+/* tells both samplers to return after their current sample */
+void sampler_stop(struct sampler *smp)
+{
+    pthread_mutex_lock(&smp->lock);
+    smp->done = 1;
+    pthread_mutex_unlock(&smp->lock);
+}
+
+
+/* polls the rotator until it reaches max_az, then stops both samplers */
+void *rot_sampler(void *arg)
+{
+    struct sampler *smp = arg;
+    azimuth_t azimuth;
+    elevation_t elevation;
+
+    while (!sampler_done(smp))
+    {
+        uint64_t t0 = now_us();
+
+        if (rot_get_position(smp->rot, &azimuth, &elevation) == RIG_OK)
+        {
+            if (series_add(&smp->azimuth, (t0 + now_us()) / 2, azimuth)
+                    != RIG_OK
+                    || fabs(smp->rot->state.max_az - azimuth) <= 1.)
+            {
+                sampler_stop(smp);
+            }
+        }
+
+        sample_pace(t0);
+    }
+
+    return NULL;
+}
+
+
+void *rig_sampler(void *arg)
+{
+    struct sampler *smp = arg;
+    value_t strength;
+
+    while (!sampler_done(smp))
+    {
+        uint64_t t0 = now_us();
+
+        if (rig_get_level(smp->rig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH,
+                          &strength) == RIG_OK)
+        {
+            if (series_add(&smp->strength, (t0 + now_us()) / 2, strength.i)
+                    != RIG_OK)
+            {
+                sampler_stop(smp);
+            }
+        }
+
+        sample_pace(t0);
+    }
+
+    return NULL;
+}
+#endif
+
+
+/*
+ * Gives each S-Meter sample the azimuth interpolated between the
+ * rotator samples around it.  S-Meter samples out of the rotator
+ * samples time span are dropped.
+ */
+void print_pattern(const struct series *azimuth,
+                   const struct series *strength)
+{
+    size_t i, j = 0;
+
+    if (azimuth->count < 2)
+    {
+        return;
+    }
+
+    for (i = 0; i < strength->count; i++)
+    {
+        const struct sample *s = &strength->samples[i];
+        const struct sample *a0, *a1;
+        double az;
+
+        while (j + 2 < azimuth->count
+                && azimuth->samples[j + 1].t_us < s->t_us)
+        {
+            j++;
+        }
+
+        a0 = &azimuth->samples[j];
+        a1 = &azimuth->samples[j + 1];
+
+        if (s->t_us < a0->t_us || s->t_us > a1->t_us)
+        {
+            continue;
+        }
+
+        az = a0->val;
+
+        if (a1->t_us > a0->t_us)
+        {
+            az += (a1->val - a0->val) * (double)(s->t_us - a0->t_us)
+                  / (double)(a1->t_us - a0->t_us);
+        }
+
+        printf("%.1f %d\n", az, (int) s->val);
+    }
+}
+
+
+int print_point(RIG *rig, const struct rig_sweep_point *point, rig_ptr_t arg)
+{
+    if (*(int *)arg)
+    {
+        fwrite(point, sizeof(*point), 1, stdout);
+    }
+    else
+    {
+        printf("%.0f %d\n", point->freq, point->val.i);
+    }
+
+    return 0;
+}
+
+
 void version()
 {
     printf("rigsmtr, %s\n\n", hamlib_version);
@@ -404,7 +762,7 @@ void version()
 void usage()
 {
     printf("Usage: rigsmtr [OPTION]... [time]\n"
-           "Input S-Meter vs Azimuth.\n\n");
+           "Input S-Meter vs Azimuth, or vs Frequency.\n\n");
 
     printf(
         "  -m, --model=ID                select radio model number. See model list\n"
@@ -416,6 +774,9 @@ void usage()
         "  -R, --rot-file=DEVICE         set device of the rotator to operate on\n"
         "  -S, --rot-serial-speed=BAUD   set serial speed of the serial port\n"
         "  -N, --rot-set-conf=PARM=VAL   set rotator config parameters\n"
+        "  -F, --freq-sweep=START,STOP[,STEP]\n"
+        "                                sweep the radio instead of turning the rotator\n"
+        "  -b, --binary                  output struct rig_sweep_point records\n"
         "  -v, --verbose                 set verbose mode, cumulative\n"
         "  -h, --help                    display this help and exit\n"
         "  -V, --version                 output version information and exit\n\n"
@@ -43,13 +43,15 @@
 static void usage();
 static void version();
 static int set_conf(RIG *rig, char *conf_parms);
+static int print_point(RIG *rig, const struct rig_sweep_point *point,
+                       rig_ptr_t arg);
 
 /*
  * Reminder: when adding long options,
  *  keep up to date SHORT_OPTIONS, usage()'s output and man page. thanks.
  * NB: do NOT use -W since it's reserved by POSIX.
  */
-#define SHORT_OPTIONS "m:r:s:c:C:p:P:vhV"
+#define SHORT_OPTIONS "m:r:s:c:C:p:P:t:bvhV"
 static struct option long_options[] =
 {
     {"model",           1, 0, 'm'},
@@ -59,6 +61,8 @@ static struct option long_options[] =
     {"set-conf",        1, 0, 'C'},
     {"ptt-file",        1, 0, 'p'},
     {"ptt-type",        1, 0, 'P'},
+    {"settle-time",     1, 0, 't'},
+    {"binary",          0, 0, 'b'},
     {"verbose",         0, 0, 'v'},
     {"help",            0, 0, 'h'},
     {"version",         0, 0, 'V'},
@@ -81,10 +85,16 @@ int main(int argc, char *argv[])
     int serial_rate = 0;
     char *civaddr = NULL;   /* NULL means no need to set conf */
     char conf_parms[MAXCONFLEN] = "";
-    freq_t freq, freqstop;
-    freq_t step = kHz(100);
+    struct rig_sweep_params sweep;
+    int binary = 0;
     value_t pwr;
 
+    memset(&sweep, 0, sizeof(sweep));
+    sweep.step = kHz(100);
+    sweep.level = RIG_LEVEL_SWR;
+    sweep.settle_ms = -1;   /* measured */
+    sweep.ptt = 1;
+
     while (1)
     {
         int c;
@@ -206,6 +216,20 @@ int main(int argc, char *argv[])
 
             break;
 
+        case 't':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            sweep.settle_ms = atoi(optarg);
+            break;
+
+        case 'b':
+            binary = 1;
+            break;
+
         case 'v':
             verbose++;
             break;
@@ -302,32 +326,25 @@ int main(int argc, char *argv[])
                rig->caps->model_name);
     }
 
-    freq = atof(argv[optind++]);
-    freqstop = atof(argv[optind++]);
+    sweep.start = atof(argv[optind++]);
+    sweep.stop = atof(argv[optind++]);
 
     if (optind < argc)
     {
-        step = atof(argv[optind]);
+        sweep.step = atof(argv[optind]);
     }
 
-    rig_set_freq(rig, RIG_VFO_CURR, freq);
+    rig_set_freq(rig, RIG_VFO_CURR, sweep.start);
     rig_set_mode(rig, RIG_VFO_CURR, RIG_MODE_CW, RIG_PASSBAND_NORMAL);
 
     pwr.f = 0.25;   /* 25% of RF POWER */
     rig_set_level(rig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, pwr);
 
-    while (freq <= freqstop)
-    {
-        value_t swr;
-
-        rig_set_ptt(rig, RIG_VFO_CURR, RIG_PTT_ON);
-        usleep(500000);
-        rig_get_level(rig, RIG_VFO_CURR, RIG_LEVEL_SWR, &swr);
-        rig_set_ptt(rig, RIG_VFO_CURR, RIG_PTT_OFF);
+    retcode = rig_sweep(rig, RIG_VFO_CURR, &sweep, print_point, &binary);
 
-        printf("%10.0f %4.2f\n", freq, swr.f);
-        freq += step;
-        rig_set_freq(rig, RIG_VFO_CURR, freq);
+    if (retcode != RIG_OK)
+    {
+        fprintf(stderr, "rig_sweep: error = %s \n", rigerror(retcode));
     }
 
     rig_close(rig);
@@ -336,6 +353,21 @@ int main(int argc, char *argv[])
 }
 
 
+int print_point(RIG *rig, const struct rig_sweep_point *point, rig_ptr_t arg)
+{
+    if (*(int *)arg)
+    {
+        fwrite(point, sizeof(*point), 1, stdout);
+    }
+    else
+    {
+        printf("%10.0f %4.2f\n", point->freq, point->val.f);
+    }
+
+    return 0;
+}
+
+
 void version()
 {
     printf("rigswr, %s\n\n", hamlib_version);
@@ -357,6 +389,8 @@ void usage()
         "  -C, --set-conf=PARM=VAL       set config parameters\n"
         "  -p, --ptt-file=DEVICE         set device of the PTT device to operate on\n"
         "  -P, --ptt-type=TYPE           set type of the PTT device to operate on\n"
+        "  -t, --settle-time=MS          set the wait before reading SWR, measured by default\n"
+        "  -b, --binary                  output struct rig_sweep_point records\n"
         "  -v, --verbose                 set verbose mode, cumulative\n"
         "  -h, --help                    display this help and exit\n"
         "  -V, --version                 output version information and exit\n\n"
@@ -0,0 +1,333 @@
+/*
+ * rigtrace.c - (C) The Hamlib Group 2020
+ *
+ * This program decodes the binary I/O trace files written by
+ * rig_trace_open(), e.g. with rigctl --trace-file.
+ *
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program; if not, write to the Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+
+#include <hamlib/rig.h>
+#include "trace.h"
+
+
+/*
+ * Prototypes
+ */
+static void usage();
+static void version();
+
+/*
+ * Reminder: when adding long options,
+ *  keep up to date SHORT_OPTIONS, usage()'s output and man page. thanks.
+ * NB: do NOT use -W since it's reserved by POSIX.
+ */
+#define SHORT_OPTIONS "p:nhV"
+static struct option long_options[] =
+{
+    {"port",            1, 0, 'p'},
+    {"no-dump",         0, 0, 'n'},
+    {"help",            0, 0, 'h'},
+    {"version",         0, 0, 'V'},
+    {0, 0, 0, 0}
+};
+
+#define DUMP_HEX_WIDTH 16
+
+struct trace_entry {
+    struct rig_trace_rec rec;
+    unsigned char *data;
+    size_t seq;             /* file order, keeps the sort stable */
+};
+
+static const char *dir_str[] =
+{
+    "TX", "RX", "TIMEOUT", "ERROR", "DROPPED"
+};
+
+static const char *func_str[] =
+{
+    "-", "write_block", "read_block", "read_string", "read_avail"
+};
+
+
+static int entry_cmp(const void *a, const void *b)
+{
+    const struct trace_entry *ea = a, *eb = b;
+
+    if (ea->rec.ts_ns != eb->rec.ts_ns)
+    {
+        return ea->rec.ts_ns < eb->rec.ts_ns ? -1 : 1;
+    }
+
+    return ea->seq < eb->seq ? -1 : (ea->seq > eb->seq);
+}
+
+
+static void dump_data(const unsigned char *ptr, size_t size)
+{
+    size_t i, j;
+
+    for (i = 0; i < size; i += DUMP_HEX_WIDTH)
+    {
+        printf("    %04x  ", (unsigned)i);
+
+        for (j = 0; j < DUMP_HEX_WIDTH; j++)
+        {
+            if (i + j < size)
+            {
+                printf("%02x ", ptr[i + j]);
+            }
+            else
+            {
+                printf("   ");
+            }
+        }
+
+        printf("   ");
+
+        for (j = 0; j < DUMP_HEX_WIDTH && i + j < size; j++)
+        {
+            putchar(ptr[i + j] >= ' ' && ptr[i + j] < 0x7f ? ptr[i + j] : '.');
+        }
+
+        putchar('\n');
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    struct rig_trace_file_hdr hdr;
+    struct trace_entry *entries = NULL;
+    size_t n = 0, alloc = 0, i;
+    int port = -1;
+    int no_dump = 0;
+    uint64_t t0;
+    FILE *fp;
+
+    while (1)
+    {
+        int c;
+        int option_index = 0;
+
+        c = getopt_long(argc, argv, SHORT_OPTIONS, long_options, &option_index);
+
+        if (c == -1)
+        {
+            break;
+        }
+
+        switch (c)
+        {
+        case 'h':
+            usage();
+            exit(0);
+
+        case 'V':
+            version();
+            exit(0);
+
+        case 'p':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            port = atoi(optarg);
+            break;
+
+        case 'n':
+            no_dump++;
+            break;
+
+        default:
+            usage();    /* unknown option? */
+            exit(1);
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage();
+        exit(1);
+    }
+
+    fp = fopen(argv[optind], "rb");
+
+    if (!fp)
+    {
+        perror(argv[optind]);
+        exit(2);
+    }
+
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+            || strncmp(hdr.magic, RIG_TRACE_MAGIC, sizeof(hdr.magic)))
+    {
+        fprintf(stderr, "%s: not a Hamlib trace file\n", argv[optind]);
+        exit(2);
+    }
+
+    if (hdr.byte_order != RIG_TRACE_BYTE_ORDER)
+    {
+        fprintf(stderr, "%s: written by a host of different byte order\n",
+                argv[optind]);
+        exit(2);
+    }
+
+    if (hdr.version != RIG_TRACE_VERSION)
+    {
+        fprintf(stderr, "%s: unsupported trace version %u\n",
+                argv[optind], hdr.version);
+        exit(2);
+    }
+
+    /* records of different threads are interleaved by chunks, sort them */
+    while (1)
+    {
+        struct trace_entry *e;
+        size_t padded;
+
+        if (n == alloc)
+        {
+            alloc = alloc ? alloc * 2 : 256;
+            entries = realloc(entries, alloc * sizeof(*entries));
+
+            if (!entries)
+            {
+                fprintf(stderr, "out of memory\n");
+                exit(2);
+            }
+        }
+
+        e = &entries[n];
+
+        if (fread(&e->rec, sizeof(e->rec), 1, fp) != 1)
+        {
+            break;
+        }
+
+        e->seq = n;
+        e->data = NULL;
+
+        if (e->rec.dir == RIG_TRACE_DROPPED)
+        {
+            n++;
+            continue;
+        }
+
+        padded = RIG_TRACE_PAD(e->rec.len);
+
+        if (padded > 0)
+        {
+            e->data = malloc(padded);
+
+            if (!e->data || fread(e->data, padded, 1, fp) != 1)
+            {
+                fprintf(stderr, "%s: truncated record\n", argv[optind]);
+                free(e->data);
+                break;
+            }
+        }
+
+        n++;
+    }
+
+    fclose(fp);
+
+    qsort(entries, n, sizeof(*entries), entry_cmp);
+
+    t0 = n ? entries[0].rec.ts_ns : 0;
+
+    for (i = 0; i < n; i++)
+    {
+        const struct rig_trace_rec *rec = &entries[i].rec;
+        uint64_t rel = rec->ts_ns - t0;
+
+        if (port >= 0 && rec->port != port)
+        {
+            continue;
+        }
+
+        printf("%6lu.%06lu fd %-3u %-7s %-11s ",
+               (unsigned long)(rel / 1000000000),
+               (unsigned long)(rel % 1000000000) / 1000,
+               rec->port,
+               rec->dir < sizeof(dir_str) / sizeof(dir_str[0])
+               ? dir_str[rec->dir] : "?",
+               rec->func < sizeof(func_str) / sizeof(func_str[0])
+               ? func_str[rec->func] : "?");
+
+        if (rec->dir == RIG_TRACE_DROPPED)
+        {
+            printf("%u records lost\n", rec->len);
+            continue;
+        }
+
+        printf("%u bytes\n", rec->len);
+
+        if (!no_dump)
+        {
+            dump_data(entries[i].data, rec->len);
+        }
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        free(entries[i].data);
+    }
+
+    free(entries);
+
+    return 0;
+}
+
+
+void version()
+{
+    printf("rigtrace, %s\n\n", hamlib_version);
+    printf("%s\n", hamlib_copyright);
+}
+
+
+void usage()
+{
+    printf("Usage: rigtrace [OPTION]... FILE\n"
+           "Decode a binary I/O trace file.\n\n");
+
+
+    printf(
+        "  -p, --port=FD                 only show records of this port\n"
+        "  -n, --no-dump                 do not hex dump the data\n"
+        "  -h, --help                    display this help and exit\n"
+        "  -V, --version                 output version information and exit\n\n"
+    );
+
+    printf("\nReport bugs to <hamlib-developer@lists.sourceforge.net>.\n");
+
+}
@@ -35,6 +35,10 @@
 #include <ctype.h>
 #include <errno.h>
 
+#ifdef HAVE_SYS_TIME_H
+#  include <sys/time.h>
+#endif
+
 #ifdef HAVE_LIBREADLINE
 #  if defined(HAVE_READLINE_READLINE_H)
 #    include <readline/readline.h>
@@ -90,7 +94,16 @@ extern int read_history();
 #ifdef HAVE_PTHREAD
 #  include <pthread.h>
 
+/* one lock per rotator, rotctld may serve several */
+struct rot_lock
+{
+    ROT *rot;
+    pthread_mutex_t mutex;
+    struct rot_lock *next;
+};
+
 static pthread_mutex_t rot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct rot_lock *rot_locks;
 #endif
 
 #define STR1(S) #S
@@ -134,6 +147,7 @@ struct test_table
     unsigned char cmd;
     const char *name;
     int (*rot_routine)(ROT *,
+                       FILE *,
                        FILE *,
                        int,
                        const struct test_table *,
@@ -152,10 +166,14 @@ struct test_table
     const char *arg6;
 };
 
+/* points converted at once by the batch commands */
+#define BATCH_CHUNK 256
+
 #define CHKSCN1ARG(a) if ((a) != 1) return -RIG_EINVAL; else do {} while(0)
 
 #define ACTION(f) rigctl_##f
 #define declare_proto_rot(f) static int (ACTION(f))(ROT *rot,           \
+                                                    FILE *fin,          \
                                                     FILE *fout,         \
                                                     int interactive,    \
                                                     const struct test_table *cmd, \
@@ -188,6 +206,14 @@ declare_proto_rot(coord2qrb);
 declare_proto_rot(az_sp2az_lp);
 declare_proto_rot(dist_sp2dist_lp);
 declare_proto_rot(pause);
+declare_proto_rot(track_add);
+declare_proto_rot(track_stop);
+declare_proto_rot(get_track);
+declare_proto_rot(get_cached_position);
+declare_proto_rot(coord2qrb_batch);
+declare_proto_rot(loc2lonlat_batch);
+declare_proto_rot(lonlat2loc_batch);
+declare_proto_rot(get_eta);
 
 /*
  * convention: upper case cmd is set, lowercase is get
@@ -217,6 +243,14 @@ struct test_table test_list[] =
     { 'A', "a_sp2a_lp",     ACTION(az_sp2az_lp),        ARG_IN1 | ARG_OUT1, "Short Path Deg", "Long Path Deg" },
     { 'a', "d_sp2d_lp",     ACTION(dist_sp2dist_lp),    ARG_IN1 | ARG_OUT1, "Short Path km", "Long Path km" },
     { 0x8c, "pause",        ACTION(pause),              ARG_IN, "Seconds" },
+    { 0x90, "track_add",    ACTION(track_add),          ARG_IN1 | ARG_IN_LINE, "Points" },
+    { 0x91, "track_stop",   ACTION(track_stop),         ARG_NONE, },
+    { 0x92, "get_track",    ACTION(get_track),          ARG_OUT, "Active", "Points", "Commands", "Latency" },
+    { 0x93, "get_cached_pos", ACTION(get_cached_position), ARG_OUT, "Azimuth", "Elevation", "Age" },
+    { 0x94, "qrb_batch",    ACTION(coord2qrb_batch),    ARG_IN1 | ARG_IN2 | ARG_IN3, "Lon 1", "Lat 1", "Count" },
+    { 0x95, "loc2lonlat_batch", ACTION(loc2lonlat_batch), ARG_IN1, "Count" },
+    { 0x96, "lonlat2loc_batch", ACTION(lonlat2loc_batch), ARG_IN1 | ARG_IN2, "Loc Len [2-12]", "Count" },
+    { 0x97, "get_eta",      ACTION(get_eta),        ARG_OUT, "ETA" },
     { 0x00, "", NULL },
 
 };
@@ -1378,9 +1412,7 @@ int rotctl_parse(ROT *my_rot, FILE *fin, FILE *fout, char *argv[], int argc)
      * mutex locking needed because rotctld is multithreaded
      * and hamlib is not MT-safe
      */
-#ifdef HAVE_PTHREAD
-    pthread_mutex_lock(&rot_mutex);
-#endif
+    rotctl_lock(my_rot);
 
     if (!prompt)
     {
@@ -1413,6 +1445,7 @@ int rotctl_parse(ROT *my_rot, FILE *fin, FILE *fout, char *argv[], int argc)
     }
 
     retcode = (*cmd_entry->rot_routine)(my_rot,
+                                        fin,
                                         fout,
                                         interactive,
                                         cmd_entry,
@@ -1423,9 +1456,7 @@ int rotctl_parse(ROT *my_rot, FILE *fin, FILE *fout, char *argv[], int argc)
                                         p5 ? p5 : "",
                                         p6 ? p6 : "");
 
-#ifdef HAVE_PTHREAD
-    pthread_mutex_unlock(&rot_mutex);
-#endif
+    rotctl_unlock(my_rot);
 
     if (retcode == RIG_EIO) return retcode;
     if (retcode != RIG_OK)
@@ -1618,6 +1649,76 @@ void list_models()
 }
 
 
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t *rot_lock_get(ROT *rot)
+{
+    struct rot_lock *l;
+
+    pthread_mutex_lock(&rot_mutex);
+
+    for (l = rot_locks; l; l = l->next)
+    {
+        if (l->rot == rot)
+        {
+            break;
+        }
+    }
+
+    if (!l)
+    {
+        l = calloc(1, sizeof(struct rot_lock));
+
+        if (!l)
+        {
+            pthread_mutex_unlock(&rot_mutex);
+            return NULL;
+        }
+
+        l->rot = rot;
+        pthread_mutex_init(&l->mutex, NULL);
+        l->next = rot_locks;
+        rot_locks = l;
+    }
+
+    pthread_mutex_unlock(&rot_mutex);
+
+    return &l->mutex;
+}
+#endif
+
+
+/*
+ * Serializes the commands to a rotator, while rotctld may serve several
+ * rotators at once.
+ */
+void rotctl_lock(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t *mutex = rot_lock_get(rot);
+
+    if (mutex)
+    {
+        pthread_mutex_lock(mutex);
+    }
+
+#endif
+}
+
+
+void rotctl_unlock(ROT *rot)
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t *mutex = rot_lock_get(rot);
+
+    if (mutex)
+    {
+        pthread_mutex_unlock(mutex);
+    }
+
+#endif
+}
+
+
 int set_conf(ROT *my_rot, char *conf_parms)
 {
     char *p, *q, *n;
@@ -2260,3 +2361,444 @@ declare_proto_rot(pause)
     sleep(seconds);
     return RIG_OK;
 }
+
+
+/*
+ * Appends the "Time Azimuth Elevation" triplets of line to *points.
+ * Returns the number added, or -1 when line holds anything else.
+ */
+static int track_parse_line(const char *line,
+                            double now,
+                            struct rot_track_point **points,
+                            int *count,
+                            int *alloc)
+{
+    const char *p = line;
+    int added = 0;
+
+    for (;;)
+    {
+        struct rot_track_point pt;
+        char t[32];
+        int n;
+
+        if (sscanf(p, "%31s %f %f%n", t, &pt.azimuth, &pt.elevation, &n) != 3)
+        {
+            break;
+        }
+
+        pt.time = atof(t) + (t[0] == '+' ? now : 0);
+
+        if (*count == *alloc)
+        {
+            int size = *alloc ? 2 * *alloc : 64;
+            struct rot_track_point *np = realloc(*points, size * sizeof(pt));
+
+            if (!np)
+            {
+                return -1;
+            }
+
+            *points = np;
+            *alloc = size;
+        }
+
+        (*points)[(*count)++] = pt;
+        added++;
+        p += n;
+    }
+
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+
+    return *p == '\0' ? added : -1;
+}
+
+
+/* next input line, NUL terminated, from readline when the commands are */
+static int track_read_line(FILE *fin, int interactive, char *line, int size)
+{
+    char *nl;
+
+#ifdef HAVE_LIBREADLINE
+
+    if (interactive && prompt && have_rl)
+    {
+        char *rl = readline("Points: ");
+
+        if (!rl)
+        {
+            return -1;
+        }
+
+        snprintf(line, size, "%s", rl);
+        free(rl);
+
+        return 0;
+    }
+
+#endif
+
+    if (fgets(line, size, fin) == NULL)
+    {
+        return -1;
+    }
+
+    nl = strpbrk(line, "\r\n");
+
+    if (nl)
+    {
+        *nl = '\0';
+    }
+
+    return 0;
+}
+
+
+/*
+ * '0x90'
+ *
+ * Points are "Time Azimuth Elevation" triplets, the time in seconds since
+ * the Epoch, or since now with a leading '+'.  With "-" for points, they
+ * follow on the next lines, up to a line holding "end", so that a whole
+ * pass goes in one command.
+ */
+declare_proto_rot(track_add)
+{
+    struct rot_track_point *points = NULL;
+    struct timeval tv;
+    double now;
+    int count = 0, alloc = 0;
+    int retval = RIG_OK;
+
+    gettimeofday(&tv, NULL);
+    now = tv.tv_sec + tv.tv_usec / 1e6;
+
+    if (strcmp(arg1, "-") != 0)
+    {
+        if (track_parse_line(arg1, now, &points, &count, &alloc) < 0)
+        {
+            retval = -RIG_EINVAL;
+        }
+    }
+    else
+    {
+        char line[1024];
+
+        /*
+         * The points come from the client, at its own pace: the other
+         * clients of the rotator are not to wait for them, so its lock
+         * is only taken again for rot_track_add().
+         */
+        rotctl_unlock(rot);
+
+        for (;;)
+        {
+            if (track_read_line(fin, interactive, line, sizeof(line)) < 0)
+            {
+                retval = -RIG_EINVAL;   /* no end marker */
+                break;
+            }
+
+            if (strcmp(line, "end") == 0)
+            {
+                break;
+            }
+
+            /* go on reading up to the end marker, then fail */
+            if (retval == RIG_OK
+                    && track_parse_line(line, now, &points, &count, &alloc) < 0)
+            {
+                retval = -RIG_EINVAL;
+            }
+        }
+
+        rotctl_lock(rot);
+    }
+
+    if (retval == RIG_OK && count == 0)
+    {
+        retval = -RIG_EINVAL;
+    }
+
+    if (retval == RIG_OK)
+    {
+        retval = rot_track_add(rot, points, count);
+    }
+
+    free(points);
+
+    return retval;
+}
+
+
+/* '0x91' */
+declare_proto_rot(track_stop)
+{
+    return rot_track_stop(rot);
+}
+
+
+/* '0x92' */
+declare_proto_rot(get_track)
+{
+    struct rot_track_status status;
+    int retval;
+
+    retval = rot_track_get_status(rot, &status);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg1);
+    }
+
+    fprintf(fout, "%d%c", status.active, resp_sep);
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg2);
+    }
+
+    fprintf(fout, "%d%c", status.points, resp_sep);
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg3);
+    }
+
+    fprintf(fout, "%lu%c", status.commands, resp_sep);
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg4);
+    }
+
+    fprintf(fout, "%d%c", status.latency_ms, resp_sep);
+
+    return RIG_OK;
+}
+
+
+/* '0x93' */
+declare_proto_rot(get_cached_position)
+{
+    int status;
+    azimuth_t az;
+    elevation_t el;
+    int age;
+
+    status = rot_get_cached_position(rot, &az, &el, &age);
+
+    if (status != RIG_OK)
+    {
+        return status;
+    }
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg1);
+    }
+
+    fprintf(fout, "%f%c", az, resp_sep);
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg2);
+    }
+
+    fprintf(fout, "%f%c", el, resp_sep);
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg3);
+    }
+
+    fprintf(fout, "%d%c", age, resp_sep);
+
+    return status;
+}
+
+
+/*
+ * '0x94'
+ *
+ * Reads Count "Lon 2" "Lat 2" pairs following the command, and answers
+ * a "Distance Azimuth" line for each.
+ */
+declare_proto_rot(coord2qrb_batch)
+{
+    double lon1, lat1;
+    double lon2[BATCH_CHUNK], lat2[BATCH_CHUNK];
+    double dist[BATCH_CHUNK], az[BATCH_CHUNK];
+    int count, done, n, i;
+    int retval = RIG_OK;
+
+    CHKSCN1ARG(sscanf(arg1, "%lf", &lon1));
+    CHKSCN1ARG(sscanf(arg2, "%lf", &lat1));
+    CHKSCN1ARG(sscanf(arg3, "%d", &count));
+
+    if (count < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (done = 0; done < count; done += n)
+    {
+        n = count - done < BATCH_CHUNK ? count - done : BATCH_CHUNK;
+
+        for (i = 0; i < n; i++)
+        {
+            if (scanfc(fin, "%lf", &lon2[i]) < 1
+                    || scanfc(fin, "%lf", &lat2[i]) < 1)
+            {
+                return -RIG_EINVAL;
+            }
+        }
+
+        if (qrb_batch(lon1, lat1, n, lon2, lat2, dist, az) != RIG_OK)
+        {
+            retval = -RIG_EINVAL;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            fprintf(fout, "%f %f%c", dist[i], az[i], resp_sep);
+        }
+    }
+
+    return retval;
+}
+
+
+/*
+ * '0x95'
+ *
+ * Reads Count locators following the command, and answers a
+ * "Longitude Latitude" line for each.
+ */
+declare_proto_rot(loc2lonlat_batch)
+{
+    char loc[BATCH_CHUNK][MAXARGSZ + 1];
+    const char *locs[BATCH_CHUNK];
+    double lon[BATCH_CHUNK], lat[BATCH_CHUNK];
+    int count, done, n, i;
+    int retval = RIG_OK;
+
+    CHKSCN1ARG(sscanf(arg1, "%d", &count));
+
+    if (count < 0)
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (done = 0; done < count; done += n)
+    {
+        n = count - done < BATCH_CHUNK ? count - done : BATCH_CHUNK;
+
+        for (i = 0; i < n; i++)
+        {
+            if (scanfc(fin, "%127s", loc[i]) < 1)
+            {
+                return -RIG_EINVAL;
+            }
+
+            locs[i] = loc[i];
+        }
+
+        if (locator2longlat_batch(n, locs, lon, lat) != RIG_OK)
+        {
+            retval = -RIG_EINVAL;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            fprintf(fout, "%f %f%c", lon[i], lat[i], resp_sep);
+        }
+    }
+
+    return retval;
+}
+
+
+/*
+ * '0x96'
+ *
+ * Reads Count "Longitude" "Latitude" pairs following the command, and
+ * answers a locator line for each.
+ */
+declare_proto_rot(lonlat2loc_batch)
+{
+    char loc[BATCH_CHUNK * 13];
+    double lon[BATCH_CHUNK], lat[BATCH_CHUNK];
+    int pair, count, done, n, i;
+    int retval;
+
+    CHKSCN1ARG(sscanf(arg1, "%d", &pair));
+    CHKSCN1ARG(sscanf(arg2, "%d", &count));
+
+    pair /= 2;
+
+    if (count < 0 || pair < 1 || pair > 6)
+    {
+        return -RIG_EINVAL;
+    }
+
+    for (done = 0; done < count; done += n)
+    {
+        n = count - done < BATCH_CHUNK ? count - done : BATCH_CHUNK;
+
+        for (i = 0; i < n; i++)
+        {
+            if (scanfc(fin, "%lf", &lon[i]) < 1
+                    || scanfc(fin, "%lf", &lat[i]) < 1)
+            {
+                return -RIG_EINVAL;
+            }
+        }
+
+        retval = longlat2locator_batch(n, lon, lat, loc, pair);
+
+        if (retval != RIG_OK)
+        {
+            return retval;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            fprintf(fout, "%s%c", loc + i * (pair * 2 + 1), resp_sep);
+        }
+    }
+
+    return RIG_OK;
+}
+
+
+/* '0x97' */
+declare_proto_rot(get_eta)
+{
+    int status;
+    double eta;
+
+    status = rot_get_eta(rot, &eta);
+
+    if (status != RIG_OK)
+    {
+        return status;
+    }
+
+    if ((interactive && prompt) || (interactive && !prompt && ext_resp))
+    {
+        fprintf(fout, "%s: ", cmd->arg1);
+    }
+
+    fprintf(fout, "%f%c", eta, resp_sep);
+
+    return status;
+}
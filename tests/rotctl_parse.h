@@ -46,4 +46,7 @@ int set_conf(ROT *my_rot, char *conf_parms);
 
 int rotctl_parse(ROT *my_rot, FILE *fin, FILE *fout, char *argv[], int argc);
 
+void rotctl_lock(ROT *rot);
+void rotctl_unlock(ROT *rot);
+
 #endif  /* ROTCTL_PARSE_H */
@@ -84,7 +84,7 @@ void usage();
  * NB: do NOT use -W since it's reserved by POSIX.
  * TODO: add an option to read from a file
  */
-#define SHORT_OPTIONS "m:r:s:C:t:T:LuvhVlZ"
+#define SHORT_OPTIONS "m:r:s:C:G:t:T:LuvhVlZ"
 static struct option long_options[] =
 {
     {"model",           1, 0, 'm'},
@@ -94,6 +94,7 @@ static struct option long_options[] =
     {"listen-addr",     1, 0, 'T'},
     {"list",            0, 0, 'l'},
     {"set-conf",        1, 0, 'C'},
+    {"group",           1, 0, 'G'},
     {"show-conf",       0, 0, 'L'},
     {"dump-caps",       0, 0, 'u'},
     {"debug-time-stamps",0, 0, 'Z'},
@@ -150,32 +151,826 @@ static void handle_error(enum rig_debug_level_e lvl, const char *msg)
 }
 
 
+#define MAX_ROTATORS    8   /* -m given more than once */
+#define MAX_GROUPS      4   /* -G */
+
+/* model of the virtual rotators of -G, known to rotctld only */
+#define ROT_MODEL_GROUP ROT_MAKE_MODEL(ROT_DUMMY, 90)
+
+/*
+ * Rotators defined on the command line, each -m after the first one
+ * starting a new one.  A rotator has its own I/O thread, running the jobs
+ * of the groups it is a member of, so that all the members of a group
+ * move at the same time.
+ */
+enum job_op
+{
+    JOB_NONE = 0,
+    JOB_SET_POS,
+    JOB_GET_POS,
+    JOB_STOP,
+    JOB_PARK,
+    JOB_RESET,
+    JOB_MOVE,
+    JOB_EXIT
+};
+
+struct worker_job
+{
+    enum job_op op;
+    azimuth_t az;
+    elevation_t el;
+    int arg1;
+    int arg2;
+    int retval;
+    int done;
+    struct worker_job *next;
+};
+
+struct rot_def
+{
+    rot_model_t model;
+    const char *rot_file;
+    int serial_rate;
+    char conf_parms[MAXCONFLEN];
+    ROT *rot;
+#ifdef HAVE_PTHREAD
+    int worker;     /* thread started */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct worker_job *head;
+    struct worker_job *tail;
+#endif
+};
+
+enum group_role
+{
+    ROLE_AZEL = 0,
+    ROLE_AZ,
+    ROLE_EL
+};
+
+struct rot_group
+{
+    const char *spec;
+    int nb_members;
+    struct rot_def *members[MAX_ROTATORS];
+    enum group_role roles[MAX_ROTATORS];
+    char info[64];
+    ROT *rot;
+};
+
+static struct rot_def rot_defs[MAX_ROTATORS] = { { ROT_MODEL_DUMMY } };
+static int nb_rots = 1;
+static struct rot_group groups[MAX_GROUPS];
+static int nb_groups = 0;
+
+struct listener
+{
+    ROT *rot;
+    int sock;
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+#endif
+};
+
+
+static void job_run(ROT *rot, struct worker_job *job)
+{
+    rotctl_lock(rot);
+
+    switch (job->op)
+    {
+    case JOB_SET_POS:
+        job->retval = rot_set_position(rot, job->az, job->el);
+        break;
+
+    case JOB_GET_POS:
+        job->retval = rot_get_position(rot, &job->az, &job->el);
+        break;
+
+    case JOB_STOP:
+        job->retval = rot_stop(rot);
+        break;
+
+    case JOB_PARK:
+        job->retval = rot_park(rot);
+        break;
+
+    case JOB_RESET:
+        job->retval = rot_reset(rot, job->arg1);
+        break;
+
+    case JOB_MOVE:
+        job->retval = rot_move(rot, job->arg1, job->arg2);
+        break;
+
+    default:
+        job->retval = -RIG_EINTERNAL;
+        break;
+    }
+
+    rotctl_unlock(rot);
+}
+
+
+#ifdef HAVE_PTHREAD
+static void *worker_thread(void *arg)
+{
+    struct rot_def *def = arg;
+
+    pthread_mutex_lock(&def->lock);
+
+    while (1)
+    {
+        struct worker_job *job;
+
+        while (!def->head)
+        {
+            pthread_cond_wait(&def->cond, &def->lock);
+        }
+
+        job = def->head;
+        def->head = job->next;
+
+        if (!def->head)
+        {
+            def->tail = NULL;
+        }
+
+        if (job->op == JOB_EXIT)
+        {
+            break;
+        }
+
+        pthread_mutex_unlock(&def->lock);
+        job_run(def->rot, job);
+        pthread_mutex_lock(&def->lock);
+
+        job->done = 1;
+        pthread_cond_broadcast(&def->cond);
+    }
+
+    pthread_mutex_unlock(&def->lock);
+
+    return NULL;
+}
+#endif
+
+
+/* queues the job for the I/O thread of the rotator, or runs it now */
+static void job_post(struct rot_def *def, struct worker_job *job)
+{
+    job->retval = RIG_OK;
+    job->done = 0;
+    job->next = NULL;
+
+#ifdef HAVE_PTHREAD
+
+    if (def->worker)
+    {
+        pthread_mutex_lock(&def->lock);
+
+        if (def->tail)
+        {
+            def->tail->next = job;
+        }
+        else
+        {
+            def->head = job;
+        }
+
+        def->tail = job;
+        pthread_cond_broadcast(&def->cond);
+        pthread_mutex_unlock(&def->lock);
+        return;
+    }
+
+#endif
+
+    job_run(def->rot, job);
+    job->done = 1;
+}
+
+
+static int job_wait(struct rot_def *def, struct worker_job *job)
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&def->lock);
+
+    while (!job->done)
+    {
+        pthread_cond_wait(&def->cond, &def->lock);
+    }
+
+    pthread_mutex_unlock(&def->lock);
+#endif
+
+    return job->retval;
+}
+
+
+static void worker_start(struct rot_def *def)
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&def->lock, NULL);
+    pthread_cond_init(&def->cond, NULL);
+
+    if (pthread_create(&def->thread, NULL, worker_thread, def) == 0)
+    {
+        def->worker = 1;
+    }
+    else
+    {
+        rig_debug(RIG_DEBUG_WARN, "%s: no I/O thread for model %d\n",
+                  __func__, def->model);
+    }
+
+#endif
+}
+
+
+static void worker_stop(struct rot_def *def)
+{
+#ifdef HAVE_PTHREAD
+    struct worker_job job;
+
+    if (!def->worker)
+    {
+        return;
+    }
+
+    memset(&job, 0, sizeof(job));
+    job.op = JOB_EXIT;
+    job_post(def, &job);
+
+    pthread_join(def->thread, NULL);
+    def->worker = 0;
+
+    pthread_cond_destroy(&def->cond);
+    pthread_mutex_destroy(&def->lock);
+#endif
+}
+
+
+/*
+ * Posts the jobs to the members of the group all at once, then waits for
+ * them all.  Returns the first error, or -RIG_EINVAL when no member had a
+ * job.
+ */
+static int group_run(struct rot_group *g, struct worker_job *jobs)
+{
+    int i;
+    int posted = 0;
+    int retval = RIG_OK;
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        if (jobs[i].op != JOB_NONE)
+        {
+            job_post(g->members[i], &jobs[i]);
+            posted++;
+        }
+    }
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        if (jobs[i].op != JOB_NONE)
+        {
+            int ret = job_wait(g->members[i], &jobs[i]);
+
+            if (ret != RIG_OK && retval == RIG_OK)
+            {
+                retval = ret;
+            }
+        }
+    }
+
+    return posted ? retval : -RIG_EINVAL;
+}
+
+
+static float clamp_pos(float val, float min, float max)
+{
+    return val < min ? min : (val > max ? max : val);
+}
+
+
+/*
+ * The azimuth member gets the azimuth, and the elevation it can do,
+ * the elevation member the other way round.
+ */
+static int group_set_position(ROT *rot, azimuth_t az, elevation_t el)
+{
+    struct rot_group *g = rot->state.priv;
+    struct worker_job jobs[MAX_ROTATORS];
+    int i;
+
+    memset(jobs, 0, sizeof(jobs));
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        struct rot_state *rs = &g->members[i]->rot->state;
+
+        jobs[i].op = JOB_SET_POS;
+        jobs[i].az = az;
+        jobs[i].el = el;
+
+        if (g->roles[i] == ROLE_AZ)
+        {
+            jobs[i].el = clamp_pos(el, rs->min_el, rs->max_el);
+        }
+        else if (g->roles[i] == ROLE_EL)
+        {
+            jobs[i].az = clamp_pos(az, rs->min_az, rs->max_az);
+        }
+    }
+
+    return group_run(g, jobs);
+}
+
+
+static int group_get_position(ROT *rot, azimuth_t *az, elevation_t *el)
+{
+    struct rot_group *g = rot->state.priv;
+    struct worker_job jobs[MAX_ROTATORS];
+    int have_az = 0, have_el = 0;
+    int i, retval;
+
+    memset(jobs, 0, sizeof(jobs));
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        jobs[i].op = JOB_GET_POS;
+    }
+
+    retval = group_run(g, jobs);
+
+    if (retval != RIG_OK)
+    {
+        return retval;
+    }
+
+    *az = 0;
+    *el = 0;
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        if (g->roles[i] != ROLE_EL && !have_az)
+        {
+            *az = jobs[i].az;
+            have_az = 1;
+        }
+
+        if (g->roles[i] != ROLE_AZ && !have_el)
+        {
+            *el = jobs[i].el;
+            have_el = 1;
+        }
+    }
+
+    return RIG_OK;
+}
+
+
+/* every member gets the job */
+static int group_all(ROT *rot, enum job_op op, int arg1)
+{
+    struct rot_group *g = rot->state.priv;
+    struct worker_job jobs[MAX_ROTATORS];
+    int i;
+
+    memset(jobs, 0, sizeof(jobs));
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        jobs[i].op = op;
+        jobs[i].arg1 = arg1;
+    }
+
+    return group_run(g, jobs);
+}
+
+
+static int group_stop(ROT *rot)
+{
+    return group_all(rot, JOB_STOP, 0);
+}
+
+
+static int group_park(ROT *rot)
+{
+    return group_all(rot, JOB_PARK, 0);
+}
+
+
+static int group_reset(ROT *rot, rot_reset_t reset)
+{
+    return group_all(rot, JOB_RESET, reset);
+}
+
+
+/* up and down for the elevation members, left and right for the azimuth */
+static int group_move(ROT *rot, int direction, int speed)
+{
+    struct rot_group *g = rot->state.priv;
+    struct worker_job jobs[MAX_ROTATORS];
+    enum group_role skip;
+    int i;
+
+    switch (direction)
+    {
+    case ROT_MOVE_UP:
+    case ROT_MOVE_DOWN:
+        skip = ROLE_AZ;
+        break;
+
+    case ROT_MOVE_LEFT:
+    case ROT_MOVE_RIGHT:
+        skip = ROLE_EL;
+        break;
+
+    default:
+        return -RIG_EINVAL;
+    }
+
+    memset(jobs, 0, sizeof(jobs));
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        if (g->roles[i] != skip)
+        {
+            jobs[i].op = JOB_MOVE;
+            jobs[i].arg1 = direction;
+            jobs[i].arg2 = speed;
+        }
+    }
+
+    return group_run(g, jobs);
+}
+
+
+static const char *group_get_info(ROT *rot)
+{
+    struct rot_group *g = rot->state.priv;
+
+    return g->info;
+}
+
+
+static const struct rot_caps group_caps =
+{
+    .rot_model =        ROT_MODEL_GROUP,
+    .model_name =       "Group",
+    .mfg_name =         "rotctld",
+    .version =          "0.1",
+    .copyright =        "LGPL",
+    .status =           RIG_STATUS_ALPHA,
+    .rot_type =         ROT_TYPE_AZEL,
+    .port_type =        RIG_PORT_NONE,
+
+    .min_az =           -180.,
+    .max_az =           450.,
+    .min_el =           0.,
+    .max_el =           180.,
+
+    .set_position =     group_set_position,
+    .get_position =     group_get_position,
+    .stop =             group_stop,
+    .park =             group_park,
+    .reset =            group_reset,
+    .move =             group_move,
+    .get_info =         group_get_info,
+};
+
+
+/*
+ * Parses "0:az,1:el", the rotators by their rank on the command line,
+ * each with the role it plays in the group, az/el when none.
+ */
+static int group_parse(struct rot_group *g)
+{
+    const char *p = g->spec;
+
+    g->nb_members = 0;
+
+    while (*p)
+    {
+        char *end;
+        long idx = strtol(p, &end, 10);
+        enum group_role role = ROLE_AZEL;
+
+        if (end == p || idx < 0 || idx >= nb_rots
+                || g->nb_members >= MAX_ROTATORS)
+        {
+            return -RIG_EINVAL;
+        }
+
+        p = end;
+
+        if (*p == ':')
+        {
+            p++;
+
+            if (!strncmp(p, "azel", 4))
+            {
+                p += 4;
+            }
+            else if (!strncmp(p, "az", 2))
+            {
+                role = ROLE_AZ;
+                p += 2;
+            }
+            else if (!strncmp(p, "el", 2))
+            {
+                role = ROLE_EL;
+                p += 2;
+            }
+            else
+            {
+                return -RIG_EINVAL;
+            }
+        }
+
+        if (*p == ',')
+        {
+            p++;
+        }
+        else if (*p)
+        {
+            return -RIG_EINVAL;
+        }
+
+        g->members[g->nb_members] = &rot_defs[idx];
+        g->roles[g->nb_members] = role;
+        g->nb_members++;
+    }
+
+    return g->nb_members ? RIG_OK : -RIG_EINVAL;
+}
+
+
+/* the range of the group is what all its members can do */
+static int group_open(struct rot_group *g)
+{
+    struct rot_state *rs;
+    int have_az = 0, have_el = 0;
+    int i;
+
+    g->rot = rot_init(ROT_MODEL_GROUP);
+
+    if (!g->rot)
+    {
+        return -RIG_EINTERNAL;
+    }
+
+    rs = &g->rot->state;
+    rs->priv = g;
+
+    for (i = 0; i < g->nb_members; i++)
+    {
+        struct rot_state *ms = &g->members[i]->rot->state;
+
+        if (g->roles[i] != ROLE_EL)
+        {
+            rs->min_az = have_az && rs->min_az > ms->min_az ? rs->min_az : ms->min_az;
+            rs->max_az = have_az && rs->max_az < ms->max_az ? rs->max_az : ms->max_az;
+            have_az = 1;
+        }
+
+        if (g->roles[i] != ROLE_AZ)
+        {
+            rs->min_el = have_el && rs->min_el > ms->min_el ? rs->min_el : ms->min_el;
+            rs->max_el = have_el && rs->max_el < ms->max_el ? rs->max_el : ms->max_el;
+            have_el = 1;
+        }
+    }
+
+    if (!have_az)
+    {
+        rs->min_az = rs->max_az = 0;
+    }
+
+    if (!have_el)
+    {
+        rs->min_el = rs->max_el = 0;
+    }
+
+    if (rs->min_az > rs->max_az || rs->min_el > rs->max_el)
+    {
+        return -RIG_EINVAL;
+    }
+
+    snprintf(g->info, sizeof(g->info), "Group %s", g->spec);
+
+    return rot_open(g->rot);
+}
+
+
+/*
+ * Opens the listening socket of one device, exits on error.
+ */
+static int listen_port(const char *port)
+{
+    struct addrinfo hints, *result, *saved_result;
+    int sock_listen;
+    int reuseaddr = 1;
+    int sockopt;
+    int retcode;
+
+    memset(&hints, 0, sizeof(struct addrinfo));
+    hints.ai_family = AF_UNSPEC;        /* Allow IPv4 or IPv6 */
+    hints.ai_socktype = SOCK_STREAM;    /* TCP socket */
+    hints.ai_flags = AI_PASSIVE;        /* For wildcard IP address */
+    hints.ai_protocol = 0;              /* Any protocol */
+
+    retcode = getaddrinfo(src_addr, port, &hints, &result);
+
+    if (retcode != 0)
+    {
+        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(retcode));
+        exit(2);
+    }
+
+    saved_result = result;
+
+    do
+    {
+        sock_listen = socket(result->ai_family,
+                             result->ai_socktype,
+                             result->ai_protocol);
+
+        if (sock_listen < 0)
+        {
+            handle_error(RIG_DEBUG_ERR, "socket");
+            freeaddrinfo(result);   /* No longer needed */
+            exit(1);
+        }
+
+        if (setsockopt(sock_listen, SOL_SOCKET, SO_REUSEADDR,
+                       (char *)&reuseaddr, sizeof(reuseaddr)) < 0)
+        {
+
+            handle_error(RIG_DEBUG_ERR, "setsockopt");
+            freeaddrinfo(result);   /* No longer needed */
+            exit(1);
+        }
+
+#ifdef IPV6_V6ONLY
+
+        if (AF_INET6 == result->ai_family)
+        {
+            /* allow IPv4 mapped to IPv6 clients, MS & BSD default this
+               to 1 i.e. disallowed */
+            sockopt = 0;
+
+            if (setsockopt(sock_listen,
+                           IPPROTO_IPV6,
+                           IPV6_V6ONLY,
+                           (char *)&sockopt,
+                           sizeof(sockopt))
+                < 0)
+            {
+
+                handle_error(RIG_DEBUG_ERR, "setsockopt");
+                freeaddrinfo(saved_result);     /* No longer needed */
+                exit(1);
+            }
+        }
+
+#endif
+
+        if (0 == bind(sock_listen, result->ai_addr, result->ai_addrlen))
+        {
+            break;
+        }
+
+        handle_error(RIG_DEBUG_WARN, "binding failed (trying next interface)");
+#ifdef __MINGW32__
+        closesocket(sock_listen);
+#else
+        close(sock_listen);
+#endif
+    }
+    while ((result = result->ai_next) != NULL);
+
+    freeaddrinfo(saved_result);     /* No longer needed */
+
+    if (NULL == result)
+    {
+        rig_debug(RIG_DEBUG_ERR, "bind error - no available interface\n");
+        exit(1);
+    }
+
+    if (listen(sock_listen, 4) < 0)
+    {
+        handle_error(RIG_DEBUG_ERR, "listening");
+        exit(1);
+    }
+
+    return sock_listen;
+}
+
+
+/*
+ * Loop accepting the connections of one device
+ */
+static void *serve(void *arg)
+{
+    struct listener *l = arg;
+    struct handle_data *data;
+    int retcode;
+    char host[NI_MAXHOST];
+    char serv[NI_MAXSERV];
+
+#ifdef HAVE_PTHREAD
+    pthread_t thread;
+    pthread_attr_t attr;
+#endif
+
+    do
+    {
+        data = malloc(sizeof(struct handle_data));
+
+        if (!data)
+        {
+            rig_debug(RIG_DEBUG_ERR, "malloc: %s\n", strerror(errno));
+            exit(1);
+        }
+
+        data->rot = l->rot;
+        data->clilen = sizeof(data->cli_addr);
+        data->sock = accept(l->sock,
+                            (struct sockaddr *) &data->cli_addr,
+                            &data->clilen);
+
+        if (data->sock < 0)
+        {
+            handle_error(RIG_DEBUG_ERR, "accept");
+            free(data);
+            break;
+        }
+
+        if ((retcode = getnameinfo((struct sockaddr const *)&data->cli_addr,
+                                   data->clilen,
+                                   host,
+                                   sizeof(host),
+                                   serv,
+                                   sizeof(serv),
+                                   NI_NOFQDN))
+            < 0)
+        {
+
+            rig_debug(RIG_DEBUG_WARN,
+                      "Peer lookup error: %s",
+                      gai_strerror(retcode));
+        }
+
+        rig_debug(RIG_DEBUG_VERBOSE,
+                  "Connection opened from %s:%s\n",
+                  host,
+                  serv);
+
+#ifdef HAVE_PTHREAD
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+        retcode = pthread_create(&thread, &attr, handle_socket, data);
+
+        if (retcode != 0)
+        {
+            rig_debug(RIG_DEBUG_ERR, "pthread_create: %s\n", strerror(retcode));
+            break;
+        }
+
+#else
+        handle_socket(data);
+#endif
+    }
+    while (retcode == 0);
+
+    return NULL;
+}
+
+
 int main(int argc, char *argv[])
 {
-    ROT *my_rot;        /* handle to rot (instance) */
-    rot_model_t my_model = ROT_MODEL_DUMMY;
+    struct rot_def *def = &rot_defs[0];     /* rotator of -r, -s, -C */
+    struct listener listeners[MAX_ROTATORS + MAX_GROUPS];
+    int nb_listeners;
+    int model_set = 0;
+    int i;
 
     int retcode;        /* generic return code from functions */
 
     int verbose = 0;
     int show_conf = 0;
     int dump_caps_opt = 0;
-    const char *rot_file = NULL;
-    int serial_rate = 0;
-    char conf_parms[MAXCONFLEN] = "";
 
-    struct addrinfo hints, *result, *saved_result;
-    int sock_listen;
-    int reuseaddr = 1;
+#ifdef __MINGW32__
     int sockopt;
-    char host[NI_MAXHOST];
-    char serv[NI_MAXSERV];
-
-#ifdef HAVE_PTHREAD
-    pthread_t thread;
-    pthread_attr_t attr;
 #endif
-    struct handle_data *arg;
 
     while (1)
     {
@@ -206,7 +1001,21 @@ int main(int argc, char *argv[])
                 exit(1);
             }
 
-            my_model = atoi(optarg);
+            /* each -m after the first one defines another rotator */
+            if (model_set)
+            {
+                if (nb_rots >= MAX_ROTATORS)
+                {
+                    fprintf(stderr, "Too many rotators, %d at most\n",
+                            MAX_ROTATORS);
+                    exit(1);
+                }
+
+                def = &rot_defs[nb_rots++];
+            }
+
+            def->model = atoi(optarg);
+            model_set = 1;
             break;
 
         case 'r':
@@ -216,7 +1025,7 @@ int main(int argc, char *argv[])
                 exit(1);
             }
 
-            rot_file = optarg;
+            def->rot_file = optarg;
             break;
 
         case 's':
@@ -226,7 +1035,7 @@ int main(int argc, char *argv[])
                 exit(1);
             }
 
-            serial_rate = atoi(optarg);
+            def->serial_rate = atoi(optarg);
             break;
 
         case 'C':
@@ -236,12 +1045,29 @@ int main(int argc, char *argv[])
                 exit(1);
             }
 
-            if (*conf_parms != '\0')
+            if (*def->conf_parms != '\0')
+            {
+                strcat(def->conf_parms, ",");
+            }
+
+            strncat(def->conf_parms, optarg,
+                    MAXCONFLEN - strlen(def->conf_parms));
+            break;
+
+        case 'G':
+            if (!optarg)
+            {
+                usage();    /* wrong arg count */
+                exit(1);
+            }
+
+            if (nb_groups >= MAX_GROUPS)
             {
-                strcat(conf_parms, ",");
+                fprintf(stderr, "Too many groups, %d at most\n", MAX_GROUPS);
+                exit(1);
             }
 
-            strncat(conf_parms, optarg, MAXCONFLEN - strlen(conf_parms));
+            groups[nb_groups++].spec = optarg;
             break;
 
         case 't':
@@ -296,43 +1122,70 @@ int main(int argc, char *argv[])
     rig_debug(RIG_DEBUG_VERBOSE,
               "Report bugs to <hamlib-developer@lists.sourceforge.net>\n\n");
 
-    my_rot = rot_init(my_model);
+    nb_listeners = nb_rots + nb_groups;
 
-    if (!my_rot)
-    {
-        fprintf(stderr,
-                "Unknown rot num %d, or initialization error.\n",
-                my_model);
+#ifndef HAVE_PTHREAD
 
-        fprintf(stderr, "Please check with --list option.\n");
-        exit(2);
+    if (nb_listeners > 1)
+    {
+        fprintf(stderr, "Several rotators need thread support.\n");
+        exit(1);
     }
 
-    retcode = set_conf(my_rot, conf_parms);
+#endif
 
-    if (retcode != RIG_OK)
+    if (nb_listeners > 1 && atoi(portno) <= 0)
     {
-        fprintf(stderr, "Config parameter error: %s\n", rigerror(retcode));
-        exit(2);
+        fprintf(stderr, "Several rotators need a numeric port.\n");
+        exit(1);
     }
 
-    if (rot_file)
+    for (i = 0; i < nb_rots; i++)
     {
-        strncpy(my_rot->state.rotport.pathname, rot_file, FILPATHLEN - 1);
-    }
+        ROT *my_rot;
 
-    /* FIXME: bound checking and port type == serial */
-    if (serial_rate != 0)
-    {
-        my_rot->state.rotport.parm.serial.rate = serial_rate;
-    }
+        def = &rot_defs[i];
+        my_rot = rot_init(def->model);
 
-    /*
-     * print out conf parameters
-     */
-    if (show_conf)
-    {
-        rot_token_foreach(my_rot, print_conf_list, (rig_ptr_t)my_rot);
+        if (!my_rot)
+        {
+            fprintf(stderr,
+                    "Unknown rot num %d, or initialization error.\n",
+                    def->model);
+
+            fprintf(stderr, "Please check with --list option.\n");
+            exit(2);
+        }
+
+        retcode = set_conf(my_rot, def->conf_parms);
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "Config parameter error: %s\n", rigerror(retcode));
+            exit(2);
+        }
+
+        if (def->rot_file)
+        {
+            strncpy(my_rot->state.rotport.pathname, def->rot_file,
+                    FILPATHLEN - 1);
+        }
+
+        /* FIXME: bound checking and port type == serial */
+        if (def->serial_rate != 0)
+        {
+            my_rot->state.rotport.parm.serial.rate = def->serial_rate;
+        }
+
+        /*
+         * print out conf parameters
+         */
+        if (show_conf)
+        {
+            rot_token_foreach(my_rot, print_conf_list, (rig_ptr_t)my_rot);
+        }
+
+        def->rot = my_rot;
     }
 
     /*
@@ -341,30 +1194,76 @@ int main(int argc, char *argv[])
      */
     if (dump_caps_opt)
     {
-        dumpcaps_rot(my_rot, stdout);
-        rot_cleanup(my_rot);    /* if you care about memory */
+        for (i = 0; i < nb_rots; i++)
+        {
+            dumpcaps_rot(rot_defs[i].rot, stdout);
+            rot_cleanup(rot_defs[i].rot);   /* if you care about memory */
+        }
+
         exit(0);
     }
 
-    retcode = rot_open(my_rot);
-
-    if (retcode != RIG_OK)
+    for (i = 0; i < nb_rots; i++)
     {
-        fprintf(stderr, "rot_open: error = %s \n", rigerror(retcode));
-        exit(2);
+        ROT *my_rot = rot_defs[i].rot;
+
+        retcode = rot_open(my_rot);
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "rot_open: error = %s \n", rigerror(retcode));
+            exit(2);
+        }
+
+        if (verbose > 0)
+        {
+            printf("Opened rot model %d, '%s'\n",
+                   my_rot->caps->rot_model,
+                   my_rot->caps->model_name);
+        }
+
+        rig_debug(RIG_DEBUG_VERBOSE,
+                  "Backend version: %s, Status: %s\n",
+                  my_rot->caps->version,
+                  rig_strstatus(my_rot->caps->status));
+
+        listeners[i].rot = my_rot;
     }
 
-    if (verbose > 0)
+    /*
+     * Groups, the members of which run their commands each on its own
+     * I/O thread.
+     */
+    if (nb_groups > 0)
     {
-        printf("Opened rot model %d, '%s'\n",
-               my_rot->caps->rot_model,
-               my_rot->caps->model_name);
+        rot_register(&group_caps);
+
+        for (i = 0; i < nb_rots; i++)
+        {
+            worker_start(&rot_defs[i]);
+        }
     }
 
-    rig_debug(RIG_DEBUG_VERBOSE,
-              "Backend version: %s, Status: %s\n",
-              my_rot->caps->version,
-              rig_strstatus(my_rot->caps->status));
+    for (i = 0; i < nb_groups; i++)
+    {
+        struct rot_group *g = &groups[i];
+
+        retcode = group_parse(g);
+
+        if (retcode == RIG_OK)
+        {
+            retcode = group_open(g);
+        }
+
+        if (retcode != RIG_OK)
+        {
+            fprintf(stderr, "Group '%s': error = %s\n", g->spec,
+                    rigerror(retcode));
+            exit(2);
+        }
+
+        listeners[nb_rots + i].rot = g->rot;
+    }
 
 #ifdef __MINGW32__
 #  ifndef SO_OPENTYPE
@@ -394,96 +1293,25 @@ int main(int argc, char *argv[])
 #endif
 
     /*
-     * Prepare listening socket
+     * Prepare listening sockets, the rotators then the groups on
+     * consecutive ports
      */
-    memset(&hints, 0, sizeof(struct addrinfo));
-    hints.ai_family = AF_UNSPEC;        /* Allow IPv4 or IPv6 */
-    hints.ai_socktype = SOCK_STREAM;    /* TCP socket */
-    hints.ai_flags = AI_PASSIVE;        /* For wildcard IP address */
-    hints.ai_protocol = 0;              /* Any protocol */
-
-    retcode = getaddrinfo(src_addr, portno, &hints, &result);
-
-    if (retcode != 0)
-    {
-        fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(retcode));
-        exit(2);
-    }
-
-    saved_result = result;
-
-    do
+    for (i = 0; i < nb_listeners; i++)
     {
-        sock_listen = socket(result->ai_family,
-                             result->ai_socktype,
-                             result->ai_protocol);
-
-        if (sock_listen < 0)
-        {
-            handle_error(RIG_DEBUG_ERR, "socket");
-            freeaddrinfo(result);   /* No longer needed */
-            exit(1);
-        }
-
-        if (setsockopt(sock_listen, SOL_SOCKET, SO_REUSEADDR,
-                       (char *)&reuseaddr, sizeof(reuseaddr)) < 0)
-        {
-
-            handle_error(RIG_DEBUG_ERR, "setsockopt");
-            freeaddrinfo(result);   /* No longer needed */
-            exit(1);
-        }
-
-#ifdef IPV6_V6ONLY
-
-        if (AF_INET6 == result->ai_family)
-        {
-            /* allow IPv4 mapped to IPv6 clients, MS & BSD default this
-               to 1 i.e. disallowed */
-            sockopt = 0;
-
-            if (setsockopt(sock_listen,
-                           IPPROTO_IPV6,
-                           IPV6_V6ONLY,
-                           (char *)&sockopt,
-                           sizeof(sockopt))
-                < 0)
-            {
-
-                handle_error(RIG_DEBUG_ERR, "setsockopt");
-                freeaddrinfo(saved_result);     /* No longer needed */
-                exit(1);
-            }
-        }
-
-#endif
+        char port[16];
 
-        if (0 == bind(sock_listen, result->ai_addr, result->ai_addrlen))
+        if (i == 0)
         {
-            break;
+            listeners[i].sock = listen_port(portno);
+            continue;
         }
 
-        handle_error(RIG_DEBUG_WARN, "binding failed (trying next interface)");
-#ifdef __MINGW32__
-        closesocket(sock_listen);
-#else
-        close(sock_listen);
-#endif
-    }
-    while ((result = result->ai_next) != NULL);
-
-    freeaddrinfo(saved_result);     /* No longer needed */
-
-    if (NULL == result)
-    {
-        rig_debug(RIG_DEBUG_ERR, "bind error - no available interface\n");
-        exit(1);
-    }
+        snprintf(port, sizeof(port), "%d", atoi(portno) + i);
+        listeners[i].sock = listen_port(port);
 
-    if (listen(sock_listen, 4) < 0)
-    {
-        handle_error(RIG_DEBUG_ERR, "listening");
-        exit(1);
+        rig_debug(RIG_DEBUG_VERBOSE, "%s %d on port %s\n",
+                  i < nb_rots ? "Rotator" : "Group",
+                  i < nb_rots ? i : i - nb_rots, port);
     }
 
 #ifdef SIGPIPE
@@ -512,70 +1340,47 @@ int main(int argc, char *argv[])
 #endif
 
     /*
-     * main loop accepting connections
+     * main loops accepting connections, one per device
      */
-    do
+#ifdef HAVE_PTHREAD
+
+    for (i = 1; i < nb_listeners; i++)
     {
-        arg = malloc(sizeof(struct handle_data));
+        retcode = pthread_create(&listeners[i].thread, NULL, serve,
+                                 &listeners[i]);
 
-        if (!arg)
+        if (retcode != 0)
         {
-            rig_debug(RIG_DEBUG_ERR, "malloc: %s\n", strerror(errno));
+            rig_debug(RIG_DEBUG_ERR, "pthread_create: %s\n", strerror(retcode));
             exit(1);
         }
+    }
 
-        arg->rot = my_rot;
-        arg->clilen = sizeof(arg->cli_addr);
-        arg->sock = accept(sock_listen,
-                           (struct sockaddr *) &arg->cli_addr,
-                           &arg->clilen);
-
-        if (arg->sock < 0)
-        {
-            handle_error(RIG_DEBUG_ERR, "accept");
-            break;
-        }
-
-        if ((retcode = getnameinfo((struct sockaddr const *)&arg->cli_addr,
-                                   arg->clilen,
-                                   host,
-                                   sizeof(host),
-                                   serv,
-                                   sizeof(serv),
-                                   NI_NOFQDN))
-            < 0)
-        {
-
-            rig_debug(RIG_DEBUG_WARN,
-                      "Peer lookup error: %s",
-                      gai_strerror(retcode));
-        }
+#endif
 
-        rig_debug(RIG_DEBUG_VERBOSE,
-                  "Connection opened from %s:%s\n",
-                  host,
-                  serv);
+    serve(&listeners[0]);
 
 #ifdef HAVE_PTHREAD
-        pthread_attr_init(&attr);
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 
-        retcode = pthread_create(&thread, &attr, handle_socket, arg);
-
-        if (retcode != 0)
-        {
-            rig_debug(RIG_DEBUG_ERR, "pthread_create: %s\n", strerror(retcode));
-            break;
-        }
+    for (i = 1; i < nb_listeners; i++)
+    {
+        pthread_join(listeners[i].thread, NULL);
+    }
 
-#else
-        handle_socket(arg);
 #endif
+
+    for (i = 0; i < nb_groups; i++)
+    {
+        rot_close(groups[i].rot);
+        rot_cleanup(groups[i].rot);
     }
-    while (retcode == 0);
 
-    rot_close(my_rot); /* close port */
-    rot_cleanup(my_rot); /* if you care about memory */
+    for (i = 0; i < nb_rots; i++)
+    {
+        worker_stop(&rot_defs[i]);
+        rot_close(rot_defs[i].rot); /* close port */
+        rot_cleanup(rot_defs[i].rot); /* if you care about memory */
+    }
 
 #ifdef __MINGW32__
     WSACleanup();
@@ -693,6 +1498,7 @@ void usage()
         "  -t, --port=NUM                set TCP listening port, default %s\n"
         "  -T, --listen-addr=IPADDR      set listening IP address, default ANY\n"
         "  -C, --set-conf=PARM=VAL       set config parameters\n"
+        "  -G, --group=ROT[:ROLE],...    combine rotators into one, ROLE az, el or azel\n"
         "  -L, --show-conf               list all config parameters\n"
         "  -l, --list                    list all model numbers and exit\n"
         "  -u, --dump-caps               dump capabilities and exit\n"
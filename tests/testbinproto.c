@@ -0,0 +1,232 @@
+/*
+ * Round trip test of the rigctld binary framing, see src/binproto.h.
+ * Every value put in a frame must come back the same once the frame has
+ * been through binproto_parse().
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <hamlib/rig.h>
+#include "misc.h"
+#include "binproto.h"
+
+static int failed;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", \
+                    __FILE__, __LINE__, #cond); \
+            failed++; \
+        } \
+    } while (0)
+
+
+/* what the other end gets of f */
+static void wire(const struct binproto_frame *f, struct binproto_frame *r)
+{
+    CHECK(BINPROTO_FRAMELEN(f->buf) == f->len);
+    CHECK(binproto_parse(r, f->buf, f->len) == RIG_OK);
+}
+
+
+static void test_header(void)
+{
+    struct binproto_frame f, r;
+
+    binproto_init(&f, 0xbeef, BINPROTO_MORE | BINPROTO_VFO, 'f');
+    CHECK(f.len == BINPROTO_HDRLEN);
+    wire(&f, &r);
+    CHECK(BINPROTO_ID(&r) == 0xbeef);
+    CHECK(BINPROTO_FLAGS(&r) == (BINPROTO_MORE | BINPROTO_VFO));
+    CHECK(BINPROTO_CMD(&r) == 'f');
+    CHECK(binproto_peek(&r) == 0);
+}
+
+
+static void test_int(void)
+{
+    static const int64_t vals[] =
+    {
+        0, 1, -1, 127, 128, -128, -129, 255, 256, 32767, -32768,
+        8388607, -8388608, 2147483647, -2147483647 - 1,
+        INT64_C(145000000), INT64_C(10000000000),
+        INT64_MAX, INT64_MIN
+    };
+    struct binproto_frame f, r;
+    int64_t v;
+    size_t i;
+
+    binproto_init(&f, 1, 0, 'j');
+
+    for (i = 0; i < sizeof(vals) / sizeof(vals[0]); i++)
+    {
+        CHECK(binproto_put_int(&f, vals[i]) == RIG_OK);
+    }
+
+    wire(&f, &r);
+
+    for (i = 0; i < sizeof(vals) / sizeof(vals[0]); i++)
+    {
+        CHECK(binproto_peek(&r) == BINPROTO_INT);
+        CHECK(binproto_get_int(&r, &v) == RIG_OK);
+
+        if (v != vals[i])
+        {
+            fprintf(stderr, "int %"PRIll" came back as %"PRIll"\n",
+                    (int64_t)vals[i], (int64_t)v);
+            failed++;
+        }
+    }
+
+    CHECK(binproto_peek(&r) == 0);
+
+    /* the shortest encoding: one byte for 127, two for 128 */
+    binproto_init(&f, 1, 0, 'j');
+    binproto_put_int(&f, 127);
+    CHECK(f.buf[BINPROTO_HDRLEN + 1] == 1);
+    binproto_put_int(&f, 128);
+    CHECK(f.buf[BINPROTO_HDRLEN + 4] == 2);
+}
+
+
+static void test_real(void)
+{
+    static const double vals[] =
+    {
+        0.0, 1.0, -1.0, 0.5, -0.25, 14074000.0, 145500000.125,
+        1.0e-9, 3.14159265358979, 9007199254740992.0, -1.0e300
+    };
+    struct binproto_frame f, r;
+    int64_t v;
+    double d;
+    size_t i;
+
+    binproto_init(&f, 2, 0, 'f');
+
+    for (i = 0; i < sizeof(vals) / sizeof(vals[0]); i++)
+    {
+        CHECK(binproto_put_real(&f, vals[i]) == RIG_OK);
+    }
+
+    wire(&f, &r);
+
+    for (i = 0; i < sizeof(vals) / sizeof(vals[0]); i++)
+    {
+        CHECK(binproto_get_real(&r, &d) == RIG_OK);
+
+        if (d != vals[i])
+        {
+            fprintf(stderr, "real %.17g came back as %.17g\n", vals[i], d);
+            failed++;
+        }
+    }
+
+    /* an integral real goes as an integer, a fractional one does not */
+    binproto_init(&f, 2, 0, 'F');
+    binproto_put_real(&f, 7074000.0);
+    binproto_put_real(&f, 7074000.5);
+    wire(&f, &r);
+    CHECK(binproto_peek(&r) == BINPROTO_INT);
+    CHECK(binproto_get_int(&r, &v) == RIG_OK && v == 7074000);
+    CHECK(binproto_peek(&r) == BINPROTO_REAL);
+    CHECK(binproto_get_int(&r, &v) == -RIG_EPROTO);
+}
+
+
+static void test_str(void)
+{
+    struct binproto_frame f, r;
+    char s[256];
+    char small[4];
+    char big[255];
+    int64_t v;
+
+    memset(big, 'x', sizeof(big));
+
+    binproto_init(&f, 3, 0, 'm');
+    CHECK(binproto_put_str(&f, "USB", -1) == RIG_OK);
+    CHECK(binproto_put_str(&f, "", -1) == RIG_OK);
+    CHECK(binproto_put_str(&f, "VFOA and more", 4) == RIG_OK);
+    CHECK(binproto_put_str(&f, big, sizeof(big)) == RIG_OK);
+    CHECK(binproto_put_str(&f, "PKTUSB", -1) == RIG_OK);
+    CHECK(binproto_put_str(&f, big, 256) == -RIG_EINVAL);
+    wire(&f, &r);
+
+    CHECK(binproto_get_str(&r, s, sizeof(s)) == 3 && !strcmp(s, "USB"));
+    CHECK(binproto_get_str(&r, s, sizeof(s)) == 0 && s[0] == '\0');
+    CHECK(binproto_get_str(&r, s, sizeof(s)) == 4 && !strcmp(s, "VFOA"));
+    CHECK(binproto_get_str(&r, s, sizeof(s)) == 255
+          && !memcmp(s, big, sizeof(big)) && s[255] == '\0');
+
+    /* truncated to the buffer, and still NUL terminated */
+    CHECK(binproto_get_str(&r, small, sizeof(small)) == 3
+          && !strcmp(small, "PKT"));
+    CHECK(binproto_peek(&r) == 0);
+    CHECK(binproto_get_str(&r, s, sizeof(s)) == -RIG_EPROTO);
+
+    /* a string is not a number */
+    binproto_init(&f, 3, 0, 'V');
+    binproto_put_str(&f, "VFOB", -1);
+    wire(&f, &r);
+    CHECK(binproto_get_int(&r, &v) == -RIG_EPROTO);
+}
+
+
+static void test_limits(void)
+{
+    struct binproto_frame f, r;
+    char chunk[255];
+    int64_t v;
+    int n;
+
+    /* a frame takes fields till BINPROTO_MAXLEN, no further */
+    memset(chunk, 'y', sizeof(chunk));
+    binproto_init(&f, 4, 0, BINPROTO_TEXT);
+
+    for (n = 0; binproto_put_str(&f, chunk, sizeof(chunk)) == RIG_OK; n++)
+    {
+    }
+
+    CHECK(n == (BINPROTO_MAXLEN - BINPROTO_HDRLEN) / (int)(2 + sizeof(chunk)));
+    CHECK(f.len <= BINPROTO_MAXLEN);
+    wire(&f, &r);
+
+    /* a length which does not match the bytes given */
+    binproto_init(&f, 4, 0, 'f');
+    binproto_put_int(&f, 42);
+    CHECK(binproto_parse(&r, f.buf, f.len - 1) == -RIG_EPROTO);
+    CHECK(binproto_parse(&r, f.buf, BINPROTO_HDRLEN - 1) == -RIG_EPROTO);
+
+    /* a field running past the end of the frame */
+    f.buf[BINPROTO_HDRLEN + 1] = 9;
+    CHECK(binproto_parse(&r, f.buf, f.len) == RIG_OK);
+    CHECK(binproto_get_int(&r, &v) == -RIG_EPROTO);
+}
+
+
+int main(int argc, char *argv[])
+{
+    test_header();
+    test_int();
+    test_real();
+    test_str();
+    test_limits();
+
+    if (failed)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failed);
+        return 1;
+    }
+
+    printf("binproto round trip OK\n");
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# Drive the Kenwood, Yaesu newcat and Icom backends against the rigemu
+# radio emulator, with some errors injected to exercise the retries.
+
+status=0
+
+for emu in "kenwood 214" "newcat 135" "icom 311"
+do
+    set -- $emu
+    tty=./testemu-$1.tty
+
+    rm -f $tty
+    ./rigemu -p $1 -l $tty -e 20 -S 5 > /dev/null &
+    pid=$!
+
+    n=0
+    while [ ! -e $tty ] && [ $n -lt 50 ]
+    do
+        sleep 0.1
+        n=`expr $n + 1`
+    done
+
+    out=`./rigctl -m $2 -r $tty -C retry=3,timeout=500 F 7074000 f M LSB 0 m | head -2 | tr '\n' ' '`
+
+    kill $pid
+    wait $pid 2> /dev/null
+
+    if [ "$out" = "7074000 LSB " ]
+    then
+        echo "$1: ok"
+    else
+        echo "$1: FAILED, got '$out'"
+        status=1
+    fi
+done
+
+exit $status
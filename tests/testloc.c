@@ -14,9 +14,70 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <hamlib/rotator.h>
 
 
+/* the batch conversions must agree with the single ones */
+static int check_batch(double lon1, double lat1, const char *loc1, int loc_len)
+{
+    const char *locs[] = { loc1, "EM79", "jn58", "AA00", "RR99", "JN58sm", "X!" };
+    const int n = sizeof(locs) / sizeof(locs[0]);
+    double lon[7], lat[7], dist[7], az[7];
+    char recoded[7 * 13];
+    int i, retcode;
+
+    retcode = locator2longlat_batch(n, locs, lon, lat);
+
+    if (retcode != -RIG_EINVAL)
+    {
+        fprintf(stderr, "locator2longlat_batch() missed a malformed locator.\n");
+        return 1;
+    }
+
+    for (i = 0; i < n - 1; i++)
+    {
+        double lon2, lat2, d, a;
+        char loc[13];
+
+        locator2longlat(&lon2, &lat2, locs[i]);
+
+        if (lon[i] != lon2 || lat[i] != lat2)
+        {
+            fprintf(stderr, "locator2longlat_batch() differs on %s.\n", locs[i]);
+            return 1;
+        }
+
+        qrb(lon1, lat1, lon2, lat2, &d, &a);
+        qrb_batch(lon1, lat1, 1, &lon2, &lat2, &dist[i], &az[i]);
+
+        if (fabs(dist[i] - d) > 1e-9 || az[i] != a)
+        {
+            fprintf(stderr, "qrb_batch() differs on %s.\n", locs[i]);
+            return 1;
+        }
+
+        longlat2locator(lon2, lat2, loc, loc_len);
+        longlat2locator_batch(1, &lon2, &lat2, recoded + i * (loc_len * 2 + 1),
+                              loc_len);
+
+        if (strcmp(loc, recoded + i * (loc_len * 2 + 1)))
+        {
+            fprintf(stderr, "longlat2locator_batch() differs on %s.\n", locs[i]);
+            return 1;
+        }
+    }
+
+    if (!isnan(lon[n - 1]) || !isnan(lat[n - 1]))
+    {
+        fprintf(stderr, "locator2longlat_batch() converted a malformed locator.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+
 int main(int argc, char *argv[])
 {
     char recodedloc[13], *loc1, *loc2, sign;
@@ -154,6 +215,11 @@ int main(int argc, char *argv[])
 
     printf("  Recoded:\t%s\n", recodedloc);
 
+    if (check_batch(lon1, lat1, loc1, loc_len))
+    {
+        exit(2);
+    }
+
     if (loc2 == NULL)
     {
         exit(0);
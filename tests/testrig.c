@@ -62,6 +62,7 @@ int main(int argc, char *argv[])
     if (argc < 2)
     {
         hamlib_port_t myport;
+        memset(&myport, 0, sizeof(myport));
         /* may be overriden by backend probe */
         myport.type.rig = RIG_PORT_SERIAL;
         myport.parm.serial.rate = 9600;
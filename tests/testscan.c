@@ -0,0 +1,216 @@
+/*
+ * Test of the software scan, see src/scan.c, on the dummy rig with a
+ * scripted squelch: the scan must stop when the hit callback says so,
+ * end after the passes asked, and give up on the first error.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <hamlib/rig.h>
+
+static int failed;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", \
+                    __FILE__, __LINE__, #cond); \
+            failed++; \
+        } \
+    } while (0)
+
+#define NENTRIES 4
+
+static struct rig_caps scripted_caps;
+static int (*dummy_set_freq)(RIG *rig, vfo_t vfo, freq_t freq);
+
+static const struct rig_scan_entry entries[NENTRIES] =
+{
+    { -1, 145500000, 0 },
+    { -1, 145525000, 0 },
+    { -1, 145550000, 0 },
+    { -1, 145575000, 0 },
+};
+
+/* the script: which frequency is busy, and after how many polls to fail */
+static freq_t busy_freq;
+static int fail_after;
+
+static freq_t tuned;
+static int tunes;
+static int polls;
+static int hits;
+static int last_hit;
+
+
+static int scripted_set_freq(RIG *rig, vfo_t vfo, freq_t freq)
+{
+    tuned = freq;
+    tunes++;
+
+    return dummy_set_freq(rig, vfo, freq);
+}
+
+
+static int scripted_get_dcd(RIG *rig, vfo_t vfo, dcd_t *dcd)
+{
+    if (fail_after && ++polls > fail_after)
+    {
+        return -RIG_EIO;
+    }
+
+    *dcd = tuned == busy_freq ? RIG_DCD_ON : RIG_DCD_OFF;
+
+    return RIG_OK;
+}
+
+
+static int hit_stop(RIG *rig, const struct rig_scan_hit *hit, rig_ptr_t arg)
+{
+    hits++;
+    last_hit = hit->index;
+
+    return 1;
+}
+
+
+static int hit_go_on(RIG *rig, const struct rig_scan_hit *hit, rig_ptr_t arg)
+{
+    hits++;
+    last_hit = hit->index;
+
+    return 0;
+}
+
+
+static void reset(freq_t busy, int fail)
+{
+    busy_freq = busy;
+    fail_after = fail;
+    tuned = 0;
+    tunes = polls = hits = 0;
+    last_hit = -1;
+}
+
+
+static void init_params(struct rig_scan_params *p, int passes)
+{
+    memset(p, 0, sizeof(*p));
+    p->entries = entries;
+    p->nentries = NENTRIES;
+    p->sense = RIG_SCAN_SENSE_DCD;
+    p->passes = passes;
+}
+
+
+/* no pass limit: only the callback ends the scan */
+static void test_stop_on_hit(RIG *rig)
+{
+    struct rig_scan_params p;
+
+    init_params(&p, 0);
+    reset(entries[2].freq, 0);
+
+    CHECK(rig_scan_soft(rig, RIG_VFO_CURR, &p, hit_stop, NULL) == RIG_OK);
+    CHECK(hits == 1 && last_hit == 2);
+    CHECK(tunes == 3);
+}
+
+
+static void test_passes(RIG *rig)
+{
+    struct rig_scan_params p;
+
+    /* all quiet */
+    init_params(&p, 3);
+    reset(0, 0);
+
+    CHECK(rig_scan_soft(rig, RIG_VFO_CURR, &p, hit_go_on, NULL) == RIG_OK);
+    CHECK(tunes == 3 * NENTRIES);
+    CHECK(hits == 0);
+
+    /* a busy channel, the callback lets the scan go on */
+    init_params(&p, 2);
+    reset(entries[1].freq, 0);
+
+    CHECK(rig_scan_soft(rig, RIG_VFO_CURR, &p, hit_go_on, NULL) == RIG_OK);
+    CHECK(tunes == 2 * NENTRIES);
+    CHECK(hits == 2 && last_hit == 1);
+}
+
+
+static void test_error(RIG *rig)
+{
+    struct rig_scan_params p;
+
+    /* even without a pass limit */
+    init_params(&p, 0);
+    reset(0, 5);
+
+    CHECK(rig_scan_soft(rig, RIG_VFO_CURR, &p, hit_go_on, NULL) == -RIG_EIO);
+    CHECK(polls == 6);
+    CHECK(hits == 0);
+
+    /* malformed parameters */
+    init_params(&p, -1);
+    CHECK(rig_scan_soft(rig, RIG_VFO_CURR, &p, NULL, NULL) == -RIG_EINVAL);
+    init_params(&p, 1);
+    p.nentries = 0;
+    CHECK(rig_scan_soft(rig, RIG_VFO_CURR, &p, NULL, NULL) == -RIG_EINVAL);
+}
+
+
+int main(int argc, char *argv[])
+{
+    RIG *rig;
+    int retcode;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    rig = rig_init(RIG_MODEL_DUMMY);
+
+    if (!rig)
+    {
+        fprintf(stderr, "rig_init failed\n");
+        return 1;
+    }
+
+    /* the dummy rig, with a squelch to order, tuned then read apart */
+    memcpy(&scripted_caps, rig->caps, sizeof(scripted_caps));
+    dummy_set_freq = scripted_caps.set_freq;
+    scripted_caps.set_freq = scripted_set_freq;
+    scripted_caps.get_dcd = scripted_get_dcd;
+    scripted_caps.tune_get_dcd = NULL;
+    rig->caps = &scripted_caps;
+
+    retcode = rig_open(rig);
+
+    if (retcode != RIG_OK)
+    {
+        fprintf(stderr, "rig_open: %s\n", rigerror(retcode));
+        return 1;
+    }
+
+    test_stop_on_hit(rig);
+    test_passes(rig);
+    test_error(rig);
+
+    rig_close(rig);
+    rig_cleanup(rig);
+
+    if (failed)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failed);
+        return 1;
+    }
+
+    printf("software scan OK\n");
+
+    return 0;
+}
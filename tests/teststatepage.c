@@ -0,0 +1,188 @@
+/*
+ * Test of the shared state page, see src/statepage.c.  A reader must get
+ * what the writer published, and the writer must leave alone any file
+ * which is not a page.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <hamlib/rig.h>
+
+static int failed;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", \
+                    __FILE__, __LINE__, #cond); \
+            failed++; \
+        } \
+    } while (0)
+
+
+static void write_file(const char *path, const char *s, size_t len)
+{
+    FILE *f = fopen(path, "wb");
+
+    CHECK(f != NULL);
+
+    if (f)
+    {
+        CHECK(fwrite(s, 1, len, f) == len);
+        fclose(f);
+    }
+}
+
+
+/* the whole of 'path' is still 's' */
+static int same_file(const char *path, const char *s, size_t len)
+{
+    char buf[512];
+    size_t n;
+    FILE *f = fopen(path, "rb");
+
+    if (!f)
+    {
+        return 0;
+    }
+
+    n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+
+    return n == len && !memcmp(buf, s, len);
+}
+
+
+static void test_publish(const char *path)
+{
+    struct rig_state_page *writer = NULL;
+    struct rig_state_page *reader = NULL;
+    struct rig_state_snapshot snap, got;
+
+    /* an empty file becomes a page */
+    write_file(path, "", 0);
+    CHECK(rig_state_page_create(path, &writer) == RIG_OK);
+    CHECK(rig_state_page_open(path, &reader) == RIG_OK);
+
+    if (!writer || !reader)
+    {
+        return;
+    }
+
+    CHECK(rig_state_page_read(reader, &got) == RIG_OK);
+    CHECK(got.count == 0 && got.vfo == RIG_VFO_NONE && got.ptt == RIG_PTT_OFF);
+
+    memset(&snap, 0, sizeof(snap));
+    snap.vfo = RIG_VFO_B;
+    snap.freq = 145500000.5;
+    snap.mode = RIG_MODE_FM;
+    snap.width = 15000;
+    snap.ptt = RIG_PTT_ON;
+    snap.stamp = 1600000000.25;
+    CHECK(rig_state_page_publish(writer, &snap) == RIG_OK);
+
+    CHECK(rig_state_page_read(reader, &got) == RIG_OK);
+    CHECK(got.vfo == RIG_VFO_B);
+    CHECK(got.freq == 145500000.5);
+    CHECK(got.mode == RIG_MODE_FM);
+    CHECK(got.width == 15000);
+    CHECK(got.ptt == RIG_PTT_ON);
+    CHECK(got.stamp == 1600000000.25);
+    CHECK(got.count == 1);
+
+    /* a reader cannot publish */
+    CHECK(rig_state_page_publish(reader, &snap) == -RIG_EINVAL);
+
+    /* the next writer takes the page over, the reader keeps its mapping */
+    CHECK(rig_state_page_close(writer) == RIG_OK);
+    writer = NULL;
+    CHECK(rig_state_page_create(path, &writer) == RIG_OK);
+
+    if (writer)
+    {
+        snap.ptt = RIG_PTT_OFF;
+        CHECK(rig_state_page_publish(writer, &snap) == RIG_OK);
+        CHECK(rig_state_page_read(reader, &got) == RIG_OK);
+        CHECK(got.ptt == RIG_PTT_OFF && got.count == 2);
+        rig_state_page_close(writer);
+    }
+
+    rig_state_page_close(reader);
+}
+
+
+static void test_foreign(const char *path)
+{
+    static const char text[] =
+        "not a state page, but a file long enough to hold one, which "
+        "rig_state_page_create() must not overwrite, whatever it holds\n";
+    struct rig_state_page *page = NULL;
+
+    write_file(path, text, sizeof(text) - 1);
+    CHECK(rig_state_page_create(path, &page) == -RIG_EPROTO && !page);
+    CHECK(rig_state_page_open(path, &page) == -RIG_EPROTO && !page);
+    CHECK(same_file(path, text, sizeof(text) - 1));
+
+    /* too short for a page */
+    write_file(path, "x", 1);
+    CHECK(rig_state_page_create(path, &page) == -RIG_EPROTO && !page);
+    CHECK(same_file(path, "x", 1));
+
+    /* a reader does not take an empty file */
+    write_file(path, "", 0);
+    CHECK(rig_state_page_open(path, &page) == -RIG_EPROTO && !page);
+}
+
+
+int main(int argc, char *argv[])
+{
+    char path[] = "teststatepage.XXXXXX";
+    struct rig_state_page *page = NULL;
+    int fd;
+
+    rig_set_debug(RIG_DEBUG_NONE);
+
+    fd = mkstemp(path);
+
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        return 1;
+    }
+
+    close(fd);
+
+    if (rig_state_page_create(path, &page) == -RIG_ENIMPL)
+    {
+        printf("no memory mapped files, skipped\n");
+        unlink(path);
+        return 77;
+    }
+
+    if (page)
+    {
+        rig_state_page_close(page);
+    }
+
+    test_publish(path);
+    test_foreign(path);
+
+    unlink(path);
+
+    if (failed)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failed);
+        return 1;
+    }
+
+    printf("state page OK\n");
+
+    return 0;
+}
@@ -4386,6 +4386,11 @@ int newcat_get_cmd (RIG *rig)
 
   while (rc != RIG_OK && retry_count++ <= state->rigport.retry)
     {
+      if (retry_count > 1)
+        {
+          state->rigport.stats.retries++;
+        }
+
       if (rc != -RIG_BUSBUSY)
         {
           /* send the command */
@@ -4412,6 +4417,7 @@ int newcat_get_cmd (RIG *rig)
         {
           rig_debug(RIG_DEBUG_ERR, "%s: Command is not correctly terminated '%s'\n",
                     __func__, priv->ret_data);
+          state->rigport.stats.protocol_errors++;
           rc = -RIG_BUSBUSY;    /* don't write command again */
                                 /* we could decrement retry_count
                                    here but there is a danger of
@@ -4438,12 +4444,14 @@ int newcat_get_cmd (RIG *rig)
             case 'O':
               /* Too many characters sent without a carriage return */
               rig_debug(RIG_DEBUG_VERBOSE, "%s: Overflow for '%s'\n", __func__, priv->cmd_str);
+              state->rigport.stats.protocol_errors++;
               rc = -RIG_EPROTO;
               break;            /* retry */
 
             case 'E':
               /* Communication error */
               rig_debug(RIG_DEBUG_VERBOSE, "%s: Communication error for '%s'\n", __func__, priv->cmd_str);
+              state->rigport.stats.protocol_errors++;
               rc = -RIG_EIO;
               break;            /* retry */
 
@@ -4466,6 +4474,7 @@ int newcat_get_cmd (RIG *rig)
            */
           rig_debug(RIG_DEBUG_ERR, "%s: wrong reply %.2s for command %.2s\n",
                     __func__, priv->ret_data, priv->cmd_str);
+          state->rigport.stats.protocol_errors++;
           rc = -RIG_BUSBUSY;    /* retry read only */
         }
     }